@@ -0,0 +1,861 @@
+#include "AssetLoader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// io_uring is used when liburing is installed, link with -luring //
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<liburing.h>)
+#include <liburing.h>
+#define POWERENGINE_HAS_IO_URING 1
+#endif
+#endif
+
+namespace PowerEngine
+{
+	namespace Assets
+	{
+		namespace
+		{
+			using Clock = std::chrono::steady_clock;
+
+			double SecondsSince(Clock::time_point start)
+			{
+				return std::chrono::duration<double>(Clock::now() - start).count();
+			}
+
+#if defined(_WIN32)
+			using FileHandle = HANDLE;
+			const FileHandle g_InvalidFile = INVALID_HANDLE_VALUE;
+
+			FileHandle OpenForRead(const std::string& path, std::uint64_t& size)
+			{
+				HANDLE file = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+				LARGE_INTEGER fileSize = {};
+				if (file != INVALID_HANDLE_VALUE && ::GetFileSizeEx(file, &fileSize))
+				{
+					size = static_cast<std::uint64_t>(fileSize.QuadPart);
+				}
+				return file;
+			}
+
+			void CloseFile(FileHandle file)
+			{
+				::CloseHandle(file);
+			}
+
+			bool QueryFileSize(const std::string& path, std::uint64_t& size)
+			{
+				WIN32_FILE_ATTRIBUTE_DATA attributes = {};
+				if (!::GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &attributes))
+				{
+					return false;
+				}
+
+				size = (static_cast<std::uint64_t>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+				return true;
+			}
+
+			bool ReadAt(FileHandle file, std::uint8_t* destination, std::uint64_t size, std::uint64_t offset)
+			{
+				while (size > 0)
+				{
+					OVERLAPPED overlapped = {};
+					overlapped.Offset = static_cast<DWORD>(offset);
+					overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+					DWORD chunk = static_cast<DWORD>(size > (1u << 30) ? (1u << 30) : size);
+					DWORD read = 0;
+					if (!::ReadFile(file, destination, chunk, &read, &overlapped) || read == 0)
+					{
+						return false;
+					}
+
+					destination += read;
+					offset += read;
+					size -= read;
+				}
+				return true;
+			}
+#else
+			using FileHandle = int;
+			const FileHandle g_InvalidFile = -1;
+
+			FileHandle OpenForRead(const std::string& path, std::uint64_t& size)
+			{
+				int file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+				struct stat info = {};
+				if (file >= 0 && ::fstat(file, &info) == 0)
+				{
+					size = static_cast<std::uint64_t>(info.st_size);
+				}
+				return file;
+			}
+
+			void CloseFile(FileHandle file)
+			{
+				::close(file);
+			}
+
+			bool QueryFileSize(const std::string& path, std::uint64_t& size)
+			{
+				struct stat info = {};
+				if (::stat(path.c_str(), &info) != 0)
+				{
+					return false;
+				}
+
+				size = static_cast<std::uint64_t>(info.st_size);
+				return true;
+			}
+
+			bool ReadAt(FileHandle file, std::uint8_t* destination, std::uint64_t size, std::uint64_t offset)
+			{
+				while (size > 0)
+				{
+					ssize_t read = ::pread(file, destination, static_cast<size_t>(size), static_cast<off_t>(offset));
+					if (read <= 0)
+					{
+						return false;
+					}
+
+					destination += read;
+					offset += static_cast<std::uint64_t>(read);
+					size -= static_cast<std::uint64_t>(read);
+				}
+				return true;
+			}
+#endif
+		}
+
+#if defined(POWERENGINE_HAS_IO_URING)
+		struct AssetLoader::IoRing
+		{
+			io_uring Ring;
+		};
+#else
+		struct AssetLoader::IoRing
+		{
+		};
+#endif
+
+		AssetLoader::AssetLoader(IAssetUploader& uploader, Core::ThreadPool& workers, std::uint32_t readBatchSize, std::uint64_t maxBufferedBytes)
+			: m_Uploader(uploader)
+			, m_Workers(workers)
+			, m_ReadBatchSize(readBatchSize ? readBatchSize : 1)
+			, m_MaxBufferedBytes(maxBufferedBytes)
+		{
+#if defined(POWERENGINE_HAS_IO_URING)
+			// One ring deep enough for a batch, reads fall back to pread without it //
+
+			m_Ring = std::make_unique<IoRing>();
+			if (io_uring_queue_init(m_ReadBatchSize, &m_Ring->Ring, 0) != 0)
+			{
+				m_Ring.reset();
+			}
+#endif
+
+			m_IoThread = std::thread(&AssetLoader::IoThread, this);
+			m_UploadThread = std::thread(&AssetLoader::UploadThread, this);
+		}
+
+		AssetLoader::~AssetLoader()
+		{
+			// Set under each lock so no waiter checks its predicate between the store and the notify //
+
+			{
+				std::lock_guard<std::mutex> readLock(m_ReadMutex);
+				std::lock_guard<std::mutex> bufferLock(m_BufferMutex);
+				std::lock_guard<std::mutex> uploadLock(m_UploadMutex);
+				m_Stop = true;
+			}
+			m_ReadAvailable.notify_all();
+			m_BuffersReleased.notify_all();
+			m_UploadAvailable.notify_all();
+
+			m_IoThread.join();
+
+			// Decompression jobs hold a pointer to the loader //
+
+			while (m_DecompressJobs.load() != 0)
+			{
+				if (!m_Workers.RunPendingJob())
+				{
+					std::this_thread::yield();
+				}
+			}
+
+			m_UploadThread.join();
+
+#if defined(POWERENGINE_HAS_IO_URING)
+			if (m_Ring)
+			{
+				io_uring_queue_exit(&m_Ring->Ring);
+			}
+#endif
+		}
+
+		AssetRequestId AssetLoader::Load(AssetRequestDesc desc)
+		{
+			RequestPtr request = std::make_shared<Request>();
+			request->Id = m_NextId++;
+			request->Desc = std::move(desc);
+
+			{
+				std::lock_guard<std::mutex> lock(m_RequestsMutex);
+				m_Requests.emplace(request->Id, request);
+			}
+			{
+				std::lock_guard<std::mutex> lock(m_StatsMutex);
+				m_Stats.InFlight++;
+			}
+			{
+				std::lock_guard<std::mutex> lock(m_ReadMutex);
+				m_ReadQueue.push(request);
+			}
+			m_ReadAvailable.notify_one();
+
+			return request->Id;
+		}
+
+		void AssetLoader::Cancel(AssetRequestId id)
+		{
+			std::lock_guard<std::mutex> lock(m_RequestsMutex);
+
+			auto it = m_Requests.find(id);
+			if (it != m_Requests.end())
+			{
+				it->second->Cancelled = true;
+			}
+		}
+
+		void AssetLoader::Update()
+		{
+			std::vector<RequestPtr> completed;
+			{
+				std::lock_guard<std::mutex> lock(m_CompletedMutex);
+				completed.swap(m_Completed);
+			}
+
+			if (completed.empty())
+			{
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_RequestsMutex);
+				for (const RequestPtr& request : completed)
+				{
+					m_Requests.erase(request->Id);
+				}
+			}
+
+			for (const RequestPtr& request : completed)
+			{
+				if (request->Desc.OnComplete)
+				{
+					request->Desc.OnComplete(request->Id, request->Status);
+				}
+			}
+		}
+
+		AssetLoaderStats AssetLoader::Stats() const
+		{
+			AssetLoaderStats stats;
+			{
+				std::lock_guard<std::mutex> lock(m_StatsMutex);
+				stats = m_Stats;
+			}
+
+			std::lock_guard<std::mutex> lock(m_BufferMutex);
+			stats.BufferedBytes = m_BufferedBytes;
+			stats.PeakBufferedBytes = m_PeakBufferedBytes;
+			return stats;
+		}
+
+		void AssetLoader::ResetStats()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_StatsMutex);
+
+				std::uint32_t inFlight = m_Stats.InFlight;
+				m_Stats = AssetLoaderStats();
+				m_Stats.InFlight = inFlight;
+			}
+
+			std::lock_guard<std::mutex> lock(m_BufferMutex);
+			m_PeakBufferedBytes = m_BufferedBytes;
+		}
+
+		void AssetLoader::Finish(const RequestPtr& request, AssetStatus status)
+		{
+			if (status == AssetStatus::Completed && request->Cancelled)
+			{
+				status = AssetStatus::Cancelled;
+			}
+
+			request->Status = status;
+			request->Data.clear();
+			request->Data.shrink_to_fit();
+			Release(*request, request->ReservedBytes);
+
+			{
+				std::lock_guard<std::mutex> lock(m_StatsMutex);
+				m_Stats.InFlight--;
+				switch (status)
+				{
+				case AssetStatus::Completed: m_Stats.Completed++; break;
+				case AssetStatus::Cancelled: m_Stats.Cancelled++; break;
+				default: m_Stats.Failed++; break;
+				}
+			}
+
+			std::lock_guard<std::mutex> lock(m_CompletedMutex);
+			m_Completed.push_back(request);
+		}
+
+		void AssetLoader::IoThread()
+		{
+			std::vector<RequestPtr> batch;
+			batch.reserve(m_ReadBatchSize);
+
+			while (!m_Stop)
+			{
+				{
+					std::unique_lock<std::mutex> lock(m_ReadMutex);
+					m_ReadAvailable.wait(lock, [this]() { return m_Stop || !m_ReadQueue.empty(); });
+
+					while (!m_ReadQueue.empty() && batch.size() < m_ReadBatchSize)
+					{
+						batch.push_back(m_ReadQueue.top());
+						m_ReadQueue.pop();
+					}
+				}
+
+				// Requests that don't fit under the buffer cap go back to the queue //
+
+				ReserveBuffers(batch);
+
+				if (batch.empty())
+				{
+					continue;
+				}
+
+				Clock::time_point start = Clock::now();
+				ReadBatch(batch);
+				double seconds = SecondsSince(start);
+
+				std::uint64_t bytes = 0;
+				for (const RequestPtr& request : batch)
+				{
+					bytes += request->Data.size();
+				}
+				{
+					std::lock_guard<std::mutex> lock(m_StatsMutex);
+					m_Stats.Read.Bytes += bytes;
+					m_Stats.Read.BusySeconds += seconds;
+				}
+
+				for (RequestPtr& request : batch)
+				{
+					if (request->Cancelled)
+					{
+						Finish(request, AssetStatus::Cancelled);
+					}
+					else if (request->Status == AssetStatus::Failed)
+					{
+						Finish(request, AssetStatus::Failed);
+					}
+					else if (request->Desc.Compression == AssetCompression::None && request->Desc.Encode.Width == 0)
+					{
+						{
+							std::lock_guard<std::mutex> lock(m_UploadMutex);
+							m_UploadQueue.push(request);
+						}
+						m_UploadAvailable.notify_one();
+					}
+					else
+					{
+						{
+							std::lock_guard<std::mutex> lock(m_DecompressMutex);
+							m_DecompressQueue.push(request);
+						}
+
+						// Each job takes whatever is most urgent when it starts, not this request //
+
+						m_DecompressJobs++;
+						m_Workers.Submit([this]()
+						{
+							DecompressOne();
+							m_DecompressJobs--;
+						});
+					}
+				}
+
+				batch.clear();
+			}
+		}
+
+		void AssetLoader::ReserveBuffers(std::vector<RequestPtr>& batch)
+		{
+			for (size_t i = 0; i < batch.size(); ++i)
+			{
+				Request& request = *batch[i];
+				if (request.Cancelled)
+				{
+					continue;
+				}
+
+				std::uint64_t fileSize = 0;
+				if (!QueryFileSize(request.Desc.Path, fileSize) || request.Desc.Offset >= fileSize)
+				{
+					request.Status = AssetStatus::Failed;
+					continue;
+				}
+
+				request.ReadSize = request.Desc.Size ? request.Desc.Size : fileSize - request.Desc.Offset;
+				if (request.ReadSize > fileSize - request.Desc.Offset)
+				{
+					request.Status = AssetStatus::Failed;
+					continue;
+				}
+
+				const std::uint64_t bytes = request.ReadSize + (request.Desc.Compression != AssetCompression::None ? request.Desc.UncompressedSize : 0) +
+					(request.Desc.Encode.Width != 0 ? request.Desc.Encode.EncodedSize() : 0);
+
+				// Only the first request may wait, what the batch holds is released after it is read //
+
+				if (!Reserve(bytes, i == 0))
+				{
+					{
+						std::lock_guard<std::mutex> lock(m_ReadMutex);
+						for (size_t j = i; j < batch.size(); ++j)
+						{
+							m_ReadQueue.push(batch[j]);
+						}
+					}
+
+					batch.resize(i);
+					return;
+				}
+
+				request.ReservedBytes = bytes;
+			}
+		}
+
+		bool AssetLoader::Reserve(std::uint64_t bytes, bool wait)
+		{
+			std::unique_lock<std::mutex> lock(m_BufferMutex);
+
+			auto fits = [&]() { return m_BufferedBytes == 0 || m_BufferedBytes + bytes <= m_MaxBufferedBytes; };
+
+			if (wait)
+			{
+				m_BuffersReleased.wait(lock, [&]() { return m_Stop || fits(); });
+			}
+
+			if (m_Stop || !fits())
+			{
+				return false;
+			}
+
+			m_BufferedBytes += bytes;
+			m_PeakBufferedBytes = std::max(m_PeakBufferedBytes, m_BufferedBytes);
+			return true;
+		}
+
+		void AssetLoader::Release(Request& request, std::uint64_t bytes)
+		{
+			bytes = std::min(bytes, request.ReservedBytes);
+			if (bytes == 0)
+			{
+				return;
+			}
+
+			request.ReservedBytes -= bytes;
+			{
+				std::lock_guard<std::mutex> lock(m_BufferMutex);
+				m_BufferedBytes -= bytes;
+			}
+			m_BuffersReleased.notify_one();
+		}
+
+		void AssetLoader::ReadBatch(std::vector<RequestPtr>& batch)
+		{
+			std::vector<FileHandle> files(batch.size(), g_InvalidFile);
+
+			for (size_t i = 0; i < batch.size(); ++i)
+			{
+				Request& request = *batch[i];
+				if (request.Cancelled || request.Status == AssetStatus::Failed)
+				{
+					continue;
+				}
+
+				// The size was checked when the buffers were reserved, a file shrunk since then fails //
+
+				std::uint64_t fileSize = 0;
+				files[i] = OpenForRead(request.Desc.Path, fileSize);
+
+				if (files[i] == g_InvalidFile || request.Desc.Offset >= fileSize || request.ReadSize > fileSize - request.Desc.Offset)
+				{
+					request.Status = AssetStatus::Failed;
+					continue;
+				}
+
+				request.Data.resize(static_cast<size_t>(request.ReadSize));
+			}
+
+			std::vector<bool> done(batch.size(), false);
+
+#if defined(POWERENGINE_HAS_IO_URING)
+			// One submission for the whole batch, short or failed reads fall back to pread below //
+
+			if (m_Ring)
+			{
+				io_uring& ring = m_Ring->Ring;
+
+				unsigned submitted = 0;
+				for (size_t i = 0; i < batch.size(); ++i)
+				{
+					Request& request = *batch[i];
+					if (request.Data.empty() || request.Status == AssetStatus::Failed || request.Data.size() > 0x7FFFF000u)
+					{
+						continue;
+					}
+
+					io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+					io_uring_prep_read(sqe, files[i], request.Data.data(), static_cast<unsigned>(request.Data.size()), request.Desc.Offset);
+					io_uring_sqe_set_data64(sqe, i);
+					submitted++;
+				}
+
+				io_uring_submit(&ring);
+
+				for (unsigned completed = 0; completed < submitted; ++completed)
+				{
+					io_uring_cqe* cqe = nullptr;
+					if (io_uring_wait_cqe(&ring, &cqe) != 0)
+					{
+						break;
+					}
+
+					size_t index = static_cast<size_t>(io_uring_cqe_get_data64(cqe));
+					done[index] = cqe->res >= 0 && static_cast<size_t>(cqe->res) == batch[index]->Data.size();
+					io_uring_cqe_seen(&ring, cqe);
+				}
+			}
+#endif
+
+			for (size_t i = 0; i < batch.size(); ++i)
+			{
+				Request& request = *batch[i];
+
+				if (!done[i] && !request.Data.empty() && request.Status != AssetStatus::Failed)
+				{
+					if (!ReadAt(files[i], request.Data.data(), request.Data.size(), request.Desc.Offset))
+					{
+						request.Status = AssetStatus::Failed;
+					}
+				}
+
+				if (files[i] != g_InvalidFile)
+				{
+					CloseFile(files[i]);
+				}
+			}
+		}
+
+		void AssetLoader::DecompressOne()
+		{
+			RequestPtr request;
+			{
+				std::lock_guard<std::mutex> lock(m_DecompressMutex);
+				if (m_DecompressQueue.empty())
+				{
+					return;
+				}
+
+				request = m_DecompressQueue.top();
+				m_DecompressQueue.pop();
+			}
+
+			if (request->Cancelled || m_Stop)
+			{
+				Finish(request, AssetStatus::Cancelled);
+				return;
+			}
+
+			if (request->Desc.Compression != AssetCompression::None)
+			{
+				Clock::time_point start = Clock::now();
+
+				Core::TaggedVector<std::uint8_t, Core::MemoryTag::Assets> decompressed(static_cast<size_t>(request->Desc.UncompressedSize));
+				bool succeeded = DecompressLz4(request->Data.data(), request->Data.size(), decompressed.data(), decompressed.size());
+
+				double seconds = SecondsSince(start);
+				{
+					std::lock_guard<std::mutex> lock(m_StatsMutex);
+					m_Stats.Decompress.Bytes += decompressed.size();
+					m_Stats.Decompress.BusySeconds += seconds;
+				}
+
+				if (!succeeded)
+				{
+					Finish(request, AssetStatus::Failed);
+					return;
+				}
+
+				const std::uint64_t compressedSize = request->Data.size();
+				request->Data.swap(decompressed);
+
+				// The compressed buffer is gone, only the decompressed one still counts //
+
+				decompressed.clear();
+				decompressed.shrink_to_fit();
+				Release(*request, compressedSize);
+			}
+
+			if (request->Desc.Encode.Width != 0 && !EncodeTexture(*request))
+			{
+				Finish(request, AssetStatus::Failed);
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_UploadMutex);
+				m_UploadQueue.push(request);
+			}
+			m_UploadAvailable.notify_one();
+		}
+
+		bool AssetLoader::EncodeTexture(Request& request)
+		{
+			const AssetTextureEncode& encode = request.Desc.Encode;
+			const std::uint64_t sourceRowPitch = std::uint64_t(encode.Width) * 4;
+
+			if (encode.Height == 0 || sourceRowPitch > UINT32_MAX || request.Data.size() < sourceRowPitch * encode.Height ||
+				encode.EncodedRowPitch() < CompressedRowSize(encode.Format, encode.Width))
+			{
+				return false;
+			}
+
+			Clock::time_point start = Clock::now();
+
+			// Tiles spread over the same workers, the nested ParallelFor runs its share here //
+
+			Core::TaggedVector<std::uint8_t, Core::MemoryTag::Assets> encoded(static_cast<size_t>(encode.EncodedSize()));
+			CompressTexture({ request.Data.data(), encode.Width, encode.Height, static_cast<std::uint32_t>(sourceRowPitch) },
+				encode.Format, encode.Quality, encoded.data(), encode.EncodedRowPitch(), m_Workers);
+
+			double seconds = SecondsSince(start);
+			{
+				std::lock_guard<std::mutex> lock(m_StatsMutex);
+				m_Stats.Encode.Bytes += sourceRowPitch * encode.Height;
+				m_Stats.Encode.BusySeconds += seconds;
+			}
+
+			const std::uint64_t sourceSize = request.Data.size();
+			request.Data.swap(encoded);
+
+			encoded.clear();
+			encoded.shrink_to_fit();
+			Release(request, sourceSize);
+
+			return true;
+		}
+
+		void AssetLoader::UploadThread()
+		{
+			for (;;)
+			{
+				std::vector<RequestPtr> batch;
+				{
+					std::unique_lock<std::mutex> lock(m_UploadMutex);
+
+					// Idle, the thread sleeps until something is queued; with copies in flight it polls their fence //
+
+					auto ready = [this]() { return m_Stop || !m_UploadQueue.empty(); };
+					if (m_UploadsInFlight.empty())
+					{
+						m_UploadAvailable.wait(lock, ready);
+					}
+					else
+					{
+						m_UploadAvailable.wait_for(lock, std::chrono::milliseconds(1), ready);
+					}
+
+					while (!m_UploadQueue.empty())
+					{
+						batch.push_back(m_UploadQueue.top());
+						m_UploadQueue.pop();
+					}
+				}
+
+				if (!batch.empty())
+				{
+					Clock::time_point start = Clock::now();
+					std::uint64_t bytes = 0;
+					bool recorded = false;
+
+					for (RequestPtr& request : batch)
+					{
+						if (request->Cancelled)
+						{
+							Finish(request, AssetStatus::Cancelled);
+							continue;
+						}
+
+						request->FenceValue = m_Uploader.Upload(request->Desc, request->Data.data(), request->Data.size());
+						bytes += request->Data.size();
+						recorded = true;
+
+						// The uploader owns a copy now //
+
+						request->Data.clear();
+						request->Data.shrink_to_fit();
+						Release(*request, request->ReservedBytes);
+						m_UploadsInFlight.push_back(request);
+					}
+
+					if (recorded)
+					{
+						m_Uploader.Submit();
+					}
+
+					double seconds = SecondsSince(start);
+					std::lock_guard<std::mutex> lock(m_StatsMutex);
+					m_Stats.Upload.Bytes += bytes;
+					m_Stats.Upload.BusySeconds += seconds;
+				}
+
+				if (!m_UploadsInFlight.empty())
+				{
+					std::uint64_t completedValue = m_Uploader.CompletedValue();
+
+					auto it = std::remove_if(m_UploadsInFlight.begin(), m_UploadsInFlight.end(), [&](const RequestPtr& request)
+					{
+						if (request->FenceValue > completedValue)
+						{
+							return false;
+						}
+
+						Finish(request, AssetStatus::Completed);
+						return true;
+					});
+					m_UploadsInFlight.erase(it, m_UploadsInFlight.end());
+				}
+
+				if (m_Stop && m_UploadsInFlight.empty() && m_DecompressJobs.load() == 0)
+				{
+					std::lock_guard<std::mutex> lock(m_UploadMutex);
+					if (m_UploadQueue.empty())
+					{
+						return;
+					}
+				}
+			}
+		}
+
+		bool AssetLoader::DecompressLz4(const std::uint8_t* source, std::uint64_t sourceSize, std::uint8_t* destination, std::uint64_t destinationSize)
+		{
+			const std::uint8_t* ip = source;
+			const std::uint8_t* const ipEnd = source + sourceSize;
+			std::uint8_t* op = destination;
+			std::uint8_t* const opEnd = destination + destinationSize;
+
+			auto readLength = [&](std::uint64_t length, bool& valid) -> std::uint64_t
+			{
+				if (length != 15)
+				{
+					return length;
+				}
+
+				std::uint8_t byte;
+				do
+				{
+					if (ip >= ipEnd)
+					{
+						valid = false;
+						return 0;
+					}
+					byte = *ip++;
+					length += byte;
+				} while (byte == 255);
+
+				return length;
+			};
+
+			while (ip < ipEnd)
+			{
+				bool valid = true;
+				const std::uint8_t token = *ip++;
+
+				std::uint64_t literals = readLength(token >> 4, valid);
+				if (!valid || literals > static_cast<std::uint64_t>(ipEnd - ip) || literals > static_cast<std::uint64_t>(opEnd - op))
+				{
+					return false;
+				}
+
+				std::memcpy(op, ip, static_cast<size_t>(literals));
+				ip += literals;
+				op += literals;
+
+				// The last sequence only carries literals //
+
+				if (ip == ipEnd)
+				{
+					break;
+				}
+
+				if (ipEnd - ip < 2)
+				{
+					return false;
+				}
+
+				const std::uint64_t offset = std::uint64_t(ip[0]) | (std::uint64_t(ip[1]) << 8);
+				ip += 2;
+
+				if (offset == 0 || offset > static_cast<std::uint64_t>(op - destination))
+				{
+					return false;
+				}
+
+				std::uint64_t match = readLength(token & 15, valid) + 4;
+				if (!valid || match > static_cast<std::uint64_t>(opEnd - op))
+				{
+					return false;
+				}
+
+				// Matches may overlap the bytes they produce //
+
+				const std::uint8_t* from = op - offset;
+				if (offset >= match)
+				{
+					std::memcpy(op, from, static_cast<size_t>(match));
+					op += match;
+				}
+				else
+				{
+					for (std::uint64_t i = 0; i < match; ++i)
+					{
+						*op++ = *from++;
+					}
+				}
+			}
+
+			return op == opEnd;
+		}
+	}
+}
@@ -0,0 +1,249 @@
+#pragma once
+
+#include "ThreadPool.h"
+#include "MemoryTracker.h"
+#include "TextureCompressor.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Assets {
+
+		using AssetRequestId = std::uint64_t;
+
+		enum class AssetPriority : std::uint8_t
+		{
+			Low = 0,
+			Normal,
+			High,
+			Critical
+		};
+
+		enum class AssetCompression : std::uint8_t
+		{
+			None = 0,
+			Lz4			// raw LZ4 block, UncompressedSize must be set
+		};
+
+		enum class AssetStatus : std::uint8_t
+		{
+			Pending = 0,
+			Completed,
+			Cancelled,
+			Failed
+		};
+
+		// Block compression of an RGBA8 texture at import, before it is uploaded //
+		/*
+		   The loaded (and decompressed) data holds Height rows of Width RGBA8 texels,
+		   tightly packed. The workers compress it with CompressTexture and the uploader
+		   receives the block rows, RowPitch bytes apart.
+		*/
+
+		struct AssetTextureEncode
+		{
+			std::uint32_t Width = 0;				// 0 uploads the data as it was loaded
+			std::uint32_t Height = 0;
+			BlockFormat Format = BlockFormat::BC7;
+			CompressionQuality Quality = CompressionQuality::High;
+			std::uint64_t RowPitch = 0;				// 0 packs the block rows, else e.g. a copyable footprint's RowPitch
+
+			std::uint64_t EncodedRowPitch() const { return RowPitch ? RowPitch : CompressedRowSize(Format, Width); }
+			std::uint64_t EncodedSize() const { return EncodedRowPitch() * BlockCount(Height); }
+		};
+
+		struct AssetRequestDesc
+		{
+			std::string Path;
+			std::uint64_t Offset = 0;
+			std::uint64_t Size = 0;					// 0 reads up to the end of the file
+			AssetCompression Compression = AssetCompression::None;
+			std::uint64_t UncompressedSize = 0;
+			AssetPriority Priority = AssetPriority::Normal;
+			AssetTextureEncode Encode;
+
+			// Interpreted by the uploader, e.g. the destination ID3D12Resource and the byte offset in it //
+
+			void* UploadTarget = nullptr;
+			std::uint64_t UploadOffset = 0;
+
+			// Called from AssetLoader::Update() on the thread that polls the loader //
+
+			std::function<void(AssetRequestId, AssetStatus)> OnComplete;
+		};
+
+		// Last stage of the pipeline, copies decompressed data to the GPU //
+
+		class IAssetUploader
+		{
+		public:
+
+			virtual ~IAssetUploader() = default;
+
+			// Records the copy and returns the fence value that marks its completion //
+
+			virtual std::uint64_t Upload(const AssetRequestDesc& request, const void* data, std::uint64_t size) = 0;
+
+			// Submits everything recorded since the last call //
+
+			virtual void Submit() = 0;
+			virtual std::uint64_t CompletedValue() = 0;
+		};
+
+		struct AssetStageStats
+		{
+			std::uint64_t Bytes = 0;
+			double BusySeconds = 0.0;
+
+			double MegabytesPerSecond() const { return BusySeconds > 0.0 ? static_cast<double>(Bytes) / (1024.0 * 1024.0) / BusySeconds : 0.0; }
+		};
+
+		struct AssetLoaderStats
+		{
+			AssetStageStats Read;
+			AssetStageStats Decompress;
+			AssetStageStats Encode;				// RGBA8 bytes block compressed
+			AssetStageStats Upload;
+			std::uint64_t Completed = 0;
+			std::uint64_t Cancelled = 0;
+			std::uint64_t Failed = 0;
+			std::uint32_t InFlight = 0;
+			std::uint64_t BufferedBytes = 0;		// read and decompression buffers held right now
+			std::uint64_t PeakBufferedBytes = 0;
+		};
+
+		// Staged asynchronous asset loading //
+		/*
+		   read (I/O thread, batched, io_uring on Linux when available)
+		     -> decompress, then block compress textures (thread pool workers)
+		       -> upload (upload thread, copy queue, completion tracked by fence)
+
+		   Each stage picks the highest priority request first. Nothing here ever runs on the
+		   frame thread except Update(), which only delivers completion callbacks.
+		   The buffers of a request are reserved before it is read and released once the
+		   uploader has its own copy; reads wait while maxBufferedBytes are held, so a large
+		   batch of requests never allocates more than that. A single request larger than
+		   the cap still goes through, alone.
+		*/
+
+		class AssetLoader
+		{
+		public:
+
+			AssetLoader(IAssetUploader& uploader, Core::ThreadPool& workers = Core::ThreadPool::Global(), std::uint32_t readBatchSize = 32,
+				std::uint64_t maxBufferedBytes = 256ull * 1024 * 1024);
+			~AssetLoader();
+
+			AssetLoader(const AssetLoader&) = delete;
+			AssetLoader& operator=(const AssetLoader&) = delete;
+
+			AssetRequestId Load(AssetRequestDesc request);
+			void Cancel(AssetRequestId request);
+
+			// Delivers completion callbacks, call once per frame //
+
+			void Update();
+
+			AssetLoaderStats Stats() const;
+			void ResetStats();
+
+			static bool DecompressLz4(const std::uint8_t* source, std::uint64_t sourceSize, std::uint8_t* destination, std::uint64_t destinationSize);
+
+		private:
+
+			struct Request
+			{
+				AssetRequestId Id = 0;
+				AssetRequestDesc Desc;
+				Core::TaggedVector<std::uint8_t, Core::MemoryTag::Assets> Data;
+				std::uint64_t FenceValue = 0;
+				std::uint64_t ReadSize = 0;
+				std::uint64_t ReservedBytes = 0;
+				std::atomic<bool> Cancelled{ false };
+				AssetStatus Status = AssetStatus::Pending;
+			};
+
+			using RequestPtr = std::shared_ptr<Request>;
+
+			struct PriorityOrder
+			{
+				bool operator()(const RequestPtr& a, const RequestPtr& b) const
+				{
+					if (a->Desc.Priority != b->Desc.Priority)
+					{
+						return a->Desc.Priority < b->Desc.Priority;
+					}
+					return a->Id > b->Id;
+				}
+			};
+
+			using RequestQueue = std::priority_queue<RequestPtr, std::vector<RequestPtr>, PriorityOrder>;
+
+			// io_uring instance kept for the loader's lifetime, only defined with liburing //
+
+			struct IoRing;
+
+			void IoThread();
+			void UploadThread();
+			void ReserveBuffers(std::vector<RequestPtr>& batch);
+			bool Reserve(std::uint64_t bytes, bool wait);
+			void Release(Request& request, std::uint64_t bytes);
+			void ReadBatch(std::vector<RequestPtr>& batch);
+			void DecompressOne();
+			bool EncodeTexture(Request& request);
+			void Finish(const RequestPtr& request, AssetStatus status);
+
+		private:
+
+			IAssetUploader& m_Uploader;
+			Core::ThreadPool& m_Workers;
+			std::uint32_t m_ReadBatchSize;
+			std::unique_ptr<IoRing> m_Ring;
+
+			std::atomic<AssetRequestId> m_NextId{ 1 };
+			std::atomic<bool> m_Stop{ false };
+
+			std::mutex m_ReadMutex;
+			std::condition_variable m_ReadAvailable;
+			RequestQueue m_ReadQueue;
+
+			mutable std::mutex m_BufferMutex;
+			std::condition_variable m_BuffersReleased;
+			std::uint64_t m_MaxBufferedBytes;
+			std::uint64_t m_BufferedBytes = 0;
+			std::uint64_t m_PeakBufferedBytes = 0;
+
+			std::mutex m_DecompressMutex;
+			RequestQueue m_DecompressQueue;
+
+			std::mutex m_UploadMutex;
+			std::condition_variable m_UploadAvailable;
+			RequestQueue m_UploadQueue;
+			std::vector<RequestPtr> m_UploadsInFlight;
+
+			std::mutex m_CompletedMutex;
+			std::vector<RequestPtr> m_Completed;
+
+			std::mutex m_RequestsMutex;
+			std::unordered_map<AssetRequestId, RequestPtr> m_Requests;
+			std::atomic<std::uint32_t> m_DecompressJobs{ 0 };
+
+			mutable std::mutex m_StatsMutex;
+			AssetLoaderStats m_Stats;
+
+			std::thread m_IoThread;
+			std::thread m_UploadThread;
+		};
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "AssetLoader.h"
+#include "CopyQueue.h"
+
+namespace PowerEngine {
+
+	namespace Assets {
+
+		// Uploads decompressed assets through the copy queue //
+		/*
+		   AssetRequestDesc::UploadTarget is the destination ID3D12Resource buffer and
+		   UploadOffset the byte offset in it. The destination must not be in use on
+		   another queue until the request completes.
+		*/
+
+		class AssetUploaderD3D12 : public IAssetUploader
+		{
+		public:
+
+			explicit AssetUploaderD3D12(Core::CopyQueue& copyQueue)
+				: m_CopyQueue(copyQueue)
+			{
+			}
+
+			std::uint64_t Upload(const AssetRequestDesc& request, const void* data, std::uint64_t size) override
+			{
+				return m_CopyQueue.UploadBuffer(static_cast<ID3D12Resource*>(request.UploadTarget), request.UploadOffset, data, size);
+			}
+
+			void Submit() override
+			{
+				m_CopyQueue.Submit();
+			}
+
+			std::uint64_t CompletedValue() override
+			{
+				return m_CopyQueue.CompletedValue();
+			}
+
+		private:
+
+			Core::CopyQueue& m_CopyQueue;
+		};
+	}
+}
@@ -0,0 +1,101 @@
+#include "BindlessAllocator.h"
+
+#include <algorithm>
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		namespace
+		{
+			constexpr std::uint32_t g_GenerationMask = (1u << (32 - BindlessHandle::IndexBits)) - 1;
+		}
+
+		// The capacity stays below IndexMask, so no live handle can equal InvalidValue //
+
+		BindlessAllocator::BindlessAllocator(std::uint32_t capacity)
+			: m_Capacity(std::min(capacity, BindlessHandle::IndexMask))
+			, m_Generations(m_Capacity, 0)
+			, m_Live(m_Capacity, false)
+		{
+			// Low indices are handed out first, it keeps the used part of the heap compact //
+
+			m_FreeIndices.reserve(m_Capacity);
+			for (std::uint32_t index = m_Capacity; index > 0; --index)
+			{
+				m_FreeIndices.push_back(index - 1);
+			}
+		}
+
+		BindlessHandle BindlessAllocator::Allocate()
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			BindlessHandle handle;
+			if (m_FreeIndices.empty())
+			{
+				return handle;
+			}
+
+			const std::uint32_t index = m_FreeIndices.back();
+			m_FreeIndices.pop_back();
+
+			m_Live[index] = true;
+			m_Allocated++;
+
+			handle.Value = (std::uint32_t(m_Generations[index]) << BindlessHandle::IndexBits) | index;
+			return handle;
+		}
+
+		void BindlessAllocator::Free(BindlessHandle handle, std::uint64_t fenceValue)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			const std::uint32_t index = handle.Index();
+			if (handle.IsNull() || index >= m_Capacity || !m_Live[index] || m_Generations[index] != handle.Generation())
+			{
+				m_RejectedFrees++;
+				return;
+			}
+
+			// The generation moves on now so that stale handles are caught before the index is reused //
+
+			m_Live[index] = false;
+			m_Generations[index] = static_cast<std::uint16_t>((m_Generations[index] + 1) & g_GenerationMask);
+			m_Allocated--;
+
+			m_Pending.push_back({ index, fenceValue });
+		}
+
+		void BindlessAllocator::Retire(std::uint64_t completedFenceValue)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			while (!m_Pending.empty() && m_Pending.front().FenceValue <= completedFenceValue)
+			{
+				m_FreeIndices.push_back(m_Pending.front().Index);
+				m_Pending.pop_front();
+			}
+		}
+
+		bool BindlessAllocator::IsValid(BindlessHandle handle) const
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			const std::uint32_t index = handle.Index();
+			return !handle.IsNull() && index < m_Capacity && m_Live[index] && m_Generations[index] == handle.Generation();
+		}
+
+		BindlessAllocatorStats BindlessAllocator::Stats() const
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			BindlessAllocatorStats stats;
+			stats.Capacity = m_Capacity;
+			stats.Allocated = m_Allocated;
+			stats.PendingFree = static_cast<std::uint32_t>(m_Pending.size());
+			stats.RejectedFrees = m_RejectedFrees;
+			return stats;
+		}
+	}
+}
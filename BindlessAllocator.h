@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// Descriptor index plus the generation it was allocated in //
+		/*
+		   Shaders only ever see Index(); the generation lets the CPU side reject handles
+		   whose slot has been freed and reused.
+		*/
+
+		struct BindlessHandle
+		{
+			static constexpr std::uint32_t IndexBits = 20;
+			static constexpr std::uint32_t IndexMask = (1u << IndexBits) - 1;
+			static constexpr std::uint32_t InvalidValue = ~0u;
+
+			std::uint32_t Value = InvalidValue;
+
+			std::uint32_t Index() const { return Value & IndexMask; }
+			std::uint32_t Generation() const { return Value >> IndexBits; }
+			bool IsNull() const { return Value == InvalidValue; }
+		};
+
+		struct BindlessAllocatorStats
+		{
+			std::uint32_t Capacity = 0;
+			std::uint32_t Allocated = 0;		// live handles
+			std::uint32_t PendingFree = 0;		// freed, waiting for the GPU
+			std::uint64_t RejectedFrees = 0;	// stale or double frees
+		};
+
+		// Generational index allocator with frees deferred until a fence value completes //
+
+		class BindlessAllocator
+		{
+		public:
+
+			explicit BindlessAllocator(std::uint32_t capacity);
+
+			// Returns a null handle when every index is live or pending //
+
+			BindlessHandle Allocate();
+
+			// The index is reused once Retire() sees fenceValue completed; the handle is invalid at once //
+
+			void Free(BindlessHandle handle, std::uint64_t fenceValue);
+			void Retire(std::uint64_t completedFenceValue);
+
+			bool IsValid(BindlessHandle handle) const;
+			BindlessAllocatorStats Stats() const;
+
+		private:
+
+			struct PendingIndex
+			{
+				std::uint32_t Index;
+				std::uint64_t FenceValue;
+			};
+
+		private:
+
+			std::uint32_t m_Capacity;
+			std::vector<std::uint16_t> m_Generations;
+			std::vector<bool> m_Live;
+			std::vector<std::uint32_t> m_FreeIndices;
+			std::deque<PendingIndex> m_Pending;		// fence values are non decreasing
+			std::uint32_t m_Allocated = 0;
+			std::uint64_t m_RejectedFrees = 0;
+			mutable std::mutex m_Mutex;
+		};
+	}
+}
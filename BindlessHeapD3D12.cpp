@@ -0,0 +1,172 @@
+#include "BindlessHeapD3D12.h"
+#include "RenderStats.h"
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		namespace
+		{
+			// Running out of descriptors is treated like any failed D3D12 allocation //
+
+			BindlessHandle AllocateHandle(BindlessAllocator& allocator)
+			{
+				BindlessHandle handle = allocator.Allocate();
+				ThrowIfFailed(handle.IsNull() ? E_OUTOFMEMORY : S_OK);
+
+				RenderStats::Count(RenderCounter::DescriptorAllocations);
+				return handle;
+			}
+		}
+
+		BindlessHeapD3D12::BindlessHeapD3D12(ComPtr<ID3D12Device2> device, std::uint32_t resourceCapacity, std::uint32_t samplerCapacity)
+			: m_Device(device)
+			, m_Resources(resourceCapacity)
+			, m_Samplers(samplerCapacity)
+		{
+			D3D12_DESCRIPTOR_HEAP_DESC desc = {};
+			desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+			desc.NumDescriptors = m_Resources.Stats().Capacity;
+			desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+			ThrowIfFailed(m_Device->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&m_ResourceHeap)));
+
+			desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER;
+			desc.NumDescriptors = m_Samplers.Stats().Capacity;
+			ThrowIfFailed(m_Device->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&m_SamplerHeap)));
+
+			m_ResourceDescriptorSize = m_Device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+			m_SamplerDescriptorSize = m_Device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER);
+		}
+
+		D3D12_CPU_DESCRIPTOR_HANDLE BindlessHeapD3D12::ResourceDescriptor(BindlessHandle handle) const
+		{
+			return CD3DX12_CPU_DESCRIPTOR_HANDLE(m_ResourceHeap->GetCPUDescriptorHandleForHeapStart(), handle.Index(), m_ResourceDescriptorSize);
+		}
+
+		D3D12_GPU_DESCRIPTOR_HANDLE BindlessHeapD3D12::GpuDescriptor(BindlessHandle handle) const
+		{
+			return CD3DX12_GPU_DESCRIPTOR_HANDLE(m_ResourceHeap->GetGPUDescriptorHandleForHeapStart(), handle.Index(), m_ResourceDescriptorSize);
+		}
+
+		BindlessHandle BindlessHeapD3D12::CreateShaderResourceView(ID3D12Resource* resource, const D3D12_SHADER_RESOURCE_VIEW_DESC* desc)
+		{
+			BindlessHandle handle = AllocateHandle(m_Resources);
+			m_Device->CreateShaderResourceView(resource, desc, ResourceDescriptor(handle));
+			return handle;
+		}
+
+		BindlessHandle BindlessHeapD3D12::CreateUnorderedAccessView(ID3D12Resource* resource, const D3D12_UNORDERED_ACCESS_VIEW_DESC* desc)
+		{
+			BindlessHandle handle = AllocateHandle(m_Resources);
+			m_Device->CreateUnorderedAccessView(resource, nullptr, desc, ResourceDescriptor(handle));
+			return handle;
+		}
+
+		BindlessHandle BindlessHeapD3D12::CreateConstantBufferView(const D3D12_CONSTANT_BUFFER_VIEW_DESC& desc)
+		{
+			BindlessHandle handle = AllocateHandle(m_Resources);
+			m_Device->CreateConstantBufferView(&desc, ResourceDescriptor(handle));
+			return handle;
+		}
+
+		BindlessHandle BindlessHeapD3D12::CreateSampler(const D3D12_SAMPLER_DESC& desc)
+		{
+			BindlessHandle handle = AllocateHandle(m_Samplers);
+			CD3DX12_CPU_DESCRIPTOR_HANDLE descriptor(m_SamplerHeap->GetCPUDescriptorHandleForHeapStart(), handle.Index(), m_SamplerDescriptorSize);
+			m_Device->CreateSampler(&desc, descriptor);
+			return handle;
+		}
+
+		void BindlessHeapD3D12::Free(BindlessHandle handle, std::uint64_t fenceValue)
+		{
+			m_Resources.Free(handle, fenceValue);
+		}
+
+		void BindlessHeapD3D12::FreeSampler(BindlessHandle handle, std::uint64_t fenceValue)
+		{
+			m_Samplers.Free(handle, fenceValue);
+		}
+
+		void BindlessHeapD3D12::Retire(std::uint64_t completedFenceValue)
+		{
+			m_Resources.Retire(completedFenceValue);
+			m_Samplers.Retire(completedFenceValue);
+		}
+
+		void BindlessHeapD3D12::SetMaterial(MaterialHandle material, std::initializer_list<BindlessHandle> handles)
+		{
+			assert(handles.size() <= g_DrawIdRootConstant && "Too many indices for the bindless root constants.");
+
+			if (material >= m_Materials.size())
+			{
+				m_Materials.resize(material + 1);
+			}
+
+			Material& entry = m_Materials[material];
+			entry.Count = 0;
+			for (BindlessHandle handle : handles)
+			{
+				entry.Indices[entry.Count++] = handle.Index();
+			}
+		}
+
+		void BindlessHeapD3D12::BindMaterial(ID3D12GraphicsCommandList* commandList, MaterialHandle material) const
+		{
+			if (material >= m_Materials.size() || m_Materials[material].Count == 0)
+			{
+				return;
+			}
+
+			const Material& entry = m_Materials[material];
+			commandList->SetGraphicsRoot32BitConstants(g_BindlessRootParameter, entry.Count, entry.Indices, 0);
+		}
+
+		void BindlessHeapD3D12::SetDescriptorHeaps(ID3D12GraphicsCommandList* commandList) const
+		{
+			ID3D12DescriptorHeap* const heaps[] = { m_ResourceHeap.Get(), m_SamplerHeap.Get() };
+			commandList->SetDescriptorHeaps(_countof(heaps), heaps);
+		}
+
+		void BindlessHeapD3D12::SetRootTables(ID3D12GraphicsCommandList* commandList) const
+		{
+			commandList->SetGraphicsRootDescriptorTable(g_ResourceTableRootParameter, ResourceTable());
+			commandList->SetGraphicsRootDescriptorTable(g_SamplerTableRootParameter, SamplerTable());
+		}
+
+		ComPtr<ID3D12RootSignature> BindlessHeapD3D12::CreateRootSignature(ComPtr<ID3D12Device2> device)
+		{
+			// Unbounded ranges over heaps with unwritten and recycled slots, the descriptors are volatile //
+
+			CD3DX12_DESCRIPTOR_RANGE1 resourceRange;
+			resourceRange.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, UINT_MAX, 0, 1, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE, 0);
+			CD3DX12_DESCRIPTOR_RANGE1 samplerRange;
+			samplerRange.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER, UINT_MAX, 0, 1, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE, 0);
+
+			CD3DX12_ROOT_PARAMETER1 parameters[4];
+			parameters[g_InstanceRootParameter].InitAsShaderResourceView(0, 0, D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE, D3D12_SHADER_VISIBILITY_VERTEX);
+			parameters[g_BindlessRootParameter].InitAsConstants(g_BindlessRootConstantCount, 0, 0, D3D12_SHADER_VISIBILITY_ALL);
+			parameters[g_ResourceTableRootParameter].InitAsDescriptorTable(1, &resourceRange, D3D12_SHADER_VISIBILITY_ALL);
+			parameters[g_SamplerTableRootParameter].InitAsDescriptorTable(1, &samplerRange, D3D12_SHADER_VISIBILITY_PIXEL);
+
+			// No heap indexing flags: every shader is built for shader model 5.1 with D3DCompile //
+
+			const D3D12_ROOT_SIGNATURE_FLAGS flags =
+				D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT |
+				D3D12_ROOT_SIGNATURE_FLAG_DENY_HULL_SHADER_ROOT_ACCESS |
+				D3D12_ROOT_SIGNATURE_FLAG_DENY_DOMAIN_SHADER_ROOT_ACCESS |
+				D3D12_ROOT_SIGNATURE_FLAG_DENY_GEOMETRY_SHADER_ROOT_ACCESS;
+
+			CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC desc;
+			desc.Init_1_1(_countof(parameters), parameters, 0, nullptr, flags);
+
+			ComPtr<ID3DBlob> signature;
+			ComPtr<ID3DBlob> error;
+			ThrowIfFailed(D3DX12SerializeVersionedRootSignature(&desc, D3D_ROOT_SIGNATURE_VERSION_1_1, &signature, &error));
+
+			ComPtr<ID3D12RootSignature> rootSignature;
+			ThrowIfFailed(device->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&rootSignature)));
+
+			return rootSignature;
+		}
+	}
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Header.h"
+#include "HelperFile.h"
+#include "BindlessAllocator.h"
+#include "DrawBatcher.h"
+
+#include <initializer_list>
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// Root parameters of the bindless root signature //
+
+		constexpr UINT g_InstanceRootParameter = 0;			// root SRV t0, StructuredBuffer<InstanceTransform>
+		constexpr UINT g_BindlessRootParameter = 1;			// root constants b0
+		constexpr UINT g_BindlessRootConstantCount = 8;
+		constexpr UINT g_DrawIdRootConstant = g_BindlessRootConstantCount - 1;	// written by ExecuteIndirect, see IndirectDrawsD3D12
+		constexpr UINT g_ResourceTableRootParameter = 2;		// t0 space1, every SRV of the resource heap
+		constexpr UINT g_SamplerTableRootParameter = 3;			// s0 space1, every sampler of the sampler heap
+
+		// One shader-visible heap for every SRV/UAV/CBV and one for every sampler //
+		/*
+		   Descriptors are written once at creation and addressed by BindlessHandle::Index().
+		   The root signature maps each heap whole to an unbounded table, Texture2D
+		   Textures[] : register(t0, space1) and SamplerState Samplers[] : register(s0,
+		   space1), which shader model 5.1 shaders index with those indices; this needs
+		   resource binding tier 2. A draw binds its material as up to
+		   g_BindlessRootConstantCount indices in root constants. Freed slots are reused
+		   only after the fence value given to Free() has completed, so in-flight frames
+		   never see a descriptor change under them.
+		*/
+
+		class BindlessHeapD3D12
+		{
+		public:
+
+			BindlessHeapD3D12(ComPtr<ID3D12Device2> device, std::uint32_t resourceCapacity = 65536, std::uint32_t samplerCapacity = D3D12_MAX_SHADER_VISIBLE_SAMPLER_HEAP_SIZE);
+
+			BindlessHandle CreateShaderResourceView(ID3D12Resource* resource, const D3D12_SHADER_RESOURCE_VIEW_DESC* desc);
+			BindlessHandle CreateUnorderedAccessView(ID3D12Resource* resource, const D3D12_UNORDERED_ACCESS_VIEW_DESC* desc);
+			BindlessHandle CreateConstantBufferView(const D3D12_CONSTANT_BUFFER_VIEW_DESC& desc);
+			BindlessHandle CreateSampler(const D3D12_SAMPLER_DESC& desc);
+
+			// fenceValue is the direct queue fence value of the last frame using the descriptor //
+
+			void Free(BindlessHandle handle, std::uint64_t fenceValue);
+			void FreeSampler(BindlessHandle handle, std::uint64_t fenceValue);
+			void Retire(std::uint64_t completedFenceValue);
+
+			// For descriptor tables of shaders built without heap indexing, the heaps must be set //
+
+			D3D12_GPU_DESCRIPTOR_HANDLE GpuDescriptor(BindlessHandle handle) const;
+
+			// Materials are the indices their shaders read from the root constants, in order //
+
+			void SetMaterial(MaterialHandle material, std::initializer_list<BindlessHandle> handles);
+			void BindMaterial(ID3D12GraphicsCommandList* commandList, MaterialHandle material) const;
+
+			// Must be called on every command list before drawing with the bindless root signature //
+
+			void SetDescriptorHeaps(ID3D12GraphicsCommandList* commandList) const;
+
+			// Points the heap tables at the heaps, after every SetGraphicsRootSignature(); BindMaterial() only writes the root constants //
+
+			void SetRootTables(ID3D12GraphicsCommandList* commandList) const;
+
+			// Root signature with the instance SRV, the bindless root constants and the heap tables, pixel and vertex shaders only //
+
+			static ComPtr<ID3D12RootSignature> CreateRootSignature(ComPtr<ID3D12Device2> device);
+
+			// Getters //
+
+			BindlessAllocatorStats ResourceStats() const { return m_Resources.Stats(); }
+			BindlessAllocatorStats SamplerStats() const { return m_Samplers.Stats(); }
+			D3D12_GPU_DESCRIPTOR_HANDLE ResourceTable() const { return m_ResourceHeap->GetGPUDescriptorHandleForHeapStart(); }
+			D3D12_GPU_DESCRIPTOR_HANDLE SamplerTable() const { return m_SamplerHeap->GetGPUDescriptorHandleForHeapStart(); }
+
+		private:
+
+			struct Material
+			{
+				std::uint32_t Indices[g_BindlessRootConstantCount] = {};
+				std::uint32_t Count = 0;
+			};
+
+			D3D12_CPU_DESCRIPTOR_HANDLE ResourceDescriptor(BindlessHandle handle) const;
+
+		private:
+
+			ComPtr<ID3D12Device2> m_Device;
+			ComPtr<ID3D12DescriptorHeap> m_ResourceHeap;
+			ComPtr<ID3D12DescriptorHeap> m_SamplerHeap;
+			UINT m_ResourceDescriptorSize;
+			UINT m_SamplerDescriptorSize;
+
+			BindlessAllocator m_Resources;
+			BindlessAllocator m_Samplers;
+			std::vector<Material> m_Materials;
+		};
+	}
+}
@@ -0,0 +1,496 @@
+#include "CommandTrace.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		namespace
+		{
+			constexpr std::size_t g_MaxTraceErrors = 100;
+
+			template<typename Record>
+			bool ReplayRecord(CommandTraceReader& reader, TraceDevice& device, void (TraceDevice::*call)(const Record&))
+			{
+				Record record;
+				if (!reader.Read(record))
+				{
+					return false;
+				}
+
+				(device.*call)(record);
+				return true;
+			}
+		}
+
+		const char* TraceOpName(TraceOp op)
+		{
+			switch (op)
+			{
+			case TraceOp::CreateQueue: return "CreateQueue";
+			case TraceOp::CreateFence: return "CreateFence";
+			case TraceOp::CreateList: return "CreateList";
+			case TraceOp::CreateResource: return "CreateResource";
+			case TraceOp::ReleaseResource: return "ReleaseResource";
+			case TraceOp::ResetList: return "ResetList";
+			case TraceOp::CloseList: return "CloseList";
+			case TraceOp::Barrier: return "Barrier";
+			case TraceOp::SetPipeline: return "SetPipeline";
+			case TraceOp::Draw: return "Draw";
+			case TraceOp::Dispatch: return "Dispatch";
+			case TraceOp::ExecuteIndirect: return "ExecuteIndirect";
+			case TraceOp::CopyBuffer: return "CopyBuffer";
+			case TraceOp::CopyTexture: return "CopyTexture";
+			case TraceOp::ExecuteLists: return "ExecuteLists";
+			case TraceOp::Signal: return "Signal";
+			case TraceOp::Wait: return "Wait";
+			case TraceOp::Present: return "Present";
+			default: return "Unknown";
+			}
+		}
+
+		CommandTraceWriter::CommandTraceWriter()
+		{
+			Clear();
+		}
+
+		void CommandTraceWriter::Clear()
+		{
+			const CommandTraceHeader header = { g_CommandTraceMagic, g_CommandTraceVersion, 0 };
+
+			m_Data.resize(sizeof(header));
+			std::memcpy(m_Data.data(), &header, sizeof(header));
+			m_RecordCount = 0;
+		}
+
+		void CommandTraceWriter::WriteVarint(std::uint64_t value)
+		{
+			while (value >= 0x80)
+			{
+				m_Data.push_back(static_cast<std::uint8_t>(value | 0x80));
+				value >>= 7;
+			}
+			m_Data.push_back(static_cast<std::uint8_t>(value));
+		}
+
+		bool CommandTraceWriter::Save(const char* path) const
+		{
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			if (!file)
+			{
+				return false;
+			}
+
+			file.write(reinterpret_cast<const char*>(m_Data.data()), static_cast<std::streamsize>(m_Data.size()));
+			return static_cast<bool>(file);
+		}
+
+		bool CommandTraceReader::Open(const char* path)
+		{
+			if (!m_File.Open(path))
+			{
+				return false;
+			}
+
+			return Open(m_File.Data(), m_File.Size());
+		}
+
+		bool CommandTraceReader::Open(const std::uint8_t* data, std::uint64_t size)
+		{
+			m_Data = data;
+			m_Size = size;
+			m_Position = 0;
+			m_Failed = false;
+
+			CommandTraceHeader header;
+			if (size < sizeof(header))
+			{
+				return false;
+			}
+
+			std::memcpy(&header, data, sizeof(header));
+			if (header.Magic != g_CommandTraceMagic || header.Version != g_CommandTraceVersion)
+			{
+				return false;
+			}
+
+			m_Position = sizeof(header);
+			return true;
+		}
+
+		bool CommandTraceReader::Next(TraceOp& op)
+		{
+			if (m_Failed || m_Position >= m_Size)
+			{
+				return false;
+			}
+
+			op = static_cast<TraceOp>(m_Data[m_Position++]);
+			return true;
+		}
+
+		std::uint64_t CommandTraceReader::ReadVarint()
+		{
+			std::uint64_t value = 0;
+
+			for (std::uint32_t shift = 0; shift < 64; shift += 7)
+			{
+				if (m_Position >= m_Size)
+				{
+					break;
+				}
+
+				const std::uint8_t byte = m_Data[m_Position++];
+				value |= std::uint64_t(byte & 0x7F) << shift;
+
+				if ((byte & 0x80) == 0)
+				{
+					return value;
+				}
+			}
+
+			m_Failed = true;
+			return 0;
+		}
+
+		bool ReplayCommandTrace(CommandTraceReader& reader, TraceDevice& device, std::string* error)
+		{
+			TraceOp op;
+			while (reader.Next(op))
+			{
+				const std::uint64_t position = reader.Position() - 1;
+				bool read = false;
+
+				switch (op)
+				{
+				case TraceOp::CreateQueue: read = ReplayRecord(reader, device, &TraceDevice::CreateQueue); break;
+				case TraceOp::CreateFence: read = ReplayRecord(reader, device, &TraceDevice::CreateFence); break;
+				case TraceOp::CreateList: read = ReplayRecord(reader, device, &TraceDevice::CreateList); break;
+				case TraceOp::CreateResource: read = ReplayRecord(reader, device, &TraceDevice::CreateResource); break;
+				case TraceOp::ReleaseResource: read = ReplayRecord(reader, device, &TraceDevice::ReleaseResource); break;
+				case TraceOp::ResetList: read = ReplayRecord(reader, device, &TraceDevice::ResetList); break;
+				case TraceOp::CloseList: read = ReplayRecord(reader, device, &TraceDevice::CloseList); break;
+				case TraceOp::Barrier: read = ReplayRecord(reader, device, &TraceDevice::Barrier); break;
+				case TraceOp::SetPipeline: read = ReplayRecord(reader, device, &TraceDevice::SetPipeline); break;
+				case TraceOp::Draw: read = ReplayRecord(reader, device, &TraceDevice::Draw); break;
+				case TraceOp::Dispatch: read = ReplayRecord(reader, device, &TraceDevice::Dispatch); break;
+				case TraceOp::ExecuteIndirect: read = ReplayRecord(reader, device, &TraceDevice::ExecuteIndirect); break;
+				case TraceOp::CopyBuffer: read = ReplayRecord(reader, device, &TraceDevice::CopyBuffer); break;
+				case TraceOp::CopyTexture: read = ReplayRecord(reader, device, &TraceDevice::CopyTexture); break;
+				case TraceOp::ExecuteLists: read = ReplayRecord(reader, device, &TraceDevice::ExecuteLists); break;
+				case TraceOp::Signal: read = ReplayRecord(reader, device, &TraceDevice::Signal); break;
+				case TraceOp::Wait: read = ReplayRecord(reader, device, &TraceDevice::Wait); break;
+				case TraceOp::Present: read = ReplayRecord(reader, device, &TraceDevice::Present); break;
+				default: break;
+				}
+
+				if (!read)
+				{
+					if (error)
+					{
+						char message[128];
+						std::snprintf(message, sizeof(message), "Corrupt %s record at byte %llu", TraceOpName(op), static_cast<unsigned long long>(position));
+						*error = message;
+					}
+					return false;
+				}
+			}
+
+			return !reader.Failed();
+		}
+
+		void SimulatedTraceDevice::Error(const char* format, ...)
+		{
+			if (m_Errors.size() >= g_MaxTraceErrors)
+			{
+				return;
+			}
+
+			char message[256];
+			int length = std::snprintf(message, sizeof(message), "Frame %zu: ", m_FrameOpen ? m_Frames.size() - 1 : m_Frames.size());
+
+			va_list arguments;
+			va_start(arguments, format);
+			std::vsnprintf(message + length, sizeof(message) - length, format, arguments);
+			va_end(arguments);
+
+			m_Errors.push_back(message);
+		}
+
+		SimulatedTraceDevice::Object& SimulatedTraceDevice::Create(TraceObject id, ObjectKind kind)
+		{
+			if (id >= m_Objects.size())
+			{
+				m_Objects.resize(std::size_t(id) + 1);
+			}
+
+			Object& object = m_Objects[id];
+			if (id == g_NullTraceObject || (object.Kind != ObjectKind::None && object.Kind != ObjectKind::Released))
+			{
+				Error("object %u created twice", id);
+			}
+
+			object = Object();
+			object.Kind = kind;
+			return object;
+		}
+
+		SimulatedTraceDevice::Object* SimulatedTraceDevice::Find(TraceObject id, ObjectKind kind, const char* use)
+		{
+			if (id < m_Objects.size() && m_Objects[id].Kind == kind)
+			{
+				return &m_Objects[id];
+			}
+
+			if (id < m_Objects.size() && m_Objects[id].Kind == ObjectKind::Released)
+			{
+				Error("%s uses released resource %u", use, id);
+			}
+			else
+			{
+				Error("%s uses unknown object %u", use, id);
+			}
+			return nullptr;
+		}
+
+		SimulatedTraceDevice::Object* SimulatedTraceDevice::RecordingList(TraceObject id, const char* use)
+		{
+			Object* list = Find(id, ObjectKind::List, use);
+			if (list && !list->Open)
+			{
+				Error("%s recorded into closed list %u", use, id);
+			}
+			return list;
+		}
+
+		TraceFrameStats& SimulatedTraceDevice::Frame()
+		{
+			if (!m_FrameOpen)
+			{
+				m_Frames.emplace_back();
+				m_Frames.back().Render.Frame = m_Frames.size();
+				m_FrameOpen = true;
+			}
+			return m_Frames.back();
+		}
+
+		void SimulatedTraceDevice::CreateQueue(const TraceCreateQueue& record)
+		{
+			Create(record.Queue, ObjectKind::Queue);
+		}
+
+		void SimulatedTraceDevice::CreateFence(const TraceCreateFence& record)
+		{
+			Create(record.Fence, ObjectKind::Fence).Value = record.InitialValue;
+		}
+
+		void SimulatedTraceDevice::CreateList(const TraceCreateList& record)
+		{
+			Create(record.List, ObjectKind::List);
+		}
+
+		void SimulatedTraceDevice::CreateResource(const TraceCreateResource& record)
+		{
+			Object& resource = Create(record.Resource, ObjectKind::Resource);
+			resource.Width = record.Width;
+			resource.Dimension = record.Dimension;
+			resource.HeapType = record.HeapType;
+		}
+
+		void SimulatedTraceDevice::ReleaseResource(const TraceReleaseResource& record)
+		{
+			if (Object* resource = Find(record.Resource, ObjectKind::Resource, "ReleaseResource"))
+			{
+				resource->Kind = ObjectKind::Released;
+			}
+		}
+
+		void SimulatedTraceDevice::ResetList(const TraceResetList& record)
+		{
+			if (Object* list = Find(record.List, ObjectKind::List, "ResetList"))
+			{
+				if (list->Open)
+				{
+					Error("list %u reset while recording", record.List);
+				}
+
+				list->Open = true;
+				list->Pipeline = g_NullTraceObject;
+				Frame().CommandLists++;
+			}
+		}
+
+		void SimulatedTraceDevice::CloseList(const TraceCloseList& record)
+		{
+			if (Object* list = RecordingList(record.List, "CloseList"))
+			{
+				list->Open = false;
+			}
+		}
+
+		void SimulatedTraceDevice::Barrier(const TraceBarrier& record)
+		{
+			RecordingList(record.List, "Barrier");
+
+			if (record.Type == g_TraceTransitionBarrier || record.Resource != g_NullTraceObject)
+			{
+				Find(record.Resource, ObjectKind::Resource, "Barrier");
+			}
+
+			Frame().Render.Counters[static_cast<std::uint32_t>(RenderCounter::Barriers)]++;
+		}
+
+		void SimulatedTraceDevice::SetPipeline(const TraceSetPipeline& record)
+		{
+			Object* list = RecordingList(record.List, "SetPipeline");
+
+			// Only actual changes count, like the recording layer counts them //
+
+			if (list && list->Pipeline != record.Pipeline)
+			{
+				list->Pipeline = record.Pipeline;
+				Frame().Render.Counters[static_cast<std::uint32_t>(RenderCounter::PipelineChanges)]++;
+			}
+		}
+
+		void SimulatedTraceDevice::Draw(const TraceDraw& record)
+		{
+			RecordingList(record.List, "Draw");
+
+			TraceFrameStats& frame = Frame();
+			frame.Render.Counters[static_cast<std::uint32_t>(RenderCounter::Draws)]++;
+			frame.Render.Counters[static_cast<std::uint32_t>(RenderCounter::Triangles)] += std::uint64_t(record.Count / 3) * record.Instances;
+		}
+
+		void SimulatedTraceDevice::Dispatch(const TraceDispatch& record)
+		{
+			RecordingList(record.List, "Dispatch");
+			Frame().Render.Counters[static_cast<std::uint32_t>(RenderCounter::Dispatches)]++;
+		}
+
+		void SimulatedTraceDevice::ExecuteIndirect(const TraceExecuteIndirect& record)
+		{
+			RecordingList(record.List, "ExecuteIndirect");
+			Find(record.Arguments, ObjectKind::Resource, "ExecuteIndirect");
+			if (record.CountBuffer != g_NullTraceObject)
+			{
+				Find(record.CountBuffer, ObjectKind::Resource, "ExecuteIndirect");
+			}
+
+			Frame().Render.Counters[static_cast<std::uint32_t>(RenderCounter::Draws)]++;
+		}
+
+		void SimulatedTraceDevice::CopyBuffer(const TraceCopyBuffer& record)
+		{
+			RecordingList(record.List, "CopyBuffer");
+			const Object* destination = Find(record.Destination, ObjectKind::Resource, "CopyBuffer");
+			const Object* source = Find(record.Source, ObjectKind::Resource, "CopyBuffer");
+
+			if (destination && record.DestinationOffset + record.Size > destination->Width)
+			{
+				Error("CopyBuffer writes past the end of resource %u", record.Destination);
+			}
+			if (source && record.SourceOffset + record.Size > source->Width)
+			{
+				Error("CopyBuffer reads past the end of resource %u", record.Source);
+			}
+
+			TraceFrameStats& frame = Frame();
+			frame.Copies++;
+			frame.CopyBytes += record.Size;
+			if (source && source->HeapType == g_TraceUploadHeap)
+			{
+				frame.Render.Counters[static_cast<std::uint32_t>(RenderCounter::UploadBytes)] += record.Size;
+			}
+		}
+
+		void SimulatedTraceDevice::CopyTexture(const TraceCopyTexture& record)
+		{
+			RecordingList(record.List, "CopyTexture");
+			Find(record.Destination, ObjectKind::Resource, "CopyTexture");
+			const Object* source = Find(record.Source, ObjectKind::Resource, "CopyTexture");
+
+			if (source && record.RowPitch != 0 && source->Dimension != g_TraceBufferDimension)
+			{
+				Error("CopyTexture reads a footprint out of texture %u", record.Source);
+			}
+
+			TraceFrameStats& frame = Frame();
+			frame.Copies++;
+			if (source && source->HeapType == g_TraceUploadHeap)
+			{
+				frame.Render.Counters[static_cast<std::uint32_t>(RenderCounter::UploadBytes)] += std::uint64_t(record.RowPitch) * record.Height * record.Depth;
+			}
+		}
+
+		void SimulatedTraceDevice::ExecuteLists(const TraceExecuteLists& record)
+		{
+			Find(record.Queue, ObjectKind::Queue, "ExecuteLists");
+
+			for (TraceObject id : record.Lists)
+			{
+				const Object* list = Find(id, ObjectKind::List, "ExecuteLists");
+				if (list && list->Open)
+				{
+					Error("list %u executed while still recording", id);
+				}
+			}
+
+			Frame().Submissions++;
+		}
+
+		void SimulatedTraceDevice::Signal(const TraceSignal& record)
+		{
+			Find(record.Queue, ObjectKind::Queue, "Signal");
+
+			if (Object* fence = Find(record.Fence, ObjectKind::Fence, "Signal"))
+			{
+				if (record.Value <= fence->Value)
+				{
+					Error("fence %u signaled with %llu after %llu", record.Fence,
+						static_cast<unsigned long long>(record.Value), static_cast<unsigned long long>(fence->Value));
+				}
+				fence->Value = std::max(fence->Value, record.Value);
+			}
+
+			Frame().Signals++;
+		}
+
+		void SimulatedTraceDevice::Wait(const TraceWait& record)
+		{
+			Find(record.Queue, ObjectKind::Queue, "Wait");
+
+			if (Object* fence = Find(record.Fence, ObjectKind::Fence, "Wait"))
+			{
+				fence->WaitedValue = std::max(fence->WaitedValue, record.Value);
+			}
+
+			Frame().Waits++;
+		}
+
+		void SimulatedTraceDevice::Present(const TracePresent&)
+		{
+			Frame();
+			m_FrameOpen = false;
+		}
+
+		void SimulatedTraceDevice::Finish()
+		{
+			for (std::size_t id = 0; id < m_Objects.size(); ++id)
+			{
+				const Object& object = m_Objects[id];
+
+				if (object.Kind == ObjectKind::Fence && object.WaitedValue > object.Value)
+				{
+					Error("fence %zu waited for %llu, never signaled past %llu", id,
+						static_cast<unsigned long long>(object.WaitedValue), static_cast<unsigned long long>(object.Value));
+				}
+			}
+		}
+	}
+}
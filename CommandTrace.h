@@ -0,0 +1,546 @@
+#pragma once
+
+#include "MappedFile.h"
+#include "RenderStats.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// Captured command stream //
+		/*
+		   File layout :
+
+		   [CommandTraceHeader]        16 bytes, fixed
+		   [record][record]...         one TraceOp byte, then the record's fields
+
+		   Every field is an unsigned LEB128 varint, so object ids, counts and most D3D12
+		   enum values take a single byte. Objects (queues, fences, command lists,
+		   resources, pipelines) are small ids given by the capture; a resource is declared
+		   with its description the first time a captured command uses it. D3D12 enums and
+		   flags are stored as their numeric values, only the replay devices read them.
+		*/
+
+		constexpr std::uint32_t g_CommandTraceMagic = 0x52544550; // "PETR"
+		constexpr std::uint32_t g_CommandTraceVersion = 1;
+
+		struct CommandTraceHeader
+		{
+			std::uint32_t Magic;
+			std::uint32_t Version;
+			std::uint64_t Reserved;
+		};
+		static_assert(sizeof(CommandTraceHeader) == 16, "CommandTraceHeader must stay 16 bytes.");
+
+		using TraceObject = std::uint32_t;
+
+		constexpr TraceObject g_NullTraceObject = 0;
+
+		// D3D12 values the portable code needs to look at //
+
+		constexpr std::uint32_t g_TraceBufferDimension = 1;		// D3D12_RESOURCE_DIMENSION_BUFFER
+		constexpr std::uint32_t g_TraceUploadHeap = 2;			// D3D12_HEAP_TYPE_UPLOAD
+		constexpr std::uint32_t g_TraceTransitionBarrier = 0;	// D3D12_RESOURCE_BARRIER_TYPE_TRANSITION
+
+		enum class TraceOp : std::uint8_t
+		{
+			CreateQueue,
+			CreateFence,
+			CreateList,
+			CreateResource,
+			ReleaseResource,
+			ResetList,
+			CloseList,
+			Barrier,
+			SetPipeline,
+			Draw,
+			Dispatch,
+			ExecuteIndirect,
+			CopyBuffer,
+			CopyTexture,
+			ExecuteLists,
+			Signal,
+			Wait,
+			Present,
+			Count
+		};
+
+		const char* TraceOpName(TraceOp op);
+
+		// One struct per TraceOp, Serialize() lists the fields in file order //
+
+		struct TraceCreateQueue
+		{
+			static constexpr TraceOp Op = TraceOp::CreateQueue;
+			TraceObject Queue = 0;
+			std::uint32_t Type = 0;		// D3D12_COMMAND_LIST_TYPE
+
+			template<typename Archive> void Serialize(Archive& archive) { archive(Queue, Type); }
+		};
+
+		struct TraceCreateFence
+		{
+			static constexpr TraceOp Op = TraceOp::CreateFence;
+			TraceObject Fence = 0;
+			std::uint64_t InitialValue = 0;
+
+			template<typename Archive> void Serialize(Archive& archive) { archive(Fence, InitialValue); }
+		};
+
+		struct TraceCreateList
+		{
+			static constexpr TraceOp Op = TraceOp::CreateList;
+			TraceObject List = 0;
+			std::uint32_t Type = 0;		// D3D12_COMMAND_LIST_TYPE
+
+			template<typename Archive> void Serialize(Archive& archive) { archive(List, Type); }
+		};
+
+		struct TraceCreateResource
+		{
+			static constexpr TraceOp Op = TraceOp::CreateResource;
+			TraceObject Resource = 0;
+			std::uint32_t HeapType = 0;		// D3D12_HEAP_TYPE
+			std::uint32_t Dimension = 0;	// D3D12_RESOURCE_DIMENSION
+			std::uint64_t Width = 0;
+			std::uint32_t Height = 0;
+			std::uint32_t DepthOrArraySize = 0;
+			std::uint32_t MipLevels = 0;
+			std::uint32_t Format = 0;		// DXGI_FORMAT
+			std::uint32_t Flags = 0;		// D3D12_RESOURCE_FLAGS
+			std::uint32_t InitialState = 0;	// D3D12_RESOURCE_STATES
+
+			template<typename Archive> void Serialize(Archive& archive)
+			{
+				archive(Resource, HeapType, Dimension, Width, Height, DepthOrArraySize, MipLevels, Format, Flags, InitialState);
+			}
+		};
+
+		struct TraceReleaseResource
+		{
+			static constexpr TraceOp Op = TraceOp::ReleaseResource;
+			TraceObject Resource = 0;
+
+			template<typename Archive> void Serialize(Archive& archive) { archive(Resource); }
+		};
+
+		struct TraceResetList
+		{
+			static constexpr TraceOp Op = TraceOp::ResetList;
+			TraceObject List = 0;
+
+			template<typename Archive> void Serialize(Archive& archive) { archive(List); }
+		};
+
+		struct TraceCloseList
+		{
+			static constexpr TraceOp Op = TraceOp::CloseList;
+			TraceObject List = 0;
+
+			template<typename Archive> void Serialize(Archive& archive) { archive(List); }
+		};
+
+		// One barrier, consecutive records of a list were one ResourceBarrier call or more //
+
+		struct TraceBarrier
+		{
+			static constexpr TraceOp Op = TraceOp::Barrier;
+			TraceObject List = 0;
+			std::uint32_t Type = 0;			// D3D12_RESOURCE_BARRIER_TYPE
+			TraceObject Resource = 0;		// null for a global UAV or aliasing barrier
+			std::uint32_t Subresource = 0;
+			std::uint32_t Before = 0;		// D3D12_RESOURCE_STATES, transitions only
+			std::uint32_t After = 0;
+
+			template<typename Archive> void Serialize(Archive& archive) { archive(List, Type, Resource, Subresource, Before, After); }
+		};
+
+		struct TraceSetPipeline
+		{
+			static constexpr TraceOp Op = TraceOp::SetPipeline;
+			TraceObject List = 0;
+			TraceObject Pipeline = 0;		// identity only, shaders are not captured
+
+			template<typename Archive> void Serialize(Archive& archive) { archive(List, Pipeline); }
+		};
+
+		struct TraceDraw
+		{
+			static constexpr TraceOp Op = TraceOp::Draw;
+			TraceObject List = 0;
+			std::uint32_t Count = 0;		// indices or vertices per instance
+			std::uint32_t Instances = 0;
+			std::uint32_t Indexed = 0;
+
+			template<typename Archive> void Serialize(Archive& archive) { archive(List, Count, Instances, Indexed); }
+		};
+
+		struct TraceDispatch
+		{
+			static constexpr TraceOp Op = TraceOp::Dispatch;
+			TraceObject List = 0;
+			std::uint32_t X = 0;
+			std::uint32_t Y = 0;
+			std::uint32_t Z = 0;
+
+			template<typename Archive> void Serialize(Archive& archive) { archive(List, X, Y, Z); }
+		};
+
+		struct TraceExecuteIndirect
+		{
+			static constexpr TraceOp Op = TraceOp::ExecuteIndirect;
+			TraceObject List = 0;
+			std::uint32_t MaxCommands = 0;
+			TraceObject Arguments = 0;
+			TraceObject CountBuffer = 0;
+
+			template<typename Archive> void Serialize(Archive& archive) { archive(List, MaxCommands, Arguments, CountBuffer); }
+		};
+
+		struct TraceCopyBuffer
+		{
+			static constexpr TraceOp Op = TraceOp::CopyBuffer;
+			TraceObject List = 0;
+			TraceObject Destination = 0;
+			std::uint64_t DestinationOffset = 0;
+			TraceObject Source = 0;
+			std::uint64_t SourceOffset = 0;
+			std::uint64_t Size = 0;
+
+			template<typename Archive> void Serialize(Archive& archive) { archive(List, Destination, DestinationOffset, Source, SourceOffset, Size); }
+		};
+
+		// Subresource to subresource, or from a buffer footprint when RowPitch is not zero //
+
+		struct TraceCopyTexture
+		{
+			static constexpr TraceOp Op = TraceOp::CopyTexture;
+			TraceObject List = 0;
+			TraceObject Destination = 0;
+			std::uint32_t DestinationSubresource = 0;
+			TraceObject Source = 0;
+			std::uint32_t SourceSubresource = 0;
+			std::uint64_t Offset = 0;		// footprint of the source buffer
+			std::uint32_t Format = 0;
+			std::uint32_t Width = 0;
+			std::uint32_t Height = 0;
+			std::uint32_t Depth = 0;
+			std::uint32_t RowPitch = 0;
+
+			template<typename Archive> void Serialize(Archive& archive)
+			{
+				archive(List, Destination, DestinationSubresource, Source, SourceSubresource, Offset, Format, Width, Height, Depth, RowPitch);
+			}
+		};
+
+		struct TraceExecuteLists
+		{
+			static constexpr TraceOp Op = TraceOp::ExecuteLists;
+			TraceObject Queue = 0;
+			std::vector<TraceObject> Lists;
+
+			template<typename Archive> void Serialize(Archive& archive) { archive(Queue, Lists); }
+		};
+
+		struct TraceSignal
+		{
+			static constexpr TraceOp Op = TraceOp::Signal;
+			TraceObject Queue = 0;
+			TraceObject Fence = 0;
+			std::uint64_t Value = 0;
+
+			template<typename Archive> void Serialize(Archive& archive) { archive(Queue, Fence, Value); }
+		};
+
+		struct TraceWait
+		{
+			static constexpr TraceOp Op = TraceOp::Wait;
+			TraceObject Queue = 0;
+			TraceObject Fence = 0;
+			std::uint64_t Value = 0;
+
+			template<typename Archive> void Serialize(Archive& archive) { archive(Queue, Fence, Value); }
+		};
+
+		// Ends a frame //
+
+		struct TracePresent
+		{
+			static constexpr TraceOp Op = TraceOp::Present;
+			std::uint32_t SyncInterval = 0;
+			std::uint32_t Flags = 0;
+
+			template<typename Archive> void Serialize(Archive& archive) { archive(SyncInterval, Flags); }
+		};
+
+		// Appends records to an in-memory trace, not thread safe //
+
+		class CommandTraceWriter
+		{
+		public:
+
+			CommandTraceWriter();
+
+			template<typename Record>
+			void Write(const Record& record)
+			{
+				m_Data.push_back(static_cast<std::uint8_t>(Record::Op));
+				const_cast<Record&>(record).Serialize(*this);
+			}
+
+			void Clear();
+			bool Save(const char* path) const;
+
+			// Archive interface used by the records' Serialize() //
+
+			template<typename... Fields>
+			void operator()(Fields&... fields)
+			{
+				int expand[] = { 0, (WriteField(fields), 0)... };
+				(void)expand;
+			}
+
+			// Getters //
+
+			const std::vector<std::uint8_t>& Data() const { return m_Data; }
+			std::uint64_t RecordCount() const { return m_RecordCount; }
+
+		private:
+
+			template<typename T>
+			void WriteField(const T& value)
+			{
+				static_assert(std::is_unsigned<T>::value, "Trace fields are unsigned integers.");
+				WriteVarint(value);
+			}
+
+			template<typename T>
+			void WriteField(const std::vector<T>& values)
+			{
+				WriteVarint(values.size());
+				for (const T& value : values)
+				{
+					WriteField(value);
+				}
+			}
+
+			void WriteVarint(std::uint64_t value);
+
+		private:
+
+			std::vector<std::uint8_t> m_Data;
+			std::uint64_t m_RecordCount = 0;
+		};
+
+		// Sequential reader over a trace file or buffer //
+
+		class CommandTraceReader
+		{
+		public:
+
+			bool Open(const char* path);
+			bool Open(const std::uint8_t* data, std::uint64_t size);
+
+			// Reads the op of the next record, false at the end of the trace //
+
+			bool Next(TraceOp& op);
+
+			// Reads the fields of the record Next() returned, false on truncated or corrupt data //
+
+			template<typename Record>
+			bool Read(Record& record)
+			{
+				record.Serialize(*this);
+				return !m_Failed;
+			}
+
+			void Rewind() { m_Position = sizeof(CommandTraceHeader); m_Failed = false; }
+
+			// Archive interface used by the records' Serialize() //
+
+			template<typename... Fields>
+			void operator()(Fields&... fields)
+			{
+				int expand[] = { 0, (ReadField(fields), 0)... };
+				(void)expand;
+			}
+
+			// Getters //
+
+			bool Failed() const { return m_Failed; }
+			std::uint64_t Position() const { return m_Position; }
+			std::uint64_t Size() const { return m_Size; }
+
+		private:
+
+			template<typename T>
+			void ReadField(T& value)
+			{
+				static_assert(std::is_unsigned<T>::value, "Trace fields are unsigned integers.");
+				const std::uint64_t read = ReadVarint();
+				value = static_cast<T>(read);
+				m_Failed |= value != read;
+			}
+
+			template<typename T>
+			void ReadField(std::vector<T>& values)
+			{
+				// Each element takes at least one byte, a larger count can only be corrupt data //
+
+				const std::uint64_t count = ReadVarint();
+				if (count > m_Size - m_Position)
+				{
+					m_Failed = true;
+					return;
+				}
+
+				values.resize(static_cast<std::size_t>(count));
+				for (T& value : values)
+				{
+					ReadField(value);
+				}
+			}
+
+			std::uint64_t ReadVarint();
+
+		private:
+
+			MappedFile m_File;
+			const std::uint8_t* m_Data = nullptr;
+			std::uint64_t m_Size = 0;
+			std::uint64_t m_Position = 0;
+			bool m_Failed = false;
+		};
+
+		// Target of a replay, one call per record //
+
+		class TraceDevice
+		{
+		public:
+
+			virtual ~TraceDevice() = default;
+
+			virtual void CreateQueue(const TraceCreateQueue& record) = 0;
+			virtual void CreateFence(const TraceCreateFence& record) = 0;
+			virtual void CreateList(const TraceCreateList& record) = 0;
+			virtual void CreateResource(const TraceCreateResource& record) = 0;
+			virtual void ReleaseResource(const TraceReleaseResource& record) = 0;
+			virtual void ResetList(const TraceResetList& record) = 0;
+			virtual void CloseList(const TraceCloseList& record) = 0;
+			virtual void Barrier(const TraceBarrier& record) = 0;
+			virtual void SetPipeline(const TraceSetPipeline& record) = 0;
+			virtual void Draw(const TraceDraw& record) = 0;
+			virtual void Dispatch(const TraceDispatch& record) = 0;
+			virtual void ExecuteIndirect(const TraceExecuteIndirect& record) = 0;
+			virtual void CopyBuffer(const TraceCopyBuffer& record) = 0;
+			virtual void CopyTexture(const TraceCopyTexture& record) = 0;
+			virtual void ExecuteLists(const TraceExecuteLists& record) = 0;
+			virtual void Signal(const TraceSignal& record) = 0;
+			virtual void Wait(const TraceWait& record) = 0;
+			virtual void Present(const TracePresent& record) = 0;
+		};
+
+		// Feeds every record of the trace to device, in order //
+
+		bool ReplayCommandTrace(CommandTraceReader& reader, TraceDevice& device, std::string* error = nullptr);
+
+		// Work of one replayed frame //
+
+		struct TraceFrameStats
+		{
+			RenderFrameStats Render;		// UploadBytes counts copies out of upload heaps
+			std::uint64_t CommandLists = 0;	// ResetList calls
+			std::uint64_t Submissions = 0;	// ExecuteLists calls
+			std::uint64_t Signals = 0;
+			std::uint64_t Waits = 0;
+			std::uint64_t Copies = 0;
+			std::uint64_t CopyBytes = 0;	// buffer copies only
+		};
+
+		// CPU stand-in device: checks the stream is well formed and counts the work of each frame //
+		/*
+		   No GPU and no D3D12, so captured frames replay on any platform. It checks that
+		   objects exist and are not used after release, that lists are recorded while open
+		   and executed once closed, that buffer copies stay in bounds, that fence signals
+		   increase and that every waited value gets signaled. Resource states are not
+		   checked, implicit promotion and decay are not modeled.
+		*/
+
+		class SimulatedTraceDevice : public TraceDevice
+		{
+		public:
+
+			void CreateQueue(const TraceCreateQueue& record) override;
+			void CreateFence(const TraceCreateFence& record) override;
+			void CreateList(const TraceCreateList& record) override;
+			void CreateResource(const TraceCreateResource& record) override;
+			void ReleaseResource(const TraceReleaseResource& record) override;
+			void ResetList(const TraceResetList& record) override;
+			void CloseList(const TraceCloseList& record) override;
+			void Barrier(const TraceBarrier& record) override;
+			void SetPipeline(const TraceSetPipeline& record) override;
+			void Draw(const TraceDraw& record) override;
+			void Dispatch(const TraceDispatch& record) override;
+			void ExecuteIndirect(const TraceExecuteIndirect& record) override;
+			void CopyBuffer(const TraceCopyBuffer& record) override;
+			void CopyTexture(const TraceCopyTexture& record) override;
+			void ExecuteLists(const TraceExecuteLists& record) override;
+			void Signal(const TraceSignal& record) override;
+			void Wait(const TraceWait& record) override;
+			void Present(const TracePresent& record) override;
+
+			// Checks what can only be checked once the whole trace has run //
+
+			void Finish();
+
+			// Getters //
+
+			const std::vector<TraceFrameStats>& Frames() const { return m_Frames; }
+			const std::vector<std::string>& Errors() const { return m_Errors; }
+
+		private:
+
+			enum class ObjectKind : std::uint8_t
+			{
+				None,
+				Queue,
+				Fence,
+				List,
+				Resource,
+				Released
+			};
+
+			struct Object
+			{
+				ObjectKind Kind = ObjectKind::None;
+				bool Open = false;					// lists
+				TraceObject Pipeline = 0;			// lists, last pipeline set
+				std::uint64_t Value = 0;			// fences, last signaled value
+				std::uint64_t WaitedValue = 0;		// fences, largest waited value
+				std::uint64_t Width = 0;			// resources
+				std::uint32_t Dimension = 0;
+				std::uint32_t HeapType = 0;
+			};
+
+			Object& Create(TraceObject id, ObjectKind kind);
+			Object* Find(TraceObject id, ObjectKind kind, const char* use);
+			Object* RecordingList(TraceObject id, const char* use);
+			TraceFrameStats& Frame();
+
+			void Error(const char* format, ...);
+
+		private:
+
+			std::vector<Object> m_Objects;
+			std::vector<TraceFrameStats> m_Frames;
+			std::vector<std::string> m_Errors;
+			bool m_FrameOpen = false;
+		};
+	}
+}
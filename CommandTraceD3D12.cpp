@@ -0,0 +1,731 @@
+#include "CommandTraceD3D12.h"
+
+#include <atomic>
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		static_assert(g_TraceBufferDimension == D3D12_RESOURCE_DIMENSION_BUFFER, "Trace constants mirror D3D12.");
+		static_assert(g_TraceUploadHeap == D3D12_HEAP_TYPE_UPLOAD, "Trace constants mirror D3D12.");
+		static_assert(g_TraceTransitionBarrier == D3D12_RESOURCE_BARRIER_TYPE_TRANSITION, "Trace constants mirror D3D12.");
+
+		namespace
+		{
+			enum CaptureState : std::uint32_t
+			{
+				CaptureIdle,
+				CaptureArmed,
+				Capturing
+			};
+
+			std::atomic<std::uint32_t> g_CaptureState{ CaptureIdle };
+
+			bool SameDesc(const D3D12_RESOURCE_DESC& a, const D3D12_RESOURCE_DESC& b)
+			{
+				return a.Dimension == b.Dimension && a.Width == b.Width && a.Height == b.Height && a.DepthOrArraySize == b.DepthOrArraySize &&
+					a.MipLevels == b.MipLevels && a.Format == b.Format && a.Flags == b.Flags;
+			}
+		}
+
+		CommandCaptureD3D12& CommandCaptureD3D12::Global()
+		{
+			static CommandCaptureD3D12 capture;
+			return capture;
+		}
+
+		void CommandCaptureD3D12::Begin(const std::string& path, std::uint32_t frameCount)
+		{
+			CommandCaptureD3D12& capture = Global();
+			std::lock_guard<std::mutex> lock(capture.m_Mutex);
+
+			if (g_CaptureState.load(std::memory_order_relaxed) != CaptureIdle)
+			{
+				return;
+			}
+
+			capture.m_Path = path;
+			capture.m_FrameCount = std::max(frameCount, 1u);
+			g_CaptureState.store(CaptureArmed, std::memory_order_relaxed);
+		}
+
+		bool CommandCaptureD3D12::IsCapturing()
+		{
+			return g_CaptureState.load(std::memory_order_relaxed) == Capturing;
+		}
+
+		void CommandCaptureD3D12::Start()
+		{
+			m_Writer.Clear();
+			m_Objects.clear();
+			m_Resources.clear();
+			m_NextObject = 1;
+			m_Frames = 0;
+			g_CaptureState.store(Capturing, std::memory_order_relaxed);
+		}
+
+		void CommandCaptureD3D12::Finish()
+		{
+			g_CaptureState.store(CaptureIdle, std::memory_order_relaxed);
+
+			char message[512];
+			if (m_Writer.Save(m_Path.c_str()))
+			{
+				sprintf_s(message, sizeof(message), "Captured %u frames, %llu KB, into %s\n", m_Frames,
+					static_cast<unsigned long long>(m_Writer.Data().size() / 1024), m_Path.c_str());
+			}
+			else
+			{
+				sprintf_s(message, sizeof(message), "Could not write the capture to %s\n", m_Path.c_str());
+			}
+			OutputDebugStringA(message);
+
+			m_Writer.Clear();
+			m_Objects.clear();
+			m_Resources.clear();
+		}
+
+		TraceObject CommandCaptureD3D12::Queue(ID3D12CommandQueue* queue)
+		{
+			auto found = m_Objects.find(queue);
+			if (found != m_Objects.end())
+			{
+				return found->second;
+			}
+
+			TraceCreateQueue record;
+			record.Queue = m_NextObject++;
+			record.Type = queue->GetDesc().Type;
+			m_Writer.Write(record);
+
+			m_Objects.emplace(queue, record.Queue);
+			return record.Queue;
+		}
+
+		TraceObject CommandCaptureD3D12::Fence(ID3D12Fence* fence)
+		{
+			auto found = m_Objects.find(fence);
+			if (found != m_Objects.end())
+			{
+				return found->second;
+			}
+
+			TraceCreateFence record;
+			record.Fence = m_NextObject++;
+			record.InitialValue = fence->GetCompletedValue();
+			m_Writer.Write(record);
+
+			m_Objects.emplace(fence, record.Fence);
+			return record.Fence;
+		}
+
+		// A list first seen while recording was reset before the capture started //
+
+		TraceObject CommandCaptureD3D12::List(ID3D12GraphicsCommandList* list)
+		{
+			auto found = m_Objects.find(list);
+			if (found != m_Objects.end())
+			{
+				return found->second;
+			}
+
+			TraceCreateList record;
+			record.List = m_NextObject++;
+			record.Type = list->GetType();
+			m_Writer.Write(record);
+			m_Writer.Write(TraceResetList{ record.List });
+
+			m_Objects.emplace(list, record.List);
+			return record.List;
+		}
+
+		TraceObject CommandCaptureD3D12::Resource(ID3D12Resource* resource, D3D12_RESOURCE_STATES state)
+		{
+			if (!resource)
+			{
+				return g_NullTraceObject;
+			}
+
+			const D3D12_RESOURCE_DESC desc = resource->GetDesc();
+
+			auto found = m_Resources.find(resource);
+			if (found != m_Resources.end())
+			{
+				if (SameDesc(found->second.Desc, desc))
+				{
+					return found->second.Id;
+				}
+
+				// The address was reused by a new resource, the old one is gone //
+
+				m_Writer.Write(TraceReleaseResource{ found->second.Id });
+				m_Resources.erase(found);
+			}
+
+			D3D12_HEAP_PROPERTIES heapProperties = {};
+			if (FAILED(resource->GetHeapProperties(&heapProperties, nullptr)))
+			{
+				heapProperties.Type = D3D12_HEAP_TYPE_DEFAULT;
+			}
+
+			if (heapProperties.Type == D3D12_HEAP_TYPE_UPLOAD)
+			{
+				state = D3D12_RESOURCE_STATE_GENERIC_READ;
+			}
+			else if (heapProperties.Type == D3D12_HEAP_TYPE_READBACK)
+			{
+				state = D3D12_RESOURCE_STATE_COPY_DEST;
+			}
+
+			TraceCreateResource record;
+			record.Resource = m_NextObject++;
+			record.HeapType = heapProperties.Type;
+			record.Dimension = desc.Dimension;
+			record.Width = desc.Width;
+			record.Height = desc.Height;
+			record.DepthOrArraySize = desc.DepthOrArraySize;
+			record.MipLevels = desc.MipLevels;
+			record.Format = desc.Format;
+			record.Flags = desc.Flags;
+			record.InitialState = state;
+			m_Writer.Write(record);
+
+			m_Resources.emplace(resource, ResourceEntry{ record.Resource, desc });
+			return record.Resource;
+		}
+
+		TraceObject CommandCaptureD3D12::Pipeline(ID3D12PipelineState* pipelineState)
+		{
+			auto found = m_Objects.find(pipelineState);
+			if (found != m_Objects.end())
+			{
+				return found->second;
+			}
+
+			const TraceObject id = m_NextObject++;
+			m_Objects.emplace(pipelineState, id);
+			return id;
+		}
+
+		void CommandCaptureD3D12::ResetList(ID3D12GraphicsCommandList* list)
+		{
+			if (!IsCapturing())
+			{
+				return;
+			}
+
+			CommandCaptureD3D12& capture = Global();
+			std::lock_guard<std::mutex> lock(capture.m_Mutex);
+
+			if (capture.m_Objects.find(list) == capture.m_Objects.end())
+			{
+				capture.List(list);
+				return;
+			}
+
+			capture.m_Writer.Write(TraceResetList{ capture.List(list) });
+		}
+
+		void CommandCaptureD3D12::CloseList(ID3D12GraphicsCommandList* list)
+		{
+			if (!IsCapturing())
+			{
+				return;
+			}
+
+			CommandCaptureD3D12& capture = Global();
+			std::lock_guard<std::mutex> lock(capture.m_Mutex);
+			capture.m_Writer.Write(TraceCloseList{ capture.List(list) });
+		}
+
+		void CommandCaptureD3D12::Barriers(ID3D12GraphicsCommandList* list, UINT count, const D3D12_RESOURCE_BARRIER* barriers)
+		{
+			if (!IsCapturing())
+			{
+				return;
+			}
+
+			CommandCaptureD3D12& capture = Global();
+			std::lock_guard<std::mutex> lock(capture.m_Mutex);
+
+			const TraceObject listId = capture.List(list);
+
+			for (UINT i = 0; i < count; ++i)
+			{
+				const D3D12_RESOURCE_BARRIER& barrier = barriers[i];
+
+				TraceBarrier record;
+				record.List = listId;
+				record.Type = barrier.Type;
+
+				switch (barrier.Type)
+				{
+				case D3D12_RESOURCE_BARRIER_TYPE_TRANSITION:
+					record.Resource = capture.Resource(barrier.Transition.pResource, barrier.Transition.StateBefore);
+					record.Subresource = barrier.Transition.Subresource;
+					record.Before = barrier.Transition.StateBefore;
+					record.After = barrier.Transition.StateAfter;
+					break;
+				case D3D12_RESOURCE_BARRIER_TYPE_ALIASING:
+					record.Resource = capture.Resource(barrier.Aliasing.pResourceAfter);
+					break;
+				case D3D12_RESOURCE_BARRIER_TYPE_UAV:
+					record.Resource = capture.Resource(barrier.UAV.pResource, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+					break;
+				}
+
+				capture.m_Writer.Write(record);
+			}
+		}
+
+		void CommandCaptureD3D12::SetPipeline(ID3D12GraphicsCommandList* list, ID3D12PipelineState* pipelineState)
+		{
+			if (!IsCapturing())
+			{
+				return;
+			}
+
+			CommandCaptureD3D12& capture = Global();
+			std::lock_guard<std::mutex> lock(capture.m_Mutex);
+			capture.m_Writer.Write(TraceSetPipeline{ capture.List(list), capture.Pipeline(pipelineState) });
+		}
+
+		void CommandCaptureD3D12::Draw(ID3D12GraphicsCommandList* list, UINT count, UINT instances, bool indexed)
+		{
+			if (!IsCapturing())
+			{
+				return;
+			}
+
+			CommandCaptureD3D12& capture = Global();
+			std::lock_guard<std::mutex> lock(capture.m_Mutex);
+			capture.m_Writer.Write(TraceDraw{ capture.List(list), count, instances, indexed ? 1u : 0u });
+		}
+
+		void CommandCaptureD3D12::Dispatch(ID3D12GraphicsCommandList* list, UINT x, UINT y, UINT z)
+		{
+			if (!IsCapturing())
+			{
+				return;
+			}
+
+			CommandCaptureD3D12& capture = Global();
+			std::lock_guard<std::mutex> lock(capture.m_Mutex);
+			capture.m_Writer.Write(TraceDispatch{ capture.List(list), x, y, z });
+		}
+
+		void CommandCaptureD3D12::ExecuteIndirect(ID3D12GraphicsCommandList* list, UINT maxCommands, ID3D12Resource* arguments, ID3D12Resource* countBuffer)
+		{
+			if (!IsCapturing())
+			{
+				return;
+			}
+
+			CommandCaptureD3D12& capture = Global();
+			std::lock_guard<std::mutex> lock(capture.m_Mutex);
+
+			TraceExecuteIndirect record;
+			record.List = capture.List(list);
+			record.MaxCommands = maxCommands;
+			record.Arguments = capture.Resource(arguments, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT);
+			record.CountBuffer = capture.Resource(countBuffer, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT);
+			capture.m_Writer.Write(record);
+		}
+
+		void CommandCaptureD3D12::CopyBuffer(ID3D12GraphicsCommandList* list, ID3D12Resource* destination, UINT64 destinationOffset, ID3D12Resource* source, UINT64 sourceOffset, UINT64 size)
+		{
+			if (!IsCapturing())
+			{
+				return;
+			}
+
+			CommandCaptureD3D12& capture = Global();
+			std::lock_guard<std::mutex> lock(capture.m_Mutex);
+
+			TraceCopyBuffer record;
+			record.List = capture.List(list);
+			record.Destination = capture.Resource(destination, D3D12_RESOURCE_STATE_COPY_DEST);
+			record.DestinationOffset = destinationOffset;
+			record.Source = capture.Resource(source, D3D12_RESOURCE_STATE_COPY_SOURCE);
+			record.SourceOffset = sourceOffset;
+			record.Size = size;
+			capture.m_Writer.Write(record);
+		}
+
+		void CommandCaptureD3D12::CopyTexture(ID3D12GraphicsCommandList* list, const D3D12_TEXTURE_COPY_LOCATION& destination, const D3D12_TEXTURE_COPY_LOCATION& source)
+		{
+			if (!IsCapturing())
+			{
+				return;
+			}
+
+			CommandCaptureD3D12& capture = Global();
+			std::lock_guard<std::mutex> lock(capture.m_Mutex);
+
+			TraceCopyTexture record;
+			record.List = capture.List(list);
+			record.Destination = capture.Resource(destination.pResource, D3D12_RESOURCE_STATE_COPY_DEST);
+			record.DestinationSubresource = destination.SubresourceIndex;
+			record.Source = capture.Resource(source.pResource, D3D12_RESOURCE_STATE_COPY_SOURCE);
+
+			if (source.Type == D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT)
+			{
+				record.Offset = source.PlacedFootprint.Offset;
+				record.Format = source.PlacedFootprint.Footprint.Format;
+				record.Width = source.PlacedFootprint.Footprint.Width;
+				record.Height = source.PlacedFootprint.Footprint.Height;
+				record.Depth = source.PlacedFootprint.Footprint.Depth;
+				record.RowPitch = source.PlacedFootprint.Footprint.RowPitch;
+			}
+			else
+			{
+				record.SourceSubresource = source.SubresourceIndex;
+			}
+
+			capture.m_Writer.Write(record);
+		}
+
+		void CommandCaptureD3D12::ExecuteLists(ID3D12CommandQueue* queue, UINT count, ID3D12CommandList* const* lists)
+		{
+			if (!IsCapturing())
+			{
+				return;
+			}
+
+			CommandCaptureD3D12& capture = Global();
+			std::lock_guard<std::mutex> lock(capture.m_Mutex);
+
+			// Every list the engine submits is a graphics command list //
+
+			TraceExecuteLists record;
+			record.Queue = capture.Queue(queue);
+			for (UINT i = 0; i < count; ++i)
+			{
+				record.Lists.push_back(capture.List(static_cast<ID3D12GraphicsCommandList*>(lists[i])));
+			}
+			capture.m_Writer.Write(record);
+		}
+
+		void CommandCaptureD3D12::Signal(ID3D12CommandQueue* queue, ID3D12Fence* fence, UINT64 value)
+		{
+			if (!IsCapturing())
+			{
+				return;
+			}
+
+			CommandCaptureD3D12& capture = Global();
+			std::lock_guard<std::mutex> lock(capture.m_Mutex);
+			capture.m_Writer.Write(TraceSignal{ capture.Queue(queue), capture.Fence(fence), value });
+		}
+
+		void CommandCaptureD3D12::Wait(ID3D12CommandQueue* queue, ID3D12Fence* fence, UINT64 value)
+		{
+			if (!IsCapturing())
+			{
+				return;
+			}
+
+			CommandCaptureD3D12& capture = Global();
+			std::lock_guard<std::mutex> lock(capture.m_Mutex);
+			capture.m_Writer.Write(TraceWait{ capture.Queue(queue), capture.Fence(fence), value });
+		}
+
+		void CommandCaptureD3D12::Present(UINT syncInterval, UINT flags)
+		{
+			if (g_CaptureState.load(std::memory_order_relaxed) == CaptureIdle)
+			{
+				return;
+			}
+
+			CommandCaptureD3D12& capture = Global();
+			std::lock_guard<std::mutex> lock(capture.m_Mutex);
+
+			// An armed capture starts with the next frame //
+
+			if (g_CaptureState.load(std::memory_order_relaxed) == CaptureArmed)
+			{
+				capture.Start();
+				return;
+			}
+
+			capture.m_Writer.Write(TracePresent{ syncInterval, flags });
+
+			if (++capture.m_Frames >= capture.m_FrameCount)
+			{
+				capture.Finish();
+			}
+		}
+
+		TraceDeviceD3D12::TraceDeviceD3D12(ComPtr<ID3D12Device2> device)
+			: m_Device(device)
+		{
+			m_FenceEvent = ::CreateEvent(NULL, FALSE, FALSE, NULL);
+			assert(m_FenceEvent && "Failed to create fence event.");
+		}
+
+		TraceDeviceD3D12::~TraceDeviceD3D12()
+		{
+			Finish();
+			::CloseHandle(m_FenceEvent);
+		}
+
+		void TraceDeviceD3D12::Finish()
+		{
+			for (auto& entry : m_Queues)
+			{
+				QueueObject& queue = entry.second;
+				ThrowIfFailed(queue.Queue->Signal(queue.Fence.Get(), ++queue.FenceValue));
+
+				if (queue.Fence->GetCompletedValue() < queue.FenceValue)
+				{
+					ThrowIfFailed(queue.Fence->SetEventOnCompletion(queue.FenceValue, m_FenceEvent));
+					::WaitForSingleObject(m_FenceEvent, INFINITE);
+				}
+			}
+		}
+
+		TraceDeviceD3D12::ListObject& TraceDeviceD3D12::List(TraceObject id)
+		{
+			auto found = m_Lists.find(id);
+			ThrowIfFailed(found != m_Lists.end() ? S_OK : E_INVALIDARG);
+			return found->second;
+		}
+
+		ID3D12Resource* TraceDeviceD3D12::Resource(TraceObject id)
+		{
+			if (id == g_NullTraceObject)
+			{
+				return nullptr;
+			}
+
+			auto found = m_Resources.find(id);
+			ThrowIfFailed(found != m_Resources.end() ? S_OK : E_INVALIDARG);
+			return found->second.Get();
+		}
+
+		void TraceDeviceD3D12::FlushBarriers(ListObject& list)
+		{
+			if (!list.Barriers.empty())
+			{
+				list.List->ResourceBarrier(static_cast<UINT>(list.Barriers.size()), list.Barriers.data());
+				list.Barriers.clear();
+			}
+		}
+
+		void TraceDeviceD3D12::CreateQueue(const TraceCreateQueue& record)
+		{
+			D3D12_COMMAND_QUEUE_DESC desc = {};
+			desc.Type = static_cast<D3D12_COMMAND_LIST_TYPE>(record.Type);
+
+			QueueObject& queue = m_Queues[record.Queue];
+			ThrowIfFailed(m_Device->CreateCommandQueue(&desc, IID_PPV_ARGS(&queue.Queue)));
+			ThrowIfFailed(m_Device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&queue.Fence)));
+		}
+
+		void TraceDeviceD3D12::CreateFence(const TraceCreateFence& record)
+		{
+			ThrowIfFailed(m_Device->CreateFence(record.InitialValue, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_Fences[record.Fence])));
+		}
+
+		void TraceDeviceD3D12::CreateList(const TraceCreateList& record)
+		{
+			ListObject& list = m_Lists[record.List];
+			list.Type = static_cast<D3D12_COMMAND_LIST_TYPE>(record.Type);
+
+			ThrowIfFailed(m_Device->CreateCommandAllocator(list.Type, IID_PPV_ARGS(&list.Allocator)));
+			ThrowIfFailed(m_Device->CreateCommandList(0, list.Type, list.Allocator.Get(), nullptr, IID_PPV_ARGS(&list.List)));
+			ThrowIfFailed(list.List->Close());
+		}
+
+		void TraceDeviceD3D12::CreateResource(const TraceCreateResource& record)
+		{
+			D3D12_RESOURCE_DESC desc = {};
+			desc.Dimension = static_cast<D3D12_RESOURCE_DIMENSION>(record.Dimension);
+			desc.Width = record.Width;
+			desc.Height = record.Height;
+			desc.DepthOrArraySize = static_cast<UINT16>(record.DepthOrArraySize);
+			desc.MipLevels = static_cast<UINT16>(record.MipLevels);
+			desc.Format = static_cast<DXGI_FORMAT>(record.Format);
+			desc.SampleDesc.Count = 1;
+			desc.Layout = desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER ? D3D12_TEXTURE_LAYOUT_ROW_MAJOR : D3D12_TEXTURE_LAYOUT_UNKNOWN;
+			desc.Flags = static_cast<D3D12_RESOURCE_FLAGS>(record.Flags);
+
+			CD3DX12_HEAP_PROPERTIES heapProperties(static_cast<D3D12_HEAP_TYPE>(record.HeapType));
+
+			ThrowIfFailed(m_Device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &desc,
+				static_cast<D3D12_RESOURCE_STATES>(record.InitialState), nullptr, IID_PPV_ARGS(&m_Resources[record.Resource])));
+		}
+
+		void TraceDeviceD3D12::ReleaseResource(const TraceReleaseResource& record)
+		{
+			auto found = m_Resources.find(record.Resource);
+			if (found != m_Resources.end())
+			{
+				m_Released.push_back(std::move(found->second));
+				m_Resources.erase(found);
+			}
+		}
+
+		void TraceDeviceD3D12::ResetList(const TraceResetList& record)
+		{
+			ListObject& list = List(record.List);
+
+			// The allocator of a submitted list is reused once that submission has completed //
+
+			if (list.LastQueue)
+			{
+				list.Retired.push_back({ list.Allocator, list.LastQueue, list.LastFenceValue });
+				list.LastQueue = nullptr;
+
+				auto completed = std::find_if(list.Retired.begin(), list.Retired.end(), [](const RetiredAllocator& retired)
+				{
+					return retired.Queue->Fence->GetCompletedValue() >= retired.FenceValue;
+				});
+
+				if (completed != list.Retired.end())
+				{
+					list.Allocator = completed->Allocator;
+					list.Retired.erase(completed);
+				}
+				else
+				{
+					ThrowIfFailed(m_Device->CreateCommandAllocator(list.Type, IID_PPV_ARGS(&list.Allocator)));
+				}
+			}
+
+			ThrowIfFailed(list.Allocator->Reset());
+			ThrowIfFailed(list.List->Reset(list.Allocator.Get(), nullptr));
+			list.Open = true;
+		}
+
+		void TraceDeviceD3D12::CloseList(const TraceCloseList& record)
+		{
+			ListObject& list = List(record.List);
+			FlushBarriers(list);
+			ThrowIfFailed(list.List->Close());
+			list.Open = false;
+		}
+
+		void TraceDeviceD3D12::Barrier(const TraceBarrier& record)
+		{
+			ListObject& list = List(record.List);
+			ID3D12Resource* resource = Resource(record.Resource);
+
+			switch (record.Type)
+			{
+			case D3D12_RESOURCE_BARRIER_TYPE_TRANSITION:
+				list.Barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(resource, static_cast<D3D12_RESOURCE_STATES>(record.Before),
+					static_cast<D3D12_RESOURCE_STATES>(record.After), record.Subresource));
+				break;
+			case D3D12_RESOURCE_BARRIER_TYPE_ALIASING:
+				list.Barriers.push_back(CD3DX12_RESOURCE_BARRIER::Aliasing(nullptr, resource));
+				break;
+			default:
+				list.Barriers.push_back(CD3DX12_RESOURCE_BARRIER::UAV(resource));
+				break;
+			}
+		}
+
+		void TraceDeviceD3D12::SetPipeline(const TraceSetPipeline& record)
+		{
+			FlushBarriers(List(record.List));
+		}
+
+		void TraceDeviceD3D12::Draw(const TraceDraw& record)
+		{
+			FlushBarriers(List(record.List));
+			m_SkippedCommands++;
+		}
+
+		void TraceDeviceD3D12::Dispatch(const TraceDispatch& record)
+		{
+			FlushBarriers(List(record.List));
+			m_SkippedCommands++;
+		}
+
+		void TraceDeviceD3D12::ExecuteIndirect(const TraceExecuteIndirect& record)
+		{
+			FlushBarriers(List(record.List));
+			m_SkippedCommands++;
+		}
+
+		void TraceDeviceD3D12::CopyBuffer(const TraceCopyBuffer& record)
+		{
+			ListObject& list = List(record.List);
+			FlushBarriers(list);
+			list.List->CopyBufferRegion(Resource(record.Destination), record.DestinationOffset, Resource(record.Source), record.SourceOffset, record.Size);
+		}
+
+		void TraceDeviceD3D12::CopyTexture(const TraceCopyTexture& record)
+		{
+			ListObject& list = List(record.List);
+			FlushBarriers(list);
+
+			CD3DX12_TEXTURE_COPY_LOCATION destination(Resource(record.Destination), record.DestinationSubresource);
+
+			if (record.RowPitch != 0)
+			{
+				D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint = {};
+				footprint.Offset = record.Offset;
+				footprint.Footprint.Format = static_cast<DXGI_FORMAT>(record.Format);
+				footprint.Footprint.Width = record.Width;
+				footprint.Footprint.Height = record.Height;
+				footprint.Footprint.Depth = record.Depth;
+				footprint.Footprint.RowPitch = record.RowPitch;
+
+				CD3DX12_TEXTURE_COPY_LOCATION source(Resource(record.Source), footprint);
+				list.List->CopyTextureRegion(&destination, 0, 0, 0, &source, nullptr);
+			}
+			else
+			{
+				CD3DX12_TEXTURE_COPY_LOCATION source(Resource(record.Source), record.SourceSubresource);
+				list.List->CopyTextureRegion(&destination, 0, 0, 0, &source, nullptr);
+			}
+		}
+
+		void TraceDeviceD3D12::ExecuteLists(const TraceExecuteLists& record)
+		{
+			auto found = m_Queues.find(record.Queue);
+			ThrowIfFailed(found != m_Queues.end() ? S_OK : E_INVALIDARG);
+			QueueObject& queue = found->second;
+
+			std::vector<ID3D12CommandList*> lists;
+			lists.reserve(record.Lists.size());
+			for (TraceObject id : record.Lists)
+			{
+				lists.push_back(List(id).List.Get());
+			}
+
+			queue.Queue->ExecuteCommandLists(static_cast<UINT>(lists.size()), lists.data());
+			ThrowIfFailed(queue.Queue->Signal(queue.Fence.Get(), ++queue.FenceValue));
+
+			for (TraceObject id : record.Lists)
+			{
+				ListObject& list = List(id);
+				list.LastQueue = &queue;
+				list.LastFenceValue = queue.FenceValue;
+			}
+		}
+
+		void TraceDeviceD3D12::Signal(const TraceSignal& record)
+		{
+			auto queue = m_Queues.find(record.Queue);
+			auto fence = m_Fences.find(record.Fence);
+			ThrowIfFailed(queue != m_Queues.end() && fence != m_Fences.end() ? S_OK : E_INVALIDARG);
+			ThrowIfFailed(queue->second.Queue->Signal(fence->second.Get(), record.Value));
+		}
+
+		void TraceDeviceD3D12::Wait(const TraceWait& record)
+		{
+			auto queue = m_Queues.find(record.Queue);
+			auto fence = m_Fences.find(record.Fence);
+			ThrowIfFailed(queue != m_Queues.end() && fence != m_Fences.end() ? S_OK : E_INVALIDARG);
+			ThrowIfFailed(queue->second.Queue->Wait(fence->second.Get(), record.Value));
+		}
+
+		void TraceDeviceD3D12::Present(const TracePresent&)
+		{
+			m_Frames++;
+		}
+	}
+}
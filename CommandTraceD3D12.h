@@ -0,0 +1,178 @@
+#pragma once
+
+#include "Header.h"
+#include "HelperFile.h"
+#include "CommandTrace.h"
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// Captures the commands the engine issues into a CommandTrace file //
+		/*
+		   The engine calls the hooks next to the D3D12 calls they mirror. Outside of a
+		   capture they cost one relaxed atomic load. Begin() arms the capture, which starts
+		   at the next Present() so the trace always holds whole frames, and saves the file
+		   by itself after frameCount presents. Objects get ids the first time a hook sees
+		   them, resources are declared with their description at that point; a resource
+		   seen again at the address of a different description is a new object.
+		*/
+
+		class CommandCaptureD3D12
+		{
+		public:
+
+			static void Begin(const std::string& path, std::uint32_t frameCount = 1);
+			static bool IsCapturing();
+
+			// Hooks, they do nothing unless capturing //
+
+			static void ResetList(ID3D12GraphicsCommandList* list);
+			static void CloseList(ID3D12GraphicsCommandList* list);
+			static void Barriers(ID3D12GraphicsCommandList* list, UINT count, const D3D12_RESOURCE_BARRIER* barriers);
+			static void SetPipeline(ID3D12GraphicsCommandList* list, ID3D12PipelineState* pipelineState);
+			static void Draw(ID3D12GraphicsCommandList* list, UINT count, UINT instances, bool indexed);
+			static void Dispatch(ID3D12GraphicsCommandList* list, UINT x, UINT y, UINT z);
+			static void ExecuteIndirect(ID3D12GraphicsCommandList* list, UINT maxCommands, ID3D12Resource* arguments, ID3D12Resource* countBuffer);
+			static void CopyBuffer(ID3D12GraphicsCommandList* list, ID3D12Resource* destination, UINT64 destinationOffset, ID3D12Resource* source, UINT64 sourceOffset, UINT64 size);
+			static void CopyTexture(ID3D12GraphicsCommandList* list, const D3D12_TEXTURE_COPY_LOCATION& destination, const D3D12_TEXTURE_COPY_LOCATION& source);
+			static void ExecuteLists(ID3D12CommandQueue* queue, UINT count, ID3D12CommandList* const* lists);
+			static void Signal(ID3D12CommandQueue* queue, ID3D12Fence* fence, UINT64 value);
+			static void Wait(ID3D12CommandQueue* queue, ID3D12Fence* fence, UINT64 value);
+			static void Present(UINT syncInterval, UINT flags);
+
+		private:
+
+			struct ResourceEntry
+			{
+				TraceObject Id;
+				D3D12_RESOURCE_DESC Desc;
+			};
+
+			CommandCaptureD3D12() = default;
+
+			static CommandCaptureD3D12& Global();
+
+			// Id of the object, declared in the trace on first sight //
+
+			TraceObject Queue(ID3D12CommandQueue* queue);
+			TraceObject Fence(ID3D12Fence* fence);
+			TraceObject List(ID3D12GraphicsCommandList* list);
+			TraceObject Resource(ID3D12Resource* resource, D3D12_RESOURCE_STATES state = D3D12_RESOURCE_STATE_COMMON);
+			TraceObject Pipeline(ID3D12PipelineState* pipelineState);
+
+			void Start();
+			void Finish();
+
+		private:
+
+			CommandTraceWriter m_Writer;
+			std::string m_Path;
+			std::uint32_t m_FrameCount = 0;
+			std::uint32_t m_Frames = 0;
+			bool m_Armed = false;
+
+			TraceObject m_NextObject = 1;
+			std::unordered_map<const void*, TraceObject> m_Objects;
+			std::unordered_map<const void*, ResourceEntry> m_Resources;
+
+			std::mutex m_Mutex;
+		};
+
+		// Replays a trace on a D3D12 device //
+		/*
+		   Resources, command lists, barriers, copies, submissions and fences are replayed
+		   as captured, which reproduces the CPU cost of the submission side. Pipelines and
+		   shaders are not part of a trace, so draws, dispatches and indirect executions
+		   are only counted. Presents end a frame, there is no swap chain. Released
+		   resources are kept until the replay device is destroyed, after the GPU is idle.
+		*/
+
+		class TraceDeviceD3D12 : public TraceDevice
+		{
+		public:
+
+			explicit TraceDeviceD3D12(ComPtr<ID3D12Device2> device);
+			~TraceDeviceD3D12();
+
+			void CreateQueue(const TraceCreateQueue& record) override;
+			void CreateFence(const TraceCreateFence& record) override;
+			void CreateList(const TraceCreateList& record) override;
+			void CreateResource(const TraceCreateResource& record) override;
+			void ReleaseResource(const TraceReleaseResource& record) override;
+			void ResetList(const TraceResetList& record) override;
+			void CloseList(const TraceCloseList& record) override;
+			void Barrier(const TraceBarrier& record) override;
+			void SetPipeline(const TraceSetPipeline& record) override;
+			void Draw(const TraceDraw& record) override;
+			void Dispatch(const TraceDispatch& record) override;
+			void ExecuteIndirect(const TraceExecuteIndirect& record) override;
+			void CopyBuffer(const TraceCopyBuffer& record) override;
+			void CopyTexture(const TraceCopyTexture& record) override;
+			void ExecuteLists(const TraceExecuteLists& record) override;
+			void Signal(const TraceSignal& record) override;
+			void Wait(const TraceWait& record) override;
+			void Present(const TracePresent& record) override;
+
+			// Waits for every queue to drain //
+
+			void Finish();
+
+			// Getters //
+
+			std::uint64_t Frames() const { return m_Frames; }
+			std::uint64_t SkippedCommands() const { return m_SkippedCommands; }
+
+		private:
+
+			struct QueueObject
+			{
+				ComPtr<ID3D12CommandQueue> Queue;
+				ComPtr<ID3D12Fence> Fence;		// signaled after every submission, retires list allocators
+				std::uint64_t FenceValue = 0;
+			};
+
+			struct RetiredAllocator
+			{
+				ComPtr<ID3D12CommandAllocator> Allocator;
+				QueueObject* Queue;
+				std::uint64_t FenceValue;
+			};
+
+			struct ListObject
+			{
+				ComPtr<ID3D12GraphicsCommandList> List;
+				ComPtr<ID3D12CommandAllocator> Allocator;
+				std::vector<RetiredAllocator> Retired;
+				std::vector<D3D12_RESOURCE_BARRIER> Barriers;	// consecutive barriers go out in one call
+				D3D12_COMMAND_LIST_TYPE Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+				QueueObject* LastQueue = nullptr;
+				std::uint64_t LastFenceValue = 0;
+				bool Open = false;
+			};
+
+			ListObject& List(TraceObject id);
+			ID3D12Resource* Resource(TraceObject id);
+			void FlushBarriers(ListObject& list);
+
+		private:
+
+			ComPtr<ID3D12Device2> m_Device;
+			HANDLE m_FenceEvent;
+
+			std::unordered_map<TraceObject, QueueObject> m_Queues;
+			std::unordered_map<TraceObject, ComPtr<ID3D12Fence>> m_Fences;
+			std::unordered_map<TraceObject, ListObject> m_Lists;
+			std::unordered_map<TraceObject, ComPtr<ID3D12Resource>> m_Resources;
+			std::vector<ComPtr<ID3D12Resource>> m_Released;
+
+			std::uint64_t m_Frames = 0;
+			std::uint64_t m_SkippedCommands = 0;
+		};
+	}
+}
@@ -0,0 +1,137 @@
+#include "ConstantAllocator.h"
+#include "ThreadEpochCache.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		namespace
+		{
+			std::uint64_t AlignUp(std::uint64_t value, std::uint64_t alignment)
+			{
+				return (value + alignment - 1) / alignment * alignment;
+			}
+
+			// Chunk a thread is bumping in, tagged with the epoch it was reserved in //
+
+			struct ThreadChunk
+			{
+				std::uint64_t Epoch = 0;
+				std::uint64_t Offset = 0;
+				std::uint64_t End = 0;
+			};
+		}
+
+		FrameConstantAllocator::FrameConstantAllocator(std::uint64_t capacity, std::uint32_t framesInFlight, std::uint64_t chunkSize)
+			: m_ChunkSize(AlignUp(std::max<std::uint64_t>(chunkSize, g_ConstantBufferAlignment), g_ConstantBufferAlignment))
+			, m_FramesInFlight(std::max(framesInFlight, 1u))
+		{
+			// Every slot is a whole number of chunks, so chunks and slots start aligned //
+
+			m_ChunksPerFrame = std::max<std::uint64_t>(capacity / m_FramesInFlight / m_ChunkSize, 1);
+			m_FrameCapacity = m_ChunksPerFrame * m_ChunkSize;
+			m_Usage = std::make_unique<ChunkUsage[]>(m_ChunksPerFrame * m_FramesInFlight);
+
+			m_Epoch = NextThreadEpoch();
+		}
+
+		void FrameConstantAllocator::BeginFrame(std::uint32_t frameIndex)
+		{
+			assert(frameIndex < m_FramesInFlight && "Frame index out of range.");
+
+			m_LastFrame = CollectFrame(m_FrameIndex);
+			m_PeakFrameBytes = std::max(m_PeakFrameBytes, m_LastFrame.Bytes);
+
+			// A new epoch invalidates every thread's chunk of the previous frame //
+
+			m_FrameIndex = frameIndex;
+			m_FrameBegin = std::uint64_t(frameIndex) * m_FrameCapacity;
+			m_Epoch = NextThreadEpoch();
+			m_Head.store(0, std::memory_order_relaxed);
+			m_Failures.store(0, std::memory_order_relaxed);
+		}
+
+		ConstantAllocatorStats FrameConstantAllocator::CollectFrame(std::uint32_t frameIndex)
+		{
+			ConstantAllocatorStats stats;
+			stats.ReservedBytes = std::min(m_Head.load(std::memory_order_relaxed), m_FrameCapacity);
+			stats.FailedAllocations = m_Failures.load(std::memory_order_relaxed);
+
+			ChunkUsage* usage = &m_Usage[std::uint64_t(frameIndex) * m_ChunksPerFrame];
+			const std::uint64_t usedChunks = (stats.ReservedBytes + m_ChunkSize - 1) / m_ChunkSize;
+
+			for (std::uint64_t i = 0; i < usedChunks; ++i)
+			{
+				stats.Bytes += usage[i].Bytes.exchange(0, std::memory_order_relaxed);
+				stats.Allocations += usage[i].Allocations.exchange(0, std::memory_order_relaxed);
+			}
+
+			return stats;
+		}
+
+		bool FrameConstantAllocator::Reserve(std::uint64_t count, std::uint64_t& offset)
+		{
+			const std::uint64_t head = m_Head.fetch_add(count, std::memory_order_relaxed);
+			if (head + count > m_FrameCapacity)
+			{
+				m_Failures.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+
+			offset = head;
+			return true;
+		}
+
+		bool FrameConstantAllocator::Allocate(std::uint64_t size, std::uint64_t& offset)
+		{
+			size = AlignUp(std::max<std::uint64_t>(size, 1), g_ConstantBufferAlignment);
+
+			ChunkUsage* const frameUsage = &m_Usage[std::uint64_t(m_FrameIndex) * m_ChunksPerFrame];
+
+			// Big allocations get whole chunks of their own and leave the thread's chunk alone //
+
+			if (size > m_ChunkSize / 4)
+			{
+				std::uint64_t reserved;
+				if (!Reserve(AlignUp(size, m_ChunkSize), reserved))
+				{
+					return false;
+				}
+
+				ChunkUsage& usage = frameUsage[reserved / m_ChunkSize];
+				usage.Bytes.store(size, std::memory_order_relaxed);
+				usage.Allocations.store(1, std::memory_order_relaxed);
+
+				offset = m_FrameBegin + reserved;
+				return true;
+			}
+
+			ThreadChunk& chunk = FindThreadEntry<ThreadChunk>(m_Epoch);
+			if (chunk.Epoch != m_Epoch || chunk.Offset + size > chunk.End)
+			{
+				std::uint64_t reserved;
+				if (!Reserve(m_ChunkSize, reserved))
+				{
+					return false;
+				}
+
+				chunk.Epoch = m_Epoch;
+				chunk.Offset = reserved;
+				chunk.End = reserved + m_ChunkSize;
+			}
+
+			// Only this thread writes the chunk's usage, plain relaxed stores are enough //
+
+			ChunkUsage& usage = frameUsage[(chunk.End - 1) / m_ChunkSize];
+			usage.Bytes.store(usage.Bytes.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+			usage.Allocations.store(usage.Allocations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+			offset = m_FrameBegin + chunk.Offset;
+			chunk.Offset += size;
+			return true;
+		}
+	}
+}
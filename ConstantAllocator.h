@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// Placement alignment of constant buffer views (D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT) //
+
+		constexpr std::uint64_t g_ConstantBufferAlignment = 256;
+
+		struct ConstantAllocatorStats
+		{
+			std::uint64_t Bytes = 0;			// aligned bytes handed out
+			std::uint64_t Allocations = 0;
+			std::uint64_t ReservedBytes = 0;	// chunks taken by the threads, Bytes plus their unused tails
+			std::uint64_t FailedAllocations = 0;
+		};
+
+		// Per frame linear allocator of constant data, handing out offsets into a buffer split in frame slots //
+		/*
+		   Each frame in flight owns capacity / framesInFlight bytes, rewound by BeginFrame()
+		   once the slot's previous frame has completed on the GPU. Threads reserve chunks of
+		   the slot with one atomic add and bump inside them without synchronization, so a
+		   per draw allocation is an aligned pointer bump. Allocations bigger than a quarter
+		   of a chunk get their own range. Usage is counted per chunk by its owning thread
+		   and summed when the slot is rewound.
+		*/
+
+		class FrameConstantAllocator
+		{
+		public:
+
+			FrameConstantAllocator(std::uint64_t capacity, std::uint32_t framesInFlight, std::uint64_t chunkSize = 64 * 1024);
+
+			FrameConstantAllocator(const FrameConstantAllocator&) = delete;
+			FrameConstantAllocator& operator=(const FrameConstantAllocator&) = delete;
+
+			// Ends the current frame and rewinds frameIndex, no Allocate() may run concurrently //
+
+			void BeginFrame(std::uint32_t frameIndex);
+
+			// Returns false when the frame slot is full, offset is from the start of the whole buffer //
+
+			bool Allocate(std::uint64_t size, std::uint64_t& offset);
+
+			// Getters //
+
+			std::uint64_t Capacity() const { return m_FrameCapacity * m_FramesInFlight; }
+			std::uint64_t FrameCapacity() const { return m_FrameCapacity; }
+
+			// Usage of the last frame rewound by BeginFrame() and the largest frame so far //
+
+			const ConstantAllocatorStats& LastFrameStats() const { return m_LastFrame; }
+			std::uint64_t PeakFrameBytes() const { return m_PeakFrameBytes; }
+
+		private:
+
+			struct ChunkUsage
+			{
+				std::atomic<std::uint64_t> Bytes{ 0 };
+				std::atomic<std::uint64_t> Allocations{ 0 };
+			};
+
+			// Returns the offset of count bytes of the current slot, or false once it is exhausted //
+
+			bool Reserve(std::uint64_t count, std::uint64_t& offset);
+
+			// Sums and clears the chunk usage of a slot //
+
+			ConstantAllocatorStats CollectFrame(std::uint32_t frameIndex);
+
+		private:
+
+			std::uint64_t m_ChunkSize;
+			std::uint64_t m_FrameCapacity;
+			std::uint32_t m_FramesInFlight;
+			std::uint64_t m_ChunksPerFrame;
+
+			std::uint32_t m_FrameIndex = 0;
+			std::uint64_t m_Epoch = 0;					// unique per allocator and frame, tags the thread chunks
+			std::uint64_t m_FrameBegin = 0;
+			std::atomic<std::uint64_t> m_Head{ 0 };		// relative to m_FrameBegin, may overshoot the slot
+			std::atomic<std::uint64_t> m_Failures{ 0 };
+
+			std::unique_ptr<ChunkUsage[]> m_Usage;		// m_ChunksPerFrame per slot
+
+			ConstantAllocatorStats m_LastFrame;
+			std::uint64_t m_PeakFrameBytes = 0;
+		};
+	}
+}
@@ -0,0 +1,41 @@
+#include "ConstantAllocatorD3D12.h"
+#include "RenderStats.h"
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		static_assert(g_ConstantBufferAlignment == D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, "Constant allocations must be CBV aligned.");
+
+		ConstantAllocatorD3D12::ConstantAllocatorD3D12(ComPtr<ID3D12Device2> device, std::uint32_t framesInFlight, std::uint64_t bytesPerFrame)
+			: m_Allocator(bytesPerFrame * framesInFlight, framesInFlight)
+		{
+			CD3DX12_HEAP_PROPERTIES heapProperties(D3D12_HEAP_TYPE_UPLOAD);
+			CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(m_Allocator.Capacity());
+
+			ThrowIfFailed(device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+				D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&m_Buffer)));
+
+			// Write combined memory, only ever written front to back by memcpy //
+
+			CD3DX12_RANGE readRange(0, 0);
+			ThrowIfFailed(m_Buffer->Map(0, &readRange, reinterpret_cast<void**>(&m_Data)));
+			m_GpuAddress = m_Buffer->GetGPUVirtualAddress();
+		}
+
+		ConstantAllocatorD3D12::~ConstantAllocatorD3D12()
+		{
+			m_Buffer->Unmap(0, nullptr);
+		}
+
+		ConstantAllocation ConstantAllocatorD3D12::Allocate(std::uint64_t size)
+		{
+			std::uint64_t offset = 0;
+			ThrowIfFailed(m_Allocator.Allocate(size, offset) ? S_OK : E_OUTOFMEMORY);
+
+			RenderStats::Count(RenderCounter::UploadBytes, size);
+
+			return { m_Data + offset, m_GpuAddress + offset };
+		}
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Header.h"
+#include "HelperFile.h"
+#include "ConstantAllocator.h"
+
+#include <cstring>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		struct ConstantAllocation
+		{
+			void* CpuAddress;
+			D3D12_GPU_VIRTUAL_ADDRESS GpuAddress;	// usable as a root CBV or in a constant buffer view
+		};
+
+		// Per frame constant data in one persistently mapped upload buffer //
+		/*
+		   Replaces a committed resource per draw with a FrameConstantAllocator bump and a
+		   memcpy. Slots follow the frame index of the command allocators, so data written
+		   for a frame stays untouched until that frame's fence has completed.
+		*/
+
+		class ConstantAllocatorD3D12
+		{
+		public:
+
+			ConstantAllocatorD3D12(ComPtr<ID3D12Device2> device, std::uint32_t framesInFlight, std::uint64_t bytesPerFrame = 16ull * 1024 * 1024);
+			~ConstantAllocatorD3D12();
+
+			ConstantAllocatorD3D12(const ConstantAllocatorD3D12&) = delete;
+			ConstantAllocatorD3D12& operator=(const ConstantAllocatorD3D12&) = delete;
+
+			// Once per frame, after the frame slot's fence has been waited on //
+
+			void BeginFrame(std::uint32_t frameIndex) { m_Allocator.BeginFrame(frameIndex); }
+
+			// Any thread; throws E_OUTOFMEMORY when the frame slot is full //
+
+			ConstantAllocation Allocate(std::uint64_t size);
+
+			template<typename T>
+			D3D12_GPU_VIRTUAL_ADDRESS Push(const T& data)
+			{
+				ConstantAllocation allocation = Allocate(sizeof(T));
+				std::memcpy(allocation.CpuAddress, &data, sizeof(T));
+				return allocation.GpuAddress;
+			}
+
+			// Getters //
+
+			const ConstantAllocatorStats& LastFrameStats() const { return m_Allocator.LastFrameStats(); }
+			std::uint64_t PeakFrameBytes() const { return m_Allocator.PeakFrameBytes(); }
+			ComPtr<ID3D12Resource> Buffer() const { return m_Buffer; }
+
+		private:
+
+			FrameConstantAllocator m_Allocator;
+			ComPtr<ID3D12Resource> m_Buffer;
+			std::uint8_t* m_Data = nullptr;
+			D3D12_GPU_VIRTUAL_ADDRESS m_GpuAddress = 0;
+		};
+	}
+}
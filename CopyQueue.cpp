@@ -0,0 +1,377 @@
+#include "CopyQueue.h"
+#include "FootprintCacheD3D12.h"
+#include "SubresourceCopy.h"
+#include "RenderStats.h"
+#include "CommandTraceD3D12.h"
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		namespace
+		{
+			// The ring wraps allocations with D3DX12Align, which needs a power of two //
+
+			std::uint64_t StagingRingSize(std::uint64_t size)
+			{
+				std::uint64_t ringSize = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+				while (ringSize < size)
+				{
+					ringSize <<= 1;
+				}
+				return ringSize;
+			}
+		}
+
+		CopyQueue::CopyQueue(ComPtr<ID3D12Device2> device, std::uint64_t stagingSize)
+			: m_Device(device)
+			, m_StagingSize(StagingRingSize(stagingSize))
+		{
+			D3D12_COMMAND_QUEUE_DESC desc = {};
+			desc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+			desc.Priority = D3D12_COMMAND_QUEUE_PRIORITY_NORMAL;
+			desc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+			desc.NodeMask = 0;
+
+			ThrowIfFailed(m_Device->CreateCommandQueue(&desc, IID_PPV_ARGS(&m_Queue)));
+			ThrowIfFailed(m_Device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_Fence)));
+
+			m_FenceEvent = ::CreateEvent(NULL, FALSE, FALSE, NULL);
+			assert(m_FenceEvent && "Failed to create fence event.");
+
+			// The staging ring stays mapped for the lifetime of the queue //
+
+			CD3DX12_HEAP_PROPERTIES heapProperties(D3D12_HEAP_TYPE_UPLOAD);
+			CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(m_StagingSize);
+
+			ThrowIfFailed(m_Device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+				D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&m_Staging)));
+
+			CD3DX12_RANGE readRange(0, 0);
+			ThrowIfFailed(m_Staging->Map(0, &readRange, reinterpret_cast<void**>(&m_StagingData)));
+		}
+
+		CopyQueue::~CopyQueue()
+		{
+			flush();
+			m_Staging->Unmap(0, nullptr);
+			::CloseHandle(m_FenceEvent);
+		}
+
+		std::uint8_t* CopyQueue::AllocateStaging(std::uint64_t size, std::uint64_t alignment, ID3D12Resource*& resource, std::uint64_t& offset)
+		{
+			if (size <= m_StagingSize)
+			{
+				std::uint64_t head = D3DX12Align<std::uint64_t>(m_StagingHead, alignment);
+
+				// An allocation never straddles the end of the ring //
+
+				if (head % m_StagingSize + size > m_StagingSize)
+				{
+					head = D3DX12Align<std::uint64_t>(head, m_StagingSize);
+				}
+
+				if (head + size - m_StagingTail > m_StagingSize)
+				{
+					RetireBatches();
+				}
+
+				if (head + size - m_StagingTail <= m_StagingSize)
+				{
+					m_StagingHead = head + size;
+
+					resource = m_Staging.Get();
+					offset = head % m_StagingSize;
+					return m_StagingData + offset;
+				}
+			}
+
+			// Too big for the ring or the ring is full of in-flight data //
+
+			ComPtr<ID3D12Resource> uploadBuffer;
+			CD3DX12_HEAP_PROPERTIES heapProperties(D3D12_HEAP_TYPE_UPLOAD);
+			CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(size);
+
+			ThrowIfFailed(m_Device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+				D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&uploadBuffer)));
+
+			void* mapped = nullptr;
+			CD3DX12_RANGE readRange(0, 0);
+			ThrowIfFailed(uploadBuffer->Map(0, &readRange, &mapped));
+
+			// Upload heaps keep their mapping valid after the resource is referenced by the GPU //
+
+			m_Current.UploadBuffers.push_back(uploadBuffer);
+			m_Stats.DedicatedAllocations++;
+
+			resource = uploadBuffer.Get();
+			offset = 0;
+			return static_cast<std::uint8_t*>(mapped);
+		}
+
+		std::uint64_t CopyQueue::UploadBuffer(ID3D12Resource* destination, std::uint64_t destinationOffset, const void* data, std::uint64_t size)
+		{
+			std::uint8_t* staging;
+			std::uint64_t fenceValue;
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+
+				if (!m_Recording)
+				{
+					BeginBatch();
+				}
+
+				ID3D12Resource* source = nullptr;
+				std::uint64_t sourceOffset = 0;
+				staging = AllocateStaging(size, 16, source, sourceOffset);
+
+				m_CommandList->CopyBufferRegion(destination, destinationOffset, source, sourceOffset, size);
+				CommandCaptureD3D12::CopyBuffer(m_CommandList.Get(), destination, destinationOffset, source, sourceOffset, size);
+
+				m_Stats.Uploads++;
+				m_Stats.UploadBytes += size;
+				m_PendingWrites++;
+				fenceValue = m_FenceValue + 1;
+			}
+
+			// The staging memory is filled outside of the lock, Submit() waits for it //
+
+			{
+				WriteScope write(*this);
+				CopySubresource({ staging, size, size }, { data, size, size }, size, 1, 1);
+			}
+
+			RenderStats::Count(RenderCounter::UploadBytes, size);
+
+			return fenceValue;
+		}
+
+		std::uint64_t CopyQueue::UploadTexture(ID3D12Resource* destination, std::uint32_t firstSubresource, std::uint32_t numSubresources, const D3D12_SUBRESOURCE_DATA* data)
+		{
+			const std::shared_ptr<const SubresourceFootprints> footprints = GetCopyableFootprints(destination->GetDesc(), firstSubresource, numSubresources);
+			ThrowIfFailed(footprints ? S_OK : E_INVALIDARG);
+			const std::vector<PlacedFootprint>& layouts = footprints->Layouts;
+			const std::vector<std::uint32_t>& numRows = footprints->NumRows;
+			const std::vector<std::uint64_t>& rowSizes = footprints->RowSizes;
+			const UINT64 totalBytes = footprints->TotalBytes;
+
+			std::uint8_t* staging;
+			std::uint64_t fenceValue;
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+
+				if (!m_Recording)
+				{
+					BeginBatch();
+				}
+
+				ID3D12Resource* source = nullptr;
+				std::uint64_t sourceOffset = 0;
+				staging = AllocateStaging(totalBytes, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, source, sourceOffset);
+
+				for (std::uint32_t i = 0; i < numSubresources; ++i)
+				{
+					D3D12_PLACED_SUBRESOURCE_FOOTPRINT placed = ToD3D12(layouts[i]);
+					placed.Offset += sourceOffset;
+
+					CD3DX12_TEXTURE_COPY_LOCATION destinationLocation(destination, firstSubresource + i);
+					CD3DX12_TEXTURE_COPY_LOCATION sourceLocation(source, placed);
+					m_CommandList->CopyTextureRegion(&destinationLocation, 0, 0, 0, &sourceLocation, nullptr);
+					CommandCaptureD3D12::CopyTexture(m_CommandList.Get(), destinationLocation, sourceLocation);
+				}
+
+				m_Stats.Uploads++;
+				m_Stats.UploadBytes += totalBytes;
+				m_PendingWrites++;
+				fenceValue = m_FenceValue + 1;
+			}
+
+			{
+				WriteScope write(*this);
+				for (std::uint32_t i = 0; i < numSubresources; ++i)
+				{
+					const std::uint64_t rowPitch = layouts[i].RowPitch;
+					CopySubresource({ staging + layouts[i].Offset, rowPitch, rowPitch * numRows[i] },
+						{ data[i].pData, static_cast<std::uint64_t>(data[i].RowPitch), static_cast<std::uint64_t>(data[i].SlicePitch) },
+						rowSizes[i], numRows[i], layouts[i].Depth);
+				}
+			}
+
+			RenderStats::Count(RenderCounter::UploadBytes, totalBytes);
+
+			return fenceValue;
+		}
+
+		std::uint64_t CopyQueue::ReadbackBuffer(ID3D12Resource* source, std::uint64_t sourceOffset, std::uint64_t size,
+			std::function<void(const void* data, std::uint64_t size)> onComplete)
+		{
+			ComPtr<ID3D12Resource> readbackBuffer;
+			CD3DX12_HEAP_PROPERTIES heapProperties(D3D12_HEAP_TYPE_READBACK);
+			CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(size);
+
+			ThrowIfFailed(m_Device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+				D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&readbackBuffer)));
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			if (!m_Recording)
+			{
+				BeginBatch();
+			}
+
+			m_CommandList->CopyBufferRegion(readbackBuffer.Get(), 0, source, sourceOffset, size);
+			CommandCaptureD3D12::CopyBuffer(m_CommandList.Get(), readbackBuffer.Get(), 0, source, sourceOffset, size);
+			m_Current.Readbacks.push_back({ readbackBuffer, size, std::move(onComplete) });
+
+			m_Stats.Readbacks++;
+
+			return m_FenceValue + 1;
+		}
+
+		std::uint64_t CopyQueue::Submit()
+		{
+			std::vector<Readback> readbacks;
+			std::uint64_t fenceValue;
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+
+				// Uploads recorded in this batch may still be filling their staging memory //
+
+				m_WritesDone.wait(lock, [this] { return m_PendingWrites == 0; });
+
+				if (m_Recording)
+				{
+					ThrowIfFailed(m_CommandList->Close());
+					CommandCaptureD3D12::CloseList(m_CommandList.Get());
+
+					ID3D12CommandList* const commandLists[] = { m_CommandList.Get() };
+					m_Queue->ExecuteCommandLists(_countof(commandLists), commandLists);
+					CommandCaptureD3D12::ExecuteLists(m_Queue.Get(), _countof(commandLists), commandLists);
+
+					m_Current.FenceValue = ++m_FenceValue;
+					m_Current.StagingEnd = m_StagingHead;
+					ThrowIfFailed(m_Queue->Signal(m_Fence.Get(), m_Current.FenceValue));
+					CommandCaptureD3D12::Signal(m_Queue.Get(), m_Fence.Get(), m_Current.FenceValue);
+
+					m_InFlight.push_back(std::move(m_Current));
+					m_Current = Batch();
+					m_Recording = false;
+					m_Stats.CommandLists++;
+				}
+
+				// Retired readbacks are collected under the lock and reported outside of it //
+
+				RetireBatches();
+				readbacks.swap(m_CompletedReadbacks);
+				fenceValue = m_FenceValue;
+			}
+
+			for (Readback& readback : readbacks)
+			{
+				void* mapped = nullptr;
+				CD3DX12_RANGE readRange(0, static_cast<SIZE_T>(readback.Size));
+				ThrowIfFailed(readback.Buffer->Map(0, &readRange, &mapped));
+
+				readback.OnComplete(mapped, readback.Size);
+
+				CD3DX12_RANGE writeRange(0, 0);
+				readback.Buffer->Unmap(0, &writeRange);
+			}
+
+			return fenceValue;
+		}
+
+		std::uint64_t CopyQueue::PendingValue()
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			return m_Recording ? m_FenceValue + 1 : m_FenceValue;
+		}
+
+		std::uint64_t CopyQueue::CompletedValue() const
+		{
+			return m_Fence->GetCompletedValue();
+		}
+
+		void CopyQueue::WaitForFenceValue(std::uint64_t fenceValue)
+		{
+			if (m_Fence->GetCompletedValue() < fenceValue)
+			{
+				ThrowIfFailed(m_Fence->SetEventOnCompletion(fenceValue, m_FenceEvent));
+				::WaitForSingleObject(m_FenceEvent, INFINITE);
+			}
+		}
+
+		void CopyQueue::flush()
+		{
+			WaitForFenceValue(Submit());
+
+			// Second pass reports the readbacks of the batch that was just waited on //
+
+			Submit();
+		}
+
+		CopyQueueStats CopyQueue::Stats()
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			return m_Stats;
+		}
+
+		void CopyQueue::EndWrite()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_PendingWrites--;
+			}
+
+			m_WritesDone.notify_all();
+		}
+
+		void CopyQueue::BeginBatch()
+		{
+			if (!m_FreeAllocators.empty())
+			{
+				m_Current.Allocator = m_FreeAllocators.back();
+				m_FreeAllocators.pop_back();
+				ThrowIfFailed(m_Current.Allocator->Reset());
+			}
+			else
+			{
+				ThrowIfFailed(m_Device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&m_Current.Allocator)));
+			}
+
+			if (!m_CommandList)
+			{
+				ThrowIfFailed(m_Device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, m_Current.Allocator.Get(), nullptr, IID_PPV_ARGS(&m_CommandList)));
+			}
+			else
+			{
+				ThrowIfFailed(m_CommandList->Reset(m_Current.Allocator.Get(), nullptr));
+			}
+			CommandCaptureD3D12::ResetList(m_CommandList.Get());
+
+			m_Recording = true;
+		}
+
+		void CopyQueue::RetireBatches()
+		{
+			const std::uint64_t completedValue = m_Fence->GetCompletedValue();
+
+			while (!m_InFlight.empty() && m_InFlight.front().FenceValue <= completedValue)
+			{
+				Batch& batch = m_InFlight.front();
+
+				m_FreeAllocators.push_back(batch.Allocator);
+				m_StagingTail = batch.StagingEnd;
+
+				// Reported by Submit() once the lock is released //
+
+				for (Readback& readback : batch.Readbacks)
+				{
+					m_CompletedReadbacks.push_back(std::move(readback));
+				}
+
+				m_InFlight.pop_front();
+			}
+		}
+	}
+}
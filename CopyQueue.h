@@ -0,0 +1,151 @@
+#pragma once
+
+#include "Header.h"
+#include "HelperFile.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		struct CopyQueueStats
+		{
+			std::uint64_t Uploads = 0;
+			std::uint64_t UploadBytes = 0;
+			std::uint64_t Readbacks = 0;
+			std::uint64_t CommandLists = 0;
+			std::uint64_t DedicatedAllocations = 0;	// uploads that did not fit in the staging ring
+		};
+
+		// D3D12_COMMAND_LIST_TYPE_COPY queue with its own fence //
+		/*
+		   Copies are recorded into the current batch from any thread and executed by Submit(),
+		   so every small upload made between two submits shares one command list.
+		   Upload data is staged in a persistently mapped ring buffer which is recycled as
+		   batches retire; only uploads larger than the ring get their own upload buffer.
+		   Staging memory is filled with CopySubresource outside of the lock, so several
+		   threads can upload at once; Submit() waits for those writes to land.
+		   Every recording call returns the fence value the copy completes at, so callers can
+		   poll CompletedValue() or make another queue wait on Fence().
+		*/
+
+		class CopyQueue
+		{
+		public:
+
+			// stagingSize is rounded up to a power of two, 64 KB at least //
+
+			CopyQueue(ComPtr<ID3D12Device2> device, std::uint64_t stagingSize = 64ull * 1024 * 1024);
+			~CopyQueue();
+
+			CopyQueue(const CopyQueue&) = delete;
+			CopyQueue& operator=(const CopyQueue&) = delete;
+
+			std::uint64_t UploadBuffer(ID3D12Resource* destination, std::uint64_t destinationOffset, const void* data, std::uint64_t size);
+			std::uint64_t UploadTexture(ID3D12Resource* destination, std::uint32_t firstSubresource, std::uint32_t numSubresources, const D3D12_SUBRESOURCE_DATA* data);
+
+			// onComplete is called from Submit() or flush() once the copy has landed, with the mapped data //
+
+			std::uint64_t ReadbackBuffer(ID3D12Resource* source, std::uint64_t sourceOffset, std::uint64_t size,
+				std::function<void(const void* data, std::uint64_t size)> onComplete);
+
+			// Executes the current batch, returns its fence value //
+
+			std::uint64_t Submit();
+
+			// Fence value the next Submit() will signal //
+
+			std::uint64_t PendingValue();
+
+			std::uint64_t CompletedValue() const;
+			bool IsComplete(std::uint64_t fenceValue) const { return CompletedValue() >= fenceValue; }
+			void WaitForFenceValue(std::uint64_t fenceValue);
+			void flush();
+
+			// Getters //
+
+			ComPtr<ID3D12CommandQueue> Queue() const { return m_Queue; }
+			ComPtr<ID3D12Fence> Fence() const { return m_Fence; }
+			CopyQueueStats Stats();
+
+		private:
+
+			struct Readback
+			{
+				ComPtr<ID3D12Resource> Buffer;
+				std::uint64_t Size;
+				std::function<void(const void*, std::uint64_t)> OnComplete;
+			};
+
+			struct Batch
+			{
+				ComPtr<ID3D12CommandAllocator> Allocator;
+				std::vector<ComPtr<ID3D12Resource>> UploadBuffers;
+				std::vector<Readback> Readbacks;
+				std::uint64_t StagingEnd = 0;
+				std::uint64_t FenceValue = 0;
+			};
+
+			// Returns the mapped address and the resource/offset to copy from //
+
+			std::uint8_t* AllocateStaging(std::uint64_t size, std::uint64_t alignment, ID3D12Resource*& resource, std::uint64_t& offset);
+
+			void BeginBatch();
+			void RetireBatches();
+			void EndWrite();
+
+			// Ends a staging write on scope exit, a throwing copy must not leave Submit() waiting forever //
+
+			class WriteScope
+			{
+			public:
+
+				explicit WriteScope(CopyQueue& queue) : m_Queue(queue) {}
+				~WriteScope() { m_Queue.EndWrite(); }
+
+				WriteScope(const WriteScope&) = delete;
+				WriteScope& operator=(const WriteScope&) = delete;
+
+			private:
+
+				CopyQueue& m_Queue;
+			};
+
+		private:
+
+			ComPtr<ID3D12Device2> m_Device;
+			ComPtr<ID3D12CommandQueue> m_Queue;
+			ComPtr<ID3D12GraphicsCommandList> m_CommandList;
+			ComPtr<ID3D12Fence> m_Fence;
+			HANDLE m_FenceEvent = NULL;
+			std::uint64_t m_FenceValue = 0;
+
+			// Staging ring, head and tail are monotonic and wrap modulo m_StagingSize //
+
+			ComPtr<ID3D12Resource> m_Staging;
+			std::uint8_t* m_StagingData = nullptr;
+			std::uint64_t m_StagingSize = 0;
+			std::uint64_t m_StagingHead = 0;
+			std::uint64_t m_StagingTail = 0;
+
+			Batch m_Current;
+			bool m_Recording = false;
+			std::deque<Batch> m_InFlight;
+			std::vector<ComPtr<ID3D12CommandAllocator>> m_FreeAllocators;
+			std::vector<Readback> m_CompletedReadbacks;
+
+			// Uploads whose commands are recorded but whose staging memory is still being written //
+
+			std::uint32_t m_PendingWrites = 0;
+			std::condition_variable m_WritesDone;
+
+			CopyQueueStats m_Stats;
+			std::mutex m_Mutex;
+		};
+	}
+}
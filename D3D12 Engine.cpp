@@ -1,44 +1,84 @@
-#include "EngineCore.h"
-
-int CALLBACK wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR lpCmdLine, int nCmdShow)
-{
-    SetThreadDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2);
-
-    const wchar_t* windowClassName = L"DX12WindowClass";
-
-    PowerEngine::Core::EngineCore::CommandLineParsing();
-    PowerEngine::Core::EngineCore::Enable_DebugD3D12_Layer();
-
-    g_TearingSupported = PowerEngine::Core::EngineCore::CheckTearingSupport();
-    
-    PowerEngine::Core::EngineCore::RegisterWindowClass(hInstance, windowClassName);
-    g_WindowHandle = PowerEngine::Core::EngineCore::CreateWindow(windowClassName, hInstance, L"D3D12 ENGINE", g_ClientWidth, g_ClientHeight);
-
-    ::GetWindowRect(g_WindowHandle, &g_WindowRect);
-
-    PowerEngine::Core::EngineCore EngineCore;
-
-    PowerEngine::Core::EngineCore::UpdateRenderTargetViews(EngineCore.Device(), EngineCore.SwapChain(), EngineCore.DescriptorHeap());
-
-    g_IsInitialized = true;
-
-    ::ShowWindow(g_WindowHandle, SW_SHOW);
-
-    MSG msg = {};
-    while (msg.message != WM_QUIT)
-    {
-        if (::PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
-        {
-            ::TranslateMessage(&msg);
-            ::DispatchMessage(&msg);
-        }
-    }
-
-    PowerEngine::Core::EngineCore::flush(g_CommandQueue, g_Fence, g_FenceValue, g_FenceEvent);
-
-    ::CloseHandle(g_FenceEvent);
-
-    return 0;
-    
-}
-
+#include "EngineCore.h"
+#include "PlatformHeadless.h"
+#include "PlatformWin32.h"
+#include "RenderThread.h"
+
+namespace
+{
+    int Run(PowerEngine::Core::Platform& platform)
+    {
+        PowerEngine::Core::EngineCore engineCore(platform);
+
+        // Headless, nothing else competes for the thread, it renders frame after frame //
+
+        if (platform.Headless())
+        {
+            platform.SetEventHandler(&PowerEngine::Core::EngineCore::OnEvent);
+
+            while (platform.ProcessEvents())
+            {
+            }
+
+            return 0;
+        }
+
+        // The main thread sleeps on window messages and forwards them, the engine runs on the render thread //
+
+        PowerEngine::Core::RenderThread renderThread(&PowerEngine::Core::EngineCore::OnEvent, [&platform]()
+        {
+            platform.Quit();
+        });
+
+        platform.SetEventHandler([&renderThread](const PowerEngine::Core::PlatformEvent& event)
+        {
+            renderThread.Post(event);
+        });
+        platform.Show();
+        renderThread.Start();
+
+        while (platform.ProcessEvents())
+        {
+        }
+
+        renderThread.Stop();
+        platform.SetEventHandler(nullptr);
+
+        // A failure on the render thread closed the window, it surfaces on this thread //
+
+        renderThread.RethrowFailure();
+
+        return 0;
+    }
+}
+
+int CALLBACK wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR lpCmdLine, int nCmdShow)
+{
+    SetThreadDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2);
+
+    int argc;
+    wchar_t** argv = ::CommandLineToArgvW(::GetCommandLineW(), &argc);
+
+    std::vector<std::string> arguments;
+    for (int i = 0; i < argc; ++i)
+    {
+        const int size = ::WideCharToMultiByte(CP_UTF8, 0, argv[i], -1, nullptr, 0, nullptr, nullptr);
+        std::string argument(std::max(size, 1) - 1, '\0');
+        ::WideCharToMultiByte(CP_UTF8, 0, argv[i], -1, argument.data(), size, nullptr, nullptr);
+        arguments.push_back(std::move(argument));
+    }
+    ::LocalFree(argv);
+
+    PowerEngine::Core::EngineCore::CommandLineParsing(arguments);
+    PowerEngine::Core::EngineCore::Enable_DebugD3D12_Layer();
+
+    if (g_Headless)
+    {
+        PowerEngine::Core::PlatformHeadless platform(g_HeadlessFrames);
+        return Run(platform);
+    }
+
+    g_TearingSupported = PowerEngine::Core::EngineCore::CheckTearingSupport();
+
+    PowerEngine::Core::PlatformWin32 platform(hInstance, L"D3D12 ENGINE", g_ClientWidth, g_ClientHeight);
+    return Run(platform);
+}
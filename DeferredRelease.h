@@ -0,0 +1,56 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// Keeps objects alive until the GPU work that may use them has completed //
+		/*
+		   Each object is held with the fence value of the last submission that may
+		   reference it and dropped by the first Retire() seeing that value completed.
+		   Entries need not be pushed in fence order. Meant for a handful of objects per
+		   frame such as resources replaced on resize, Retire() walks every entry.
+		*/
+
+		template<typename T>
+		class DeferredReleaseQueue
+		{
+		public:
+
+			void Push(T object, std::uint64_t fenceValue)
+			{
+				m_Entries.push_back({ std::move(object), fenceValue });
+			}
+
+			void Retire(std::uint64_t completedFenceValue)
+			{
+				m_Entries.erase(std::remove_if(m_Entries.begin(), m_Entries.end(), [completedFenceValue](const Entry& entry)
+				{
+					return entry.FenceValue <= completedFenceValue;
+				}), m_Entries.end());
+			}
+
+			// Getters //
+
+			bool Empty() const { return m_Entries.empty(); }
+			std::size_t Size() const { return m_Entries.size(); }
+
+		private:
+
+			struct Entry
+			{
+				T Object;
+				std::uint64_t FenceValue;
+			};
+
+		private:
+
+			std::vector<Entry> m_Entries;
+		};
+	}
+}
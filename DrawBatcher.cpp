@@ -0,0 +1,213 @@
+#include "DrawBatcher.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		std::size_t DrawBatcher::GroupKeyHash::operator()(const GroupKey& key) const
+		{
+			std::uint64_t hash = (std::uint64_t(key.Pass) << 32) ^ key.Pipeline;
+			hash = hash * 0x9E3779B97F4A7C15ull ^ (std::uint64_t(key.Material) << 32 | key.Mesh);
+			hash ^= hash >> 29;
+			return static_cast<std::size_t>(hash * 0xBF58476D1CE4E5B9ull);
+		}
+
+		namespace
+		{
+			constexpr std::uint32_t g_EmptyGroup = ~0u;
+
+			template<typename Draw>
+			void CountStateChange(StateChangeCounts& counts, const Draw* previous, const Draw& draw)
+			{
+				if (previous == nullptr || previous->Pipeline != draw.Pipeline)
+				{
+					counts.Pipelines++;
+					counts.Materials++;		// rebinding the root signature drops the material bindings
+				}
+				else if (previous->Material != draw.Material)
+				{
+					counts.Materials++;
+				}
+
+				if (previous == nullptr || previous->Mesh != draw.Mesh)
+				{
+					counts.Meshes++;
+				}
+			}
+		}
+
+		void DrawBatcher::Submit(std::uint32_t pass, const DrawRequest& draw)
+		{
+			m_Pending.push_back({ pass, draw });
+		}
+
+		std::uint32_t DrawBatcher::FindGroup(const GroupKey& key, bool& inserted)
+		{
+			const std::size_t mask = m_GroupTable.size() - 1;
+			for (std::size_t slot = GroupKeyHash()(key) & mask;; slot = (slot + 1) & mask)
+			{
+				std::uint32_t& group = m_GroupTable[slot];
+				if (group == g_EmptyGroup)
+				{
+					inserted = true;
+					group = static_cast<std::uint32_t>(m_Draws.size());
+					return group;
+				}
+
+				const InstancedDraw& draw = m_Draws[group];
+				if (key == GroupKey{ draw.Pass, draw.Pipeline, draw.Material, draw.Mesh })
+				{
+					inserted = false;
+					return group;
+				}
+			}
+		}
+
+		void DrawBatcher::Build(ThreadPool* pool)
+		{
+			m_Draws.clear();
+			m_Instances.clear();
+			m_GroupOfDraw.resize(m_Pending.size());
+
+			// At most half full, so probes stay short //
+
+			std::size_t tableSize = 16;
+			while (tableSize < m_Pending.size() * 2)
+			{
+				tableSize *= 2;
+			}
+			m_GroupTable.assign(tableSize, g_EmptyGroup);
+
+			m_SortOrder.resize(m_Pending.size());
+			for (std::uint32_t i = 0; i < m_SortOrder.size(); ++i)
+			{
+				m_SortOrder[i] = i;
+			}
+
+			m_Stats.SortMilliseconds = 0.0;
+			if (m_SortingEnabled)
+			{
+				const auto sortBegin = std::chrono::steady_clock::now();
+
+				m_SortKeys.resize(m_Pending.size());
+				for (std::size_t i = 0; i < m_Pending.size(); ++i)
+				{
+					const DrawRequest& request = m_Pending[i].Request;
+					m_SortKeys[i] = EncodeSortKey(m_SortKeyLayout, { m_Pending[i].Pass, request.Layer, request.Pipeline, request.Material, request.Depth });
+				}
+
+				RadixSort(m_SortKeys, m_SortOrder, m_SortScratch, pool);
+
+				m_Stats.SortMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sortBegin).count();
+			}
+
+			// Groups are numbered in order of first appearance in the sorted sequence //
+
+			for (std::uint32_t i : m_SortOrder)
+			{
+				const PendingDraw& pending = m_Pending[i];
+				const GroupKey key = { pending.Pass, pending.Request.Pipeline, pending.Request.Material, pending.Request.Mesh };
+
+				std::uint32_t group = static_cast<std::uint32_t>(m_Draws.size());
+				if (m_InstancingEnabled)
+				{
+					bool inserted = false;
+					group = FindGroup(key, inserted);
+
+					if (!inserted)
+					{
+						m_Draws[group].InstanceCount++;
+						m_GroupOfDraw[i] = group;
+						continue;
+					}
+				}
+
+				m_Draws.push_back({ pending.Pass, pending.Request.Pipeline, pending.Request.Material, pending.Request.Mesh, 0, 1 });
+				m_GroupOfDraw[i] = group;
+			}
+
+			// Order by pass without disturbing the order inside a pass, then lay the instances out //
+			/*
+			   The sort key leads with the pass, so sorted frames are usually in pass order
+			   already; only passes wider than PassBits or unsorted frames need the radix sort.
+			*/
+
+			m_PassOrder.resize(m_Draws.size());
+			for (std::uint32_t g = 0; g < m_PassOrder.size(); ++g)
+			{
+				m_PassOrder[g] = g;
+			}
+
+			if (!std::is_sorted(m_Draws.begin(), m_Draws.end(), [](const InstancedDraw& a, const InstancedDraw& b) { return a.Pass < b.Pass; }))
+			{
+				m_PassKeys.resize(m_Draws.size());
+				for (std::size_t g = 0; g < m_Draws.size(); ++g)
+				{
+					m_PassKeys[g] = m_Draws[g].Pass;
+				}
+				RadixSort(m_PassKeys, m_PassOrder, m_SortScratch, nullptr);
+			}
+
+			m_SortedDraws.resize(m_Draws.size());
+			m_InstanceCursor.resize(m_Draws.size());
+			std::uint32_t firstInstance = 0;
+
+			for (std::size_t i = 0; i < m_PassOrder.size(); ++i)
+			{
+				const std::uint32_t group = m_PassOrder[i];
+				m_SortedDraws[i] = m_Draws[group];
+				m_SortedDraws[i].FirstInstance = firstInstance;
+				m_InstanceCursor[group] = firstInstance;
+				firstInstance += m_SortedDraws[i].InstanceCount;
+			}
+
+			// Instances of a group follow the key order too, near to far unless the layout says otherwise //
+
+			m_Instances.resize(m_Pending.size());
+			for (std::uint32_t i : m_SortOrder)
+			{
+				m_Instances[m_InstanceCursor[m_GroupOfDraw[i]]++] = m_Pending[i].Request.Transform;
+			}
+
+			m_Draws.swap(m_SortedDraws);
+
+			m_Stats.SubmittedDraws = static_cast<std::uint32_t>(m_Pending.size());
+			m_Stats.EmittedDraws = static_cast<std::uint32_t>(m_Draws.size());
+			m_Stats.Passes = 0;
+			m_Stats.StateChangesEmitted = StateChangeCounts();
+			for (std::size_t i = 0; i < m_Draws.size(); ++i)
+			{
+				const bool newPass = i == 0 || m_Draws[i].Pass != m_Draws[i - 1].Pass;
+				m_Stats.Passes += newPass ? 1 : 0;
+
+				// Every pass is recorded from a clean state //
+
+				CountStateChange(m_Stats.StateChangesEmitted, newPass ? nullptr : &m_Draws[i - 1], m_Draws[i]);
+			}
+
+			m_Stats.StateChangesSubmitted = StateChangeCounts();
+			for (std::size_t i = 0; i < m_Pending.size(); ++i)
+			{
+				const bool newPass = i == 0 || m_Pending[i].Pass != m_Pending[i - 1].Pass;
+				CountStateChange(m_Stats.StateChangesSubmitted, newPass ? nullptr : &m_Pending[i - 1].Request, m_Pending[i].Request);
+			}
+		}
+
+		void DrawBatcher::Reset()
+		{
+			m_Pending.clear();
+		}
+
+		void DrawBatcher::PassRange(std::uint32_t pass, std::size_t& begin, std::size_t& end) const
+		{
+			auto lower = std::lower_bound(m_Draws.begin(), m_Draws.end(), pass, [](const InstancedDraw& draw, std::uint32_t value) { return draw.Pass < value; });
+			auto upper = std::upper_bound(lower, m_Draws.end(), pass, [](std::uint32_t value, const InstancedDraw& draw) { return value < draw.Pass; });
+
+			begin = static_cast<std::size_t>(lower - m_Draws.begin());
+			end = static_cast<std::size_t>(upper - m_Draws.begin());
+		}
+	}
+}
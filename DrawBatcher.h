@@ -0,0 +1,149 @@
+#pragma once
+
+#include "DrawSortKey.h"
+#include "MemoryTracker.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		using MeshHandle = std::uint32_t;
+		using MaterialHandle = std::uint32_t;
+		using PipelineHandle = std::uint32_t;
+
+		// World matrix, three rows of a row-major 4x4 whose last row is (0, 0, 0, 1) //
+
+		struct InstanceTransform
+		{
+			float Rows[3][4];
+		};
+
+		struct DrawRequest
+		{
+			PipelineHandle Pipeline;
+			MaterialHandle Material;
+			MeshHandle Mesh;
+			std::uint32_t Layer;	// sort layer inside the pass
+			float Depth;			// view space distance used by the sort key
+			InstanceTransform Transform;
+		};
+
+		// One draw after batching, its transforms are Instances()[FirstInstance, FirstInstance + InstanceCount) //
+
+		struct InstancedDraw
+		{
+			std::uint32_t Pass;
+			PipelineHandle Pipeline;
+			MaterialHandle Material;
+			MeshHandle Mesh;
+			std::uint32_t FirstInstance;
+			std::uint32_t InstanceCount;
+		};
+
+		struct DrawBatchStats
+		{
+			std::uint32_t SubmittedDraws = 0;	// DrawRequest count
+			std::uint32_t EmittedDraws = 0;		// draw calls after instancing
+			std::uint32_t Passes = 0;
+
+			StateChangeCounts StateChangesSubmitted;	// one draw per request, submission order
+			StateChangeCounts StateChangesEmitted;		// the draws actually recorded
+			double SortMilliseconds = 0.0;
+		};
+
+		// Collects the frame's draws and merges those sharing pipeline, material and mesh //
+		/*
+		   Requests are first radix sorted on their 64 bit key (see SortKeyLayout), then
+		   merged within a pass, a merged draw taking the place of the first request of
+		   its group in key order. With sorting disabled the submission order is kept.
+		   Submit() is meant for the render thread; Build() is called once per frame
+		   before the D3D12 side uploads Instances() and records. Build() works in
+		   member buffers that only grow, a steady frame doesn't allocate.
+		*/
+
+		class DrawBatcher
+		{
+		public:
+
+			void Submit(std::uint32_t pass, const DrawRequest& draw);
+
+			// Turns the submitted requests into Draws() and Instances() //
+
+			void Build(ThreadPool* pool = &ThreadPool::Global());
+
+			// Clears the requests for the next frame, the last Stats() stay available //
+
+			void Reset();
+
+			// Without instancing every request becomes its own draw, useful to compare the counts //
+
+			void SetInstancingEnabled(bool enabled) { m_InstancingEnabled = enabled; }
+			void SetSortingEnabled(bool enabled) { m_SortingEnabled = enabled; }
+			void SetSortKeyLayout(const SortKeyLayout& layout) { m_SortKeyLayout = layout; }
+
+			// Getters //
+
+			const TaggedVector<InstancedDraw, MemoryTag::Render>& Draws() const { return m_Draws; }
+			const TaggedVector<InstanceTransform, MemoryTag::Render>& Instances() const { return m_Instances; }
+			const DrawBatchStats& Stats() const { return m_Stats; }
+
+			// Range of Draws() belonging to pass, draws are ordered by pass //
+
+			void PassRange(std::uint32_t pass, std::size_t& begin, std::size_t& end) const;
+
+		private:
+
+			struct PendingDraw
+			{
+				std::uint32_t Pass;
+				DrawRequest Request;
+			};
+
+			struct GroupKey
+			{
+				std::uint32_t Pass;
+				PipelineHandle Pipeline;
+				MaterialHandle Material;
+				MeshHandle Mesh;
+
+				bool operator==(const GroupKey& other) const
+				{
+					return Pass == other.Pass && Pipeline == other.Pipeline && Material == other.Material && Mesh == other.Mesh;
+				}
+			};
+
+			struct GroupKeyHash
+			{
+				std::size_t operator()(const GroupKey& key) const;
+			};
+
+		private:
+
+			// Open addressing over m_Draws indices, returns the draw of key's group or adds one //
+
+			std::uint32_t FindGroup(const GroupKey& key, bool& inserted);
+
+		private:
+
+			TaggedVector<PendingDraw, MemoryTag::Render> m_Pending;
+			std::vector<std::uint64_t> m_SortKeys;
+			std::vector<std::uint32_t> m_SortOrder;
+			TaggedVector<InstancedDraw, MemoryTag::Render> m_Draws;
+			TaggedVector<InstanceTransform, MemoryTag::Render> m_Instances;
+			TaggedVector<std::uint32_t, MemoryTag::Render> m_GroupTable;	// power of two, empty slots hold ~0u
+			TaggedVector<std::uint32_t, MemoryTag::Render> m_GroupOfDraw;
+			std::vector<std::uint64_t> m_PassKeys;
+			std::vector<std::uint32_t> m_PassOrder;
+			TaggedVector<InstancedDraw, MemoryTag::Render> m_SortedDraws;
+			TaggedVector<std::uint32_t, MemoryTag::Render> m_InstanceCursor;
+			RadixSortScratch m_SortScratch;
+			DrawBatchStats m_Stats;
+			SortKeyLayout m_SortKeyLayout;
+			bool m_InstancingEnabled = true;
+			bool m_SortingEnabled = true;
+		};
+	}
+}
@@ -0,0 +1,167 @@
+#include "DrawBatcherD3D12.h"
+#include "RenderStats.h"
+#include "CommandTraceD3D12.h"
+
+#include <cstring>
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		DrawBatcherD3D12::DrawBatcherD3D12(ComPtr<ID3D12Device2> device, std::uint32_t framesInFlight, UINT instanceRootParameter)
+			: m_Device(device)
+			, m_InstanceRootParameter(instanceRootParameter)
+			, m_Frames(framesInFlight)
+		{
+		}
+
+		void DrawBatcherD3D12::RegisterMesh(MeshHandle mesh, const MeshBinding& binding)
+		{
+			if (mesh >= m_Meshes.size())
+			{
+				m_Meshes.resize(mesh + 1);
+			}
+
+			m_Meshes[mesh] = binding;
+		}
+
+		void DrawBatcherD3D12::RegisterPipeline(PipelineHandle pipeline, ComPtr<ID3D12PipelineState> pipelineState, ComPtr<ID3D12RootSignature> rootSignature)
+		{
+			if (pipeline >= m_Pipelines.size())
+			{
+				m_Pipelines.resize(pipeline + 1);
+			}
+
+			m_Pipelines[pipeline] = { pipelineState, rootSignature };
+		}
+
+		void DrawBatcherD3D12::Upload(const DrawBatcher& batcher, std::uint32_t frameIndex)
+		{
+			FrameBuffer& frame = m_Frames[frameIndex];
+			const std::uint64_t size = batcher.Instances().size() * sizeof(InstanceTransform);
+
+			if (size == 0)
+			{
+				return;
+			}
+
+			// Grown by doubling; the old buffer belongs to a retired frame and can go right away //
+
+			if (size > frame.Capacity)
+			{
+				std::uint64_t capacity = frame.Capacity > 0 ? frame.Capacity : 64 * sizeof(InstanceTransform);
+				while (capacity < size)
+				{
+					capacity *= 2;
+				}
+
+				CD3DX12_HEAP_PROPERTIES heapProperties(D3D12_HEAP_TYPE_UPLOAD);
+				CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(capacity);
+
+				if (frame.Residency != g_InvalidResidencyHandle)
+				{
+					m_Residency->Untrack(frame.Residency);
+					frame.Residency = g_InvalidResidencyHandle;
+				}
+
+				frame.Buffer.Reset();
+				ThrowIfFailed(m_Device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+					D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&frame.Buffer)));
+
+				if (m_Residency)
+				{
+					frame.Residency = m_Residency->Track(frame.Buffer.Get());
+				}
+
+				CD3DX12_RANGE readRange(0, 0);
+				ThrowIfFailed(frame.Buffer->Map(0, &readRange, reinterpret_cast<void**>(&frame.Data)));
+				frame.Capacity = capacity;
+			}
+
+			if (m_Residency)
+			{
+				m_Residency->MarkUsed(frame.Residency);
+			}
+
+			std::memcpy(frame.Data, batcher.Instances().data(), static_cast<size_t>(size));
+
+			RenderStats::Count(RenderCounter::UploadBytes, size);
+		}
+
+		void DrawBatcherD3D12::Record(ID3D12GraphicsCommandList* commandList, const DrawBatcher& batcher, std::uint32_t pass, std::uint32_t frameIndex)
+		{
+			std::size_t begin, end;
+			batcher.PassRange(pass, begin, end);
+
+			if (begin == end)
+			{
+				return;
+			}
+
+			const D3D12_GPU_VIRTUAL_ADDRESS instances = m_Frames[frameIndex].Buffer->GetGPUVirtualAddress();
+
+			// State is only set when it changes from the previous draw //
+
+			const PipelineHandle noHandle = ~0u;
+			ID3D12RootSignature* currentRootSignature = nullptr;
+			PipelineHandle currentPipeline = noHandle;
+			MaterialHandle currentMaterial = noHandle;
+			MeshHandle currentMesh = noHandle;
+			std::uint64_t triangles = 0;
+			std::uint64_t pipelineChanges = 0;
+
+			commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				const InstancedDraw& draw = batcher.Draws()[i];
+
+				if (draw.Pipeline != currentPipeline)
+				{
+					const PipelineBinding& pipeline = m_Pipelines[draw.Pipeline];
+					commandList->SetPipelineState(pipeline.PipelineState.Get());
+					CommandCaptureD3D12::SetPipeline(commandList, pipeline.PipelineState.Get());
+					currentPipeline = draw.Pipeline;
+					pipelineChanges++;
+
+					// Pipelines often share a root signature, a new one invalidates the material bindings //
+
+					if (pipeline.RootSignature.Get() != currentRootSignature)
+					{
+						commandList->SetGraphicsRootSignature(pipeline.RootSignature.Get());
+						currentRootSignature = pipeline.RootSignature.Get();
+						currentMaterial = noHandle;
+
+						if (m_RootTableBinder)
+						{
+							m_RootTableBinder(commandList);
+						}
+					}
+				}
+
+				if (draw.Material != currentMaterial && m_MaterialBinder)
+				{
+					m_MaterialBinder(commandList, draw.Material);
+					currentMaterial = draw.Material;
+				}
+
+				const MeshBinding& mesh = m_Meshes[draw.Mesh];
+				if (draw.Mesh != currentMesh)
+				{
+					commandList->IASetVertexBuffers(0, 1, &mesh.VertexBuffer);
+					commandList->IASetIndexBuffer(&mesh.IndexBuffer);
+					currentMesh = draw.Mesh;
+				}
+
+				commandList->SetGraphicsRootShaderResourceView(m_InstanceRootParameter, instances + std::uint64_t(draw.FirstInstance) * sizeof(InstanceTransform));
+				commandList->DrawIndexedInstanced(mesh.IndexCount, draw.InstanceCount, 0, 0, 0);
+				CommandCaptureD3D12::Draw(commandList, mesh.IndexCount, draw.InstanceCount, true);
+				triangles += std::uint64_t(mesh.IndexCount / 3) * draw.InstanceCount;
+			}
+
+			RenderStats::Count(RenderCounter::Draws, end - begin);
+			RenderStats::Count(RenderCounter::Triangles, triangles);
+			RenderStats::Count(RenderCounter::PipelineChanges, pipelineChanges);
+		}
+	}
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Header.h"
+#include "HelperFile.h"
+#include "DrawBatcher.h"
+#include "ResidencyManagerD3D12.h"
+
+#include <functional>
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		struct MeshBinding
+		{
+			D3D12_VERTEX_BUFFER_VIEW VertexBuffer;
+			D3D12_INDEX_BUFFER_VIEW IndexBuffer;
+			UINT IndexCount;
+		};
+
+		// Uploads the batched instance transforms and records the instanced draws //
+		/*
+		   Every root signature used with the batcher takes a root SRV at instanceRootParameter
+		   holding a StructuredBuffer<InstanceTransform>, indexed with SV_InstanceID. The root
+		   SRV is pointed at the draw's first instance, so shaders need no instance offset.
+		   Each frame slot has its own persistently mapped upload buffer, only rewritten once
+		   the slot's previous frame has retired.
+		*/
+
+		class DrawBatcherD3D12
+		{
+		public:
+
+			using MaterialBinder = std::function<void(ID3D12GraphicsCommandList* commandList, MaterialHandle material)>;
+			using RootTableBinder = std::function<void(ID3D12GraphicsCommandList* commandList)>;
+
+			DrawBatcherD3D12(ComPtr<ID3D12Device2> device, std::uint32_t framesInFlight, UINT instanceRootParameter = 0);
+
+			void RegisterMesh(MeshHandle mesh, const MeshBinding& binding);
+			void RegisterPipeline(PipelineHandle pipeline, ComPtr<ID3D12PipelineState> pipelineState, ComPtr<ID3D12RootSignature> rootSignature);
+			void SetMaterialBinder(MaterialBinder binder) { m_MaterialBinder = std::move(binder); }
+
+			// Sets the tables every material shares, called once after each root signature change //
+
+			void SetRootTableBinder(RootTableBinder binder) { m_RootTableBinder = std::move(binder); }
+
+			// Tracks the instance buffers, Upload() marks the frame slot's one used //
+
+			void SetResidency(ResidencyManagerD3D12* residency) { m_Residency = residency; }
+
+			// Copies batcher.Instances() into the frame slot's buffer, after DrawBatcher::Build() //
+
+			void Upload(const DrawBatcher& batcher, std::uint32_t frameIndex);
+
+			// Records the draws of one pass, render targets and viewport are left to the caller //
+
+			void Record(ID3D12GraphicsCommandList* commandList, const DrawBatcher& batcher, std::uint32_t pass, std::uint32_t frameIndex);
+
+		private:
+
+			struct PipelineBinding
+			{
+				ComPtr<ID3D12PipelineState> PipelineState;
+				ComPtr<ID3D12RootSignature> RootSignature;
+			};
+
+			struct FrameBuffer
+			{
+				ComPtr<ID3D12Resource> Buffer;
+				std::uint8_t* Data = nullptr;
+				std::uint64_t Capacity = 0;
+				ResidencyHandle Residency = g_InvalidResidencyHandle;
+			};
+
+		private:
+
+			ComPtr<ID3D12Device2> m_Device;
+			UINT m_InstanceRootParameter;
+			std::vector<MeshBinding> m_Meshes;
+			std::vector<PipelineBinding> m_Pipelines;
+			MaterialBinder m_MaterialBinder;
+			RootTableBinder m_RootTableBinder;
+			std::vector<FrameBuffer> m_Frames;
+			ResidencyManagerD3D12* m_Residency = nullptr;
+		};
+	}
+}
@@ -0,0 +1,185 @@
+#include "DrawSortKey.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		namespace
+		{
+			constexpr std::uint32_t g_RadixBits = 8;
+			constexpr std::uint32_t g_RadixSize = 1u << g_RadixBits;
+			constexpr std::size_t g_ParallelSortMinimum = 8192;
+
+			std::uint64_t FieldBits(std::uint64_t value, std::uint32_t bits)
+			{
+				return bits >= 64 ? value : value & ((1ull << bits) - 1);
+			}
+
+			// Shifting by the full 64 bits is undefined, a field that wide shifts the rest out //
+
+			std::uint64_t ShiftLeft(std::uint64_t value, std::uint32_t bits)
+			{
+				return bits >= 64 ? 0 : value << bits;
+			}
+		}
+
+		std::uint64_t EncodeSortKey(const SortKeyLayout& layout, const SortKeyFields& fields)
+		{
+			assert(layout.IsValid() && "Sort key fields must fit in 64 bits, depth in 32.");
+
+			std::uint32_t depthBits = 0;
+			if (layout.DepthBits > 0)
+			{
+				const float depth = fields.Depth > 0.0f ? fields.Depth : 0.0f;
+				std::memcpy(&depthBits, &depth, sizeof(depthBits));
+				depthBits >>= 32 - std::min<std::uint32_t>(layout.DepthBits, 32);
+
+				if (layout.BackToFront)
+				{
+					depthBits = static_cast<std::uint32_t>(FieldBits(~depthBits, layout.DepthBits));
+				}
+			}
+
+			std::uint64_t key = FieldBits(fields.Pass, layout.PassBits);
+			key = ShiftLeft(key, layout.LayerBits) | FieldBits(fields.Layer, layout.LayerBits);
+			key = ShiftLeft(key, layout.PipelineBits) | FieldBits(fields.Pipeline, layout.PipelineBits);
+			key = ShiftLeft(key, layout.MaterialBits) | FieldBits(fields.Material, layout.MaterialBits);
+			key = ShiftLeft(key, layout.DepthBits) | depthBits;
+
+			// Fields start at bit 63 so that layouts narrower than 64 bits still sort pass first //
+
+			const std::uint32_t used = layout.PassBits + layout.LayerBits + layout.PipelineBits + layout.MaterialBits + layout.DepthBits;
+			return used < 64 ? ShiftLeft(key, 64 - used) : key;
+		}
+
+		void RadixSort(std::vector<std::uint64_t>& keys, std::vector<std::uint32_t>& values, ThreadPool* pool)
+		{
+			RadixSortScratch scratch;
+			RadixSort(keys, values, scratch, pool);
+		}
+
+		void RadixSort(std::vector<std::uint64_t>& keys, std::vector<std::uint32_t>& values, RadixSortScratch& scratch, ThreadPool* pool)
+		{
+			const std::size_t count = keys.size();
+			if (count < 2)
+			{
+				return;
+			}
+
+			std::uint32_t chunkCount = 1;
+			if (pool != nullptr && count >= g_ParallelSortMinimum)
+			{
+				chunkCount = std::min<std::uint32_t>(pool->ThreadCount() + 1, static_cast<std::uint32_t>(count / (g_ParallelSortMinimum / 2)));
+				chunkCount = std::max(chunkCount, 1u);
+			}
+
+			const std::size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+			// Only grows, a steady frame size sorts without allocating //
+
+			scratch.Keys.resize(count);
+			scratch.Values.resize(count);
+			scratch.Histograms.resize(std::size_t(chunkCount) * g_RadixSize);
+			std::vector<std::uint32_t>& histograms = scratch.Histograms;
+
+			std::uint64_t* sourceKeys = keys.data();
+			std::uint32_t* sourceValues = values.data();
+			std::uint64_t* destinationKeys = scratch.Keys.data();
+			std::uint32_t* destinationValues = scratch.Values.data();
+
+			auto forEachChunk = [&](auto&& function)
+			{
+				auto run = [&](std::uint32_t first, std::uint32_t last)
+				{
+					for (std::uint32_t chunk = first; chunk < last; ++chunk)
+					{
+						const std::size_t begin = chunk * chunkSize;
+						function(chunk, begin, std::min(begin + chunkSize, count));
+					}
+				};
+
+				if (chunkCount == 1)
+				{
+					run(0, 1);
+				}
+				else
+				{
+					pool->ParallelFor(chunkCount, 1, run);
+				}
+			};
+
+			for (std::uint32_t shift = 0; shift < 64; shift += g_RadixBits)
+			{
+				// Per chunk histograms //
+
+				std::fill(histograms.begin(), histograms.end(), 0u);
+				forEachChunk([&](std::uint32_t chunk, std::size_t begin, std::size_t end)
+				{
+					std::uint32_t* histogram = histograms.data() + std::size_t(chunk) * g_RadixSize;
+					for (std::size_t i = begin; i < end; ++i)
+					{
+						histogram[(sourceKeys[i] >> shift) & (g_RadixSize - 1)]++;
+					}
+				});
+
+				// Skip the pass when every key has the same digit //
+
+				bool trivial = false;
+				for (std::uint32_t digit = 0; digit < g_RadixSize && !trivial; ++digit)
+				{
+					std::size_t total = 0;
+					for (std::uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+					{
+						total += histograms[std::size_t(chunk) * g_RadixSize + digit];
+					}
+					trivial = total == count;
+				}
+
+				if (trivial)
+				{
+					continue;
+				}
+
+				// Exclusive prefix sum, digit major then chunk, keeps the sort stable //
+
+				std::uint32_t offset = 0;
+				for (std::uint32_t digit = 0; digit < g_RadixSize; ++digit)
+				{
+					for (std::uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+					{
+						std::uint32_t& slot = histograms[std::size_t(chunk) * g_RadixSize + digit];
+						const std::uint32_t digitCount = slot;
+						slot = offset;
+						offset += digitCount;
+					}
+				}
+
+				forEachChunk([&](std::uint32_t chunk, std::size_t begin, std::size_t end)
+				{
+					std::uint32_t* offsets = histograms.data() + std::size_t(chunk) * g_RadixSize;
+					for (std::size_t i = begin; i < end; ++i)
+					{
+						const std::uint32_t position = offsets[(sourceKeys[i] >> shift) & (g_RadixSize - 1)]++;
+						destinationKeys[position] = sourceKeys[i];
+						destinationValues[position] = sourceValues[i];
+					}
+				});
+
+				std::swap(sourceKeys, destinationKeys);
+				std::swap(sourceValues, destinationValues);
+			}
+
+			// An odd number of executed passes leaves the result in the scratch buffers //
+
+			if (sourceKeys != keys.data())
+			{
+				keys.swap(scratch.Keys);
+				values.swap(scratch.Values);
+			}
+		}
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "ThreadPool.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// Bit widths of the draw sort key fields, from the most significant down //
+		/*
+		   pass | layer | pipeline | material | depth
+		   Fields wider than their bits are truncated, which only costs sort quality since
+		   batching compares the full handles. Depth uses the top bits of the positive
+		   float, whose ordering matches the integer ordering. EncodeSortKey asserts
+		   IsValid().
+		*/
+
+		struct SortKeyLayout
+		{
+			std::uint8_t PassBits = 4;
+			std::uint8_t LayerBits = 4;
+			std::uint8_t PipelineBits = 12;
+			std::uint8_t MaterialBits = 20;
+			std::uint8_t DepthBits = 24;
+			bool BackToFront = false;	// transparent passes want the far draws first
+
+			bool IsValid() const { return PassBits + LayerBits + PipelineBits + MaterialBits + DepthBits <= 64 && DepthBits <= 32; }
+		};
+
+		struct SortKeyFields
+		{
+			std::uint32_t Pass;
+			std::uint32_t Layer;
+			std::uint32_t Pipeline;
+			std::uint32_t Material;
+			float Depth;	// view space distance, negative values clamp to 0
+		};
+
+		std::uint64_t EncodeSortKey(const SortKeyLayout& layout, const SortKeyFields& fields);
+
+		// Buffers RadixSort works in, kept by callers that sort every frame so their capacity is reused //
+
+		struct RadixSortScratch
+		{
+			std::vector<std::uint64_t> Keys;
+			std::vector<std::uint32_t> Values;
+			std::vector<std::uint32_t> Histograms;
+		};
+
+		// Stable LSD radix sort of keys, 8 bits per pass, values follow their keys //
+		/*
+		   Digit passes whose byte is identical for every key are skipped, so unused high
+		   bits cost nothing. Above a few thousand keys the histogram and scatter of each
+		   pass are split across the pool; pass nullptr to stay on the calling thread.
+		   The result may end up in the scratch buffers, which are then swapped with keys
+		   and values; without a scratch the sort allocates its own.
+		*/
+
+		void RadixSort(std::vector<std::uint64_t>& keys, std::vector<std::uint32_t>& values, ThreadPool* pool = &ThreadPool::Global());
+		void RadixSort(std::vector<std::uint64_t>& keys, std::vector<std::uint32_t>& values, RadixSortScratch& scratch, ThreadPool* pool = &ThreadPool::Global());
+
+		// Bind calls a draw sequence costs when only changes are emitted //
+
+		struct StateChangeCounts
+		{
+			std::uint32_t Pipelines = 0;	// SetPipelineState, root signature changes follow the pipeline
+			std::uint32_t Materials = 0;	// descriptor tables / root constants
+			std::uint32_t Meshes = 0;		// vertex and index buffer views
+
+			std::uint32_t Total() const { return Pipelines + Materials + Meshes; }
+		};
+	}
+}
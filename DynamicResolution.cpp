@@ -0,0 +1,77 @@
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		DynamicResolutionController::DynamicResolutionController(const DynamicResolutionSettings& settings)
+		{
+			SetSettings(settings);
+			m_Stats.Scale = m_Settings.MaxScale;
+		}
+
+		void DynamicResolutionController::SetSettings(const DynamicResolutionSettings& settings)
+		{
+			m_Settings = settings;
+			m_Settings.TargetMilliseconds = std::max(settings.TargetMilliseconds, 0.1);
+			m_Settings.MaxScale = std::min(std::max(settings.MaxScale, 0.05f), 2.0f);
+			m_Settings.MinScale = std::min(std::max(settings.MinScale, 0.05f), m_Settings.MaxScale);
+			m_Settings.Headroom = std::min(std::max(settings.Headroom, 0.1f), 1.0f);
+			m_Settings.MaxIncrease = std::max(settings.MaxIncrease, 0.0f);
+			m_Settings.Smoothing = std::min(std::max(settings.Smoothing, 0.0f), 1.0f);
+
+			m_Stats.Scale = Clamp(m_Stats.Scale);
+		}
+
+		float DynamicResolutionController::Clamp(float scale) const
+		{
+			return std::min(std::max(scale, m_Settings.MinScale), m_Settings.MaxScale);
+		}
+
+		float DynamicResolutionController::Update(double gpuMilliseconds, float renderedScale)
+		{
+			if (!(gpuMilliseconds > 0.0) || !(renderedScale > 0.0f))
+			{
+				return m_Stats.Scale;
+			}
+
+			const double cost = gpuMilliseconds / (double(renderedScale) * renderedScale);
+
+			m_Stats.CostMilliseconds = m_Stats.Samples == 0 ? cost : m_Stats.CostMilliseconds + (cost - m_Stats.CostMilliseconds) * m_Settings.Smoothing;
+			m_Stats.GpuMilliseconds = gpuMilliseconds;
+			m_Stats.Samples++;
+
+			const double settle = m_Settings.TargetMilliseconds * m_Settings.Headroom;
+
+			if (gpuMilliseconds > m_Settings.TargetMilliseconds)
+			{
+				// The spike is believed right away, the average would take frames to catch up //
+
+				m_Stats.CostMilliseconds = std::max(m_Stats.CostMilliseconds, cost);
+				m_Stats.OverTarget++;
+
+				const float scale = static_cast<float>(std::sqrt(settle / cost));
+				m_Stats.Scale = Clamp(std::min(scale, m_Stats.Scale));
+			}
+			else
+			{
+				const float scale = static_cast<float>(std::sqrt(settle / m_Stats.CostMilliseconds));
+				if (scale > m_Stats.Scale)
+				{
+					m_Stats.Scale = Clamp(std::min(scale, m_Stats.Scale + m_Settings.MaxIncrease));
+				}
+			}
+
+			return m_Stats.Scale;
+		}
+
+		std::uint32_t ScaleExtent(std::uint32_t extent, float scale)
+		{
+			const double scaled = std::floor(double(extent) * scale + 0.5);
+			return static_cast<std::uint32_t>(std::max(scaled, 1.0));
+		}
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		struct DynamicResolutionSettings
+		{
+			double TargetMilliseconds = 14.0;	// GPU frame time to hold, below the frame interval to leave room for present
+			float MinScale = 0.5f;				// per axis, of the output size
+			float MaxScale = 1.0f;				// up to 2, above 1 supersamples
+			float Headroom = 0.9f;				// scales up only while the frame would stay under Headroom * target
+			float MaxIncrease = 0.02f;			// per frame, the scale drops as far as it needs to at once
+			float Smoothing = 0.1f;				// weight of a new sample in the cost estimate
+		};
+
+		struct DynamicResolutionStats
+		{
+			float Scale = 1.0f;
+			double GpuMilliseconds = 0.0;		// latest sample
+			double CostMilliseconds = 0.0;		// estimated GPU time at scale 1
+			std::uint64_t Samples = 0;
+			std::uint64_t OverTarget = 0;		// samples over the target, each one lowered the scale
+		};
+
+		// Picks the render scale from measured GPU frame times //
+		/*
+		   GPU time is taken to grow with the pixel count, the square of the scale, so each
+		   sample is normalized by the scale its frame was rendered at. Timestamps arrive
+		   frames after the scale they measured was chosen; normalizing makes those late
+		   samples agree with the current scale instead of overcorrecting it. A frame over
+		   the target lowers the scale at once from that frame's cost alone. Frames under
+		   it raise the scale by at most MaxIncrease per frame toward Headroom * target,
+		   following the smoothed cost, so a load spike costs a frame or two of detail and
+		   a quiet frame does not start an oscillation. Between Headroom * target and
+		   the target the scale holds.
+		*/
+
+		class DynamicResolutionController
+		{
+		public:
+
+			explicit DynamicResolutionController(const DynamicResolutionSettings& settings = DynamicResolutionSettings());
+
+			// gpuMilliseconds was measured on a frame rendered at renderedScale, returns the scale for the next frame //
+
+			float Update(double gpuMilliseconds, float renderedScale);
+
+			// Keeps the current scale within the new bounds //
+
+			void SetSettings(const DynamicResolutionSettings& settings);
+
+			// Getters //
+
+			float Scale() const { return m_Stats.Scale; }
+			const DynamicResolutionSettings& Settings() const { return m_Settings; }
+			const DynamicResolutionStats& Stats() const { return m_Stats; }
+
+		private:
+
+			float Clamp(float scale) const;
+
+		private:
+
+			DynamicResolutionSettings m_Settings;
+			DynamicResolutionStats m_Stats;
+		};
+
+		// extent * scale rounded to whole pixels, never 0 //
+
+		std::uint32_t ScaleExtent(std::uint32_t extent, float scale);
+	}
+}
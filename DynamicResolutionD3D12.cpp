@@ -0,0 +1,328 @@
+#include "DynamicResolutionD3D12.h"
+#include "RenderStats.h"
+#include "CommandTraceD3D12.h"
+
+#include <cmath>
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		namespace
+		{
+			enum UpscaleRootParameter : UINT
+			{
+				UpscaleConstantsParameter,
+				SceneParameter,
+				UpscaleParameterCount
+			};
+
+			struct UpscaleConstants
+			{
+				float UvScale[2];
+				float UvMax[2];
+			};
+
+			// The scene covers the top left of the target, sampling stops half a texel inside its edge //
+
+			const char g_UpscaleShaderSource[] = R"(
+cbuffer UpscaleConstants : register(b0)
+{
+	float2 UvScale;
+	float2 UvMax;
+};
+
+Texture2D Scene : register(t0);
+SamplerState Linear : register(s0);
+
+struct VertexOutput
+{
+	float4 Position : SV_Position;
+	float2 Uv : TEXCOORD0;
+};
+
+VertexOutput UpscaleVS(uint vertex : SV_VertexID)
+{
+	float2 corner = float2((vertex << 1) & 2, vertex & 2);
+
+	VertexOutput output;
+	output.Position = float4(corner.x * 2.0f - 1.0f, 1.0f - corner.y * 2.0f, 0.0f, 1.0f);
+	output.Uv = corner * UvScale;
+	return output;
+}
+
+float4 UpscalePS(VertexOutput input) : SV_Target
+{
+	return Scene.SampleLevel(Linear, min(input.Uv, UvMax), 0.0f);
+}
+)";
+
+			ComPtr<ID3DBlob> CompileUpscaleShader(const char* entryPoint, const char* target)
+			{
+				UINT flags = D3DCOMPILE_OPTIMIZATION_LEVEL3;
+				#if defined(_DEBUG)
+				flags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+				#endif
+
+				ComPtr<ID3DBlob> shader;
+				ComPtr<ID3DBlob> error;
+				HRESULT hr = D3DCompile(g_UpscaleShaderSource, sizeof(g_UpscaleShaderSource) - 1, "DynamicResolution", nullptr, nullptr,
+					entryPoint, target, flags, 0, &shader, &error);
+
+				if (FAILED(hr) && error)
+				{
+					OutputDebugStringA(static_cast<const char*>(error->GetBufferPointer()));
+				}
+				ThrowIfFailed(hr);
+
+				return shader;
+			}
+
+			std::uint32_t AllocatedExtent(std::uint32_t extent, float maxScale)
+			{
+				return static_cast<std::uint32_t>(std::max(std::ceil(double(extent) * maxScale), 1.0));
+			}
+		}
+
+		DynamicResolutionD3D12::DynamicResolutionD3D12(ComPtr<ID3D12Device2> device, ComPtr<ID3D12CommandQueue> queue, BindlessHeapD3D12& bindless,
+			std::uint32_t framesInFlight, DXGI_FORMAT format, const DynamicResolutionSettings& settings)
+			: m_Device(device)
+			, m_Queue(queue)
+			, m_Bindless(bindless)
+			, m_Format(format)
+			, m_Controller(settings)
+		{
+			CreatePipeline(format);
+
+			D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc = {};
+			rtvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
+			rtvHeapDesc.NumDescriptors = 1;
+			ThrowIfFailed(m_Device->CreateDescriptorHeap(&rtvHeapDesc, IID_PPV_ARGS(&m_RtvHeap)));
+
+			m_Frames.resize(std::max(framesInFlight, 1u));
+
+			D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
+			queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+			queryHeapDesc.Count = static_cast<UINT>(m_Frames.size()) * 2;
+			ThrowIfFailed(m_Device->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&m_QueryHeap)));
+
+			CD3DX12_HEAP_PROPERTIES heapProperties(D3D12_HEAP_TYPE_READBACK);
+			CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(sizeof(UINT64) * queryHeapDesc.Count);
+			ThrowIfFailed(m_Device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+				D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&m_Readback)));
+		}
+
+		void DynamicResolutionD3D12::CreatePipeline(DXGI_FORMAT format)
+		{
+			CD3DX12_DESCRIPTOR_RANGE1 sceneRange;
+			sceneRange.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0);
+
+			CD3DX12_ROOT_PARAMETER1 parameters[UpscaleParameterCount];
+			parameters[UpscaleConstantsParameter].InitAsConstants(sizeof(UpscaleConstants) / sizeof(std::uint32_t), 0);
+			parameters[SceneParameter].InitAsDescriptorTable(1, &sceneRange, D3D12_SHADER_VISIBILITY_PIXEL);
+
+			CD3DX12_STATIC_SAMPLER_DESC sampler(0, D3D12_FILTER_MIN_MAG_MIP_LINEAR,
+				D3D12_TEXTURE_ADDRESS_MODE_CLAMP, D3D12_TEXTURE_ADDRESS_MODE_CLAMP, D3D12_TEXTURE_ADDRESS_MODE_CLAMP);
+			sampler.ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+
+			CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC desc;
+			desc.Init_1_1(_countof(parameters), parameters, 1, &sampler, D3D12_ROOT_SIGNATURE_FLAG_NONE);
+
+			ComPtr<ID3DBlob> signature;
+			ComPtr<ID3DBlob> error;
+			ThrowIfFailed(D3DX12SerializeVersionedRootSignature(&desc, D3D_ROOT_SIGNATURE_VERSION_1_1, &signature, &error));
+			ThrowIfFailed(m_Device->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&m_RootSignature)));
+
+			ComPtr<ID3DBlob> vertexShader = CompileUpscaleShader("UpscaleVS", "vs_5_1");
+			ComPtr<ID3DBlob> pixelShader = CompileUpscaleShader("UpscalePS", "ps_5_1");
+
+			CD3DX12_RASTERIZER_DESC rasterizerDesc(D3D12_DEFAULT);
+			rasterizerDesc.CullMode = D3D12_CULL_MODE_NONE;
+
+			CD3DX12_DEPTH_STENCIL_DESC depthStencilDesc(D3D12_DEFAULT);
+			depthStencilDesc.DepthEnable = FALSE;
+
+			D3D12_GRAPHICS_PIPELINE_STATE_DESC pipelineDesc = {};
+			pipelineDesc.pRootSignature = m_RootSignature.Get();
+			pipelineDesc.VS = CD3DX12_SHADER_BYTECODE(vertexShader.Get());
+			pipelineDesc.PS = CD3DX12_SHADER_BYTECODE(pixelShader.Get());
+			pipelineDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
+			pipelineDesc.SampleMask = UINT_MAX;
+			pipelineDesc.RasterizerState = rasterizerDesc;
+			pipelineDesc.DepthStencilState = depthStencilDesc;
+			pipelineDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+			pipelineDesc.NumRenderTargets = 1;
+			pipelineDesc.RTVFormats[0] = format;
+			pipelineDesc.SampleDesc.Count = 1;
+
+			ThrowIfFailed(m_Device->CreateGraphicsPipelineState(&pipelineDesc, IID_PPV_ARGS(&m_PipelineState)));
+		}
+
+		void DynamicResolutionD3D12::Resize(std::uint32_t width, std::uint32_t height, std::uint64_t fenceValue)
+		{
+			width = std::max(width, 1u);
+			height = std::max(height, 1u);
+
+			// A larger MaxScale set since the last call needs a larger target as well //
+
+			const float maxScale = m_Controller.Settings().MaxScale;
+			const std::uint32_t targetWidth = AllocatedExtent(width, maxScale);
+			const std::uint32_t targetHeight = AllocatedExtent(height, maxScale);
+
+			m_Width = width;
+			m_Height = height;
+
+			if (m_Target.Resource && targetWidth == m_TargetWidth && targetHeight == m_TargetHeight)
+			{
+				return;
+			}
+
+			if (m_Target.Resource)
+			{
+				m_Bindless.Free(m_Target.View, fenceValue);
+				m_Retired.Push(std::move(m_Target.Resource), fenceValue);
+			}
+
+			const CD3DX12_HEAP_PROPERTIES heapProperties(D3D12_HEAP_TYPE_DEFAULT);
+			const CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Tex2D(m_Format, targetWidth, targetHeight, 1, 1, 1, 0,
+				D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+
+			D3D12_CLEAR_VALUE clearValue = {};
+			clearValue.Format = m_Format;
+			clearValue.Color[0] = 0.4f;
+			clearValue.Color[1] = 0.6f;
+			clearValue.Color[2] = 0.9f;
+			clearValue.Color[3] = 1.0f;
+
+			ThrowIfFailed(m_Device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &desc,
+				D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, &clearValue, IID_PPV_ARGS(&m_Target.Resource)));
+
+			m_Target.View = m_Bindless.CreateShaderResourceView(m_Target.Resource.Get(), nullptr);
+
+			// Render target views are read when recorded, the old frames are not affected //
+
+			m_Device->CreateRenderTargetView(m_Target.Resource.Get(), nullptr, m_RtvHeap->GetCPUDescriptorHandleForHeapStart());
+
+			m_TargetWidth = targetWidth;
+			m_TargetHeight = targetHeight;
+		}
+
+		void DynamicResolutionD3D12::Retire(std::uint64_t completedFenceValue)
+		{
+			m_Retired.Retire(completedFenceValue);
+		}
+
+		void DynamicResolutionD3D12::ReadTiming(std::uint32_t frameIndex)
+		{
+			FrameQueries& frame = m_Frames[frameIndex];
+			frame.Pending = false;
+
+			UINT64* ticks = nullptr;
+			CD3DX12_RANGE readRange(sizeof(UINT64) * frameIndex * 2, sizeof(UINT64) * (frameIndex * 2 + 2));
+			ThrowIfFailed(m_Readback->Map(0, &readRange, reinterpret_cast<void**>(&ticks)));
+
+			const UINT64 begin = ticks[frameIndex * 2];
+			const UINT64 end = ticks[frameIndex * 2 + 1];
+
+			CD3DX12_RANGE writeRange(0, 0);
+			m_Readback->Unmap(0, &writeRange);
+
+			UINT64 frequency = 0;
+			ThrowIfFailed(m_Queue->GetTimestampFrequency(&frequency));
+
+			if (end > begin && frequency != 0)
+			{
+				m_Controller.Update(static_cast<double>(end - begin) * 1000.0 / static_cast<double>(frequency), frame.Scale);
+			}
+		}
+
+		void DynamicResolutionD3D12::BeginScene(ID3D12GraphicsCommandList* commandList, std::uint32_t frameIndex)
+		{
+			assert(frameIndex < m_Frames.size() && "Frame index out of range.");
+			assert(m_Target.Resource && "Resize() must be called before the first frame.");
+
+			// The previous use of this slot has retired, its timestamps are ready //
+
+			if (m_Frames[frameIndex].Pending)
+			{
+				ReadTiming(frameIndex);
+			}
+
+			FrameQueries& frame = m_Frames[frameIndex];
+			frame.Scale = m_Controller.Scale();
+
+			m_SceneWidth = std::min(ScaleExtent(m_Width, frame.Scale), m_TargetWidth);
+			m_SceneHeight = std::min(ScaleExtent(m_Height, frame.Scale), m_TargetHeight);
+
+			commandList->EndQuery(m_QueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, frameIndex * 2);
+
+			CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(m_Target.Resource.Get(),
+				D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_RENDER_TARGET);
+			commandList->ResourceBarrier(1, &barrier);
+			CommandCaptureD3D12::Barriers(commandList, 1, &barrier);
+			RenderStats::Count(RenderCounter::Barriers);
+
+			// Only the part this frame renders to is cleared //
+
+			const FLOAT clearColor[] = { 0.4f, 0.6f, 0.9f, 1.0f };
+			const D3D12_CPU_DESCRIPTOR_HANDLE rtv = m_RtvHeap->GetCPUDescriptorHandleForHeapStart();
+			const D3D12_RECT sceneRect = { 0, 0, static_cast<LONG>(m_SceneWidth), static_cast<LONG>(m_SceneHeight) };
+			commandList->ClearRenderTargetView(rtv, clearColor, 1, &sceneRect);
+
+			ResumeScene(commandList);
+		}
+
+		void DynamicResolutionD3D12::ResumeScene(ID3D12GraphicsCommandList* commandList)
+		{
+			const D3D12_CPU_DESCRIPTOR_HANDLE rtv = m_RtvHeap->GetCPUDescriptorHandleForHeapStart();
+			const D3D12_RECT sceneRect = { 0, 0, static_cast<LONG>(m_SceneWidth), static_cast<LONG>(m_SceneHeight) };
+
+			CD3DX12_VIEWPORT viewport(0.0f, 0.0f, static_cast<float>(m_SceneWidth), static_cast<float>(m_SceneHeight));
+			commandList->RSSetViewports(1, &viewport);
+			commandList->RSSetScissorRects(1, &sceneRect);
+			commandList->OMSetRenderTargets(1, &rtv, FALSE, nullptr);
+		}
+
+		void DynamicResolutionD3D12::Upscale(ID3D12GraphicsCommandList* commandList, std::uint32_t frameIndex, D3D12_CPU_DESCRIPTOR_HANDLE output)
+		{
+			CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(m_Target.Resource.Get(),
+				D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+			commandList->ResourceBarrier(1, &barrier);
+			CommandCaptureD3D12::Barriers(commandList, 1, &barrier);
+			RenderStats::Count(RenderCounter::Barriers);
+
+			UpscaleConstants constants;
+			constants.UvScale[0] = static_cast<float>(m_SceneWidth) / static_cast<float>(m_TargetWidth);
+			constants.UvScale[1] = static_cast<float>(m_SceneHeight) / static_cast<float>(m_TargetHeight);
+			constants.UvMax[0] = (static_cast<float>(m_SceneWidth) - 0.5f) / static_cast<float>(m_TargetWidth);
+			constants.UvMax[1] = (static_cast<float>(m_SceneHeight) - 0.5f) / static_cast<float>(m_TargetHeight);
+
+			CD3DX12_VIEWPORT viewport(0.0f, 0.0f, static_cast<float>(m_Width), static_cast<float>(m_Height));
+			CD3DX12_RECT scissorRect(0, 0, LONG_MAX, LONG_MAX);
+			commandList->RSSetViewports(1, &viewport);
+			commandList->RSSetScissorRects(1, &scissorRect);
+			commandList->OMSetRenderTargets(1, &output, FALSE, nullptr);
+
+			commandList->SetGraphicsRootSignature(m_RootSignature.Get());
+			commandList->SetPipelineState(m_PipelineState.Get());
+			CommandCaptureD3D12::SetPipeline(commandList, m_PipelineState.Get());
+			commandList->SetGraphicsRoot32BitConstants(UpscaleConstantsParameter, sizeof(constants) / sizeof(std::uint32_t), &constants, 0);
+			commandList->SetGraphicsRootDescriptorTable(SceneParameter, m_Bindless.GpuDescriptor(m_Target.View));
+			commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+			commandList->DrawInstanced(3, 1, 0, 0);
+			CommandCaptureD3D12::Draw(commandList, 3, 1, false);
+
+			RenderStats::Count(RenderCounter::Draws);
+			RenderStats::Count(RenderCounter::Triangles);
+			RenderStats::Count(RenderCounter::PipelineChanges);
+
+			// The upscale is part of the measured frame, it costs the same at every scale //
+
+			commandList->EndQuery(m_QueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, frameIndex * 2 + 1);
+			commandList->ResolveQueryData(m_QueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, frameIndex * 2, 2,
+				m_Readback.Get(), sizeof(UINT64) * frameIndex * 2);
+
+			m_Frames[frameIndex].Pending = true;
+		}
+	}
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Header.h"
+#include "HelperFile.h"
+#include "BindlessHeapD3D12.h"
+#include "DeferredRelease.h"
+#include "DynamicResolution.h"
+
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// Renders the scene into a scaled internal target and upscales it to the back buffer //
+		/*
+		   The internal target is allocated once per output size at the largest scale and
+		   each frame renders into its top left corner, so changing the scale costs
+		   nothing. BeginScene() and Upscale() bracket the frame with timestamp queries;
+		   once a frame slot comes around again its GPU time goes to the controller along
+		   with the scale it was rendered at. The upscale is a bilinear fullscreen
+		   triangle reading the target through the bindless heap, shaders are built with
+		   D3DCompile at startup.
+		*/
+
+		class DynamicResolutionD3D12
+		{
+		public:
+
+			DynamicResolutionD3D12(ComPtr<ID3D12Device2> device, ComPtr<ID3D12CommandQueue> queue, BindlessHeapD3D12& bindless,
+				std::uint32_t framesInFlight, DXGI_FORMAT format, const DynamicResolutionSettings& settings = DynamicResolutionSettings());
+
+			// Reallocates the internal target for a new output size, the old one is kept until fenceValue completes //
+
+			void Resize(std::uint32_t width, std::uint32_t height, std::uint64_t fenceValue);
+			void Retire(std::uint64_t completedFenceValue);
+
+			// Binds and clears the internal target at this frame's scale, viewport and scissor included //
+			/*
+			   The frame slot must not be in use by the GPU anymore, EngineCore guarantees it
+			   by waiting on m_FrameFenceValues before recording.
+			*/
+
+			void BeginScene(ID3D12GraphicsCommandList* commandList, std::uint32_t frameIndex);
+
+			// Binds the internal target again on a later command list of the same frame //
+
+			void ResumeScene(ID3D12GraphicsCommandList* commandList);
+
+			// Draws the scene over the whole of the bound output, left bound with a full viewport //
+			/*
+			   The root signature and the pipeline are left bound, callers drawing afterwards
+			   must set their own. The bindless heaps must be set on the command list.
+			*/
+
+			void Upscale(ID3D12GraphicsCommandList* commandList, std::uint32_t frameIndex, D3D12_CPU_DESCRIPTOR_HANDLE output);
+
+			// Getters //
+
+			DynamicResolutionController& Controller() { return m_Controller; }
+			std::uint32_t SceneWidth() const { return ScaleExtent(m_Width, m_Controller.Scale()); }
+			std::uint32_t SceneHeight() const { return ScaleExtent(m_Height, m_Controller.Scale()); }
+
+		private:
+
+			struct FrameQueries
+			{
+				float Scale = 1.0f;
+				bool Pending = false;
+			};
+
+			struct Target
+			{
+				ComPtr<ID3D12Resource> Resource;
+				BindlessHandle View;
+			};
+
+			void CreatePipeline(DXGI_FORMAT format);
+			void ReadTiming(std::uint32_t frameIndex);
+
+		private:
+
+			ComPtr<ID3D12Device2> m_Device;
+			ComPtr<ID3D12CommandQueue> m_Queue;
+			BindlessHeapD3D12& m_Bindless;
+			DXGI_FORMAT m_Format;
+
+			DynamicResolutionController m_Controller;
+
+			ComPtr<ID3D12RootSignature> m_RootSignature;
+			ComPtr<ID3D12PipelineState> m_PipelineState;
+
+			// Scene target, in the pixel shader resource state between frames //
+
+			Target m_Target;
+			std::uint32_t m_Width = 0;			// output size
+			std::uint32_t m_Height = 0;
+			std::uint32_t m_TargetWidth = 0;	// allocated size, the output at the largest scale
+			std::uint32_t m_TargetHeight = 0;
+			DeferredReleaseQueue<ComPtr<ID3D12Resource>> m_Retired;
+
+			ComPtr<ID3D12DescriptorHeap> m_RtvHeap;
+
+			// Two timestamps per frame slot //
+
+			ComPtr<ID3D12QueryHeap> m_QueryHeap;
+			ComPtr<ID3D12Resource> m_Readback;
+			std::vector<FrameQueries> m_Frames;
+			std::uint32_t m_SceneWidth = 0;		// of the frame being recorded
+			std::uint32_t m_SceneHeight = 0;
+		};
+	}
+}
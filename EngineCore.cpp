@@ -1,642 +1,1066 @@
-#include "EngineCore.h"
-
-namespace PowerEngine
-{
-	namespace Core
-	{
-		EngineCore::EngineCore()
-		{
-			ComPtr<IDXGIAdapter4> dxgiAdapter4 = GetAdapter(g_UseWarp);
-
-			m_Device = CreateDevice(dxgiAdapter4);
-			m_CommandQueue = CreateCommandQueue(m_Device, D3D12_COMMAND_LIST_TYPE_DIRECT);
-			m_SwapChain = CreateSwapChain(g_WindowHandle, m_CommandQueue, g_ClientWidth, g_ClientHeight, g_NumFrames);
-			m_CurrentBackBufferIndex = m_SwapChain->GetCurrentBackBufferIndex();
-			m_RTVDescriptorHeap = CreateDescriptor(m_Device, D3D12_DESCRIPTOR_HEAP_TYPE_RTV, g_NumFrames);
-			m_RTVDescriptorSize = m_Device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
-
-			for (int i = 0; i < g_NumFrames; ++i)
-			{
-				m_CommandAllocators[i] = CreateCommandAllocator(m_Device, D3D12_COMMAND_LIST_TYPE_DIRECT);
-			}
-
-			m_CommandList = CreateCommandList(m_Device, m_CommandAllocators[m_CurrentBackBufferIndex], D3D12_COMMAND_LIST_TYPE_DIRECT);
-			m_Fence = CreateFence(m_Device);
-			m_FenceEvent = CreateEventHandle();
-
-		}
-		EngineCore::~EngineCore()
-		{
-
-		}
-		void EngineCore::update()
-		{
-			static std::uint64_t frameCounter = 0;
-			static double elapsedSeconds = 0.0;
-			static std::chrono::high_resolution_clock clock;
-			static auto t0 = clock.now();
-
-			frameCounter++;
-			auto t1 = clock.now();
-			auto deltaTime = t1 - t0;
-			t0 = t1;
-
-			elapsedSeconds += deltaTime.count() * 1e-9; // convert the deltaTime from nanoseconds into seconds
-			if (elapsedSeconds > 1.0)
-			{
-				char buffer[500];
-				auto fps = frameCounter / elapsedSeconds;
-				sprintf_s(buffer, 500, "FPS: %f\n", fps);
-				OutputDebugString(buffer);
-
-				frameCounter = 0;
-				elapsedSeconds = 0.0;
-			}
-		}
-		void EngineCore::render()
-		{
-			// Retrieve the current pointers of the command allocator and back buffer resource according to the current back buffer index. //
-
-			auto commandAllocator = m_CommandAllocators[m_CurrentBackBufferIndex];
-			auto backBuffer = m_BackBuffers[m_CurrentBackBufferIndex];
-
-			// Preaparing the command allocator and the command list for the next frame. //
-
-			commandAllocator->Reset();
-			m_CommandList->Reset(commandAllocator.Get(), nullptr);
-
-			// Clear the render target. //
-			{
-				/* 
-				   To build correctly the transition barrier, 
-				   the before and next state must be known before hand.
-				   That's why it's hard coded here.
-				*/
-				CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(backBuffer.Get(), 
-					D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
-
-				m_CommandList->ResourceBarrier(1, &barrier);
-
-				FLOAT clearColor[] = { 0.4f, 0.6f, 0.9f, 1.0f };
-				CD3DX12_CPU_DESCRIPTOR_HANDLE rtv(m_RTVDescriptorHeap->GetCPUDescriptorHandleForHeapStart(),
-					m_CurrentBackBufferIndex, m_RTVDescriptorSize);
-
-				m_CommandList->ClearRenderTargetView(rtv, clearColor, 0, nullptr);
-
-				 
-				
-				// Before presenting, the back buffer resource must be transitioned to the present state //
-
-				
-				CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-						backBuffer.Get(),
-						D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
-				m_CommandList->ResourceBarrier(1, &barrier);
-				
-				ThrowIfFailed(m_CommandList->Close());
-
-				ID3D12CommandList* const commandLists[] = {m_CommandList.Get()};
-				m_CommandQueue->ExecuteCommandLists(_countof(commandLists), commandLists);
-
-				UINT syncInterval = g_VSync ? 1 : 0;
-				UINT presentFlags = g_TearingSupported && !g_VSync ? DXGI_PRESENT_ALLOW_TEARING : 0;
-				ThrowIfFailed(m_SwapChain->Present(syncInterval, presentFlags));
-
-				m_FrameFenceValues[m_CurrentBackBufferIndex] = Signal(m_CommandQueue, m_Fence, m_FenceValue);
-
-				m_CurrentBackBufferIndex = m_SwapChain->GetCurrentBackBufferIndex();
-
-				WaitFenceValue(m_Fence, m_FrameFenceValues[m_CurrentBackBufferIndex], m_FenceEvent);
-			
-			}
-
-		}
-		void EngineCore::CommandLineParsing()
-		{
-			int argc;
-			wchar_t** argv = ::CommandLineToArgvW(::GetCommandLineW(), &argc);
-
-			for (size_t i = 0; i < argc; i++)
-			{
-				if (::wcscmp(argv[i], L"-w") == 0 || ::wcscmp(argv[i], L"--width") == 0)
-				{
-					g_ClientWidth = ::wcstol(argv[++i], nullptr, 10);
-				}
-				if (::wcscmp(argv[i], L"-h") == 0 || ::wcscmp(argv[i], L"--height") == 0)
-				{
-					g_ClientHeight = ::wcstol(argv[++i], nullptr, 10);
-				}
-				if (::wcscmp(argv[i], L"-warp") == 0 || ::wcscmp(argv[i], L"--warp") == 0)
-				{
-					g_UseWarp = true;
-				}
-			}
-		}
-
-		void EngineCore::Enable_DebugD3D12_Layer()
-		{
-			#if defined(_DEBUG)
-			ComPtr<ID3D12Debug> debugInterface;
-			ThrowIfFailed(D3D12GetDebugInterface(IID_PPV_ARGS(&debugInterface)));
-			debugInterface->EnableDebugLayer();
-			#endif
-		}
-
-		HANDLE EngineCore::CreateEventHandle()
-		{
-			HANDLE fenceEvent;
-
-			fenceEvent = ::CreateEvent(NULL, FALSE, FALSE, NULL);
-			assert(fenceEvent && "Failed to create fence event.");
-
-			return fenceEvent;
-		}
-
-		void EngineCore::ResizeWindow(std::uint32_t width, std::uint32_t height)
-		{
-			if (g_ClientWidth != width || g_ClientHeight != height)
-			{
-				// Don't allow 0 size swap chain back buffers.
-
-				g_ClientWidth = std::max(1u, width);
-				g_ClientHeight = std::max(1u, height);
-
-				// Flush the GPU queue to make sure the swap chain's back buffers
-				// are not being referenced by an in-flight command list.
-
-				flush(m_CommandQueue, m_Fence, m_FenceValue, m_FenceEvent);
-
-				for (int i = 0; i < g_NumFrames; ++i)
-				{
-					// Any references to the back buffers must be released
-					// before the swap chain can be resized.
-
-					m_BackBuffers[i].Reset();
-					m_FrameFenceValues[i] = m_FrameFenceValues[m_CurrentBackBufferIndex];
-				}
-
-				DXGI_SWAP_CHAIN_DESC swapChainDesc = {};
-				ThrowIfFailed(m_SwapChain->GetDesc(&swapChainDesc));
-				ThrowIfFailed(m_SwapChain->ResizeBuffers(g_NumFrames, g_ClientWidth, g_ClientHeight,
-					swapChainDesc.BufferDesc.Format, swapChainDesc.Flags));
-
-				m_CurrentBackBufferIndex = m_SwapChain->GetCurrentBackBufferIndex();
-
-				UpdateRenderTargetViews(m_Device, m_SwapChain, m_RTVDescriptorHeap);
-			}
-		}
-
-		std::uint64_t EngineCore::Signal(ComPtr<ID3D12CommandQueue> commandQueue, ComPtr<ID3D12Fence> fence, std::uint64_t& fenceValue)
-		{
-			std::uint64_t fenceValueForSignal = ++fenceValue;
-			ThrowIfFailed(commandQueue->Signal(fence.Get(), fenceValueForSignal));
-
-			return fenceValueForSignal;
-		}
-
-		void EngineCore::WaitFenceValue(ComPtr<ID3D12Fence> fence, std::uint64_t fenceValue, HANDLE fenceEvent, std::chrono::milliseconds duration)
-		{
-			if (fence->GetCompletedValue() < fenceValue)
-			{
-				ThrowIfFailed(fence->SetEventOnCompletion(fenceValue, fenceEvent));
-				::WaitForSingleObject(fenceEvent, static_cast<DWORD>(duration.count()));
-			}
-		}
-
-		void EngineCore::flush(ComPtr<ID3D12CommandQueue> commandQueue, ComPtr<ID3D12Fence> fence, std::uint64_t& fenceValue, HANDLE fenceEvent)
-		{
-			uint64_t fenceValueForSignal = Signal(commandQueue, fence, fenceValue);
-			WaitFenceValue(fence, fenceValueForSignal, fenceEvent);
-		}
-
-		ComPtr<IDXGIAdapter4> EngineCore::GetAdapter(bool useWarp)
-		{
-			ComPtr<IDXGIFactory4> dxgiFactory;
-			UINT createFactoryFlags = 0;
-			#if defined(_DEBUG)
-			createFactoryFlags = DXGI_CREATE_FACTORY_DEBUG;
-			#endif
-
-			ThrowIfFailed(CreateDXGIFactory2(createFactoryFlags, IID_PPV_ARGS(&dxgiFactory)));
-
-			ComPtr<IDXGIAdapter1> dxgiAdapter1;
-			ComPtr<IDXGIAdapter4> dxgiAdapter4;
-
-			if (useWarp)
-			{
-				ThrowIfFailed(dxgiFactory->EnumWarpAdapter(IID_PPV_ARGS(&dxgiAdapter1)));
-				ThrowIfFailed(dxgiAdapter1.As(&dxgiAdapter4));
-			}
-			else
-			{
-				SIZE_T maxDedicatedVideoMemory = 0;
-				for (UINT i = 0; dxgiFactory->EnumAdapters1(i, &dxgiAdapter1) != DXGI_ERROR_NOT_FOUND; ++i)
-				{
-					DXGI_ADAPTER_DESC1 dxgiAdapterDesc1;
-					dxgiAdapter1->GetDesc1(&dxgiAdapterDesc1);
-
-					// Check to see if the adapter can create a D3D12 device without actually 
-					// creating it. The adapter with the largest dedicated video memory
-					// is favored.
-					if ((dxgiAdapterDesc1.Flags & DXGI_ADAPTER_FLAG_SOFTWARE) == 0 &&
-						SUCCEEDED(D3D12CreateDevice(dxgiAdapter1.Get(),
-							D3D_FEATURE_LEVEL_11_0, __uuidof(ID3D12Device), nullptr)) &&
-						dxgiAdapterDesc1.DedicatedVideoMemory > maxDedicatedVideoMemory)
-					{
-						maxDedicatedVideoMemory = dxgiAdapterDesc1.DedicatedVideoMemory;
-						ThrowIfFailed(dxgiAdapter1.As(&dxgiAdapter4));
-					}
-				}
-			}
-		}
-
-		ComPtr<ID3D12Device2> EngineCore::CreateDevice(ComPtr<IDXGIAdapter4> adapter)
-		{
-			ComPtr<ID3D12Device2> d3d12Device2;
-			ThrowIfFailed(D3D12CreateDevice(adapter.Get(), D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&d3d12Device2)));
-
-			#if defined(_DEBUG)
-			ComPtr<ID3D12InfoQueue> pInfoQueue;
-			if (SUCCEEDED(d3d12Device2.As(&pInfoQueue)))
-			{
-				pInfoQueue->SetBreakOnSeverity(D3D12_MESSAGE_SEVERITY_CORRUPTION, TRUE);
-				pInfoQueue->SetBreakOnSeverity(D3D12_MESSAGE_SEVERITY_ERROR, TRUE);
-				pInfoQueue->SetBreakOnSeverity(D3D12_MESSAGE_SEVERITY_WARNING, TRUE);
-
-				// Suppress messages based on their severity level
-				D3D12_MESSAGE_SEVERITY Severities[] =
-				{
-					D3D12_MESSAGE_SEVERITY_INFO
-				};
-
-				// Suppress individual messages by their ID
-				D3D12_MESSAGE_ID DenyIds[] = {
-					D3D12_MESSAGE_ID_CLEARRENDERTARGETVIEW_MISMATCHINGCLEARVALUE,   
-					D3D12_MESSAGE_ID_MAP_INVALID_NULLRANGE,                        
-					D3D12_MESSAGE_ID_UNMAP_INVALID_NULLRANGE,                       
-				};
-
-				D3D12_INFO_QUEUE_FILTER NewFilter = {};
-				//NewFilter.DenyList.NumCategories = _countof(Categories);
-				//NewFilter.DenyList.pCategoryList = Categories;
-				NewFilter.DenyList.NumSeverities = _countof(Severities);
-				NewFilter.DenyList.pSeverityList = Severities;
-				NewFilter.DenyList.NumIDs = _countof(DenyIds);
-				NewFilter.DenyList.pIDList = DenyIds;
-
-				ThrowIfFailed(pInfoQueue->PushStorageFilter(&NewFilter));
-			}
-			#endif
-
-			return d3d12Device2;
-		}
-
-		ComPtr<ID3D12CommandQueue> EngineCore::CreateCommandQueue(ComPtr<ID3D12Device2> device, D3D12_COMMAND_LIST_TYPE type)
-		{
-			ComPtr<ID3D12CommandQueue> d3d12CommandQueue;
-
-			D3D12_COMMAND_QUEUE_DESC desc = {};
-			desc.Type = type;
-			desc.Priority = D3D12_COMMAND_QUEUE_PRIORITY_NORMAL;
-			desc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
-			desc.NodeMask = 0;
-
-			ThrowIfFailed(device->CreateCommandQueue(&desc, IID_PPV_ARGS(&d3d12CommandQueue)));
-
-			return d3d12CommandQueue;
-		}
-
-		ComPtr<ID3D12CommandAllocator> EngineCore::CreateCommandAllocator(ComPtr<ID3D12Device2> device, D3D12_COMMAND_LIST_TYPE type)
-		{
-			ComPtr<ID3D12CommandAllocator> commandAllocator;
-			ThrowIfFailed(device->CreateCommandAllocator(type, IID_PPV_ARGS(&commandAllocator)));
-
-			return commandAllocator;
-		}
-
-		ComPtr<ID3D12GraphicsCommandList> EngineCore::CreateCommandList(ComPtr<ID3D12Device2> device, ComPtr<ID3D12CommandAllocator> commandAllocator, D3D12_COMMAND_LIST_TYPE type)
-		{
-			ComPtr<ID3D12GraphicsCommandList> commandList;
-			ThrowIfFailed(device->CreateCommandList(0, type, commandAllocator.Get(), nullptr, IID_PPV_ARGS(&commandList)));
-
-			ThrowIfFailed(commandList->Close());
-
-			return commandList;
-		}
-
-		ComPtr<ID3D12Fence> EngineCore::CreateFence(ComPtr<ID3D12Device2> device)
-		{
-			ComPtr<ID3D12Fence> fence;
-
-			ThrowIfFailed(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence)));
-
-			return fence;
-		}
-
-		LRESULT EngineCore::WndProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam)
-		{
-			if (g_IsInitialized)
-			{
-				switch (message)
-				{
-				case WM_PAINT:
-
-					update();
-					render();
-
-					break;
-
-				case WM_SYSKEYDOWN:
-				case WM_KEYDOWN:
-				{
-					bool alt = (::GetAsyncKeyState(VK_MENU) & 0x8000) != 0;
-
-					switch (wParam)
-					{
-					case 'V':
-						g_VSync = !g_VSync;
-						break;
-					case VK_ESCAPE:
-						::PostQuitMessage(0);
-						break;
-					case VK_RETURN:
-						if (alt)
-						{
-					case VK_F11:
-						SetFullScreen(!m_Fullscreen);
-						}
-						break;
-					}
-				}
-				break;
-				// The default window procedure will play a system notification sound 
-				// when pressing the Alt+Enter keyboard combination if this message is 
-				// not handled.
-				case WM_SYSCHAR:
-					break;
-
-				case WM_SIZE:
-				{
-					RECT clientRect = {};
-					::GetClientRect(g_WindowHandle, &clientRect);
-
-					int width = clientRect.right - clientRect.left;
-					int height = clientRect.bottom - clientRect.top;
-
-					ResizeWindow(width, height);
-				}
-				break;
-
-				case WM_DESTROY:
-					::PostQuitMessage(0);
-					break;
-				default:
-					return ::DefWindowProcW(hwnd, message, wParam, lParam);
-				}
-			}
-			else
-			{
-				return ::DefWindowProcW(hwnd, message, wParam, lParam);
-			}
-
-			return 0;
-		}
-
-		void EngineCore::SetFullScreen(bool fullscreen)
-		{
-			if (m_Fullscreen != fullscreen)
-			{
-				m_Fullscreen = fullscreen;
-
-				if (m_Fullscreen) // Switching to fullscreen.
-				{
-					// Store the current window dimensions so they can be restored when switching out of fullscreen state //
-					::GetWindowRect(g_WindowHandle, &g_WindowRect);
-
-					// Set the window style to a borderless window so the client area fills the entire screen //
-					UINT windowStyle = WS_OVERLAPPEDWINDOW & ~(WS_CAPTION | WS_SYSMENU | WS_THICKFRAME | WS_MINIMIZEBOX | WS_MAXIMIZEBOX);
-
-					::SetWindowLongW(g_WindowHandle, GWL_STYLE, windowStyle);
-
-					// Query the name of the nearest display device for the window.
-					// This is required to set the fullscreen dimensions of the window
-					// when using a multi-monitor setup
-
-					HMONITOR hMonitor = ::MonitorFromWindow(g_WindowHandle, MONITOR_DEFAULTTONEAREST);
-					MONITORINFOEX monitorInfo = {};
-					monitorInfo.cbSize = sizeof(MONITORINFOEX);
-					::GetMonitorInfo(hMonitor, &monitorInfo);
-
-					::SetWindowPos(g_WindowHandle, HWND_TOP,
-						monitorInfo.rcMonitor.left,
-						monitorInfo.rcMonitor.top,
-						monitorInfo.rcMonitor.right - monitorInfo.rcMonitor.left,
-						monitorInfo.rcMonitor.bottom - monitorInfo.rcMonitor.top,
-						SWP_FRAMECHANGED | SWP_NOACTIVATE);
-
-					::ShowWindow(g_WindowHandle, SW_MAXIMIZE);
-				}
-				else
-				{
-					// Restore all the window decorators.
-					::SetWindowLong(g_WindowHandle, GWL_STYLE, WS_OVERLAPPEDWINDOW);
-
-					::SetWindowPos(g_WindowHandle, HWND_NOTOPMOST,
-						g_WindowRect.left,
-						g_WindowRect.top,
-						g_WindowRect.right - g_WindowRect.left,
-						g_WindowRect.bottom - g_WindowRect.top,
-						SWP_FRAMECHANGED | SWP_NOACTIVATE);
-
-					::ShowWindow(g_WindowHandle, SW_NORMAL);
-				}
-			}
-		}
-
-		void EngineCore::RegisterWindowClass(HINSTANCE Inst, const wchar_t* windowClassName)
-		{
-			// Register a window class for creating our render window with.
-			WNDCLASSEXW windowClass = {};
-
-			windowClass.cbSize = sizeof(WNDCLASSEX);
-			windowClass.style = CS_HREDRAW | CS_VREDRAW;
-			windowClass.lpfnWndProc = &WndProc;
-			windowClass.cbClsExtra = 0;
-			windowClass.cbWndExtra = 0;
-			windowClass.hInstance = Inst;
-			windowClass.hIcon = ::LoadIcon(Inst, NULL);
-			windowClass.hCursor = ::LoadCursor(NULL, IDC_ARROW);
-			windowClass.hbrBackground = (HBRUSH)(COLOR_WINDOW + 1);
-			windowClass.lpszMenuName = NULL;
-			windowClass.lpszClassName = windowClassName;
-			windowClass.hIconSm = ::LoadIcon(Inst, NULL);
-
-			static ATOM atom = ::RegisterClassExW(&windowClass);
-			assert(atom > 0);
-		}
-
-		HWND EngineCore::CreateWindow(const wchar_t* windowClassName, HINSTANCE hInst, const wchar_t* windowTitle, std::uint16_t width, std::uint16_t height)
-		{
-			int screenWidth = ::GetSystemMetrics(SM_CXSCREEN);
-			int screenHeight = ::GetSystemMetrics(SM_CYSCREEN);
-
-			RECT windowRect = { 0, 0, static_cast<LONG>(width), static_cast<LONG>(height) };
-			::AdjustWindowRect(&windowRect, WS_OVERLAPPEDWINDOW, FALSE);
-
-			int windowWidth = windowRect.right - windowRect.left;
-			int windowHeight = windowRect.bottom - windowRect.top;
-
-			// Center the window within the screen. Clamp to 0, 0 for the top-left corner.
-			int windowX = std::max<int>(0, (screenWidth - windowWidth) / 2);
-			int windowY = std::max<int>(0, (screenHeight - windowHeight) / 2);
-
-			HWND hWnd = ::CreateWindowExW(
-				NULL,
-				windowClassName,
-				windowTitle,
-				WS_OVERLAPPEDWINDOW,
-				windowX,
-				windowY,
-				windowWidth,
-				windowHeight,
-				NULL,
-				NULL,
-				hInst,
-				nullptr
-			);
-
-			assert(hWnd && "Failed to create window");
-
-			return hWnd;
-		}
-
-		ComPtr<IDXGISwapChain4> EngineCore::CreateSwapChain(HWND hWnd, ComPtr<ID3D12CommandQueue> commandQueue, std::uint32_t width, std::uint32_t height, std::uint32_t bufferCount)
-		{
-			ComPtr<IDXGISwapChain4> dxgiSwapChain4;
-			ComPtr<IDXGIFactory4> dxgiFactory4;
-			UINT createFactoryFlags = 0;
-#if defined(_DEBUG)
-			createFactoryFlags = DXGI_CREATE_FACTORY_DEBUG;
-#endif
-
-			ThrowIfFailed(CreateDXGIFactory2(createFactoryFlags, IID_PPV_ARGS(&dxgiFactory4)));
-
-			DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
-			swapChainDesc.Width = width;
-			swapChainDesc.Height = height;
-			swapChainDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-			swapChainDesc.Stereo = FALSE;
-			swapChainDesc.SampleDesc = { 1, 0 };
-			swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-			swapChainDesc.BufferCount = bufferCount;
-			swapChainDesc.Scaling = DXGI_SCALING_STRETCH;
-			swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
-			swapChainDesc.Flags = CheckTearingSupport() ? DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING : 0;
-
-			ComPtr<IDXGISwapChain1> swapChain1;
-			ThrowIfFailed(dxgiFactory4->CreateSwapChainForHwnd(
-				commandQueue.Get(),
-				hWnd,
-				&swapChainDesc,
-				nullptr,
-				nullptr,
-				&swapChain1));
-
-			// Disable the Alt+Enter fullscreen toggle feature. Switching to fullscreen
-			// will be handled manually.
-			ThrowIfFailed(dxgiFactory4->MakeWindowAssociation(hWnd, DXGI_MWA_NO_ALT_ENTER));
-
-			ThrowIfFailed(swapChain1.As(&dxgiSwapChain4));
-
-			return dxgiSwapChain4;
-		}
-
-		ComPtr<ID3D12DescriptorHeap> EngineCore::CreateDescriptor(ComPtr<ID3D12Device2> device, D3D12_DESCRIPTOR_HEAP_TYPE type, std::uint32_t numDescriptors)
-		{
-			ComPtr<ID3D12DescriptorHeap> descriptorHeap;
-
-			D3D12_DESCRIPTOR_HEAP_DESC desc = {};
-			desc.NumDescriptors = numDescriptors;
-			desc.Type = type;
-
-			ThrowIfFailed(device->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&descriptorHeap)));
-
-			return descriptorHeap;
-		}
-
-		void EngineCore::UpdateRenderTargetViews(ComPtr<ID3D12Device2> device, ComPtr<IDXGISwapChain4> swapChain, ComPtr<ID3D12DescriptorHeap> descriptorHeap)
-		{
-			auto rtvDescriptorSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
-
-			CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(descriptorHeap->GetCPUDescriptorHandleForHeapStart());
-
-			for (int i = 0; i < g_NumFrames; ++i)
-			{
-				ComPtr<ID3D12Resource> backBuffer;
-				ThrowIfFailed(swapChain->GetBuffer(i, IID_PPV_ARGS(&backBuffer)));
-
-				device->CreateRenderTargetView(backBuffer.Get(), nullptr, rtvHandle);
-
-				m_BackBuffers[i] = backBuffer;
-
-				rtvHandle.Offset(rtvDescriptorSize);
-			}
-		}
-
-		bool EngineCore::CheckTearingSupport()
-		{
-
-			BOOL allowTearing = FALSE;
-
-			ComPtr<IDXGIFactory4> factory4;
-			if (SUCCEEDED(CreateDXGIFactory1(IID_PPV_ARGS(&factory4))))
-			{
-				ComPtr<IDXGIFactory5> factory5;
-				if (SUCCEEDED(factory4.As(&factory5)))
-				{
-					if (FAILED(factory5->CheckFeatureSupport(
-						DXGI_FEATURE_PRESENT_ALLOW_TEARING,
-						&allowTearing, sizeof(allowTearing))))
-					{
-						allowTearing = FALSE;
-					}
-				}
-			}
-
-			return allowTearing == TRUE;
-
-		}
-
-		ComPtr<ID3D12Device2> EngineCore::Device()
-		{
-			return m_Device;
-		}
-
-		ComPtr<IDXGISwapChain4> EngineCore::SwapChain()
-		{
-			return m_SwapChain;
-		}
-
-		ComPtr<ID3D12DescriptorHeap> EngineCore::DescriptorHeap()
-		{
-			return m_RTVDescriptorHeap;
-		}
-
-		ComPtr<ID3D12CommandQueue> EngineCore::CommandQueue()
-		{
-			return m_CommandQueue;
-		}
-
-		ComPtr<ID3D12Fence> EngineCore::Fence()
-		{
-			return m_Fence;
-		}
-
-		std::uint64_t EngineCore::FenceValue()
-		{
-			return std::uint64_t();
-		}
-
-	}
-}
-
+#include "EngineCore.h"
+
+namespace
+{
+	// A performance counter value on the frame clock //
+
+	double QpcToFrameClock(LONGLONG qpc)
+	{
+		LARGE_INTEGER frequency;
+		LARGE_INTEGER now;
+		::QueryPerformanceFrequency(&frequency);
+		::QueryPerformanceCounter(&now);
+
+		const double age = static_cast<double>(now.QuadPart - qpc) * 1000.0 / static_cast<double>(frequency.QuadPart);
+		return PowerEngine::Core::FrameClockMilliseconds() - age;
+	}
+}
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		std::unique_ptr<Core::CopyQueue> EngineCore::m_CopyQueue;
+		std::uint64_t EngineCore::m_RequiredCopyFenceValue = 0;
+		ComPtr<ID3D12CommandQueue> EngineCore::m_ComputeQueue;
+		std::unique_ptr<QueueSchedulerD3D12> EngineCore::m_Scheduler;
+		QueueScheduler EngineCore::m_Passes;
+		PassId EngineCore::m_ScenePass = 0;
+		PassId EngineCore::m_IndirectCullPass = 0;
+		PassId EngineCore::m_CompositePass = 0;
+		DrawBatcher EngineCore::m_DrawBatcher;
+		std::unique_ptr<DrawBatcherD3D12> EngineCore::m_DrawRecorder;
+		std::unique_ptr<BindlessHeapD3D12> EngineCore::m_Bindless;
+		ComPtr<ID3D12RootSignature> EngineCore::m_RootSignature;
+		std::unique_ptr<IndirectDrawsD3D12> EngineCore::m_IndirectDraws;
+		std::unique_ptr<ConstantAllocatorD3D12> EngineCore::m_Constants;
+		std::unique_ptr<ResidencyManagerD3D12> EngineCore::m_Residency;
+		FrameArena EngineCore::m_FrameArena(g_NumFrames);
+		TextOverlay EngineCore::m_Hud;
+		std::unique_ptr<TextOverlayD3D12> EngineCore::m_HudRenderer;
+		Platform* EngineCore::m_Platform = nullptr;
+		std::unique_ptr<SimulationPipeline> EngineCore::m_Simulation;
+		DeferredReleaseQueue<ComPtr<ID3D12Resource>> EngineCore::m_DeferredReleases;
+		std::uint32_t EngineCore::m_PendingWidth = 0;
+		std::uint32_t EngineCore::m_PendingHeight = 0;
+		bool EngineCore::m_ResizePending = false;
+		bool EngineCore::m_ResizeHeld = false;
+		DynamicResolutionSettings EngineCore::m_ResolutionSettings;
+		std::unique_ptr<DynamicResolutionD3D12> EngineCore::m_DynamicResolution;
+		HANDLE EngineCore::m_FrameLatencyWaitable = nullptr;
+		FramePacer EngineCore::m_Pacer;
+		FrameLatencyTracker EngineCore::m_Latency;
+		FrameStamps EngineCore::m_FrameStamps;
+		double EngineCore::m_FrameInput = 0.0;
+		double EngineCore::m_SimulatedInput = 0.0;
+		std::uint64_t EngineCore::m_PacedGpuSamples = 0;
+		std::uint64_t EngineCore::m_PresentId = 0;
+		UINT EngineCore::m_LastSyncRefreshCount = 0;
+		double EngineCore::m_LastSyncTime = 0.0;
+		double EngineCore::m_RefreshPeriod = 0.0;
+
+		EngineCore::EngineCore(Platform& platform)
+		{
+			m_Platform = &platform;
+
+			ComPtr<IDXGIAdapter4> dxgiAdapter4 = GetAdapter(g_UseWarp);
+
+			m_Device = CreateDevice(dxgiAdapter4);
+			m_CommandQueue = CreateCommandQueue(m_Device, D3D12_COMMAND_LIST_TYPE_DIRECT);
+			m_ComputeQueue = CreateCommandQueue(m_Device, D3D12_COMMAND_LIST_TYPE_COMPUTE);
+			m_Scheduler = std::make_unique<QueueSchedulerD3D12>(m_Device, m_CommandQueue, m_ComputeQueue, g_NumFrames);
+			m_CopyQueue = std::make_unique<Core::CopyQueue>(m_Device);
+			m_Bindless = std::make_unique<BindlessHeapD3D12>(m_Device);
+			m_RootSignature = BindlessHeapD3D12::CreateRootSignature(m_Device);
+			m_IndirectDraws = std::make_unique<IndirectDrawsD3D12>(m_Device, m_RootSignature, g_NumFrames, 65536, 4096,
+				g_InstanceRootParameter, g_BindlessRootParameter, g_DrawIdRootConstant);
+			m_IndirectDraws->SetDescriptorTables(m_Bindless->ResourceTable(), m_Bindless->SamplerTable());
+			m_ScenePass = m_Passes.AddPass("Scene", false);
+			m_IndirectCullPass = m_Passes.AddPass("IndirectCull", true);
+			m_CompositePass = m_Passes.AddPass("Composite", false, { m_ScenePass, m_IndirectCullPass });
+			m_Passes.Compile();
+			m_Constants = std::make_unique<ConstantAllocatorD3D12>(m_Device, g_NumFrames);
+			m_Residency = std::make_unique<ResidencyManagerD3D12>(m_Device, dxgiAdapter4);
+			m_DrawRecorder = std::make_unique<DrawBatcherD3D12>(m_Device, g_NumFrames, g_InstanceRootParameter);
+			m_DrawRecorder->SetResidency(m_Residency.get());
+			m_IndirectDraws->SetResidency(m_Residency.get());
+			LoadScene();
+			m_DrawRecorder->SetMaterialBinder([](ID3D12GraphicsCommandList* commandList, MaterialHandle material)
+			{
+				m_Bindless->BindMaterial(commandList, material);
+			});
+			m_DrawRecorder->SetRootTableBinder([](ID3D12GraphicsCommandList* commandList)
+			{
+				m_Bindless->SetRootTables(commandList);
+			});
+			m_HudRenderer = std::make_unique<TextOverlayD3D12>(m_Device, g_NumFrames, DXGI_FORMAT_R8G8B8A8_UNORM);
+			m_DynamicResolution = std::make_unique<DynamicResolutionD3D12>(m_Device, m_CommandQueue, *m_Bindless, g_NumFrames,
+				DXGI_FORMAT_R8G8B8A8_UNORM, m_ResolutionSettings);
+			m_DynamicResolution->Resize(g_ClientWidth, g_ClientHeight, 0);
+			m_RTVDescriptorHeap = CreateDescriptor(m_Device, D3D12_DESCRIPTOR_HEAP_TYPE_RTV, g_NumFrames);
+			m_RTVDescriptorSize = m_Device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+
+			// Without a window the frames go to offscreen targets, there is nothing to present //
+
+			if (platform.Headless())
+			{
+				CreateOffscreenTargets(m_Device, m_RTVDescriptorHeap, g_ClientWidth, g_ClientHeight);
+				m_CurrentBackBufferIndex = 0;
+			}
+			else
+			{
+				m_SwapChain = CreateSwapChain(static_cast<HWND>(platform.NativeWindow()), m_CommandQueue, g_ClientWidth, g_ClientHeight, g_NumFrames);
+				m_CurrentBackBufferIndex = m_SwapChain->GetCurrentBackBufferIndex();
+				UpdateRenderTargetViews(m_Device, m_SwapChain, m_RTVDescriptorHeap);
+
+				// A single queued present, BeginFrame() waits for the display to take the last one //
+
+				if (g_LowLatency)
+				{
+					ThrowIfFailed(m_SwapChain->SetMaximumFrameLatency(1));
+					m_FrameLatencyWaitable = m_SwapChain->GetFrameLatencyWaitableObject();
+				}
+			}
+
+			m_Fence = CreateFence(m_Device);
+			m_FenceEvent = CreateEventHandle();
+
+		}
+		EngineCore::~EngineCore()
+		{
+			m_Simulation.reset();
+			flush(m_CommandQueue, m_Fence, m_FenceValue, m_FenceEvent);
+			m_DeferredReleases.Retire(m_FenceValue);
+			m_DynamicResolution->Retire(m_FenceValue);
+			::CloseHandle(m_FenceEvent);
+			if (m_FrameLatencyWaitable)
+			{
+				::CloseHandle(m_FrameLatencyWaitable);
+			}
+
+			OutputDebugStringA(m_FrameArena.HighWaterReport().c_str());
+			OutputDebugStringA(MemoryTracker::Format(MemoryTracker::Global().Snapshot()).c_str());
+			OutputDebugStringA(("Input latency " + FrameLatencyTracker::Format(m_Latency.Report()) + "\n").c_str());
+		}
+		void EngineCore::update()
+		{
+			static std::uint64_t frameCounter = 0;
+			static double elapsedSeconds = 0.0;
+			static double fps = 0.0;
+			static std::chrono::high_resolution_clock clock;
+			static auto t0 = clock.now();
+
+			frameCounter++;
+			auto t1 = clock.now();
+			auto deltaTime = t1 - t0;
+			t0 = t1;
+
+			const double deltaSeconds = deltaTime.count() * 1e-9; // convert the deltaTime from nanoseconds into seconds
+			elapsedSeconds += deltaSeconds;
+			if (elapsedSeconds > 1.0)
+			{
+				fps = frameCounter / elapsedSeconds;
+				frameCounter = 0;
+				elapsedSeconds = 0.0;
+			}
+
+			// Draws simulated during the last frame, the next simulation starts on the pool //
+
+			if (m_Simulation)
+			{
+				m_Simulation->BeginFrame(deltaSeconds, m_DrawBatcher);
+			}
+
+			// Simulated one frame ahead, the draws show the input sampled for the frame before //
+
+			const double input = m_FrameInput != 0.0 ? m_FrameInput : FrameClockMilliseconds();
+
+			m_FrameStamps = FrameStamps();
+			m_FrameStamps.Input = m_Simulation && m_SimulatedInput != 0.0 ? m_SimulatedInput : input;
+			m_FrameStamps.Simulate = FrameClockMilliseconds();
+			m_SimulatedInput = input;
+
+			// The HUD shows the last recorded frame, its text is rebuilt every frame //
+
+			if (!m_Hud.Visible())
+			{
+				return;
+			}
+
+			char buffer[1024];
+			const DrawBatchStats& draws = m_DrawBatcher.Stats();
+			const ConstantAllocatorStats& constants = m_Constants->LastFrameStats();
+			const ResidencyStats residency = m_Residency->Stats();
+			const ResidencySegmentStats& local = residency.Segments[static_cast<std::uint32_t>(MemorySegment::Local)];
+			const SimulationStats simulation = m_Simulation ? m_Simulation->LastFrameStats() : SimulationStats();
+			const DynamicResolutionStats& resolution = m_DynamicResolution->Controller().Stats();
+			sprintf_s(buffer, 1024, "FPS: %.1f (%.2f ms), input latency %s\n%s\nInstancing: %u submitted, %u drawn, %u state changes (%u unsorted)\n"
+				"Constants: %llu KB in %llu allocations\nVRAM: %llu / %llu MB, %llu evictions\nMemory: %llu MB live\n"
+				"Simulation: %u steps, %.2f ms overlapped, %.2f ms waited\n"
+				"Resolution: %ux%u (%.0f%%), GPU %.2f / %.2f ms, %llu frames over\n"
+				"Queues: %.2f ms GPU, %.2f ms async compute overlapped",
+				fps, fps > 0.0 ? 1000.0 / fps : 0.0, FrameLatencyTracker::Format(m_Latency.Report()).c_str(), RenderStats::Format(RenderStats::Global().LastFrame()).c_str(),
+				draws.SubmittedDraws, draws.EmittedDraws, draws.StateChangesEmitted.Total(), draws.StateChangesSubmitted.Total(),
+				constants.Bytes / 1024, constants.Allocations, local.Usage >> 20, local.Budget >> 20, residency.Evictions,
+				MemoryTracker::Global().Snapshot().LiveBytes() >> 20,
+				simulation.Steps, simulation.SimulateMilliseconds, simulation.WaitMilliseconds,
+				m_DynamicResolution->SceneWidth(), m_DynamicResolution->SceneHeight(), resolution.Scale * 100.0f,
+				resolution.GpuMilliseconds, m_DynamicResolution->Controller().Settings().TargetMilliseconds, resolution.OverTarget,
+				m_Scheduler->LastFrameGpuMs(), m_Scheduler->LastOverlapMs());
+
+			m_Hud.Clear();
+			m_Hud.Print(8.0f, 8.0f, buffer);
+		}
+		void EngineCore::render()
+		{
+			// Resources whose frames have retired go first, old back buffers included //
+
+			m_DeferredReleases.Retire(m_Fence->GetCompletedValue());
+			m_DynamicResolution->Retire(m_Fence->GetCompletedValue());
+
+			ApplyPendingResize();
+
+			// Retrieve the back buffer resource according to the current back buffer index. //
+
+			auto backBuffer = m_BackBuffers[m_CurrentBackBufferIndex];
+
+			// Offscreen targets rest in the copy source state, ready to be read back //
+
+			const bool headless = m_Platform->Headless();
+			const D3D12_RESOURCE_STATES restingState = headless ? D3D12_RESOURCE_STATE_COPY_SOURCE : D3D12_RESOURCE_STATE_PRESENT;
+
+			// Descriptors freed by frames that have retired can be handed out again //
+
+			m_Bindless->Retire(m_Fence->GetCompletedValue());
+
+			// Over budget, the least recently used heaps whose frames have retired are evicted //
+
+			m_Residency->Update(m_Fence->GetCompletedValue(), m_FenceValue + 1);
+
+			// The slot's previous frame has completed, its constant data and transient memory can be reused //
+
+			m_Constants->BeginFrame(m_CurrentBackBufferIndex);
+			m_FrameArena.BeginFrame(m_CurrentBackBufferIndex);
+			WaitForUpload(m_IndirectDraws->BeginFrame(*m_CopyQueue, m_CurrentBackBufferIndex));
+
+			// Scene draws, identical mesh/material/pipeline draws become one instanced draw //
+
+			m_DrawBatcher.Build();
+			if (!m_DrawBatcher.Draws().empty())
+			{
+				m_DrawRecorder->Upload(m_DrawBatcher, m_CurrentBackBufferIndex);
+			}
+
+			{
+				// Evicted objects this frame uses are paged back in before any of its work runs, uploads included //
+
+				m_Residency->MakeResident({ m_CopyQueue->Queue().Get(), m_ComputeQueue.Get(), m_CommandQueue.Get() });
+
+				// Every upload recorded for this frame goes out in a single copy command list. //
+				// The direct queue only waits on the copy fence when this frame reads that data //
+				// and the copy has not already landed. //
+
+				m_CopyQueue->Submit();
+
+				// The compute queue waits as well, the cull reads the uploaded scene objects. //
+
+				if (m_RequiredCopyFenceValue > m_CopyQueue->CompletedValue())
+				{
+					for (ID3D12CommandQueue* queue : { m_CommandQueue.Get(), m_ComputeQueue.Get() })
+					{
+						ThrowIfFailed(queue->Wait(m_CopyQueue->Fence().Get(), m_RequiredCopyFenceValue));
+						CommandCaptureD3D12::Wait(queue, m_CopyQueue->Fence().Get(), m_RequiredCopyFenceValue);
+					}
+				}
+				m_RequiredCopyFenceValue = 0;
+
+				CD3DX12_CPU_DESCRIPTOR_HANDLE rtv(m_RTVDescriptorHeap->GetCPUDescriptorHandleForHeapStart(),
+					m_CurrentBackBufferIndex, m_RTVDescriptorSize);
+
+				// The scene renders at the dynamic resolution while the cull runs on the compute queue //
+
+				m_Scheduler->SetPassRecorder(m_ScenePass, [&](ID3D12GraphicsCommandList* commandList)
+				{
+					m_Bindless->SetDescriptorHeaps(commandList);
+
+					/* 
+					   To build correctly the transition barrier, 
+					   the before and next state must be known before hand.
+					   That's why it's hard coded here.
+					*/
+					CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(backBuffer.Get(), 
+						restingState, D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+					commandList->ResourceBarrier(1, &barrier);
+					CommandCaptureD3D12::Barriers(commandList, 1, &barrier);
+					RenderStats::Count(RenderCounter::Barriers);
+
+					m_DynamicResolution->BeginScene(commandList, m_CurrentBackBufferIndex);
+
+					if (!m_DrawBatcher.Draws().empty())
+					{
+						m_DrawRecorder->Record(commandList, m_DrawBatcher, 0, m_CurrentBackBufferIndex);
+					}
+				});
+
+				m_Scheduler->SetPassRecorder(m_IndirectCullPass, [](ID3D12GraphicsCommandList* commandList)
+				{
+					m_IndirectDraws->RecordCull(commandList);
+				});
+
+				// Once both are done the culled objects are drawn and the upscale covers the whole back buffer //
+
+				m_Scheduler->SetPassRecorder(m_CompositePass, [&](ID3D12GraphicsCommandList* commandList)
+				{
+					m_Bindless->SetDescriptorHeaps(commandList);
+					m_DynamicResolution->ResumeScene(commandList);
+
+					// GPU driven scene objects, culled on the compute queue and drawn without per object CPU work //
+
+					m_IndirectDraws->RecordDraw(commandList);
+
+					m_DynamicResolution->Upscale(commandList, m_CurrentBackBufferIndex, rtv);
+
+					// Performance HUD over everything else, at the output resolution //
+
+					m_HudRenderer->Record(commandList, m_Hud, m_CurrentBackBufferIndex, g_ClientWidth, g_ClientHeight);
+
+					// Before presenting, the back buffer resource must be transitioned to the present state //
+
+					CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(
+							backBuffer.Get(),
+							D3D12_RESOURCE_STATE_RENDER_TARGET, restingState);
+					commandList->ResourceBarrier(1, &barrier);
+					CommandCaptureD3D12::Barriers(commandList, 1, &barrier);
+					RenderStats::Count(RenderCounter::Barriers);
+				});
+
+				ExecutePasses(m_Passes);
+				m_DrawBatcher.Reset();
+
+				// The frame timestamps read back for the resolution also tell the pacer how long the GPU takes //
+
+				const DynamicResolutionStats& resolution = m_DynamicResolution->Controller().Stats();
+				if (resolution.Samples != m_PacedGpuSamples)
+				{
+					m_PacedGpuSamples = resolution.Samples;
+					m_Pacer.RecordGpu(resolution.GpuMilliseconds);
+				}
+
+				m_FrameStamps.Submit = FrameClockMilliseconds();
+				m_Pacer.RecordCpu(m_FrameStamps.Submit - m_FrameInput);
+				m_Pacer.Submitted(m_FrameStamps.Submit);
+
+				// Headless frames skip presentation and vsync, only the frame fences pace them //
+
+				UINT syncInterval = g_VSync && !headless ? 1 : 0;
+				UINT presentFlags = g_TearingSupported && !g_VSync && !headless ? DXGI_PRESENT_ALLOW_TEARING : 0;
+				if (!headless)
+				{
+					ThrowIfFailed(m_SwapChain->Present(syncInterval, presentFlags));
+				}
+
+				m_FrameStamps.Present = FrameClockMilliseconds();
+
+				if (headless)
+				{
+					m_Latency.Presented(++m_PresentId, m_FrameStamps);
+				}
+				else
+				{
+					UINT presentCount = 0;
+					ThrowIfFailed(m_SwapChain->GetLastPresentCount(&presentCount));
+					m_Latency.Presented(presentCount, m_FrameStamps);
+
+					ReadPresentStatistics();
+				}
+
+				m_FrameFenceValues[m_CurrentBackBufferIndex] = Signal(m_CommandQueue, m_Fence, m_FenceValue);
+
+				// The frame's signal belongs to it, so a capture starts or ends after it //
+
+				CommandCaptureD3D12::Present(syncInterval, presentFlags);
+
+				// Per subsystem memory and render counters of every thread are merged once per frame //
+
+				MemoryTracker::Global().EndFrame();
+				RenderStats::Global().EndFrame();
+
+				m_CurrentBackBufferIndex = headless ? (m_CurrentBackBufferIndex + 1) % g_NumFrames : m_SwapChain->GetCurrentBackBufferIndex();
+
+				WaitFenceValue(m_Fence, m_FrameFenceValues[m_CurrentBackBufferIndex], m_FenceEvent);
+			
+			}
+
+		}
+		void EngineCore::CommandLineParsing(const std::vector<std::string>& arguments)
+		{
+			for (size_t i = 0; i < arguments.size(); i++)
+			{
+				const std::string& argument = arguments[i];
+				const bool hasValue = i + 1 < arguments.size();
+
+				if ((argument == "-w" || argument == "--width") && hasValue)
+				{
+					g_ClientWidth = static_cast<std::uint16_t>(std::strtol(arguments[++i].c_str(), nullptr, 10));
+				}
+				else if ((argument == "-h" || argument == "--height") && hasValue)
+				{
+					g_ClientHeight = static_cast<std::uint16_t>(std::strtol(arguments[++i].c_str(), nullptr, 10));
+				}
+				else if (argument == "-warp" || argument == "--warp")
+				{
+					g_UseWarp = true;
+				}
+				else if (argument == "--headless")
+				{
+					g_Headless = true;
+				}
+				else if (argument == "--frames" && hasValue)
+				{
+					g_HeadlessFrames = std::strtoull(arguments[++i].c_str(), nullptr, 10);
+				}
+				else if (argument == "--low-latency")
+				{
+					g_LowLatency = true;
+				}
+				else if (argument == "--gpu-target" && hasValue)
+				{
+					m_ResolutionSettings.TargetMilliseconds = std::strtod(arguments[++i].c_str(), nullptr);
+				}
+				else if (argument == "--min-scale" && hasValue)
+				{
+					m_ResolutionSettings.MinScale = std::strtof(arguments[++i].c_str(), nullptr);
+				}
+				else if (argument == "--max-scale" && hasValue)
+				{
+					m_ResolutionSettings.MaxScale = std::strtof(arguments[++i].c_str(), nullptr);
+				}
+				else if (argument == "--scene" && hasValue)
+				{
+					g_ScenePath = arguments[++i];
+				}
+				else if (argument == "--capture" && hasValue)
+				{
+					// Captures that many frames from the first present on, replayed by Tools/TraceReplay //
+
+					CommandCaptureD3D12::Begin("capture.petrace", static_cast<std::uint32_t>(std::strtol(arguments[++i].c_str(), nullptr, 10)));
+				}
+			}
+		}
+
+		void EngineCore::Enable_DebugD3D12_Layer()
+		{
+			#if defined(_DEBUG)
+			ComPtr<ID3D12Debug> debugInterface;
+			ThrowIfFailed(D3D12GetDebugInterface(IID_PPV_ARGS(&debugInterface)));
+			debugInterface->EnableDebugLayer();
+			#endif
+		}
+
+		HANDLE EngineCore::CreateEventHandle()
+		{
+			HANDLE fenceEvent;
+
+			fenceEvent = ::CreateEvent(NULL, FALSE, FALSE, NULL);
+			assert(fenceEvent && "Failed to create fence event.");
+
+			return fenceEvent;
+		}
+
+		void EngineCore::ResizeWindow(std::uint32_t width, std::uint32_t height, bool sizing)
+		{
+			// Don't allow 0 size swap chain back buffers.
+
+			m_PendingWidth = std::max(1u, width);
+			m_PendingHeight = std::max(1u, height);
+
+			// A resize under way has given its buffers up already, it completes even back to the same size //
+
+			m_ResizePending = m_ResizePending || m_PendingWidth != g_ClientWidth || m_PendingHeight != g_ClientHeight;
+
+			// Resizing the swap chain waits for the frames in flight. While the border is dragged the //
+			// old buffers are stretched to the window instead, and the size is applied once it settles. //
+
+			m_ResizeHeld = sizing;
+		}
+
+		void EngineCore::BeginFrame()
+		{
+			// The swap chain has room for the frame, the pacer holds it until it can finish just in time //
+
+			if (m_FrameLatencyWaitable)
+			{
+				::WaitForSingleObjectEx(m_FrameLatencyWaitable, 1000, TRUE);
+				SleepPrecise(m_Pacer.SleepMilliseconds(FrameClockMilliseconds()));
+			}
+
+			m_FrameInput = FrameClockMilliseconds();
+		}
+
+		void EngineCore::ReadPresentStatistics()
+		{
+			// Fails until the first vblank and after a mode change, the next frame tries again //
+
+			DXGI_FRAME_STATISTICS statistics = {};
+			if (FAILED(m_SwapChain->GetFrameStatistics(&statistics)))
+			{
+				return;
+			}
+
+			const double syncTime = QpcToFrameClock(statistics.SyncQPCTime.QuadPart);
+			m_Latency.Displayed(statistics.PresentCount, syncTime);
+
+			if (m_LastSyncRefreshCount != 0 && statistics.SyncRefreshCount > m_LastSyncRefreshCount)
+			{
+				m_RefreshPeriod = (syncTime - m_LastSyncTime) / static_cast<double>(statistics.SyncRefreshCount - m_LastSyncRefreshCount);
+			}
+			m_LastSyncRefreshCount = statistics.SyncRefreshCount;
+			m_LastSyncTime = syncTime;
+
+			m_Pacer.SetDisplayTiming(syncTime, g_VSync ? m_RefreshPeriod : 0.0);
+		}
+
+		void EngineCore::ApplyPendingResize()
+		{
+			if (!m_ResizePending || m_ResizeHeld)
+			{
+				return;
+			}
+
+			// Each old buffer is released once the last frame that used it retires, //
+			// frames already in flight keep their targets. //
+
+			std::uint64_t lastFrameFenceValue = 0;
+			for (int i = 0; i < g_NumFrames; ++i)
+			{
+				if (m_BackBuffers[i])
+				{
+					m_DeferredReleases.Push(std::move(m_BackBuffers[i]), m_FrameFenceValues[i]);
+					lastFrameFenceValue = std::max(lastFrameFenceValue, m_FrameFenceValues[i]);
+				}
+			}
+
+			g_ClientWidth = static_cast<std::uint16_t>(m_PendingWidth);
+			g_ClientHeight = static_cast<std::uint16_t>(m_PendingHeight);
+
+			// The scene target follows the output size, frames in flight keep the old one //
+
+			m_DynamicResolution->Resize(g_ClientWidth, g_ClientHeight, m_FenceValue + 1);
+
+			// Offscreen targets are plain resources, the new ones are used right away //
+
+			if (m_Platform->Headless())
+			{
+				CreateOffscreenTargets(m_Device, m_RTVDescriptorHeap, g_ClientWidth, g_ClientHeight);
+				m_ResizePending = false;
+				return;
+			}
+
+			// The swap chain can only resize once nothing references its buffers, on the CPU or the GPU, //
+			// the thread sleeps on the fence event of the last frame using them rather than skip frames. //
+			// That drains the direct queue, once per settled size: drags only get here on WM_EXITSIZEMOVE. //
+
+			WaitFenceValue(m_Fence, lastFrameFenceValue, m_FenceEvent);
+			m_DeferredReleases.Retire(m_Fence->GetCompletedValue());
+
+			DXGI_SWAP_CHAIN_DESC swapChainDesc = {};
+			ThrowIfFailed(m_SwapChain->GetDesc(&swapChainDesc));
+			ThrowIfFailed(m_SwapChain->ResizeBuffers(g_NumFrames, g_ClientWidth, g_ClientHeight,
+				swapChainDesc.BufferDesc.Format, swapChainDesc.Flags));
+
+			m_CurrentBackBufferIndex = m_SwapChain->GetCurrentBackBufferIndex();
+
+			UpdateRenderTargetViews(m_Device, m_SwapChain, m_RTVDescriptorHeap);
+
+			m_ResizePending = false;
+		}
+
+		std::uint64_t EngineCore::Signal(ComPtr<ID3D12CommandQueue> commandQueue, ComPtr<ID3D12Fence> fence, std::uint64_t& fenceValue)
+		{
+			std::uint64_t fenceValueForSignal = ++fenceValue;
+			ThrowIfFailed(commandQueue->Signal(fence.Get(), fenceValueForSignal));
+			CommandCaptureD3D12::Signal(commandQueue.Get(), fence.Get(), fenceValueForSignal);
+
+			return fenceValueForSignal;
+		}
+
+		void EngineCore::WaitFenceValue(ComPtr<ID3D12Fence> fence, std::uint64_t fenceValue, HANDLE fenceEvent, std::chrono::milliseconds duration)
+		{
+			if (fence->GetCompletedValue() < fenceValue)
+			{
+				ThrowIfFailed(fence->SetEventOnCompletion(fenceValue, fenceEvent));
+				::WaitForSingleObject(fenceEvent, static_cast<DWORD>(duration.count()));
+			}
+		}
+
+		void EngineCore::flush(ComPtr<ID3D12CommandQueue> commandQueue, ComPtr<ID3D12Fence> fence, std::uint64_t& fenceValue, HANDLE fenceEvent)
+		{
+			uint64_t fenceValueForSignal = Signal(commandQueue, fence, fenceValue);
+			WaitFenceValue(fence, fenceValueForSignal, fenceEvent);
+		}
+
+		void EngineCore::WaitForUpload(std::uint64_t copyFenceValue)
+		{
+			m_RequiredCopyFenceValue = std::max(m_RequiredCopyFenceValue, copyFenceValue);
+		}
+
+		void EngineCore::LoadScene()
+		{
+			if (g_ScenePath.empty())
+			{
+				return;
+			}
+
+			// The streams are copied out during the upload, the file is unmapped right after //
+
+			Assets::MeshFile mesh;
+			ThrowIfFailed(mesh.Open(g_ScenePath.c_str()) ? S_OK : E_INVALIDARG);
+			WaitForUpload(m_IndirectDraws->LoadGeometry(*m_CopyQueue, mesh, 0));
+		}
+
+		void EngineCore::ExecutePasses(const QueueScheduler& scheduler)
+		{
+			m_Scheduler->Execute(scheduler, m_CurrentBackBufferIndex);
+		}
+
+		void EngineCore::DeferRelease(ComPtr<ID3D12Resource> resource)
+		{
+			m_DeferredReleases.Push(std::move(resource), m_FenceValue + 1);
+		}
+
+		void EngineCore::ReleaseDescriptor(BindlessHandle handle)
+		{
+			m_Bindless->Free(handle, m_FenceValue + 1);
+		}
+
+		void EngineCore::MarkResident(ResidencyHandle handle)
+		{
+			m_Residency->MarkUsed(handle, m_FenceValue + 1);
+		}
+
+		void EngineCore::SetSimulation(double stepSeconds, SimulationPipeline::StepFunction step)
+		{
+			m_Simulation = std::make_unique<SimulationPipeline>(stepSeconds, std::move(step));
+		}
+
+		void EngineCore::SetDynamicResolution(const DynamicResolutionSettings& settings)
+		{
+			m_ResolutionSettings = settings;
+
+			if (m_DynamicResolution)
+			{
+				m_DynamicResolution->Controller().SetSettings(settings);
+				m_DynamicResolution->Resize(g_ClientWidth, g_ClientHeight, m_FenceValue + 1);
+			}
+		}
+
+		ComPtr<IDXGIAdapter4> EngineCore::GetAdapter(bool useWarp)
+		{
+			ComPtr<IDXGIFactory4> dxgiFactory;
+			UINT createFactoryFlags = 0;
+			#if defined(_DEBUG)
+			createFactoryFlags = DXGI_CREATE_FACTORY_DEBUG;
+			#endif
+
+			ThrowIfFailed(CreateDXGIFactory2(createFactoryFlags, IID_PPV_ARGS(&dxgiFactory)));
+
+			ComPtr<IDXGIAdapter1> dxgiAdapter1;
+			ComPtr<IDXGIAdapter4> dxgiAdapter4;
+
+			if (useWarp)
+			{
+				ThrowIfFailed(dxgiFactory->EnumWarpAdapter(IID_PPV_ARGS(&dxgiAdapter1)));
+				ThrowIfFailed(dxgiAdapter1.As(&dxgiAdapter4));
+			}
+			else
+			{
+				SIZE_T maxDedicatedVideoMemory = 0;
+				for (UINT i = 0; dxgiFactory->EnumAdapters1(i, &dxgiAdapter1) != DXGI_ERROR_NOT_FOUND; ++i)
+				{
+					DXGI_ADAPTER_DESC1 dxgiAdapterDesc1;
+					dxgiAdapter1->GetDesc1(&dxgiAdapterDesc1);
+
+					// Check to see if the adapter can create a D3D12 device without actually 
+					// creating it. The adapter with the largest dedicated video memory
+					// is favored.
+					if ((dxgiAdapterDesc1.Flags & DXGI_ADAPTER_FLAG_SOFTWARE) == 0 &&
+						SUCCEEDED(D3D12CreateDevice(dxgiAdapter1.Get(),
+							D3D_FEATURE_LEVEL_11_0, __uuidof(ID3D12Device), nullptr)) &&
+						dxgiAdapterDesc1.DedicatedVideoMemory > maxDedicatedVideoMemory)
+					{
+						maxDedicatedVideoMemory = dxgiAdapterDesc1.DedicatedVideoMemory;
+						ThrowIfFailed(dxgiAdapter1.As(&dxgiAdapter4));
+					}
+				}
+			}
+
+			return dxgiAdapter4;
+		}
+
+		ComPtr<ID3D12Device2> EngineCore::CreateDevice(ComPtr<IDXGIAdapter4> adapter)
+		{
+			ComPtr<ID3D12Device2> d3d12Device2;
+			ThrowIfFailed(D3D12CreateDevice(adapter.Get(), D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&d3d12Device2)));
+
+			#if defined(_DEBUG)
+			ComPtr<ID3D12InfoQueue> pInfoQueue;
+			if (SUCCEEDED(d3d12Device2.As(&pInfoQueue)))
+			{
+				pInfoQueue->SetBreakOnSeverity(D3D12_MESSAGE_SEVERITY_CORRUPTION, TRUE);
+				pInfoQueue->SetBreakOnSeverity(D3D12_MESSAGE_SEVERITY_ERROR, TRUE);
+				pInfoQueue->SetBreakOnSeverity(D3D12_MESSAGE_SEVERITY_WARNING, TRUE);
+
+				// Suppress messages based on their severity level
+				D3D12_MESSAGE_SEVERITY Severities[] =
+				{
+					D3D12_MESSAGE_SEVERITY_INFO
+				};
+
+				// Suppress individual messages by their ID
+				D3D12_MESSAGE_ID DenyIds[] = {
+					D3D12_MESSAGE_ID_CLEARRENDERTARGETVIEW_MISMATCHINGCLEARVALUE,   
+					D3D12_MESSAGE_ID_MAP_INVALID_NULLRANGE,                        
+					D3D12_MESSAGE_ID_UNMAP_INVALID_NULLRANGE,                       
+				};
+
+				D3D12_INFO_QUEUE_FILTER NewFilter = {};
+				//NewFilter.DenyList.NumCategories = _countof(Categories);
+				//NewFilter.DenyList.pCategoryList = Categories;
+				NewFilter.DenyList.NumSeverities = _countof(Severities);
+				NewFilter.DenyList.pSeverityList = Severities;
+				NewFilter.DenyList.NumIDs = _countof(DenyIds);
+				NewFilter.DenyList.pIDList = DenyIds;
+
+				ThrowIfFailed(pInfoQueue->PushStorageFilter(&NewFilter));
+			}
+			#endif
+
+			return d3d12Device2;
+		}
+
+		ComPtr<ID3D12CommandQueue> EngineCore::CreateCommandQueue(ComPtr<ID3D12Device2> device, D3D12_COMMAND_LIST_TYPE type)
+		{
+			ComPtr<ID3D12CommandQueue> d3d12CommandQueue;
+
+			D3D12_COMMAND_QUEUE_DESC desc = {};
+			desc.Type = type;
+			desc.Priority = D3D12_COMMAND_QUEUE_PRIORITY_NORMAL;
+			desc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+			desc.NodeMask = 0;
+
+			ThrowIfFailed(device->CreateCommandQueue(&desc, IID_PPV_ARGS(&d3d12CommandQueue)));
+
+			return d3d12CommandQueue;
+		}
+
+		ComPtr<ID3D12CommandAllocator> EngineCore::CreateCommandAllocator(ComPtr<ID3D12Device2> device, D3D12_COMMAND_LIST_TYPE type)
+		{
+			ComPtr<ID3D12CommandAllocator> commandAllocator;
+			ThrowIfFailed(device->CreateCommandAllocator(type, IID_PPV_ARGS(&commandAllocator)));
+
+			return commandAllocator;
+		}
+
+		ComPtr<ID3D12GraphicsCommandList> EngineCore::CreateCommandList(ComPtr<ID3D12Device2> device, ComPtr<ID3D12CommandAllocator> commandAllocator, D3D12_COMMAND_LIST_TYPE type)
+		{
+			ComPtr<ID3D12GraphicsCommandList> commandList;
+			ThrowIfFailed(device->CreateCommandList(0, type, commandAllocator.Get(), nullptr, IID_PPV_ARGS(&commandList)));
+
+			ThrowIfFailed(commandList->Close());
+
+			return commandList;
+		}
+
+		ComPtr<ID3D12Fence> EngineCore::CreateFence(ComPtr<ID3D12Device2> device)
+		{
+			ComPtr<ID3D12Fence> fence;
+
+			ThrowIfFailed(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence)));
+
+			return fence;
+		}
+
+		void EngineCore::OnEvent(const PlatformEvent& event)
+		{
+			switch (event.Type)
+			{
+			case PlatformEventType::Paint:
+
+				update();
+				render();
+
+				break;
+
+			case PlatformEventType::Key:
+
+				switch (event.Key)
+				{
+				case PlatformKey::V:
+					g_VSync = !g_VSync;
+					break;
+				case PlatformKey::H:
+					m_Hud.SetVisible(!m_Hud.Visible());
+					break;
+				case PlatformKey::F12:
+					CommandCaptureD3D12::Begin("capture.petrace");
+					break;
+				case PlatformKey::Escape:
+					m_Platform->Quit();
+					break;
+				case PlatformKey::Enter:
+					if (event.Alt)
+					{
+				case PlatformKey::F11:
+					m_Platform->SetFullScreen(!m_Platform->FullScreen());
+					}
+					break;
+				default:
+					break;
+				}
+
+				break;
+
+			case PlatformEventType::Resize:
+
+				ResizeWindow(event.Width, event.Height, event.Sizing);
+
+				break;
+
+			case PlatformEventType::BeginFrame:
+
+				BeginFrame();
+
+				break;
+			}
+		}
+
+		ComPtr<IDXGISwapChain4> EngineCore::CreateSwapChain(HWND hWnd, ComPtr<ID3D12CommandQueue> commandQueue, std::uint32_t width, std::uint32_t height, std::uint32_t bufferCount)
+		{
+			ComPtr<IDXGISwapChain4> dxgiSwapChain4;
+			ComPtr<IDXGIFactory4> dxgiFactory4;
+			UINT createFactoryFlags = 0;
+#if defined(_DEBUG)
+			createFactoryFlags = DXGI_CREATE_FACTORY_DEBUG;
+#endif
+
+			ThrowIfFailed(CreateDXGIFactory2(createFactoryFlags, IID_PPV_ARGS(&dxgiFactory4)));
+
+			DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
+			swapChainDesc.Width = width;
+			swapChainDesc.Height = height;
+			swapChainDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+			swapChainDesc.Stereo = FALSE;
+			swapChainDesc.SampleDesc = { 1, 0 };
+			swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+			swapChainDesc.BufferCount = bufferCount;
+			swapChainDesc.Scaling = DXGI_SCALING_STRETCH;	// fills the window with the old buffers while a resize is held
+			swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+			swapChainDesc.Flags = CheckTearingSupport() ? DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING : 0;
+			swapChainDesc.Flags |= g_LowLatency ? DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT : 0;
+
+			ComPtr<IDXGISwapChain1> swapChain1;
+			ThrowIfFailed(dxgiFactory4->CreateSwapChainForHwnd(
+				commandQueue.Get(),
+				hWnd,
+				&swapChainDesc,
+				nullptr,
+				nullptr,
+				&swapChain1));
+
+			// Disable the Alt+Enter fullscreen toggle feature. Switching to fullscreen
+			// will be handled manually.
+			ThrowIfFailed(dxgiFactory4->MakeWindowAssociation(hWnd, DXGI_MWA_NO_ALT_ENTER));
+
+			ThrowIfFailed(swapChain1.As(&dxgiSwapChain4));
+
+			return dxgiSwapChain4;
+		}
+
+		ComPtr<ID3D12DescriptorHeap> EngineCore::CreateDescriptor(ComPtr<ID3D12Device2> device, D3D12_DESCRIPTOR_HEAP_TYPE type, std::uint32_t numDescriptors)
+		{
+			ComPtr<ID3D12DescriptorHeap> descriptorHeap;
+
+			D3D12_DESCRIPTOR_HEAP_DESC desc = {};
+			desc.NumDescriptors = numDescriptors;
+			desc.Type = type;
+
+			ThrowIfFailed(device->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&descriptorHeap)));
+
+			return descriptorHeap;
+		}
+
+		void EngineCore::UpdateRenderTargetViews(ComPtr<ID3D12Device2> device, ComPtr<IDXGISwapChain4> swapChain, ComPtr<ID3D12DescriptorHeap> descriptorHeap)
+		{
+			auto rtvDescriptorSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+
+			CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(descriptorHeap->GetCPUDescriptorHandleForHeapStart());
+
+			for (int i = 0; i < g_NumFrames; ++i)
+			{
+				ComPtr<ID3D12Resource> backBuffer;
+				ThrowIfFailed(swapChain->GetBuffer(i, IID_PPV_ARGS(&backBuffer)));
+
+				device->CreateRenderTargetView(backBuffer.Get(), nullptr, rtvHandle);
+
+				m_BackBuffers[i] = backBuffer;
+
+				rtvHandle.Offset(rtvDescriptorSize);
+			}
+		}
+
+		void EngineCore::CreateOffscreenTargets(ComPtr<ID3D12Device2> device, ComPtr<ID3D12DescriptorHeap> descriptorHeap, std::uint32_t width, std::uint32_t height)
+		{
+			auto rtvDescriptorSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+
+			CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(descriptorHeap->GetCPUDescriptorHandleForHeapStart());
+
+			// Same format as the swap chain, so every pass records the same way with or without a window //
+
+			const CD3DX12_HEAP_PROPERTIES heapProperties(D3D12_HEAP_TYPE_DEFAULT);
+			const CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM, width, height, 1, 1, 1, 0,
+				D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+
+			D3D12_CLEAR_VALUE clearValue = {};
+			clearValue.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+			clearValue.Color[0] = 0.4f;
+			clearValue.Color[1] = 0.6f;
+			clearValue.Color[2] = 0.9f;
+			clearValue.Color[3] = 1.0f;
+
+			for (int i = 0; i < g_NumFrames; ++i)
+			{
+				ComPtr<ID3D12Resource> target;
+				ThrowIfFailed(device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &desc,
+					D3D12_RESOURCE_STATE_COPY_SOURCE, &clearValue, IID_PPV_ARGS(&target)));
+
+				device->CreateRenderTargetView(target.Get(), nullptr, rtvHandle);
+
+				m_BackBuffers[i] = target;
+
+				rtvHandle.Offset(rtvDescriptorSize);
+			}
+		}
+
+		bool EngineCore::CheckTearingSupport()
+		{
+
+			BOOL allowTearing = FALSE;
+
+			ComPtr<IDXGIFactory4> factory4;
+			if (SUCCEEDED(CreateDXGIFactory1(IID_PPV_ARGS(&factory4))))
+			{
+				ComPtr<IDXGIFactory5> factory5;
+				if (SUCCEEDED(factory4.As(&factory5)))
+				{
+					if (FAILED(factory5->CheckFeatureSupport(
+						DXGI_FEATURE_PRESENT_ALLOW_TEARING,
+						&allowTearing, sizeof(allowTearing))))
+					{
+						allowTearing = FALSE;
+					}
+				}
+			}
+
+			return allowTearing == TRUE;
+
+		}
+
+		ComPtr<ID3D12Device2> EngineCore::Device()
+		{
+			return m_Device;
+		}
+
+		ComPtr<IDXGISwapChain4> EngineCore::SwapChain()
+		{
+			return m_SwapChain;
+		}
+
+		ComPtr<ID3D12DescriptorHeap> EngineCore::DescriptorHeap()
+		{
+			return m_RTVDescriptorHeap;
+		}
+
+		ComPtr<ID3D12CommandQueue> EngineCore::CommandQueue()
+		{
+			return m_CommandQueue;
+		}
+
+		Core::CopyQueue& EngineCore::UploadQueue()
+		{
+			return *m_CopyQueue;
+		}
+
+		ComPtr<ID3D12CommandQueue> EngineCore::ComputeQueue()
+		{
+			return m_ComputeQueue;
+		}
+
+		QueueSchedulerD3D12& EngineCore::Scheduler()
+		{
+			return *m_Scheduler;
+		}
+
+		DrawBatcher& EngineCore::Draws()
+		{
+			return m_DrawBatcher;
+		}
+
+		DrawBatcherD3D12& EngineCore::DrawRecorder()
+		{
+			return *m_DrawRecorder;
+		}
+
+		BindlessHeapD3D12& EngineCore::Bindless()
+		{
+			return *m_Bindless;
+		}
+
+		ComPtr<ID3D12RootSignature> EngineCore::RootSignature()
+		{
+			return m_RootSignature;
+		}
+
+		IndirectDrawsD3D12& EngineCore::IndirectDraws()
+		{
+			return *m_IndirectDraws;
+		}
+
+		ConstantAllocatorD3D12& EngineCore::Constants()
+		{
+			return *m_Constants;
+		}
+
+		ResidencyManagerD3D12& EngineCore::Residency()
+		{
+			return *m_Residency;
+		}
+
+		FrameArena& EngineCore::FrameMemory()
+		{
+			return m_FrameArena;
+		}
+
+		TextOverlay& EngineCore::Hud()
+		{
+			return m_Hud;
+		}
+
+		DynamicResolutionD3D12& EngineCore::DynamicResolution()
+		{
+			return *m_DynamicResolution;
+		}
+
+		ComPtr<ID3D12Fence> EngineCore::Fence()
+		{
+			return m_Fence;
+		}
+
+		std::uint64_t EngineCore::FenceValue()
+		{
+			return std::uint64_t();
+		}
+
+	}
+}
+
@@ -1,124 +1,296 @@
-#pragma once
-
-#include "Header.h"
-#include "HelperFile.h"
-
-
-#ifndef EngineCore_h
-#define EngineCore_H
-
-// Global Variables to see the state of the engine //
-
-const std::uint8_t g_NumFrames = 3;
-bool g_UseWarp = false;
-
-std::uint16_t g_ClientWidth = 1920;
-std::uint16_t g_ClientHeight = 1080;
-
-// By default, enable V-Sync.
-// Can be toggled with the V key.
-
-bool g_VSync = true;
-bool g_IsInitialized = false;
-bool g_TearingSupported = false;
-
-HWND g_WindowHandle;
-RECT g_WindowRect;
-
-namespace PowerEngine {
-
-	namespace Core {
-
-		class EngineCore
-		{
-		public:
-
-			EngineCore();
-			~EngineCore();
-
-			static void update();
-			static void render();
-
-			// helper function //
-
-			static void CommandLineParsing();
-			static void Enable_DebugD3D12_Layer();
-			static HANDLE CreateEventHandle();
-
-			static void SetFullScreen(bool fullscreen);
-
-			static void RegisterWindowClass(HINSTANCE Inst, const wchar_t* windowClassName);
-			static HWND CreateWindow(const wchar_t* windowClassName, HINSTANCE hInst, const wchar_t* windowTitle, std::uint16_t width, std::uint16_t height);
-
-			static void ResizeWindow(std::uint32_t width, std::uint32_t height);	
-			// Control Function //
-
-			static std::uint64_t Signal(ComPtr<ID3D12CommandQueue> commandQueue, ComPtr<ID3D12Fence> fence, std::uint64_t& fenceValue);
-			static void WaitFenceValue(ComPtr<ID3D12Fence> fence, std::uint64_t fenceValue, HANDLE fenceEvent, std::chrono::milliseconds duration = std::chrono::milliseconds::max());
-			static void flush(ComPtr<ID3D12CommandQueue> commandQueue, ComPtr<ID3D12Fence> fence, std::uint64_t& fenceValue, HANDLE fenceEvent);
-
-			static void UpdateRenderTargetViews(ComPtr<ID3D12Device2>device, ComPtr<IDXGISwapChain4> swapChain, ComPtr<ID3D12DescriptorHeap> descriptorHeap);
-			static bool CheckTearingSupport();
-
-			// Getters // 
-
-			ComPtr<ID3D12Device2> Device();
-			ComPtr<IDXGISwapChain4> SwapChain();
-			ComPtr<ID3D12DescriptorHeap> DescriptorHeap();
-			ComPtr<ID3D12CommandQueue> CommandQueue();
-			ComPtr<ID3D12Fence> Fence();
-			std::uint64_t FenceValue();
-
-
-		private :
-			// Device Creation Function //
-
-			ComPtr<IDXGIAdapter4> GetAdapter(bool useWarp);
-			ComPtr<ID3D12Device2> CreateDevice(ComPtr<IDXGIAdapter4> adapter);
-			ComPtr<ID3D12CommandQueue> CreateCommandQueue(ComPtr<ID3D12Device2> device, D3D12_COMMAND_LIST_TYPE type);
-			ComPtr<ID3D12CommandAllocator> CreateCommandAllocator(ComPtr<ID3D12Device2> device, D3D12_COMMAND_LIST_TYPE type);
-			ComPtr<ID3D12GraphicsCommandList> CreateCommandList(ComPtr<ID3D12Device2> device, ComPtr<ID3D12CommandAllocator> commandAllocator, D3D12_COMMAND_LIST_TYPE type);
-			ComPtr<ID3D12Fence> CreateFence(ComPtr<ID3D12Device2> device);
-
-			ComPtr<IDXGISwapChain4> CreateSwapChain(HWND hWnd, ComPtr<ID3D12CommandQueue>commandQueue, std::uint32_t width, std::uint32_t height, std::uint32_t bufferCount);
-			ComPtr<ID3D12DescriptorHeap> CreateDescriptor(ComPtr<ID3D12Device2> device, D3D12_DESCRIPTOR_HEAP_TYPE type, std::uint32_t numDescriptors);
-
-			// CALLBACK //
-
-			static LRESULT WndProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam);
-
-
-		private :
-
-			static ComPtr<ID3D12Device2> m_Device;
-			static ComPtr<ID3D12CommandQueue> m_CommandQueue;
-			static ComPtr<IDXGISwapChain4> m_SwapChain;
-			static ComPtr<ID3D12GraphicsCommandList> m_CommandList;
-			static ComPtr<ID3D12CommandAllocator> m_CommandAllocators[g_NumFrames];
-			static ComPtr<ID3D12Resource> m_BackBuffers[g_NumFrames];
-			static ComPtr<ID3D12DescriptorHeap> m_RTVDescriptorHeap;
-			static UINT m_RTVDescriptorSize;
-			static UINT m_CurrentBackBufferIndex;
-
-			// Synchronization objects //
-
-			static ComPtr<ID3D12Fence> m_Fence;
-			static std::uint64_t m_FenceValue;
-			static std::uint64_t m_FrameFenceValues[g_NumFrames];
-			static HANDLE m_FenceEvent;
-
-			// SwapChain Variables // 
-
-			static bool m_Fullscreen;
-			
-
-		};
-
-		
-
-
-		
-	}
-}
-
-#endif
+#pragma once
+
+#include "Header.h"
+#include "HelperFile.h"
+#include "CopyQueue.h"
+#include "QueueSchedulerD3D12.h"
+#include "DrawBatcherD3D12.h"
+#include "BindlessHeapD3D12.h"
+#include "IndirectDrawsD3D12.h"
+#include "ConstantAllocatorD3D12.h"
+#include "ResidencyManagerD3D12.h"
+#include "FrameArena.h"
+#include "MemoryTracker.h"
+#include "RenderStats.h"
+#include "TextOverlayD3D12.h"
+#include "CommandTraceD3D12.h"
+#include "Platform.h"
+#include "SimulationPipeline.h"
+#include "DeferredRelease.h"
+#include "DynamicResolutionD3D12.h"
+#include "FramePacing.h"
+
+#include <string>
+#include <vector>
+
+
+#ifndef EngineCore_h
+#define EngineCore_H
+
+// Global Variables to see the state of the engine //
+
+const std::uint8_t g_NumFrames = 3;
+bool g_UseWarp = false;
+
+std::uint16_t g_ClientWidth = 1920;
+std::uint16_t g_ClientHeight = 1080;
+
+// By default, enable V-Sync.
+// Can be toggled with the V key.
+
+bool g_VSync = true;
+bool g_TearingSupported = false;
+
+// Headless renders offscreen with no window, --frames stops it after that many frames //
+
+bool g_Headless = false;
+std::uint64_t g_HeadlessFrames = 0;
+
+// Low latency waits on the swap chain's frame latency object and delays input sampling, --low-latency //
+
+bool g_LowLatency = false;
+
+// Cooked mesh whose geometry the GPU driven scene draws, --scene //
+
+std::string g_ScenePath;
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		class EngineCore
+		{
+		public:
+
+			// Presents to the platform's window, or renders offscreen when it has none //
+
+			explicit EngineCore(Platform& platform);
+			~EngineCore();
+
+			static void update();
+			static void render();
+
+			// Frames, keys and resizes from the platform layer //
+
+			static void OnEvent(const PlatformEvent& event);
+
+			// helper function //
+
+			static void CommandLineParsing(const std::vector<std::string>& arguments);
+			static void Enable_DebugD3D12_Layer();
+			static HANDLE CreateEventHandle();
+
+			// Only records the size, render() applies the latest one at the start of its frame once sizing is over //
+
+			static void ResizeWindow(std::uint32_t width, std::uint32_t height, bool sizing = false);	
+			// Control Function //
+
+			static std::uint64_t Signal(ComPtr<ID3D12CommandQueue> commandQueue, ComPtr<ID3D12Fence> fence, std::uint64_t& fenceValue);
+			static void WaitFenceValue(ComPtr<ID3D12Fence> fence, std::uint64_t fenceValue, HANDLE fenceEvent, std::chrono::milliseconds duration = std::chrono::milliseconds::max());
+			static void flush(ComPtr<ID3D12CommandQueue> commandQueue, ComPtr<ID3D12Fence> fence, std::uint64_t& fenceValue, HANDLE fenceEvent);
+
+			// The frame being recorded reads data uploaded by the copy queue up to copyFenceValue //
+
+			static void WaitForUpload(std::uint64_t copyFenceValue);
+
+			// Maps the --scene mesh and uploads its streams as the GPU driven scene geometry //
+
+			static void LoadScene();
+
+			// Records and submits the frame's passes on the direct and async compute queues. //
+			// Must be called between the frame fence wait and the frame fence signal. //
+
+			static void ExecutePasses(const QueueScheduler& scheduler);
+
+			// Frees a bindless descriptor once the frame being recorded has completed on the GPU //
+
+			static void ReleaseDescriptor(BindlessHandle handle);
+
+			// Releases a resource once the frame being recorded has completed on the GPU //
+
+			static void DeferRelease(ComPtr<ID3D12Resource> resource);
+
+			// Keeps a tracked heap or resource resident for the frame being recorded //
+
+			static void MarkResident(ResidencyHandle handle);
+
+			// Runs step every stepSeconds on the thread pool, one frame ahead of rendering //
+			/*
+			   update() hands the frame time to the simulation and submits the draws of the
+			   previous frame's simulation, interpolated between its last two steps, while
+			   the next one runs. Call before the first frame.
+			*/
+
+			static void SetSimulation(double stepSeconds, SimulationPipeline::StepFunction step);
+
+			// Bounds and GPU frame time target of the scene's render scale, may change between frames //
+
+			static void SetDynamicResolution(const DynamicResolutionSettings& settings);
+
+			static void UpdateRenderTargetViews(ComPtr<ID3D12Device2>device, ComPtr<IDXGISwapChain4> swapChain, ComPtr<ID3D12DescriptorHeap> descriptorHeap);
+			static void CreateOffscreenTargets(ComPtr<ID3D12Device2> device, ComPtr<ID3D12DescriptorHeap> descriptorHeap, std::uint32_t width, std::uint32_t height);
+			static bool CheckTearingSupport();
+
+			// Getters // 
+
+			ComPtr<ID3D12Device2> Device();
+			ComPtr<IDXGISwapChain4> SwapChain();
+			ComPtr<ID3D12DescriptorHeap> DescriptorHeap();
+			ComPtr<ID3D12CommandQueue> CommandQueue();
+			Core::CopyQueue& UploadQueue();
+			ComPtr<ID3D12CommandQueue> ComputeQueue();
+			QueueSchedulerD3D12& Scheduler();
+			DrawBatcher& Draws();
+			DrawBatcherD3D12& DrawRecorder();
+			BindlessHeapD3D12& Bindless();
+			ComPtr<ID3D12RootSignature> RootSignature();
+			IndirectDrawsD3D12& IndirectDraws();
+			ConstantAllocatorD3D12& Constants();
+			ResidencyManagerD3D12& Residency();
+			FrameArena& FrameMemory();
+			TextOverlay& Hud();
+			DynamicResolutionD3D12& DynamicResolution();
+			ComPtr<ID3D12Fence> Fence();
+			std::uint64_t FenceValue();
+
+
+		private :
+			// Device Creation Function //
+
+			ComPtr<IDXGIAdapter4> GetAdapter(bool useWarp);
+			ComPtr<ID3D12Device2> CreateDevice(ComPtr<IDXGIAdapter4> adapter);
+			ComPtr<ID3D12CommandQueue> CreateCommandQueue(ComPtr<ID3D12Device2> device, D3D12_COMMAND_LIST_TYPE type);
+			ComPtr<ID3D12CommandAllocator> CreateCommandAllocator(ComPtr<ID3D12Device2> device, D3D12_COMMAND_LIST_TYPE type);
+			ComPtr<ID3D12GraphicsCommandList> CreateCommandList(ComPtr<ID3D12Device2> device, ComPtr<ID3D12CommandAllocator> commandAllocator, D3D12_COMMAND_LIST_TYPE type);
+			ComPtr<ID3D12Fence> CreateFence(ComPtr<ID3D12Device2> device);
+
+			ComPtr<IDXGISwapChain4> CreateSwapChain(HWND hWnd, ComPtr<ID3D12CommandQueue>commandQueue, std::uint32_t width, std::uint32_t height, std::uint32_t bufferCount);
+			ComPtr<ID3D12DescriptorHeap> CreateDescriptor(ComPtr<ID3D12Device2> device, D3D12_DESCRIPTOR_HEAP_TYPE type, std::uint32_t numDescriptors);
+
+			// Waits for the frames still using the old back buffers before resizing the swap chain, once per settled size //
+
+			static void ApplyPendingResize();
+
+			// Waits until the next frame can start just in time in low latency mode, then stamps its input //
+
+			static void BeginFrame();
+
+			// Display times of past presents and the refresh period, from the swap chain statistics //
+
+			static void ReadPresentStatistics();
+
+
+		private :
+
+			static ComPtr<ID3D12Device2> m_Device;
+			static ComPtr<ID3D12CommandQueue> m_CommandQueue;
+			static ComPtr<IDXGISwapChain4> m_SwapChain;
+			static ComPtr<ID3D12Resource> m_BackBuffers[g_NumFrames];
+			static ComPtr<ID3D12DescriptorHeap> m_RTVDescriptorHeap;
+			static UINT m_RTVDescriptorSize;
+			static UINT m_CurrentBackBufferIndex;
+
+			// Synchronization objects //
+
+			static ComPtr<ID3D12Fence> m_Fence;
+			static std::uint64_t m_FenceValue;
+			static std::uint64_t m_FrameFenceValues[g_NumFrames];
+			static HANDLE m_FenceEvent;
+
+			// Resources kept until the frames using them have retired, old back buffers among them //
+
+			static DeferredReleaseQueue<ComPtr<ID3D12Resource>> m_DeferredReleases;
+
+			// Latest size asked for, applied once per frame; held while the border is dragged //
+
+			static std::uint32_t m_PendingWidth;
+			static std::uint32_t m_PendingHeight;
+			static bool m_ResizePending;
+			static bool m_ResizeHeld;
+
+			// Copy queue used for every upload and readback //
+
+			static std::unique_ptr<Core::CopyQueue> m_CopyQueue;
+			static std::uint64_t m_RequiredCopyFenceValue;
+
+			// Async compute queue and the scheduler spreading passes over both queues //
+
+			static ComPtr<ID3D12CommandQueue> m_ComputeQueue;
+			static std::unique_ptr<QueueSchedulerD3D12> m_Scheduler;
+
+			// The engine's own passes, the indirect draws' cull runs on the compute queue next to the scene //
+
+			static QueueScheduler m_Passes;
+			static PassId m_ScenePass;
+			static PassId m_IndirectCullPass;
+			static PassId m_CompositePass;
+
+			// Scene draws submitted for the frame, merged into instanced draws in render() //
+
+			static DrawBatcher m_DrawBatcher;
+			static std::unique_ptr<DrawBatcherD3D12> m_DrawRecorder;
+
+			// Global shader-visible descriptor heaps, materials bind as root constant indices //
+
+			static std::unique_ptr<BindlessHeapD3D12> m_Bindless;
+			static ComPtr<ID3D12RootSignature> m_RootSignature;
+
+			// GPU culled scene objects, drawn with a single ExecuteIndirect //
+
+			static std::unique_ptr<IndirectDrawsD3D12> m_IndirectDraws;
+
+			// Per draw constant data, one slot per frame in flight //
+
+			static std::unique_ptr<ConstantAllocatorD3D12> m_Constants;
+
+			// Evicts least recently used heaps when the video memory budget shrinks //
+
+			static std::unique_ptr<ResidencyManagerD3D12> m_Residency;
+
+			// Fixed step simulation overlapping the render thread's submission //
+
+			static std::unique_ptr<SimulationPipeline> m_Simulation;
+
+			// Scene rendered at a scale held to a GPU frame time, upscaled to the back buffer //
+
+			static DynamicResolutionSettings m_ResolutionSettings;
+			static std::unique_ptr<DynamicResolutionD3D12> m_DynamicResolution;
+
+			// Input to present stamps of every frame and the pacing of low latency mode //
+
+			static HANDLE m_FrameLatencyWaitable;
+			static FramePacer m_Pacer;
+			static FrameLatencyTracker m_Latency;
+			static FrameStamps m_FrameStamps;
+			static double m_FrameInput;				// input sampled for the frame being recorded
+			static double m_SimulatedInput;			// input the simulation in flight started from
+			static std::uint64_t m_PacedGpuSamples;
+			static std::uint64_t m_PresentId;
+			static UINT m_LastSyncRefreshCount;
+			static double m_LastSyncTime;
+			static double m_RefreshPeriod;
+
+			// Transient CPU data of the frame being recorded, rewound with its command allocator //
+
+			static FrameArena m_FrameArena;
+
+			// Performance HUD drawn over the frame, toggled with the H key //
+
+			static TextOverlay m_Hud;
+			static std::unique_ptr<TextOverlayD3D12> m_HudRenderer;
+
+			// Window and events, or none when headless //
+
+			static Platform* m_Platform;
+			
+
+		};
+
+		
+
+
+		
+	}
+}
+
+#endif
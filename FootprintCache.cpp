@@ -0,0 +1,131 @@
+#include "FootprintCache.h"
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		namespace
+		{
+			// FNV-1a, fed field by field so struct padding never reaches the hash //
+
+			template<typename T>
+			void HashValue(std::uint64_t& hash, const T& value)
+			{
+				const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+				for (std::size_t i = 0; i < sizeof(T); ++i)
+				{
+					hash ^= bytes[i];
+					hash *= 0x100000001B3ull;
+				}
+			}
+		}
+
+		bool FootprintCache::Key::operator==(const Key& other) const
+		{
+			return Desc.Dimension == other.Desc.Dimension && Desc.Width == other.Desc.Width && Desc.Height == other.Desc.Height &&
+				Desc.DepthOrArraySize == other.Desc.DepthOrArraySize && Desc.MipLevels == other.Desc.MipLevels && Desc.Format == other.Desc.Format &&
+				FirstSubresource == other.FirstSubresource && NumSubresources == other.NumSubresources;
+		}
+
+		std::size_t FootprintCache::KeyHash::operator()(const Key& key) const
+		{
+			std::uint64_t hash = 0xCBF29CE484222325ull;
+			HashValue(hash, key.Desc.Dimension);
+			HashValue(hash, key.Desc.Width);
+			HashValue(hash, key.Desc.Height);
+			HashValue(hash, key.Desc.DepthOrArraySize);
+			HashValue(hash, key.Desc.MipLevels);
+			HashValue(hash, key.Desc.Format);
+			HashValue(hash, key.FirstSubresource);
+			HashValue(hash, key.NumSubresources);
+			return static_cast<std::size_t>(hash);
+		}
+
+		FootprintCache::FootprintCache(FootprintFunction compute, std::uint32_t capacity)
+			: m_Compute(compute)
+			, m_Capacity(capacity > 0 ? capacity : 1)
+		{
+		}
+
+		std::shared_ptr<const SubresourceFootprints> FootprintCache::Get(const FootprintDesc& desc, std::uint32_t firstSubresource, std::uint32_t numSubresources)
+		{
+			const Key key = { desc, firstSubresource, numSubresources };
+
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+
+				auto found = m_Index.find(key);
+				if (found != m_Index.end())
+				{
+					m_Entries.splice(m_Entries.begin(), m_Entries, found->second);
+					m_Stats.Hits++;
+					return found->second->second;
+				}
+
+				m_Stats.Misses++;
+			}
+
+			// Computed outside the lock; two threads missing on the same key both compute it //
+
+			auto footprints = std::make_shared<SubresourceFootprints>();
+			if (!m_Compute(desc, firstSubresource, numSubresources, *footprints))
+			{
+				// Never cached so every caller sees the failure //
+
+				return nullptr;
+			}
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			auto found = m_Index.find(key);
+			if (found != m_Index.end())
+			{
+				return found->second->second;
+			}
+
+			m_Entries.emplace_front(key, footprints);
+			m_Index.emplace(key, m_Entries.begin());
+			EvictOverflow();
+
+			return footprints;
+		}
+
+		void FootprintCache::SetCapacity(std::uint32_t capacity)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Capacity = capacity > 0 ? capacity : 1;
+			EvictOverflow();
+		}
+
+		void FootprintCache::Clear()
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Index.clear();
+			m_Entries.clear();
+		}
+
+		FootprintCacheStats FootprintCache::Stats()
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			FootprintCacheStats stats = m_Stats;
+			stats.Entries = static_cast<std::uint32_t>(m_Entries.size());
+			return stats;
+		}
+
+		void FootprintCache::ResetStats()
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Stats = FootprintCacheStats();
+		}
+
+		void FootprintCache::EvictOverflow()
+		{
+			while (m_Entries.size() > m_Capacity)
+			{
+				m_Index.erase(m_Entries.back().first);
+				m_Entries.pop_back();
+				m_Stats.Evictions++;
+			}
+		}
+	}
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// The D3D12_RESOURCE_DESC fields a copyable footprint depends on, same values //
+		/*
+		   Alignment, sample count, layout and flags do not change a copyable footprint
+		   and are left out, so every texture sharing a size and format shares an entry.
+		*/
+
+		struct FootprintDesc
+		{
+			std::uint32_t Dimension;
+			std::uint64_t Width;
+			std::uint32_t Height;
+			std::uint16_t DepthOrArraySize;
+			std::uint16_t MipLevels;
+			std::uint32_t Format;
+		};
+
+		// Same meaning and layout as D3D12_PLACED_SUBRESOURCE_FOOTPRINT //
+
+		struct PlacedFootprint
+		{
+			std::uint64_t Offset;
+			std::uint32_t Format;
+			std::uint32_t Width;
+			std::uint32_t Height;
+			std::uint32_t Depth;
+			std::uint32_t RowPitch;
+		};
+
+		// Output of D3DX12GetCopyableFootprints for a range of subresources, at base offset 0 //
+
+		struct SubresourceFootprints
+		{
+			std::vector<PlacedFootprint> Layouts;
+			std::vector<std::uint32_t> NumRows;
+			std::vector<std::uint64_t> RowSizes;
+			std::uint64_t TotalBytes = 0;
+		};
+
+		// Fills every vector of footprints for the range, false for a range outside the resource //
+
+		using FootprintFunction = bool (*)(const FootprintDesc& desc, std::uint32_t firstSubresource, std::uint32_t numSubresources,
+			SubresourceFootprints& footprints);
+
+		struct FootprintCacheStats
+		{
+			std::uint64_t Hits = 0;
+			std::uint64_t Misses = 0;
+			std::uint64_t Evictions = 0;
+			std::uint32_t Entries = 0;
+		};
+
+		// LRU cache in front of a footprint function //
+		/*
+		   Keyed by the description plus the subresource range. Entries are handed out as
+		   shared pointers and stay valid after eviction. Callers add their own base offset
+		   to Layouts[i].Offset. Get returns null when the function fails; failures are not
+		   cached. Holds no D3D12 types: FootprintCacheD3D12.h puts one in front of
+		   D3DX12GetCopyableFootprints for the engine.
+		*/
+
+		class FootprintCache
+		{
+		public:
+
+			explicit FootprintCache(FootprintFunction compute, std::uint32_t capacity = 1024);
+
+			FootprintCache(const FootprintCache&) = delete;
+			FootprintCache& operator=(const FootprintCache&) = delete;
+
+			std::shared_ptr<const SubresourceFootprints> Get(const FootprintDesc& desc, std::uint32_t firstSubresource, std::uint32_t numSubresources);
+
+			void SetCapacity(std::uint32_t capacity);
+			void Clear();
+
+			FootprintCacheStats Stats();
+			void ResetStats();
+
+		private:
+
+			struct Key
+			{
+				FootprintDesc Desc;
+				std::uint32_t FirstSubresource;
+				std::uint32_t NumSubresources;
+
+				bool operator==(const Key& other) const;
+			};
+
+			struct KeyHash
+			{
+				std::size_t operator()(const Key& key) const;
+			};
+
+			using Entry = std::pair<Key, std::shared_ptr<const SubresourceFootprints>>;
+
+			void EvictOverflow();
+
+		private:
+
+			FootprintFunction m_Compute;
+			std::uint32_t m_Capacity;
+			std::list<Entry> m_Entries;	// most recently used first
+			std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_Index;
+			FootprintCacheStats m_Stats;
+			std::mutex m_Mutex;
+		};
+	}
+}
@@ -0,0 +1,57 @@
+#include "FootprintCacheD3D12.h"
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		FootprintDesc ToFootprintDesc(const D3D12_RESOURCE_DESC& desc)
+		{
+			return { static_cast<std::uint32_t>(desc.Dimension), desc.Width, desc.Height, desc.DepthOrArraySize, desc.MipLevels,
+				static_cast<std::uint32_t>(desc.Format) };
+		}
+
+		bool ComputeCopyableFootprints(const FootprintDesc& desc, std::uint32_t firstSubresource, std::uint32_t numSubresources,
+			SubresourceFootprints& footprints)
+		{
+			CD3DX12_RESOURCE_DESC1 resourceDesc = {};
+			resourceDesc.Dimension = static_cast<D3D12_RESOURCE_DIMENSION>(desc.Dimension);
+			resourceDesc.Width = desc.Width;
+			resourceDesc.Height = desc.Height;
+			resourceDesc.DepthOrArraySize = desc.DepthOrArraySize;
+			resourceDesc.MipLevels = desc.MipLevels;
+			resourceDesc.Format = static_cast<DXGI_FORMAT>(desc.Format);
+			resourceDesc.SampleDesc.Count = 1;
+
+			// D3DX12GetCopyableFootprints fills subresources past the end with ~0 and still succeeds //
+
+			const UINT subresourceCount = static_cast<UINT>(desc.MipLevels) * resourceDesc.ArraySize() *
+				D3D12_PROPERTY_LAYOUT_FORMAT_TABLE::GetPlaneCount(resourceDesc.Format);
+			if (firstSubresource > subresourceCount || numSubresources > subresourceCount - firstSubresource)
+			{
+				return false;
+			}
+
+			footprints.Layouts.resize(numSubresources);
+			footprints.NumRows.resize(numSubresources);
+			footprints.RowSizes.resize(numSubresources);
+
+			// A layout that overflows comes back all ~0 and fails //
+
+			return D3DX12GetCopyableFootprints(resourceDesc, firstSubresource, numSubresources, 0,
+				reinterpret_cast<D3D12_PLACED_SUBRESOURCE_FOOTPRINT*>(footprints.Layouts.data()), footprints.NumRows.data(),
+				footprints.RowSizes.data(), &footprints.TotalBytes);
+		}
+
+		std::shared_ptr<const SubresourceFootprints> GetCopyableFootprints(const D3D12_RESOURCE_DESC& desc, std::uint32_t firstSubresource,
+			std::uint32_t numSubresources)
+		{
+			return CopyableFootprintCache().Get(ToFootprintDesc(desc), firstSubresource, numSubresources);
+		}
+
+		FootprintCache& CopyableFootprintCache()
+		{
+			static FootprintCache cache(ComputeCopyableFootprints);
+			return cache;
+		}
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Header.h"
+#include "FootprintCache.h"
+
+#include <cstddef>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		static_assert(sizeof(PlacedFootprint) == sizeof(D3D12_PLACED_SUBRESOURCE_FOOTPRINT) &&
+			offsetof(PlacedFootprint, Format) == offsetof(D3D12_PLACED_SUBRESOURCE_FOOTPRINT, Footprint.Format) &&
+			offsetof(PlacedFootprint, RowPitch) == offsetof(D3D12_PLACED_SUBRESOURCE_FOOTPRINT, Footprint.RowPitch),
+			"PlacedFootprint must match D3D12_PLACED_SUBRESOURCE_FOOTPRINT.");
+
+		FootprintDesc ToFootprintDesc(const D3D12_RESOURCE_DESC& desc);
+
+		inline const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& ToD3D12(const PlacedFootprint& footprint)
+		{
+			return reinterpret_cast<const D3D12_PLACED_SUBRESOURCE_FOOTPRINT&>(footprint);
+		}
+
+		// D3DX12GetCopyableFootprints as a FootprintFunction //
+
+		bool ComputeCopyableFootprints(const FootprintDesc& desc, std::uint32_t firstSubresource, std::uint32_t numSubresources,
+			SubresourceFootprints& footprints);
+
+		// Through the FootprintCache CopyQueue and the texture streamer share, null for a range outside the resource //
+
+		std::shared_ptr<const SubresourceFootprints> GetCopyableFootprints(const D3D12_RESOURCE_DESC& desc, std::uint32_t firstSubresource,
+			std::uint32_t numSubresources);
+
+		FootprintCache& CopyableFootprintCache();
+	}
+}
@@ -0,0 +1,186 @@
+#include "FrameArena.h"
+#include "MemoryTracker.h"
+#include "ThreadEpochCache.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		namespace
+		{
+			// Block a thread is bumping in, tagged with the arena frame it was taken in //
+
+			struct ThreadBlock
+			{
+				std::uint64_t Epoch = 0;
+				void* Block = nullptr;
+				std::uint8_t* Data = nullptr;
+				std::size_t Offset = 0;
+				std::size_t Size = 0;
+			};
+
+			std::size_t AlignUp(std::size_t value, std::size_t alignment)
+			{
+				return (value + alignment - 1) & ~(alignment - 1);
+			}
+		}
+
+		void FrameArena::BlockDelete::operator()(std::uint8_t* data) const
+		{
+			TaggedFree(data);
+		}
+
+		FrameArena::FrameArena(std::uint32_t framesInFlight, std::size_t blockSize)
+			: m_BlockSize(AlignUp(std::max<std::size_t>(blockSize, 4096), g_FrameArenaBlockAlignment))
+			, m_Slots(std::max(framesInFlight, 1u))
+		{
+			m_Epoch = NextThreadEpoch();
+		}
+
+		void FrameArena::CollectFrame()
+		{
+			Slot& slot = m_Slots[m_FrameIndex];
+
+			FrameArenaStats frame;
+			for (std::size_t i = 0; i < slot.TakenBlocks; ++i)
+			{
+				Block& block = *slot.Blocks[i];
+				frame.Bytes += block.Used.exchange(0, std::memory_order_relaxed);
+				frame.Allocations += block.Allocations.exchange(0, std::memory_order_relaxed);
+				frame.ReservedBytes += block.Size;
+			}
+
+			slot.HighWaterBytes = std::max(slot.HighWaterBytes, frame.Bytes);
+			slot.HighWaterReservedBytes = std::max(slot.HighWaterReservedBytes, frame.ReservedBytes);
+
+			frame.HighWaterBytes = std::max(m_LastFrame.HighWaterBytes, frame.Bytes);
+			frame.HighWaterReservedBytes = std::max(m_LastFrame.HighWaterReservedBytes, frame.ReservedBytes);
+			m_LastFrame = frame;
+		}
+
+		void FrameArena::BeginFrame(std::uint32_t frameIndex)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			assert(frameIndex < m_Slots.size() && "Frame index out of range.");
+
+			CollectFrame();
+
+			// A new epoch retires every thread's block, the slot's blocks are all free again //
+
+			m_FrameIndex = frameIndex;
+			m_Slots[frameIndex].TakenBlocks = 0;
+			m_Epoch = NextThreadEpoch();
+		}
+
+		FrameArena::Block* FrameArena::TakeBlock(std::size_t minimumSize)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			Slot& slot = m_Slots[m_FrameIndex];
+
+			// First free block big enough, swapped to the end of the taken range //
+
+			std::size_t found = slot.Blocks.size();
+			for (std::size_t i = slot.TakenBlocks; i < slot.Blocks.size(); ++i)
+			{
+				if (slot.Blocks[i]->Size >= minimumSize)
+				{
+					found = i;
+					break;
+				}
+			}
+
+			if (found == slot.Blocks.size())
+			{
+				auto block = std::make_unique<Block>();
+				block->Size = std::max(m_BlockSize, AlignUp(minimumSize, m_BlockSize));
+				block->Data.reset(static_cast<std::uint8_t*>(TaggedAllocate(block->Size, g_FrameArenaBlockAlignment, MemoryTag::Frame)));
+
+				m_OwnedBytes += block->Size;
+				m_HeapAllocations++;
+				slot.Blocks.push_back(std::move(block));
+			}
+
+			std::swap(slot.Blocks[found], slot.Blocks[slot.TakenBlocks]);
+			return slot.Blocks[slot.TakenBlocks++].get();
+		}
+
+		void* FrameArena::Allocate(std::size_t size, std::size_t alignment)
+		{
+			assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && alignment <= g_FrameArenaBlockAlignment && "Unsupported frame arena alignment.");
+
+			size = std::max<std::size_t>(size, 1);
+
+			// Big allocations get a block of their own and leave the thread's block alone //
+
+			if (size > m_BlockSize / 4)
+			{
+				Block* block = TakeBlock(size);
+				block->Used.store(size, std::memory_order_relaxed);
+				block->Allocations.store(1, std::memory_order_relaxed);
+				return block->Data.get();
+			}
+
+			ThreadBlock& current = FindThreadEntry<ThreadBlock>(m_Epoch);
+			std::size_t offset = AlignUp(current.Offset, alignment);
+
+			if (current.Epoch != m_Epoch || offset + size > current.Size)
+			{
+				Block* block = TakeBlock(m_BlockSize);
+				current.Epoch = m_Epoch;
+				current.Block = block;
+				current.Data = block->Data.get();
+				current.Size = block->Size;
+				offset = 0;
+			}
+
+			current.Offset = offset + size;
+
+			// Only this thread writes the block's usage, plain relaxed stores are enough //
+
+			Block& block = *static_cast<Block*>(current.Block);
+			block.Used.store(block.Used.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+			block.Allocations.store(block.Allocations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+			return current.Data + offset;
+		}
+
+		FrameArenaStats FrameArena::Stats() const
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			FrameArenaStats stats = m_LastFrame;
+			stats.OwnedBytes = m_OwnedBytes;
+			stats.HeapAllocations = m_HeapAllocations;
+			return stats;
+		}
+
+		std::string FrameArena::HighWaterReport() const
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			std::string report;
+			char line[160];
+
+			for (std::size_t i = 0; i < m_Slots.size(); ++i)
+			{
+				const Slot& slot = m_Slots[i];
+				std::snprintf(line, sizeof(line), "Frame arena slot %zu: high water %llu KB used, %llu KB reserved, %zu blocks\n", i,
+					static_cast<unsigned long long>(slot.HighWaterBytes / 1024), static_cast<unsigned long long>(slot.HighWaterReservedBytes / 1024), slot.Blocks.size());
+				report += line;
+			}
+
+			std::snprintf(line, sizeof(line), "Frame arena: %llu KB owned, %llu heap allocations, last frame %llu KB in %llu allocations\n",
+				static_cast<unsigned long long>(m_OwnedBytes / 1024), static_cast<unsigned long long>(m_HeapAllocations),
+				static_cast<unsigned long long>(m_LastFrame.Bytes / 1024), static_cast<unsigned long long>(m_LastFrame.Allocations));
+			report += line;
+
+			return report;
+		}
+	}
+}
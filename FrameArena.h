@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// Alignment of the arena blocks, the largest alignment Allocate() accepts //
+
+		constexpr std::size_t g_FrameArenaBlockAlignment = 64;
+
+		struct FrameArenaStats
+		{
+			std::uint64_t Bytes = 0;				// handed out during the last frame
+			std::uint64_t Allocations = 0;
+			std::uint64_t ReservedBytes = 0;		// blocks taken by threads during the last frame
+			std::uint64_t HighWaterBytes = 0;		// largest Bytes of any frame
+			std::uint64_t HighWaterReservedBytes = 0;
+			std::uint64_t OwnedBytes = 0;			// blocks owned by every slot
+			std::uint64_t HeapAllocations = 0;		// blocks taken from the general heap so far
+		};
+
+		// Transient CPU memory for one frame in flight, released wholesale //
+		/*
+		   One slot per frame in flight, indexed like the command allocators. BeginFrame()
+		   rewinds the slot once its previous frame's fence has completed, everything
+		   allocated in it during that frame is gone at once and nothing is ever freed on
+		   its own. Each thread bumps inside a block of its own, only taking the arena's
+		   lock to grab the next block, so steady state frames neither contend nor touch
+		   the general heap: blocks are kept by their slot and reused.
+		*/
+
+		class FrameArena
+		{
+		public:
+
+			FrameArena(std::uint32_t framesInFlight, std::size_t blockSize = 256 * 1024);
+
+			FrameArena(const FrameArena&) = delete;
+			FrameArena& operator=(const FrameArena&) = delete;
+
+			// Ends the current frame and rewinds frameIndex, no Allocate() may run concurrently //
+
+			void BeginFrame(std::uint32_t frameIndex);
+
+			// alignment is a power of two up to g_FrameArenaBlockAlignment //
+
+			void* Allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+
+			template<typename T, typename... Args>
+			T* New(Args&&... args)
+			{
+				static_assert(std::is_trivially_destructible<T>::value, "Frame memory is never destroyed.");
+				return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+			}
+
+			FrameArenaStats Stats() const;
+
+			// One line per slot plus the totals, for logs //
+
+			std::string HighWaterReport() const;
+
+		private:
+
+			struct BlockDelete
+			{
+				void operator()(std::uint8_t* data) const;
+			};
+
+			struct Block
+			{
+				std::unique_ptr<std::uint8_t[], BlockDelete> Data;
+				std::size_t Size = 0;
+				std::atomic<std::size_t> Used{ 0 };			// written by the owning thread only
+				std::atomic<std::uint64_t> Allocations{ 0 };
+			};
+
+			struct Slot
+			{
+				std::vector<std::unique_ptr<Block>> Blocks;
+				std::size_t TakenBlocks = 0;				// Blocks[0, TakenBlocks) belong to the slot's frame
+				std::uint64_t HighWaterBytes = 0;
+				std::uint64_t HighWaterReservedBytes = 0;
+			};
+
+			Block* TakeBlock(std::size_t minimumSize);
+			void CollectFrame();
+
+		private:
+
+			std::size_t m_BlockSize;
+			std::vector<Slot> m_Slots;
+			std::uint32_t m_FrameIndex = 0;
+			std::uint64_t m_Epoch = 0;
+			std::uint64_t m_OwnedBytes = 0;
+			std::uint64_t m_HeapAllocations = 0;
+			FrameArenaStats m_LastFrame;
+			mutable std::mutex m_Mutex;
+		};
+
+		// Standard allocator over the current frame of an arena, deallocate() does nothing //
+		/*
+		   Containers using it must not outlive the frame. Growth leaves the old storage
+		   behind until the slot is rewound, so reserve() up front when the size is known.
+		*/
+
+		template<typename T>
+		class FrameAllocator
+		{
+		public:
+
+			using value_type = T;
+
+			explicit FrameAllocator(FrameArena& arena) : m_Arena(&arena) {}
+
+			template<typename U>
+			FrameAllocator(const FrameAllocator<U>& other) : m_Arena(other.Arena()) {}
+
+			T* allocate(std::size_t count) { return static_cast<T*>(m_Arena->Allocate(count * sizeof(T), alignof(T))); }
+			void deallocate(T*, std::size_t) {}
+
+			FrameArena* Arena() const { return m_Arena; }
+
+			template<typename U>
+			bool operator==(const FrameAllocator<U>& other) const { return m_Arena == other.Arena(); }
+			template<typename U>
+			bool operator!=(const FrameAllocator<U>& other) const { return m_Arena != other.Arena(); }
+
+		private:
+
+			FrameArena* m_Arena;
+		};
+
+		template<typename T>
+		using FrameVector = std::vector<T, FrameAllocator<T>>;
+	}
+}
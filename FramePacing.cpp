@@ -0,0 +1,260 @@
+#include "FramePacing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		namespace
+		{
+			// Nearest rank percentile, sorts values in place //
+
+			double Percentile(std::vector<double>& values, double percentile)
+			{
+				if (values.empty())
+				{
+					return 0.0;
+				}
+
+				const std::size_t rank = static_cast<std::size_t>(std::ceil(percentile * values.size()));
+				const std::size_t index = std::min(std::max<std::size_t>(rank, 1), values.size()) - 1;
+
+				std::nth_element(values.begin(), values.begin() + index, values.end());
+				return values[index];
+			}
+
+			LatencyPercentiles Percentiles(std::vector<double>& values)
+			{
+				LatencyPercentiles percentiles;
+				percentiles.Samples = static_cast<std::uint32_t>(values.size());
+				percentiles.P50 = Percentile(values, 0.5);
+				percentiles.P90 = Percentile(values, 0.9);
+				percentiles.P99 = Percentile(values, 0.99);
+				return percentiles;
+			}
+		}
+
+		double FrameClockMilliseconds()
+		{
+			return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		void SleepPrecise(double milliseconds)
+		{
+			const double end = FrameClockMilliseconds() + milliseconds;
+
+			if (milliseconds > 2.0)
+			{
+				std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(milliseconds - 2.0));
+			}
+
+			while (FrameClockMilliseconds() < end)
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		FrameLatencyTracker::FrameLatencyTracker(std::uint32_t historyFrames, std::uint32_t maxPending)
+			: m_Capacity(std::max(historyFrames, 1u))
+			, m_MaxPending(std::max(maxPending, 1u))
+		{
+			m_History.reserve(m_Capacity);
+		}
+
+		void FrameLatencyTracker::Record(const FrameStamps& stamps)
+		{
+			if (m_History.size() < m_Capacity)
+			{
+				m_History.push_back(stamps);
+			}
+			else
+			{
+				m_History[m_Next] = stamps;
+			}
+
+			m_Next = (m_Next + 1) % m_Capacity;
+		}
+
+		void FrameLatencyTracker::Presented(std::uint64_t presentId, const FrameStamps& stamps)
+		{
+			m_Pending.push_back({ presentId, stamps });
+
+			if (m_Pending.size() > m_MaxPending)
+			{
+				Record(m_Pending.front().Stamps);
+				m_Pending.erase(m_Pending.begin());
+			}
+		}
+
+		void FrameLatencyTracker::Displayed(std::uint64_t presentId, double displayTime)
+		{
+			// Presents up to presentId are all settled, those skipped by the display have no time //
+
+			std::size_t settled = 0;
+			while (settled < m_Pending.size() && m_Pending[settled].PresentId <= presentId)
+			{
+				FrameStamps& stamps = m_Pending[settled].Stamps;
+				if (m_Pending[settled].PresentId == presentId)
+				{
+					stamps.Display = displayTime;
+				}
+
+				Record(stamps);
+				settled++;
+			}
+
+			m_Pending.erase(m_Pending.begin(), m_Pending.begin() + settled);
+		}
+
+		FrameLatencyReport FrameLatencyTracker::Report() const
+		{
+			FrameLatencyReport report;
+
+			std::vector<double> present;
+			std::vector<double> display;
+			present.reserve(m_History.size());
+
+			for (const FrameStamps& stamps : m_History)
+			{
+				present.push_back(stamps.Present - stamps.Input);
+				if (stamps.Display > 0.0)
+				{
+					display.push_back(stamps.Display - stamps.Input);
+				}
+
+				report.InputToSimulate += stamps.Simulate - stamps.Input;
+				report.SimulateToSubmit += stamps.Submit - stamps.Simulate;
+				report.SubmitToPresent += stamps.Present - stamps.Submit;
+			}
+
+			if (!m_History.empty())
+			{
+				const double scale = 1.0 / static_cast<double>(m_History.size());
+				report.InputToSimulate *= scale;
+				report.SimulateToSubmit *= scale;
+				report.SubmitToPresent *= scale;
+			}
+
+			report.InputToPresent = Percentiles(present);
+			report.InputToDisplay = Percentiles(display);
+
+			return report;
+		}
+
+		std::string FrameLatencyTracker::Format(const FrameLatencyReport& report)
+		{
+			char buffer[160];
+			int length = std::snprintf(buffer, sizeof(buffer), "p50/p90/p99 %.1f / %.1f / %.1f ms",
+				report.InputToPresent.P50, report.InputToPresent.P90, report.InputToPresent.P99);
+
+			if (report.InputToDisplay.Samples != 0 && length > 0 && static_cast<std::size_t>(length) < sizeof(buffer))
+			{
+				std::snprintf(buffer + length, sizeof(buffer) - length, ", display %.1f / %.1f / %.1f ms",
+					report.InputToDisplay.P50, report.InputToDisplay.P90, report.InputToDisplay.P99);
+			}
+
+			return buffer;
+		}
+
+		FramePacer::FramePacer(const FramePacingSettings& settings)
+			: m_Settings(settings)
+		{
+			m_Settings.MarginMilliseconds = std::max(settings.MarginMilliseconds, 0.0);
+			m_Settings.Percentile = std::min(std::max(settings.Percentile, 0.0f), 1.0f);
+			m_Settings.History = std::max(settings.History, 1u);
+		}
+
+		void FramePacer::SetDisplayTiming(double vblankTime, double refreshPeriod)
+		{
+			m_VblankTime = vblankTime;
+			m_RefreshPeriod = std::max(refreshPeriod, 0.0);
+		}
+
+		void FramePacer::Add(Samples& samples, double milliseconds)
+		{
+			if (samples.Values.size() < m_Settings.History)
+			{
+				samples.Values.push_back(milliseconds);
+			}
+			else
+			{
+				samples.Values[samples.Next] = milliseconds;
+			}
+
+			samples.Next = (samples.Next + 1) % m_Settings.History;
+		}
+
+		void FramePacer::RecordCpu(double milliseconds)
+		{
+			Add(m_Cpu, std::max(milliseconds, 0.0));
+		}
+
+		void FramePacer::RecordGpu(double milliseconds)
+		{
+			Add(m_Gpu, std::max(milliseconds, 0.0));
+		}
+
+		double FramePacer::Estimate(const Samples& samples, double percentile) const
+		{
+			std::vector<double> values = samples.Values;
+			return Percentile(values, percentile);
+		}
+
+		double FramePacer::Typical(const Samples& samples) const
+		{
+			const std::size_t latest = (samples.Next + samples.Values.size() - 1) % samples.Values.size();
+			return std::min(Estimate(samples, 0.5), samples.Values[latest]);
+		}
+
+		double FramePacer::NextVblank(double time) const
+		{
+			const double periods = std::ceil((time - m_VblankTime) / m_RefreshPeriod);
+			return m_VblankTime + periods * m_RefreshPeriod;
+		}
+
+		void FramePacer::Submitted(double submitTime)
+		{
+			m_GpuFree = std::max(submitTime, m_GpuFree) + (m_Gpu.Values.empty() ? 0.0 : Typical(m_Gpu));
+
+			if (m_RefreshPeriod > 0.0)
+			{
+				m_LastDisplay = std::max(NextVblank(m_GpuFree), m_LastDisplay + m_RefreshPeriod);
+			}
+		}
+
+		double FramePacer::SleepMilliseconds(double now) const
+		{
+			if (m_Cpu.Values.empty() || m_Gpu.Values.empty())
+			{
+				return 0.0;
+			}
+
+			const double cpu = CpuEstimate();
+			const double gpu = GpuEstimate();
+			const double margin = m_Settings.MarginMilliseconds;
+
+			// Without vsync, or when the GPU can't finish a frame within a refresh, there is no vblank to //
+			// aim at and any time the GPU idles is a frame lost. The frame only waits for the GPU to free up. //
+
+			if (m_RefreshPeriod <= 0.0 || gpu + margin > m_RefreshPeriod)
+			{
+				return std::max(m_GpuFree - cpu - now, 0.0);
+			}
+
+			// When the GPU could start a frame of typical cost sampled right now //
+
+			const double earliestStart = std::max(now + Typical(m_Cpu), m_GpuFree);
+
+			// The vblank such a frame makes without sleeping, the sleep never costs a refresh //
+
+			const double end = NextVblank(std::max(earliestStart + Typical(m_Gpu), m_LastDisplay + m_RefreshPeriod * 0.5)) - margin;
+
+			return std::max(end - gpu - cpu - now, 0.0);
+		}
+	}
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// Milliseconds on the steady clock, the clock every frame stamp and pacing time is on //
+
+		double FrameClockMilliseconds();
+
+		// Sleeps most of the time and yields the last stretch, OS sleeps overshoot by a millisecond or more //
+
+		void SleepPrecise(double milliseconds);
+
+		// When a frame went through each stage, on the frame clock //
+		/*
+		   Input is when the input the frame shows was sampled. Display is when its
+		   present reached the screen, 0 while not known: without vsync statistics, or
+		   headless.
+		*/
+
+		struct FrameStamps
+		{
+			double Input = 0.0;
+			double Simulate = 0.0;
+			double Submit = 0.0;
+			double Present = 0.0;
+			double Display = 0.0;
+		};
+
+		struct LatencyPercentiles
+		{
+			double P50 = 0.0;
+			double P90 = 0.0;
+			double P99 = 0.0;
+			std::uint32_t Samples = 0;
+		};
+
+		struct FrameLatencyReport
+		{
+			LatencyPercentiles InputToPresent;
+			LatencyPercentiles InputToDisplay;		// frames with a display time only
+			double InputToSimulate = 0.0;			// means of each stage
+			double SimulateToSubmit = 0.0;
+			double SubmitToPresent = 0.0;
+		};
+
+		// Latency of the last frames presented //
+		/*
+		   Display times come back from the swap chain statistics frames after the
+		   present, Presented() holds the stamps until Displayed() reaches their present
+		   id. A frame not matched by then, or still waiting with maxPending frames
+		   behind it, is kept without a display time.
+		*/
+
+		class FrameLatencyTracker
+		{
+		public:
+
+			explicit FrameLatencyTracker(std::uint32_t historyFrames = 256, std::uint32_t maxPending = 8);
+
+			// presentId increases with every present //
+
+			void Presented(std::uint64_t presentId, const FrameStamps& stamps);
+			void Displayed(std::uint64_t presentId, double displayTime);
+
+			FrameLatencyReport Report() const;
+
+			// "p50/p90/p99 12.1 / 14.0 / 16.2 ms, display 20.3 / 22.1 / 25.0 ms" //
+
+			static std::string Format(const FrameLatencyReport& report);
+
+		private:
+
+			struct PendingFrame
+			{
+				std::uint64_t PresentId;
+				FrameStamps Stamps;
+			};
+
+			void Record(const FrameStamps& stamps);
+
+		private:
+
+			std::vector<FrameStamps> m_History;		// ring of m_Capacity frames
+			std::uint32_t m_Capacity;
+			std::uint32_t m_Next = 0;
+			std::vector<PendingFrame> m_Pending;
+			std::uint32_t m_MaxPending;
+		};
+
+		struct FramePacingSettings
+		{
+			double MarginMilliseconds = 1.0;		// the frame is paced to finish this much before it is needed
+			float Percentile = 0.9f;				// of recent CPU and GPU times the sleep leaves room for
+			std::uint32_t History = 32;				// frames the estimates look back on
+		};
+
+		// Delays input sampling so the frame finishes just before it is needed //
+		/*
+		   The CPU part of a frame runs from input sampling to submission, then the GPU
+		   starts once it is done with the frames before. Submitted() extends a predicted
+		   GPU timeline with each frame's typical GPU time, the lower of the median and
+		   the latest. With a refresh period, the frame is needed MarginMilliseconds
+		   before the vblank a frame of typical cost would make if started right away;
+		   without one, as soon as the GPU is free. SleepMilliseconds() is how long to
+		   wait before sampling input so that a frame at the Percentile of recent costs
+		   still ends by then, instead of the input growing old in a queue. Aiming
+		   optimistically is what keeps pacing from costing refreshes: a vblank the frame
+		   cannot make leaves no time to sleep, the frame then starts right away as it
+		   would without pacing. Slow frames in the history only shorten the sleep.
+
+		   When the GPU estimate plus the margin is over a refresh, the GPU can't keep up
+		   with the display and any time it idles is a frame lost: the frame then only
+		   waits until it reaches the GPU as the GPU frees up, which is also all it does
+		   without vsync. So pacing helps when the GPU has time to spare in a refresh,
+		   more so the deeper the swap chain queue: the input no longer waits out the
+		   queued frames. A GPU bound game only gets the queue wait removed, with no
+		   change in frame rate. The price is the frames above the Percentile, about
+		   1 - Percentile of them, which miss the vblank they were paced for.
+		*/
+
+		class FramePacer
+		{
+		public:
+
+			explicit FramePacer(const FramePacingSettings& settings = FramePacingSettings());
+
+			// Any past vblank on the frame clock and the refresh period, 0 when presents are not synced //
+
+			void SetDisplayTiming(double vblankTime, double refreshPeriod);
+
+			// Input sampling to submission, and the GPU time of a frame //
+
+			void RecordCpu(double milliseconds);
+			void RecordGpu(double milliseconds);
+
+			// The frame was submitted at submitTime on the frame clock //
+
+			void Submitted(double submitTime);
+
+			// How long to wait from now before sampling input, 0 until both estimates have samples //
+
+			double SleepMilliseconds(double now) const;
+
+			// Getters //
+
+			double CpuEstimate() const { return Estimate(m_Cpu, m_Settings.Percentile); }
+			double GpuEstimate() const { return Estimate(m_Gpu, m_Settings.Percentile); }
+			double GpuFree() const { return m_GpuFree; }
+			const FramePacingSettings& Settings() const { return m_Settings; }
+
+		private:
+
+			struct Samples
+			{
+				std::vector<double> Values;
+				std::uint32_t Next = 0;
+			};
+
+			void Add(Samples& samples, double milliseconds);
+			double Estimate(const Samples& samples, double percentile) const;
+			double Typical(const Samples& samples) const;		// median or latest, the lower, samples must not be empty
+			double NextVblank(double time) const;
+
+		private:
+
+			FramePacingSettings m_Settings;
+			Samples m_Cpu;
+			Samples m_Gpu;
+
+			double m_VblankTime = 0.0;
+			double m_RefreshPeriod = 0.0;
+
+			double m_GpuFree = 0.0;			// predicted end of the GPU work submitted so far
+			double m_LastDisplay = 0.0;		// predicted vblank showing the last frame submitted
+		};
+	}
+}
@@ -1,36 +1,37 @@
-#pragma once
-
-#define  WIN32_LEAN_AND_MEAN
-#include <Windows.h>
-#include <shellapi.h>
-#include <wrl.h>
-#include <string>
-#include <iostream>
-#include <chrono>
-#include <algorithm>
-#include <cassert>
-#include <thread>
-#include <cstdint>
-
-// DirectX 12 specific headers.
-#include <d3d12.h>
-#include <dxgi1_6.h>
-#include <d3dcompiler.h>
-#include <DirectXMath.h>
-
-// D3D12 extension library.
-#include "d3dx12.h"
-
-#if defined(min)
-#undef min
-#endif
-
-#if defined(max)
-#undef max
-#endif
-
-#if defined(CreateWindow)
-#undef CreateWindow
-#endif
-
+#pragma once
+
+#define  WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <shellapi.h>
+#include <wrl.h>
+#include <string>
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <cassert>
+#include <thread>
+#include <cstdint>
+#include <memory>
+
+// DirectX 12 specific headers.
+#include <d3d12.h>
+#include <dxgi1_6.h>
+#include <d3dcompiler.h>
+#include <DirectXMath.h>
+
+// D3D12 extension library.
+#include "d3dx12.h"
+
+#if defined(min)
+#undef min
+#endif
+
+#if defined(max)
+#undef max
+#endif
+
+#if defined(CreateWindow)
+#undef CreateWindow
+#endif
+
 using namespace Microsoft::WRL;
\ No newline at end of file
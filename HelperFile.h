@@ -1,12 +1,12 @@
-#pragma once
-#define WIN32_LEAN_AND_MEAN
-#include <Windows.h>
-#include <exception>
-
-inline void ThrowIfFailed(HRESULT hr)
-{
-	if (FAILED(hr))
-	{
-		throw std::exception();
-	}
+#pragma once
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <exception>
+
+inline void ThrowIfFailed(HRESULT hr)
+{
+	if (FAILED(hr))
+	{
+		throw std::exception();
+	}
 }
\ No newline at end of file
@@ -0,0 +1,195 @@
+#include "IndirectDraws.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		namespace
+		{
+			constexpr std::uint32_t g_VisibleBit = 1u << 31;
+
+			// Groups handed to a pool task at once, the per object work is a few dozen instructions //
+
+			constexpr std::uint32_t g_GroupsPerTask = 16;
+
+			// Rounds a product to float before it is added, no compiler can fuse the two into an FMA //
+			/*
+			   GCC contracts a*b + c by default in GNU modes whatever the pragmas say, a volatile
+			   store is the one rounding point every compiler keeps.
+			*/
+
+			float RoundedProduct(float a, float b)
+			{
+				volatile float product = a * b;
+				return product;
+			}
+		}
+
+		CullFrustum ExtractFrustum(const float viewProjection[4][4])
+		{
+			// Clip space is v * M, so every clip coordinate is a column of the matrix //
+
+			auto column = [&](int c, float out[4])
+			{
+				for (int r = 0; r < 4; ++r)
+				{
+					out[r] = viewProjection[r][c];
+				}
+			};
+
+			float x[4], y[4], z[4], w[4];
+			column(0, x);
+			column(1, y);
+			column(2, z);
+			column(3, w);
+
+			CullFrustum frustum;
+			for (int i = 0; i < 4; ++i)
+			{
+				frustum.Planes[0][i] = w[i] + x[i];		// left
+				frustum.Planes[1][i] = w[i] - x[i];		// right
+				frustum.Planes[2][i] = w[i] + y[i];		// bottom
+				frustum.Planes[3][i] = w[i] - y[i];		// top
+				frustum.Planes[4][i] = z[i];			// near, D3D depth starts at 0
+				frustum.Planes[5][i] = w[i] - z[i];		// far
+			}
+
+			for (float* plane : frustum.Planes)
+			{
+				const float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+				if (length > 0.0f)
+				{
+					for (int i = 0; i < 4; ++i)
+					{
+						plane[i] /= length;
+					}
+				}
+			}
+
+			return frustum;
+		}
+
+		bool IsSceneObjectVisible(const CullFrustum& frustum, const SceneObject& object)
+		{
+			if (object.Flags & g_SceneObjectHidden)
+			{
+				return false;
+			}
+
+			// Matches the "precise" distance of the shader: ((a*x + b*y) + c*z) + d, each step rounded //
+
+			for (const float* plane : frustum.Planes)
+			{
+				float distance = RoundedProduct(plane[0], object.BoundsCenter[0]);
+				distance = distance + RoundedProduct(plane[1], object.BoundsCenter[1]);
+				distance = distance + RoundedProduct(plane[2], object.BoundsCenter[2]);
+				distance = distance + plane[3];
+
+				if (distance < -object.BoundsRadius)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		std::uint32_t GenerateIndirectArguments(const CullFrustum& frustum, const std::vector<SceneObject>& objects, const std::vector<IndirectMesh>& meshes,
+			std::vector<IndirectDrawArguments>& arguments, ThreadPool* pool)
+		{
+			const std::uint32_t objectCount = static_cast<std::uint32_t>(objects.size());
+			const std::uint32_t groupCount = (objectCount + g_IndirectCullGroupSize - 1) / g_IndirectCullGroupSize;
+
+			// CullObjects: visibility and the offset inside the group, packed like ObjectOffsets //
+
+			std::vector<std::uint32_t> objectOffsets(objectCount);
+			std::vector<std::uint32_t> groupOffsets(groupCount);
+
+			auto cullGroups = [&](std::uint32_t begin, std::uint32_t end)
+			{
+				for (std::uint32_t group = begin; group < end; ++group)
+				{
+					const std::uint32_t first = group * g_IndirectCullGroupSize;
+					const std::uint32_t last = std::min(first + g_IndirectCullGroupSize, objectCount);
+
+					std::uint32_t total = 0;
+					for (std::uint32_t object = first; object < last; ++object)
+					{
+						const bool visible = IsSceneObjectVisible(frustum, objects[object]);
+						objectOffsets[object] = total | (visible ? g_VisibleBit : 0);
+						total += visible ? 1 : 0;
+					}
+
+					groupOffsets[group] = total;
+				}
+			};
+
+			// WriteArguments: one command per visible object at its group offset plus its local offset //
+
+			auto writeArguments = [&](std::uint32_t begin, std::uint32_t end)
+			{
+				for (std::uint32_t group = begin; group < end; ++group)
+				{
+					const std::uint32_t first = group * g_IndirectCullGroupSize;
+					const std::uint32_t last = std::min(first + g_IndirectCullGroupSize, objectCount);
+
+					for (std::uint32_t object = first; object < last; ++object)
+					{
+						const std::uint32_t packed = objectOffsets[object];
+						if ((packed & g_VisibleBit) == 0)
+						{
+							continue;
+						}
+
+						assert(objects[object].Mesh < meshes.size() && "Scene object references a mesh outside the mesh buffer.");
+						const IndirectMesh& mesh = meshes[objects[object].Mesh];
+
+						IndirectDrawArguments& command = arguments[groupOffsets[group] + (packed & ~g_VisibleBit)];
+						command.DrawId = object;
+						command.IndexCountPerInstance = mesh.IndexCount;
+						command.InstanceCount = 1;
+						command.StartIndexLocation = mesh.StartIndex;
+						command.BaseVertexLocation = mesh.BaseVertex;
+						command.StartInstanceLocation = 0;
+					}
+				}
+			};
+
+			if (pool && groupCount > g_GroupsPerTask)
+			{
+				pool->ParallelFor(groupCount, g_GroupsPerTask, cullGroups);
+			}
+			else
+			{
+				cullGroups(0, groupCount);
+			}
+
+			// ScanGroups: exclusive scan of the group totals, the sum is the draw count //
+
+			std::uint32_t drawCount = 0;
+			for (std::uint32_t& offset : groupOffsets)
+			{
+				const std::uint32_t total = offset;
+				offset = drawCount;
+				drawCount += total;
+			}
+
+			arguments.resize(drawCount);
+
+			if (pool && groupCount > g_GroupsPerTask)
+			{
+				pool->ParallelFor(groupCount, g_GroupsPerTask, writeArguments);
+			}
+			else
+			{
+				writeArguments(0, groupCount);
+			}
+
+			return drawCount;
+		}
+	}
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "DrawBatcher.h"
+#include "ThreadPool.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// Objects handled by one cull thread group, shared with the compute shader //
+
+		constexpr std::uint32_t g_IndirectCullGroupSize = 256;
+
+		// Scene object as it lives in the persistent GPU scene buffer //
+		/*
+		   The vertex shader reads the transform through the draw id, the cull shader the
+		   world space bounding sphere. Flags bit 0 hides the object without removing it.
+		*/
+
+		struct SceneObject
+		{
+			InstanceTransform Transform;
+			float BoundsCenter[3];
+			float BoundsRadius;
+			std::uint32_t Mesh;
+			std::uint32_t Material;
+			std::uint32_t Flags;
+			std::uint32_t Padding;
+		};
+
+		constexpr std::uint32_t g_SceneObjectHidden = 1u << 0;
+
+		// Range of the shared vertex and index buffers drawn for a mesh //
+
+		struct IndirectMesh
+		{
+			std::uint32_t IndexCount;
+			std::uint32_t StartIndex;
+			std::int32_t BaseVertex;
+			std::uint32_t Padding;
+		};
+
+		// One command of the command signature: the draw id root constant, then D3D12_DRAW_INDEXED_ARGUMENTS //
+
+		struct IndirectDrawArguments
+		{
+			std::uint32_t DrawId;
+			std::uint32_t IndexCountPerInstance;
+			std::uint32_t InstanceCount;
+			std::uint32_t StartIndexLocation;
+			std::int32_t BaseVertexLocation;
+			std::uint32_t StartInstanceLocation;
+
+			bool operator==(const IndirectDrawArguments& other) const
+			{
+				return DrawId == other.DrawId && IndexCountPerInstance == other.IndexCountPerInstance && InstanceCount == other.InstanceCount &&
+					StartIndexLocation == other.StartIndexLocation && BaseVertexLocation == other.BaseVertexLocation && StartInstanceLocation == other.StartInstanceLocation;
+			}
+		};
+
+		static_assert(sizeof(SceneObject) == 80, "SceneObject must match the HLSL struct.");
+		static_assert(sizeof(IndirectMesh) == 16, "IndirectMesh must match the HLSL struct.");
+		static_assert(sizeof(IndirectDrawArguments) == 24, "IndirectDrawArguments must match the command signature.");
+
+		// Planes as (a, b, c, d), a point is inside when a*x + b*y + c*z + d >= 0 //
+
+		struct CullFrustum
+		{
+			float Planes[6][4];
+		};
+
+		// Frustum of a row-major view projection matrix used with row vectors (DirectXMath layout), planes normalized //
+
+		CullFrustum ExtractFrustum(const float viewProjection[4][4]);
+
+		// Same test as the cull shader, in the same order, every product rounded before it is added so no FMA forms //
+
+		bool IsSceneObjectVisible(const CullFrustum& frustum, const SceneObject& object);
+
+		// CPU reference of the GPU cull and argument generation //
+		/*
+		   Produces exactly what the three cull dispatches write: visible objects in object
+		   order, one IndirectDrawArguments each. The compaction follows the GPU scheme,
+		   a per group exclusive scan, a scan of the group totals, then the scatter, so it
+		   doubles as a throughput reference when run over the pool. Every object's mesh
+		   must be inside meshes, as the shader reads it without bounds checks.
+		   Returns the draw count the GPU writes to the count buffer.
+		*/
+
+		std::uint32_t GenerateIndirectArguments(const CullFrustum& frustum, const std::vector<SceneObject>& objects, const std::vector<IndirectMesh>& meshes,
+			std::vector<IndirectDrawArguments>& arguments, ThreadPool* pool = &ThreadPool::Global());
+	}
+}
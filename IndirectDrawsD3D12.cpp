@@ -0,0 +1,576 @@
+#include "IndirectDrawsD3D12.h"
+#include "BindlessHeapD3D12.h"
+#include "RenderStats.h"
+#include "CommandTraceD3D12.h"
+
+#include <cstring>
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		namespace
+		{
+			// Root parameters of the cull root signature //
+
+			enum CullRootParameter : UINT
+			{
+				CullConstantsParameter,
+				ObjectsParameter,
+				MeshesParameter,
+				ObjectOffsetsParameter,
+				GroupOffsetsParameter,
+				ArgumentsParameter,
+				DrawCountParameter,
+				CullParameterCount
+			};
+
+			struct CullConstants
+			{
+				float Planes[6][4];
+				std::uint32_t ObjectCount;
+				std::uint32_t GroupCount;
+			};
+
+			// Cull, scan and scatter of the scene objects, mirrored by GenerateIndirectArguments() //
+			/*
+			   Shader model 5.1 so that it builds with D3DCompile; the group scan is done in
+			   groupshared memory instead of wave intrinsics. The plane distance is "precise"
+			   so the compiler neither fuses nor reorders it, which keeps the CPU reference
+			   bit exact.
+			*/
+
+			const char g_CullShaderSource[] = R"(
+#define GROUP_SIZE 256
+
+struct SceneObject
+{
+	float4 Transform[3];
+	float4 Bounds;
+	uint Mesh;
+	uint Material;
+	uint Flags;
+	uint Padding;
+};
+
+struct IndirectMesh
+{
+	uint IndexCount;
+	uint StartIndex;
+	int BaseVertex;
+	uint Padding;
+};
+
+struct DrawArguments
+{
+	uint DrawId;
+	uint IndexCountPerInstance;
+	uint InstanceCount;
+	uint StartIndexLocation;
+	int BaseVertexLocation;
+	uint StartInstanceLocation;
+};
+
+cbuffer CullConstants : register(b0)
+{
+	float4 Planes[6];
+	uint ObjectCount;
+	uint GroupCount;
+};
+
+StructuredBuffer<SceneObject> Objects : register(t0);
+StructuredBuffer<IndirectMesh> Meshes : register(t1);
+RWStructuredBuffer<uint> ObjectOffsets : register(u0);
+RWStructuredBuffer<uint> GroupOffsets : register(u1);
+RWStructuredBuffer<DrawArguments> Arguments : register(u2);
+RWStructuredBuffer<uint> DrawCount : register(u3);
+
+groupshared uint g_Scan[GROUP_SIZE];
+
+bool IsVisible(SceneObject object)
+{
+	if (object.Flags & 1)
+	{
+		return false;
+	}
+
+	[unroll]
+	for (uint p = 0; p < 6; ++p)
+	{
+		precise float distance = Planes[p].x * object.Bounds.x;
+		distance = distance + Planes[p].y * object.Bounds.y;
+		distance = distance + Planes[p].z * object.Bounds.z;
+		distance = distance + Planes[p].w;
+
+		if (distance < -object.Bounds.w)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Inclusive scan over the group, g_Scan holds every thread's result on return //
+
+uint GroupScan(uint value, uint thread)
+{
+	g_Scan[thread] = value;
+	GroupMemoryBarrierWithGroupSync();
+
+	for (uint offset = 1; offset < GROUP_SIZE; offset <<= 1)
+	{
+		uint add = thread >= offset ? g_Scan[thread - offset] : 0;
+		GroupMemoryBarrierWithGroupSync();
+		g_Scan[thread] += add;
+		GroupMemoryBarrierWithGroupSync();
+	}
+
+	return g_Scan[thread];
+}
+
+[numthreads(GROUP_SIZE, 1, 1)]
+void CullObjects(uint3 group : SV_GroupID, uint thread : SV_GroupIndex, uint3 id : SV_DispatchThreadID)
+{
+	uint visible = 0;
+	if (id.x < ObjectCount && IsVisible(Objects[id.x]))
+	{
+		visible = 1;
+	}
+
+	uint inclusive = GroupScan(visible, thread);
+
+	if (id.x < ObjectCount)
+	{
+		ObjectOffsets[id.x] = (inclusive - visible) | (visible << 31);
+	}
+	if (thread == GROUP_SIZE - 1)
+	{
+		GroupOffsets[group.x] = inclusive;
+	}
+}
+
+[numthreads(GROUP_SIZE, 1, 1)]
+void ScanGroups(uint thread : SV_GroupIndex)
+{
+	uint carry = 0;
+	for (uint base = 0; base < GroupCount; base += GROUP_SIZE)
+	{
+		uint index = base + thread;
+		uint total = index < GroupCount ? GroupOffsets[index] : 0;
+		uint inclusive = GroupScan(total, thread);
+
+		if (index < GroupCount)
+		{
+			GroupOffsets[index] = carry + inclusive - total;
+		}
+
+		carry += g_Scan[GROUP_SIZE - 1];
+		GroupMemoryBarrierWithGroupSync();
+	}
+
+	if (thread == 0)
+	{
+		DrawCount[0] = carry;
+	}
+}
+
+[numthreads(GROUP_SIZE, 1, 1)]
+void WriteArguments(uint3 group : SV_GroupID, uint3 id : SV_DispatchThreadID)
+{
+	if (id.x >= ObjectCount)
+	{
+		return;
+	}
+
+	uint packed = ObjectOffsets[id.x];
+	if ((packed >> 31) == 0)
+	{
+		return;
+	}
+
+	IndirectMesh mesh = Meshes[Objects[id.x].Mesh];
+
+	DrawArguments arguments;
+	arguments.DrawId = id.x;
+	arguments.IndexCountPerInstance = mesh.IndexCount;
+	arguments.InstanceCount = 1;
+	arguments.StartIndexLocation = mesh.StartIndex;
+	arguments.BaseVertexLocation = mesh.BaseVertex;
+	arguments.StartInstanceLocation = 0;
+
+	Arguments[GroupOffsets[group.x] + (packed & 0x7FFFFFFF)] = arguments;
+}
+)";
+
+			ComPtr<ID3DBlob> CompileCullShader(const char* entryPoint)
+			{
+				UINT flags = D3DCOMPILE_OPTIMIZATION_LEVEL3;
+				#if defined(_DEBUG)
+				flags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+				#endif
+
+				ComPtr<ID3DBlob> shader;
+				ComPtr<ID3DBlob> error;
+				HRESULT hr = D3DCompile(g_CullShaderSource, sizeof(g_CullShaderSource) - 1, "IndirectCull", nullptr, nullptr,
+					entryPoint, "cs_5_1", flags, 0, &shader, &error);
+
+				if (FAILED(hr) && error)
+				{
+					OutputDebugStringA(static_cast<const char*>(error->GetBufferPointer()));
+				}
+				ThrowIfFailed(hr);
+
+				return shader;
+			}
+		}
+
+		IndirectDrawsD3D12::IndirectDrawsD3D12(ComPtr<ID3D12Device2> device, ComPtr<ID3D12RootSignature> rootSignature, std::uint32_t framesInFlight, std::uint32_t objectCapacity,
+			std::uint32_t meshCapacity, UINT objectRootParameter, UINT drawIdRootParameter, UINT drawIdConstant)
+			: m_Device(device)
+			, m_RootSignature(rootSignature)
+			, m_ObjectRootParameter(objectRootParameter)
+			, m_ObjectCapacity(std::max(objectCapacity, 1u))
+			, m_MeshCapacity(std::max(meshCapacity, 1u))
+		{
+			const std::uint32_t groupCapacity = (m_ObjectCapacity + g_IndirectCullGroupSize - 1) / g_IndirectCullGroupSize;
+
+			m_Slots.resize(std::max(framesInFlight, 1u));
+			for (FrameSlot& slot : m_Slots)
+			{
+				slot.Objects = CreateBuffer(std::uint64_t(m_ObjectCapacity) * sizeof(SceneObject), D3D12_RESOURCE_FLAG_NONE);
+				slot.ObjectOffsets = CreateBuffer(std::uint64_t(m_ObjectCapacity) * sizeof(std::uint32_t), D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+				slot.GroupOffsets = CreateBuffer(std::uint64_t(groupCapacity) * sizeof(std::uint32_t), D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+				slot.Arguments = CreateBuffer(std::uint64_t(m_ObjectCapacity) * sizeof(IndirectDrawArguments), D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+				slot.DrawCount = CreateBuffer(sizeof(std::uint32_t), D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+			}
+			m_SceneObjects.resize(m_ObjectCapacity);
+
+			m_Meshes = CreateBuffer(std::uint64_t(m_MeshCapacity) * sizeof(IndirectMesh), D3D12_RESOURCE_FLAG_NONE);
+
+			CreateCullPipelines();
+			CreateCommandSignature(drawIdRootParameter, drawIdConstant);
+		}
+
+		// Buffers start in the common state and are promoted on first use; they decay back at the end of every command list //
+
+		ComPtr<ID3D12Resource> IndirectDrawsD3D12::CreateBuffer(std::uint64_t size, D3D12_RESOURCE_FLAGS flags)
+		{
+			CD3DX12_HEAP_PROPERTIES heapProperties(D3D12_HEAP_TYPE_DEFAULT);
+			CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(size, flags);
+
+			ComPtr<ID3D12Resource> buffer;
+			ThrowIfFailed(m_Device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+				D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&buffer)));
+
+			return buffer;
+		}
+
+		void IndirectDrawsD3D12::CreateCullPipelines()
+		{
+			CD3DX12_ROOT_PARAMETER1 parameters[CullParameterCount];
+			parameters[CullConstantsParameter].InitAsConstants(sizeof(CullConstants) / sizeof(std::uint32_t), 0);
+			parameters[ObjectsParameter].InitAsShaderResourceView(0);
+			parameters[MeshesParameter].InitAsShaderResourceView(1);
+			parameters[ObjectOffsetsParameter].InitAsUnorderedAccessView(0);
+			parameters[GroupOffsetsParameter].InitAsUnorderedAccessView(1);
+			parameters[ArgumentsParameter].InitAsUnorderedAccessView(2);
+			parameters[DrawCountParameter].InitAsUnorderedAccessView(3);
+
+			CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC desc;
+			desc.Init_1_1(_countof(parameters), parameters, 0, nullptr, D3D12_ROOT_SIGNATURE_FLAG_NONE);
+
+			ComPtr<ID3DBlob> signature;
+			ComPtr<ID3DBlob> error;
+			ThrowIfFailed(D3DX12SerializeVersionedRootSignature(&desc, D3D_ROOT_SIGNATURE_VERSION_1_1, &signature, &error));
+			ThrowIfFailed(m_Device->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&m_CullRootSignature)));
+
+			auto createPipeline = [&](const char* entryPoint, ComPtr<ID3D12PipelineState>& pipelineState)
+			{
+				ComPtr<ID3DBlob> shader = CompileCullShader(entryPoint);
+
+				D3D12_COMPUTE_PIPELINE_STATE_DESC pipelineDesc = {};
+				pipelineDesc.pRootSignature = m_CullRootSignature.Get();
+				pipelineDesc.CS = CD3DX12_SHADER_BYTECODE(shader.Get());
+				ThrowIfFailed(m_Device->CreateComputePipelineState(&pipelineDesc, IID_PPV_ARGS(&pipelineState)));
+			};
+
+			createPipeline("CullObjects", m_CullObjects);
+			createPipeline("ScanGroups", m_ScanGroups);
+			createPipeline("WriteArguments", m_WriteArguments);
+		}
+
+		void IndirectDrawsD3D12::CreateCommandSignature(UINT drawIdRootParameter, UINT drawIdConstant)
+		{
+			// Layout of IndirectDrawArguments: the draw id root constant, then the indexed draw //
+
+			D3D12_INDIRECT_ARGUMENT_DESC arguments[2] = {};
+			arguments[0].Type = D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT;
+			arguments[0].Constant.RootParameterIndex = drawIdRootParameter;
+			arguments[0].Constant.DestOffsetIn32BitValues = drawIdConstant;
+			arguments[0].Constant.Num32BitValuesToSet = 1;
+			arguments[1].Type = D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED;
+
+			D3D12_COMMAND_SIGNATURE_DESC desc = {};
+			desc.ByteStride = sizeof(IndirectDrawArguments);
+			desc.NumArgumentDescs = _countof(arguments);
+			desc.pArgumentDescs = arguments;
+
+			ThrowIfFailed(m_Device->CreateCommandSignature(&desc, m_RootSignature.Get(), IID_PPV_ARGS(&m_CommandSignature)));
+		}
+
+		void IndirectDrawsD3D12::UpdateObjects(std::uint32_t firstObject, const SceneObject* objects, std::uint32_t count)
+		{
+			assert(std::uint64_t(firstObject) + count <= m_ObjectCapacity && "Scene object update past the scene buffer.");
+			if (count == 0)
+			{
+				return;
+			}
+
+			std::memcpy(&m_SceneObjects[firstObject], objects, std::size_t(count) * sizeof(SceneObject));
+
+			// Touching or overlapping the last range of a slot extends it, a frame's updates usually come in order //
+
+			for (FrameSlot& slot : m_Slots)
+			{
+				std::vector<ObjectRange>& pending = slot.PendingObjects;
+				if (!pending.empty() && firstObject <= pending.back().First + pending.back().Count && firstObject + count >= pending.back().First)
+				{
+					ObjectRange& range = pending.back();
+					const std::uint32_t end = std::max(range.First + range.Count, firstObject + count);
+					range.First = std::min(range.First, firstObject);
+					range.Count = end - range.First;
+				}
+				else
+				{
+					pending.push_back({ firstObject, count });
+				}
+			}
+		}
+
+		std::uint64_t IndirectDrawsD3D12::BeginFrame(CopyQueue& copyQueue, std::uint32_t frameIndex)
+		{
+			m_FrameIndex = frameIndex % static_cast<std::uint32_t>(m_Slots.size());
+			FrameSlot& slot = m_Slots[m_FrameIndex];
+
+			// The upload below writes the slot's objects, they must be resident before the copy runs //
+
+			if (m_Residency)
+			{
+				for (const std::vector<ResidencyHandle>* handles : { &slot.Residency, &m_SharedResidency })
+				{
+					for (ResidencyHandle handle : *handles)
+					{
+						m_Residency->MarkUsed(handle);
+					}
+				}
+			}
+
+			std::uint64_t copyFenceValue = 0;
+			for (const ObjectRange& range : slot.PendingObjects)
+			{
+				copyFenceValue = copyQueue.UploadBuffer(slot.Objects.Get(), std::uint64_t(range.First) * sizeof(SceneObject),
+					&m_SceneObjects[range.First], std::uint64_t(range.Count) * sizeof(SceneObject));
+			}
+			slot.PendingObjects.clear();
+
+			return copyFenceValue;
+		}
+
+		std::uint64_t IndirectDrawsD3D12::UpdateMeshes(CopyQueue& copyQueue, std::uint32_t firstMesh, const IndirectMesh* meshes, std::uint32_t count)
+		{
+			assert(std::uint64_t(firstMesh) + count <= m_MeshCapacity && "Mesh update past the mesh buffer.");
+			return copyQueue.UploadBuffer(m_Meshes.Get(), std::uint64_t(firstMesh) * sizeof(IndirectMesh), meshes, std::uint64_t(count) * sizeof(IndirectMesh));
+		}
+
+		void IndirectDrawsD3D12::SetObjectCount(std::uint32_t count)
+		{
+			assert(count <= m_ObjectCapacity && "More scene objects than the scene buffer holds.");
+			m_ObjectCount = std::min(count, m_ObjectCapacity);
+		}
+
+		void IndirectDrawsD3D12::SetGeometry(const D3D12_VERTEX_BUFFER_VIEW& vertexBuffer, const D3D12_INDEX_BUFFER_VIEW& indexBuffer)
+		{
+			m_VertexBuffer = vertexBuffer;
+			m_IndexBuffer = indexBuffer;
+		}
+
+		std::uint64_t IndirectDrawsD3D12::LoadGeometry(CopyQueue& copyQueue, const Assets::MeshFile& mesh, std::uint32_t meshIndex)
+		{
+			assert(!m_Vertices && "The scene geometry is only loaded once.");
+
+			const std::int32_t vertexStream = mesh.FindStream(Assets::MeshStreamType::Vertices);
+			std::int32_t indexStream = mesh.FindStream(Assets::MeshStreamType::Indices32);
+			DXGI_FORMAT indexFormat = DXGI_FORMAT_R32_UINT;
+			if (indexStream < 0)
+			{
+				indexStream = mesh.FindStream(Assets::MeshStreamType::Indices16);
+				indexFormat = DXGI_FORMAT_R16_UINT;
+			}
+
+			if (vertexStream < 0 || indexStream < 0)
+			{
+				return 0;
+			}
+
+			const Assets::MeshStreamEntry& vertices = mesh.Stream(static_cast<std::uint32_t>(vertexStream));
+			const Assets::MeshStreamEntry& indices = mesh.Stream(static_cast<std::uint32_t>(indexStream));
+
+			m_Vertices = CreateBuffer(vertices.Size, D3D12_RESOURCE_FLAG_NONE);
+			m_Indices = CreateBuffer(indices.Size, D3D12_RESOURCE_FLAG_NONE);
+
+			if (m_Residency)
+			{
+				m_SharedResidency.push_back(m_Residency->Track(m_Vertices.Get()));
+				m_SharedResidency.push_back(m_Residency->Track(m_Indices.Get()));
+			}
+
+			// The mapped streams are read once, by the copy into the staging ring //
+
+			copyQueue.UploadBuffer(m_Vertices.Get(), 0, mesh.StreamData(static_cast<std::uint32_t>(vertexStream)), vertices.Size);
+			copyQueue.UploadBuffer(m_Indices.Get(), 0, mesh.StreamData(static_cast<std::uint32_t>(indexStream)), indices.Size);
+
+			D3D12_VERTEX_BUFFER_VIEW vertexBuffer = { m_Vertices->GetGPUVirtualAddress(), static_cast<UINT>(vertices.Size), vertices.Stride };
+			D3D12_INDEX_BUFFER_VIEW indexBuffer = { m_Indices->GetGPUVirtualAddress(), static_cast<UINT>(indices.Size), indexFormat };
+			SetGeometry(vertexBuffer, indexBuffer);
+
+			IndirectMesh entry = { indices.ElementCount, 0, 0, 0 };
+			return UpdateMeshes(copyQueue, meshIndex, &entry, 1);
+		}
+
+		void IndirectDrawsD3D12::SetResidency(ResidencyManagerD3D12* residency)
+		{
+			m_Residency = residency;
+			m_SharedResidency.clear();
+			for (FrameSlot& slot : m_Slots)
+			{
+				slot.Residency.clear();
+			}
+
+			if (!m_Residency)
+			{
+				return;
+			}
+
+			for (FrameSlot& slot : m_Slots)
+			{
+				for (ID3D12Resource* buffer : { slot.Objects.Get(), slot.ObjectOffsets.Get(), slot.GroupOffsets.Get(), slot.Arguments.Get(), slot.DrawCount.Get() })
+				{
+					slot.Residency.push_back(m_Residency->Track(buffer));
+				}
+			}
+
+			for (ID3D12Resource* buffer : { m_Meshes.Get(), m_Vertices.Get(), m_Indices.Get() })
+			{
+				if (buffer)
+				{
+					m_SharedResidency.push_back(m_Residency->Track(buffer));
+				}
+			}
+		}
+
+		void IndirectDrawsD3D12::SetDescriptorTables(D3D12_GPU_DESCRIPTOR_HANDLE resources, D3D12_GPU_DESCRIPTOR_HANDLE samplers)
+		{
+			m_ResourceTable = resources;
+			m_SamplerTable = samplers;
+		}
+
+		void IndirectDrawsD3D12::Record(ID3D12GraphicsCommandList* commandList)
+		{
+			RecordCull(commandList);
+			RecordDraw(commandList);
+		}
+
+		void IndirectDrawsD3D12::RecordCull(ID3D12GraphicsCommandList* commandList)
+		{
+			if (m_ObjectCount == 0 || !m_PipelineState)
+			{
+				return;
+			}
+
+			// Cull and compact, the three dispatches depend on each other's UAV writes //
+
+			const FrameSlot& slot = m_Slots[m_FrameIndex];
+
+			CullConstants constants;
+			std::memcpy(constants.Planes, m_Frustum.Planes, sizeof(constants.Planes));
+			constants.ObjectCount = m_ObjectCount;
+			constants.GroupCount = (m_ObjectCount + g_IndirectCullGroupSize - 1) / g_IndirectCullGroupSize;
+
+			commandList->SetComputeRootSignature(m_CullRootSignature.Get());
+			commandList->SetComputeRoot32BitConstants(CullConstantsParameter, sizeof(constants) / sizeof(std::uint32_t), &constants, 0);
+			commandList->SetComputeRootShaderResourceView(ObjectsParameter, slot.Objects->GetGPUVirtualAddress());
+			commandList->SetComputeRootShaderResourceView(MeshesParameter, m_Meshes->GetGPUVirtualAddress());
+			commandList->SetComputeRootUnorderedAccessView(ObjectOffsetsParameter, slot.ObjectOffsets->GetGPUVirtualAddress());
+			commandList->SetComputeRootUnorderedAccessView(GroupOffsetsParameter, slot.GroupOffsets->GetGPUVirtualAddress());
+			commandList->SetComputeRootUnorderedAccessView(ArgumentsParameter, slot.Arguments->GetGPUVirtualAddress());
+			commandList->SetComputeRootUnorderedAccessView(DrawCountParameter, slot.DrawCount->GetGPUVirtualAddress());
+
+			CD3DX12_RESOURCE_BARRIER uavBarrier = CD3DX12_RESOURCE_BARRIER::UAV(nullptr);
+
+			commandList->SetPipelineState(m_CullObjects.Get());
+			CommandCaptureD3D12::SetPipeline(commandList, m_CullObjects.Get());
+			commandList->Dispatch(constants.GroupCount, 1, 1);
+			CommandCaptureD3D12::Dispatch(commandList, constants.GroupCount, 1, 1);
+			commandList->ResourceBarrier(1, &uavBarrier);
+			CommandCaptureD3D12::Barriers(commandList, 1, &uavBarrier);
+
+			commandList->SetPipelineState(m_ScanGroups.Get());
+			CommandCaptureD3D12::SetPipeline(commandList, m_ScanGroups.Get());
+			commandList->Dispatch(1, 1, 1);
+			CommandCaptureD3D12::Dispatch(commandList, 1, 1, 1);
+			commandList->ResourceBarrier(1, &uavBarrier);
+			CommandCaptureD3D12::Barriers(commandList, 1, &uavBarrier);
+
+			commandList->SetPipelineState(m_WriteArguments.Get());
+			CommandCaptureD3D12::SetPipeline(commandList, m_WriteArguments.Get());
+			commandList->Dispatch(constants.GroupCount, 1, 1);
+			CommandCaptureD3D12::Dispatch(commandList, constants.GroupCount, 1, 1);
+
+			CD3DX12_RESOURCE_BARRIER barriers[] =
+			{
+				CD3DX12_RESOURCE_BARRIER::Transition(slot.Arguments.Get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT),
+				CD3DX12_RESOURCE_BARRIER::Transition(slot.DrawCount.Get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT)
+			};
+			commandList->ResourceBarrier(_countof(barriers), barriers);
+			CommandCaptureD3D12::Barriers(commandList, _countof(barriers), barriers);
+
+			RenderStats::Count(RenderCounter::Dispatches, 3);
+			RenderStats::Count(RenderCounter::Barriers, 2 + _countof(barriers));
+			RenderStats::Count(RenderCounter::PipelineChanges, 3);
+		}
+
+		void IndirectDrawsD3D12::RecordDraw(ID3D12GraphicsCommandList* commandList)
+		{
+			if (m_ObjectCount == 0 || !m_PipelineState)
+			{
+				return;
+			}
+
+			// One call draws every visible object //
+
+			const FrameSlot& slot = m_Slots[m_FrameIndex];
+
+			commandList->SetGraphicsRootSignature(m_RootSignature.Get());
+			commandList->SetPipelineState(m_PipelineState.Get());
+			CommandCaptureD3D12::SetPipeline(commandList, m_PipelineState.Get());
+			commandList->SetGraphicsRootShaderResourceView(m_ObjectRootParameter, slot.Objects->GetGPUVirtualAddress());
+			if (m_ResourceTable.ptr != 0)
+			{
+				commandList->SetGraphicsRootDescriptorTable(g_ResourceTableRootParameter, m_ResourceTable);
+				commandList->SetGraphicsRootDescriptorTable(g_SamplerTableRootParameter, m_SamplerTable);
+			}
+			commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+			commandList->IASetVertexBuffers(0, 1, &m_VertexBuffer);
+			commandList->IASetIndexBuffer(&m_IndexBuffer);
+
+			commandList->ExecuteIndirect(m_CommandSignature.Get(), m_ObjectCount, slot.Arguments.Get(), 0, slot.DrawCount.Get(), 0);
+			CommandCaptureD3D12::ExecuteIndirect(commandList, m_ObjectCount, slot.Arguments.Get(), slot.DrawCount.Get());
+
+			// The visible object count and their triangles are only known on the GPU //
+
+			RenderStats::Count(RenderCounter::PipelineChanges);
+			RenderStats::Count(RenderCounter::Draws);
+		}
+	}
+}
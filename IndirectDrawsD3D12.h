@@ -0,0 +1,176 @@
+#pragma once
+
+#include "Header.h"
+#include "HelperFile.h"
+#include "CopyQueue.h"
+#include "IndirectDraws.h"
+#include "MeshFormat.h"
+#include "MemoryTracker.h"
+#include "ResidencyManagerD3D12.h"
+
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// GPU driven scene draws through ExecuteIndirect //
+		/*
+		   Scene objects and meshes live in persistent default heap buffers updated through
+		   the copy queue. Each frame three compute dispatches cull the objects against the
+		   frustum and compact one IndirectDrawArguments per visible object, in object order,
+		   plus the draw count; a single ExecuteIndirect then draws them. The objects and the
+		   cull outputs exist once per frame in flight, so a cull on the compute queue never
+		   overwrites what an earlier frame still draws. The CPU cost of a frame is the same
+		   for ten objects or a million, and GenerateIndirectArguments() computes the exact
+		   same arguments on the CPU.
+		   Every mesh shares one vertex and index buffer set, from SetGeometry() or from a
+		   cooked mesh through LoadGeometry(). Shaders find their object as Objects[DrawId],
+		   DrawId being the root constant at drawIdConstant of drawIdRootParameter, and the
+		   material through SceneObject::Material.
+		*/
+
+		class IndirectDrawsD3D12
+		{
+		public:
+
+			IndirectDrawsD3D12(ComPtr<ID3D12Device2> device, ComPtr<ID3D12RootSignature> rootSignature, std::uint32_t framesInFlight, std::uint32_t objectCapacity,
+				std::uint32_t meshCapacity, UINT objectRootParameter, UINT drawIdRootParameter, UINT drawIdConstant);
+
+			// Object changes are kept on the CPU and reach each frame slot's buffer in BeginFrame() //
+			/*
+			   A frame in flight keeps reading its own copy, so it never sees a later
+			   frame's transforms. Meshes are rewritten in place; UpdateMeshes() returns the
+			   copy fence value the frame drawing the change must wait for.
+			*/
+
+			void UpdateObjects(std::uint32_t firstObject, const SceneObject* objects, std::uint32_t count);
+			std::uint64_t UpdateMeshes(CopyQueue& copyQueue, std::uint32_t firstMesh, const IndirectMesh* meshes, std::uint32_t count);
+
+			// The slot's previous frame has completed, uploads the changes its buffer misses //
+			/*
+			   Returns the copy fence value the frame must wait for, 0 when nothing changed.
+			*/
+
+			std::uint64_t BeginFrame(CopyQueue& copyQueue, std::uint32_t frameIndex);
+
+			// Objects [0, count) take part in culling //
+
+			void SetObjectCount(std::uint32_t count);
+
+			void SetGeometry(const D3D12_VERTEX_BUFFER_VIEW& vertexBuffer, const D3D12_INDEX_BUFFER_VIEW& indexBuffer);
+
+			// Shared geometry from a cooked mesh file, loaded once before the scene is drawn //
+			/*
+			   The interleaved vertex stream and the index stream go from the mapped file
+			   straight into the copy queue's upload memory, and the whole file becomes mesh
+			   meshIndex. Returns the copy fence value the first frame drawing it must wait
+			   for, 0 when the file has no vertex or index stream.
+			*/
+
+			std::uint64_t LoadGeometry(CopyQueue& copyQueue, const Assets::MeshFile& mesh, std::uint32_t meshIndex);
+			void SetPipeline(ComPtr<ID3D12PipelineState> pipelineState) { m_PipelineState = pipelineState; }
+			void SetFrustum(const CullFrustum& frustum) { m_Frustum = frustum; }
+
+			// Tracks every buffer, BeginFrame() then marks those the frame uses //
+
+			void SetResidency(ResidencyManagerD3D12* residency);
+
+			// Heap tables of the bindless root signature, bound with it before the draw //
+
+			void SetDescriptorTables(D3D12_GPU_DESCRIPTOR_HANDLE resources, D3D12_GPU_DESCRIPTOR_HANDLE samplers);
+
+			// Culls and draws, render targets, viewport and descriptor heaps are left to the caller //
+			/*
+			   Nothing is recorded without objects or a pipeline. The root signature and the
+			   pipeline are left bound, callers drawing afterwards must set their own.
+			*/
+
+			void Record(ID3D12GraphicsCommandList* commandList);
+
+			// The two halves of Record(), for a cull on the async compute queue //
+			/*
+			   RecordCull() only dispatches and fits a compute command list. RecordDraw() goes
+			   on a direct list that runs after it, on the same list or behind a fence wait on
+			   the cull's queue; the arguments decay to the common state between queues and are
+			   promoted back on the draw.
+			*/
+
+			void RecordCull(ID3D12GraphicsCommandList* commandList);
+			void RecordDraw(ID3D12GraphicsCommandList* commandList);
+
+			// Getters //
+
+			std::uint32_t ObjectCount() const { return m_ObjectCount; }
+			std::uint32_t ObjectCapacity() const { return m_ObjectCapacity; }
+			D3D12_GPU_VIRTUAL_ADDRESS Objects() const { return m_Slots[m_FrameIndex].Objects->GetGPUVirtualAddress(); }
+
+		private:
+
+			struct ObjectRange
+			{
+				std::uint32_t First;
+				std::uint32_t Count;
+			};
+
+			// Everything a frame writes or reads while the next frames are recorded //
+
+			struct FrameSlot
+			{
+				ComPtr<ID3D12Resource> Objects;
+				std::vector<ObjectRange> PendingObjects;		// ranges the slot's objects miss
+
+				// Cull outputs, rewritten by every frame using the slot //
+
+				ComPtr<ID3D12Resource> ObjectOffsets;
+				ComPtr<ID3D12Resource> GroupOffsets;
+				ComPtr<ID3D12Resource> Arguments;
+				ComPtr<ID3D12Resource> DrawCount;
+
+				std::vector<ResidencyHandle> Residency;
+			};
+
+		private:
+
+			void CreateCullPipelines();
+			void CreateCommandSignature(UINT drawIdRootParameter, UINT drawIdConstant);
+
+			ComPtr<ID3D12Resource> CreateBuffer(std::uint64_t size, D3D12_RESOURCE_FLAGS flags);
+
+		private:
+
+			ComPtr<ID3D12Device2> m_Device;
+			ComPtr<ID3D12RootSignature> m_RootSignature;
+			UINT m_ObjectRootParameter;
+
+			std::uint32_t m_ObjectCapacity;
+			std::uint32_t m_MeshCapacity;
+			std::uint32_t m_ObjectCount = 0;
+
+			// Persistent scene data, the objects and cull outputs once per frame slot //
+
+			std::vector<FrameSlot> m_Slots;
+			TaggedVector<SceneObject, MemoryTag::Scene> m_SceneObjects;
+			std::uint32_t m_FrameIndex = 0;
+			ComPtr<ID3D12Resource> m_Meshes;
+
+			ResidencyManagerD3D12* m_Residency = nullptr;
+			std::vector<ResidencyHandle> m_SharedResidency;		// meshes and geometry
+
+			ComPtr<ID3D12RootSignature> m_CullRootSignature;
+			ComPtr<ID3D12PipelineState> m_CullObjects;
+			ComPtr<ID3D12PipelineState> m_ScanGroups;
+			ComPtr<ID3D12PipelineState> m_WriteArguments;
+			ComPtr<ID3D12CommandSignature> m_CommandSignature;
+
+			ComPtr<ID3D12PipelineState> m_PipelineState;
+			ComPtr<ID3D12Resource> m_Vertices;		// set by LoadGeometry()
+			ComPtr<ID3D12Resource> m_Indices;
+			D3D12_VERTEX_BUFFER_VIEW m_VertexBuffer = {};
+			D3D12_INDEX_BUFFER_VIEW m_IndexBuffer = {};
+			CullFrustum m_Frustum = {};
+			D3D12_GPU_DESCRIPTOR_HANDLE m_ResourceTable = {};
+			D3D12_GPU_DESCRIPTOR_HANDLE m_SamplerTable = {};
+		};
+	}
+}
@@ -0,0 +1,174 @@
+#include "MappedFile.h"
+
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		MappedFile::~MappedFile()
+		{
+			Close();
+		}
+
+		MappedFile::MappedFile(MappedFile&& other) noexcept
+		{
+			*this = std::move(other);
+		}
+
+		MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+		{
+			if (this != &other)
+			{
+				Close();
+
+				std::swap(m_Data, other.m_Data);
+				std::swap(m_Size, other.m_Size);
+				std::swap(m_File, other.m_File);
+#if defined(_WIN32)
+				std::swap(m_Mapping, other.m_Mapping);
+#endif
+			}
+
+			return *this;
+		}
+
+		bool MappedFile::Open(const char* path, bool sequential)
+		{
+			Close();
+
+#if defined(_WIN32)
+			DWORD flags = sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+			HANDLE file = ::CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, flags, NULL);
+			if (file == INVALID_HANDLE_VALUE)
+			{
+				return false;
+			}
+
+			LARGE_INTEGER size = {};
+			if (!::GetFileSizeEx(file, &size) || size.QuadPart == 0)
+			{
+				::CloseHandle(file);
+				return false;
+			}
+
+			HANDLE mapping = ::CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (mapping == NULL)
+			{
+				::CloseHandle(file);
+				return false;
+			}
+
+			void* view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			if (view == nullptr)
+			{
+				::CloseHandle(mapping);
+				::CloseHandle(file);
+				return false;
+			}
+
+			m_File = file;
+			m_Mapping = mapping;
+			m_Data = static_cast<const std::uint8_t*>(view);
+			m_Size = static_cast<std::uint64_t>(size.QuadPart);
+#else
+			int file = ::open(path, O_RDONLY | O_CLOEXEC);
+			if (file < 0)
+			{
+				return false;
+			}
+
+			struct stat info = {};
+			if (::fstat(file, &info) != 0 || info.st_size == 0)
+			{
+				::close(file);
+				return false;
+			}
+
+			void* view = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+			if (view == MAP_FAILED)
+			{
+				::close(file);
+				return false;
+			}
+
+			::madvise(view, static_cast<size_t>(info.st_size), sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+
+			m_File = file;
+			m_Data = static_cast<const std::uint8_t*>(view);
+			m_Size = static_cast<std::uint64_t>(info.st_size);
+#endif
+
+			return true;
+		}
+
+		void MappedFile::Close()
+		{
+#if defined(_WIN32)
+			if (m_Data)
+			{
+				::UnmapViewOfFile(m_Data);
+			}
+			if (m_Mapping)
+			{
+				::CloseHandle(m_Mapping);
+			}
+			if (m_File)
+			{
+				::CloseHandle(m_File);
+			}
+			m_Mapping = nullptr;
+			m_File = nullptr;
+#else
+			if (m_Data)
+			{
+				::munmap(const_cast<std::uint8_t*>(m_Data), static_cast<size_t>(m_Size));
+			}
+			if (m_File >= 0)
+			{
+				::close(m_File);
+			}
+			m_File = -1;
+#endif
+
+			m_Data = nullptr;
+			m_Size = 0;
+		}
+
+		void MappedFile::Prefetch(std::uint64_t offset, std::uint64_t size) const
+		{
+			if (!m_Data || offset >= m_Size)
+			{
+				return;
+			}
+
+			if (size > m_Size - offset)
+			{
+				size = m_Size - offset;
+			}
+
+#if defined(_WIN32)
+			WIN32_MEMORY_RANGE_ENTRY range = {};
+			range.VirtualAddress = const_cast<std::uint8_t*>(m_Data + offset);
+			range.NumberOfBytes = static_cast<SIZE_T>(size);
+			::PrefetchVirtualMemory(::GetCurrentProcess(), 1, &range, 0);
+#else
+			// madvise needs a page aligned start address //
+
+			const std::uint64_t pageSize = static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE));
+			const std::uint64_t alignedOffset = offset & ~(pageSize - 1);
+			::madvise(const_cast<std::uint8_t*>(m_Data + alignedOffset), static_cast<size_t>(size + offset - alignedOffset), MADV_WILLNEED);
+#endif
+		}
+	}
+}
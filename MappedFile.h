@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// Read-only memory mapping of a whole file //
+		/*
+		   Uses mmap on Linux and CreateFileMapping on Windows.
+		   The mapping stays valid until Close() or destruction, so pointers
+		   returned by Data() can be handed straight to a memcpy into upload memory.
+		*/
+
+		class MappedFile
+		{
+		public:
+
+			MappedFile() = default;
+			~MappedFile();
+
+			MappedFile(const MappedFile&) = delete;
+			MappedFile& operator=(const MappedFile&) = delete;
+
+			MappedFile(MappedFile&& other) noexcept;
+			MappedFile& operator=(MappedFile&& other) noexcept;
+
+			bool Open(const char* path, bool sequential = true);
+			void Close();
+
+			// Hint the OS to start reading a range ahead of the first access //
+
+			void Prefetch(std::uint64_t offset, std::uint64_t size) const;
+
+			// Getters //
+
+			const std::uint8_t* Data() const { return m_Data; }
+			std::uint64_t Size() const { return m_Size; }
+			bool IsOpen() const { return m_Data != nullptr; }
+
+		private:
+
+			const std::uint8_t* m_Data = nullptr;
+			std::uint64_t m_Size = 0;
+
+#if defined(_WIN32)
+			void* m_File = nullptr;
+			void* m_Mapping = nullptr;
+#else
+			int m_File = -1;
+#endif
+		};
+	}
+}
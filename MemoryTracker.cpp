@@ -0,0 +1,230 @@
+#include "MemoryTracker.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <new>
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		namespace
+		{
+			// Stored right before every tagged allocation //
+
+			struct AllocationHeader
+			{
+				std::uint64_t Size;
+				std::uint32_t Alignment;	// distance back to the start of the heap block
+				std::uint32_t Tag;
+			};
+
+			constexpr std::size_t g_HeaderAlignment = 16;
+
+			static_assert(sizeof(AllocationHeader) <= g_HeaderAlignment, "The header must fit in the minimum alignment.");
+		}
+
+		const char* MemoryTagName(MemoryTag tag)
+		{
+			switch (tag)
+			{
+			case MemoryTag::Render: return "Render";
+			case MemoryTag::Assets: return "Assets";
+			case MemoryTag::Streaming: return "Streaming";
+			case MemoryTag::Scene: return "Scene";
+			case MemoryTag::Frame: return "Frame";
+			default: return "Unknown";
+			}
+		}
+
+		void* TaggedAllocate(std::size_t size, std::size_t alignment, MemoryTag tag)
+		{
+			alignment = std::max(alignment, g_HeaderAlignment);
+
+			std::uint8_t* block = static_cast<std::uint8_t*>(::operator new(size + alignment, std::align_val_t(alignment)));
+			std::uint8_t* memory = block + alignment;
+
+			AllocationHeader* header = reinterpret_cast<AllocationHeader*>(memory - g_HeaderAlignment);
+			header->Size = size;
+			header->Alignment = static_cast<std::uint32_t>(alignment);
+			header->Tag = static_cast<std::uint32_t>(tag);
+
+			MemoryTracker::CountAllocation(tag, size);
+			return memory;
+		}
+
+		void TaggedFree(void* memory)
+		{
+			if (!memory)
+			{
+				return;
+			}
+
+			std::uint8_t* bytes = static_cast<std::uint8_t*>(memory);
+			const AllocationHeader header = *reinterpret_cast<const AllocationHeader*>(bytes - g_HeaderAlignment);
+
+			MemoryTracker::CountFree(static_cast<MemoryTag>(header.Tag), static_cast<std::size_t>(header.Size));
+			::operator delete(bytes - header.Alignment, std::align_val_t(header.Alignment));
+		}
+
+		std::uint64_t MemorySnapshot::LiveBytes() const
+		{
+			std::uint64_t bytes = 0;
+			for (const MemoryTagStats& tag : Tags)
+			{
+				bytes += tag.LiveBytes;
+			}
+			return bytes;
+		}
+
+		MemoryTracker& MemoryTracker::Global()
+		{
+			static MemoryTracker* tracker = new MemoryTracker();
+			return *tracker;
+		}
+
+		void MemoryTracker::CountAllocation(MemoryTag tag, std::size_t size)
+		{
+			const std::uint32_t index = static_cast<std::uint32_t>(tag);
+
+			MemoryTracker& tracker = Global();
+			tracker.m_Counters.Add(Counter(AllocatedBytes, index), size);
+			tracker.m_Counters.Add(Counter(Allocations, index), 1);
+		}
+
+		void MemoryTracker::CountFree(MemoryTag tag, std::size_t size)
+		{
+			const std::uint32_t index = static_cast<std::uint32_t>(tag);
+
+			MemoryTracker& tracker = Global();
+			tracker.m_Counters.Add(Counter(FreedBytes, index), size);
+			tracker.m_Counters.Add(Counter(Frees, index), 1);
+		}
+
+		void MemoryTracker::EndFrame()
+		{
+			std::uint64_t totals[CounterKindCount * g_MemoryTagCount];
+			m_Counters.Sum(totals);
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			m_Snapshot.Frame++;
+
+			for (std::uint32_t tag = 0; tag < g_MemoryTagCount; ++tag)
+			{
+				const std::uint64_t allocatedBytes = totals[Counter(AllocatedBytes, tag)];
+				const std::uint64_t freedBytes = totals[Counter(FreedBytes, tag)];
+				const std::uint64_t allocations = totals[Counter(Allocations, tag)];
+				const std::uint64_t frees = totals[Counter(Frees, tag)];
+
+				// The frame churn is what the cumulative totals moved by since the last merge //
+
+				MemoryTagStats& stats = m_Snapshot.Tags[tag];
+				stats.FrameAllocatedBytes = allocatedBytes - stats.TotalBytes;
+				stats.FrameAllocations = allocations - stats.TotalAllocations;
+				stats.FrameFreedBytes = freedBytes - m_MergedFreedBytes[tag];
+				stats.FrameFrees = frees - m_MergedFrees[tag];
+				stats.PeakFrameAllocatedBytes = std::max(stats.PeakFrameAllocatedBytes, stats.FrameAllocatedBytes);
+
+				// Frees counted before their allocation was merged can briefly run ahead //
+
+				stats.TotalBytes = allocatedBytes;
+				stats.TotalAllocations = allocations;
+				m_MergedFreedBytes[tag] = freedBytes;
+				m_MergedFrees[tag] = frees;
+				stats.LiveBytes = allocatedBytes - std::min(freedBytes, allocatedBytes);
+				stats.LiveAllocations = allocations - std::min(frees, allocations);
+			}
+		}
+
+		MemorySnapshot MemoryTracker::Snapshot() const
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			return m_Snapshot;
+		}
+
+		MemorySnapshotDiff MemoryTracker::Diff(const MemorySnapshot& before, const MemorySnapshot& after)
+		{
+			MemorySnapshotDiff diff;
+			diff.Frames = after.Frame - before.Frame;
+
+			for (std::uint32_t tag = 0; tag < g_MemoryTagCount; ++tag)
+			{
+				const MemoryTagStats& a = before.Tags[tag];
+				const MemoryTagStats& b = after.Tags[tag];
+
+				diff.Tags[tag].LiveBytes = static_cast<std::int64_t>(b.LiveBytes) - static_cast<std::int64_t>(a.LiveBytes);
+				diff.Tags[tag].LiveAllocations = static_cast<std::int64_t>(b.LiveAllocations) - static_cast<std::int64_t>(a.LiveAllocations);
+				diff.Tags[tag].AllocatedBytes = b.TotalBytes - a.TotalBytes;
+				diff.Tags[tag].Allocations = b.TotalAllocations - a.TotalAllocations;
+			}
+
+			return diff;
+		}
+
+		std::string MemoryTracker::Format(const MemorySnapshot& snapshot)
+		{
+			std::uint32_t order[g_MemoryTagCount];
+			for (std::uint32_t tag = 0; tag < g_MemoryTagCount; ++tag)
+			{
+				order[tag] = tag;
+			}
+			std::sort(std::begin(order), std::end(order), [&](std::uint32_t a, std::uint32_t b)
+			{
+				return snapshot.Tags[a].LiveBytes > snapshot.Tags[b].LiveBytes;
+			});
+
+			std::string report;
+			char line[200];
+
+			std::snprintf(line, sizeof(line), "Memory at frame %llu: %llu KB live\n",
+				static_cast<unsigned long long>(snapshot.Frame), static_cast<unsigned long long>(snapshot.LiveBytes() / 1024));
+			report += line;
+
+			for (std::uint32_t tag : order)
+			{
+				const MemoryTagStats& stats = snapshot.Tags[tag];
+				std::snprintf(line, sizeof(line), "  %-10s %10llu KB live in %8llu allocations, frame %+lld KB (%llu allocs, %llu frees), peak frame %llu KB\n",
+					MemoryTagName(static_cast<MemoryTag>(tag)),
+					static_cast<unsigned long long>(stats.LiveBytes / 1024), static_cast<unsigned long long>(stats.LiveAllocations),
+					(static_cast<long long>(stats.FrameAllocatedBytes) - static_cast<long long>(stats.FrameFreedBytes)) / 1024,
+					static_cast<unsigned long long>(stats.FrameAllocations), static_cast<unsigned long long>(stats.FrameFrees),
+					static_cast<unsigned long long>(stats.PeakFrameAllocatedBytes / 1024));
+				report += line;
+			}
+
+			return report;
+		}
+
+		std::string MemoryTracker::Format(const MemorySnapshotDiff& diff)
+		{
+			std::uint32_t order[g_MemoryTagCount];
+			for (std::uint32_t tag = 0; tag < g_MemoryTagCount; ++tag)
+			{
+				order[tag] = tag;
+			}
+			std::sort(std::begin(order), std::end(order), [&](std::uint32_t a, std::uint32_t b)
+			{
+				return diff.Tags[a].LiveBytes > diff.Tags[b].LiveBytes;
+			});
+
+			std::string report;
+			char line[200];
+
+			std::snprintf(line, sizeof(line), "Memory change over %llu frames\n", static_cast<unsigned long long>(diff.Frames));
+			report += line;
+
+			for (std::uint32_t tag : order)
+			{
+				const MemoryTagDiff& change = diff.Tags[tag];
+				std::snprintf(line, sizeof(line), "  %-10s %+10lld KB live, %+8lld allocations live, %llu KB allocated in %llu allocations\n",
+					MemoryTagName(static_cast<MemoryTag>(tag)),
+					static_cast<long long>(change.LiveBytes / 1024), static_cast<long long>(change.LiveAllocations),
+					static_cast<unsigned long long>(change.AllocatedBytes / 1024), static_cast<unsigned long long>(change.Allocations));
+				report += line;
+			}
+
+			return report;
+		}
+	}
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "ThreadCounterRegistry.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// Subsystem charged for an allocation //
+
+		enum class MemoryTag : std::uint8_t
+		{
+			Render,		// draw batching and overlay buffers
+			Assets,		// decoded and encoded asset data
+			Streaming,	// texture streaming state and uploads
+			Scene,		// scene objects and simulation snapshots
+			Frame,		// FrameArena blocks
+			Count
+		};
+
+		constexpr std::uint32_t g_MemoryTagCount = static_cast<std::uint32_t>(MemoryTag::Count);
+
+		const char* MemoryTagName(MemoryTag tag);
+
+		// Tagged heap allocations, freed without knowing their size or tag //
+
+		void* TaggedAllocate(std::size_t size, std::size_t alignment, MemoryTag tag);
+		void TaggedFree(void* memory);
+
+		struct MemoryTagStats
+		{
+			std::uint64_t LiveBytes = 0;
+			std::uint64_t LiveAllocations = 0;
+			std::uint64_t TotalBytes = 0;				// allocated since start
+			std::uint64_t TotalAllocations = 0;
+			std::uint64_t FrameAllocatedBytes = 0;		// churn of the last merged frame
+			std::uint64_t FrameFreedBytes = 0;
+			std::uint64_t FrameAllocations = 0;
+			std::uint64_t FrameFrees = 0;
+			std::uint64_t PeakFrameAllocatedBytes = 0;	// largest FrameAllocatedBytes so far
+		};
+
+		struct MemorySnapshot
+		{
+			std::uint64_t Frame = 0;
+			MemoryTagStats Tags[g_MemoryTagCount];
+
+			std::uint64_t LiveBytes() const;
+		};
+
+		// Change between two snapshots, positive LiveBytes means the tag grew //
+
+		struct MemoryTagDiff
+		{
+			std::int64_t LiveBytes = 0;
+			std::int64_t LiveAllocations = 0;
+			std::uint64_t AllocatedBytes = 0;
+			std::uint64_t Allocations = 0;
+		};
+
+		struct MemorySnapshotDiff
+		{
+			std::uint64_t Frames = 0;
+			MemoryTagDiff Tags[g_MemoryTagCount];
+		};
+
+		// Per tag accounting of TaggedAllocate / TaggedFree //
+		/*
+		   Every thread counts into its own counters (see ThreadCounterRegistry);
+		   EndFrame() merges them once per frame into the snapshot, so allocating never
+		   contends. Compare
+		   two snapshots with Diff() to see which subsystem grew: a live size climbing
+		   across many frames is a leak, a large frame churn is a spike.
+		*/
+
+		class MemoryTracker
+		{
+		public:
+
+			// Merges the thread counters, call once per frame //
+
+			void EndFrame();
+
+			// State as of the last EndFrame() //
+
+			MemorySnapshot Snapshot() const;
+
+			static MemorySnapshotDiff Diff(const MemorySnapshot& before, const MemorySnapshot& after);
+
+			// One line per tag, largest first //
+
+			static std::string Format(const MemorySnapshot& snapshot);
+			static std::string Format(const MemorySnapshotDiff& diff);
+
+			// Never destroyed, so allocations freed during static destruction are still counted //
+
+			static MemoryTracker& Global();
+
+		private:
+
+			friend void* TaggedAllocate(std::size_t size, std::size_t alignment, MemoryTag tag);
+			friend void TaggedFree(void* memory);
+
+			// Each tag has one counter of every kind, counter = kind * g_MemoryTagCount + tag //
+
+			enum CounterKind : std::uint32_t
+			{
+				AllocatedBytes,
+				FreedBytes,
+				Allocations,
+				Frees,
+				CounterKindCount
+			};
+
+			MemoryTracker() = default;
+
+			static void CountAllocation(MemoryTag tag, std::size_t size);
+			static void CountFree(MemoryTag tag, std::size_t size);
+			static std::uint32_t Counter(CounterKind kind, std::uint32_t tag) { return kind * g_MemoryTagCount + tag; }
+
+		private:
+
+			ThreadCounterRegistry<CounterKindCount * g_MemoryTagCount, MemoryTracker> m_Counters;
+			MemorySnapshot m_Snapshot;
+			std::uint64_t m_MergedFreedBytes[g_MemoryTagCount] = {};
+			std::uint64_t m_MergedFrees[g_MemoryTagCount] = {};
+			mutable std::mutex m_Mutex;
+		};
+
+		// Standard allocator charging its allocations to Tag //
+
+		template<typename T, MemoryTag Tag>
+		class TaggedAllocator
+		{
+		public:
+
+			using value_type = T;
+
+			template<typename U>
+			struct rebind
+			{
+				using other = TaggedAllocator<U, Tag>;
+			};
+
+			TaggedAllocator() = default;
+
+			template<typename U>
+			TaggedAllocator(const TaggedAllocator<U, Tag>&) {}
+
+			T* allocate(std::size_t count) { return static_cast<T*>(TaggedAllocate(count * sizeof(T), alignof(T), Tag)); }
+			void deallocate(T* memory, std::size_t) { TaggedFree(memory); }
+
+			template<typename U>
+			bool operator==(const TaggedAllocator<U, Tag>&) const { return true; }
+			template<typename U>
+			bool operator!=(const TaggedAllocator<U, Tag>&) const { return false; }
+		};
+
+		template<typename T, MemoryTag Tag>
+		using TaggedVector = std::vector<T, TaggedAllocator<T, Tag>>;
+	}
+}
@@ -0,0 +1,187 @@
+#include "MeshFormat.h"
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace PowerEngine
+{
+	namespace Assets
+	{
+		bool WriteCookedMesh(const char* path, const MeshStreamDesc* streams, std::uint32_t streamCount,
+			std::uint32_t vertexCount, std::uint32_t indexCount, const float boundsMin[3], const float boundsMax[3])
+		{
+			MeshFileHeader header = {};
+			header.Magic = g_MeshFileMagic;
+			header.Version = g_MeshFileVersion;
+			header.StreamCount = streamCount;
+			header.TableOffset = sizeof(MeshFileHeader);
+			header.VertexCount = vertexCount;
+			header.IndexCount = indexCount;
+			std::memcpy(header.BoundsMin, boundsMin, sizeof(header.BoundsMin));
+			std::memcpy(header.BoundsMax, boundsMax, sizeof(header.BoundsMax));
+
+			// Build the offset table before writing anything so the file is written in one pass //
+
+			std::vector<MeshStreamEntry> table(streamCount);
+			std::uint64_t offset = AlignMeshStream(header.TableOffset + sizeof(MeshStreamEntry) * streamCount);
+
+			for (std::uint32_t i = 0; i < streamCount; ++i)
+			{
+				table[i].Type = static_cast<std::uint32_t>(streams[i].Type);
+				table[i].Stride = streams[i].Stride;
+				table[i].Offset = offset;
+				table[i].Size = streams[i].Size;
+				table[i].ElementCount = streams[i].Stride ? static_cast<std::uint32_t>(streams[i].Size / streams[i].Stride) : 0;
+				table[i].Format = streams[i].Format;
+
+				offset = AlignMeshStream(offset + streams[i].Size);
+			}
+
+			header.FileSize = offset;
+
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			if (!file)
+			{
+				return false;
+			}
+
+			static const char padding[g_MeshStreamAlignment] = {};
+
+			auto writePadding = [&](std::uint64_t from)
+			{
+				file.write(padding, static_cast<std::streamsize>(AlignMeshStream(from) - from));
+			};
+
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(reinterpret_cast<const char*>(table.data()), static_cast<std::streamsize>(sizeof(MeshStreamEntry) * streamCount));
+			writePadding(header.TableOffset + sizeof(MeshStreamEntry) * streamCount);
+
+			for (std::uint32_t i = 0; i < streamCount; ++i)
+			{
+				file.write(static_cast<const char*>(streams[i].Data), static_cast<std::streamsize>(streams[i].Size));
+				writePadding(table[i].Offset + table[i].Size);
+			}
+
+			return static_cast<bool>(file);
+		}
+
+		bool MeshFile::Open(const char* path)
+		{
+			Close();
+
+			if (!m_File.Open(path))
+			{
+				return false;
+			}
+
+			if (m_File.Size() < sizeof(MeshFileHeader))
+			{
+				m_File.Close();
+				return false;
+			}
+
+			m_Header = reinterpret_cast<const MeshFileHeader*>(m_File.Data());
+			m_Streams = reinterpret_cast<const MeshStreamEntry*>(m_File.Data() + m_Header->TableOffset);
+
+			if (!Validate())
+			{
+				Close();
+				return false;
+			}
+
+			// Everything past the table is stream data that is about to be copied in order //
+
+			m_File.Prefetch(m_Streams[0].Offset, m_File.Size() - m_Streams[0].Offset);
+
+			return true;
+		}
+
+		void MeshFile::Close()
+		{
+			m_File.Close();
+			m_Header = nullptr;
+			m_Streams = nullptr;
+		}
+
+		bool MeshFile::Validate() const
+		{
+			const MeshFileHeader& header = *m_Header;
+
+			if (header.Magic != g_MeshFileMagic || header.Version != g_MeshFileVersion)
+			{
+				return false;
+			}
+
+			// Bounded by what is left after the table offset so a crafted count can't wrap the size //
+
+			if (header.StreamCount == 0 || header.FileSize != m_File.Size() || header.TableOffset < sizeof(MeshFileHeader) ||
+				header.TableOffset % alignof(MeshStreamEntry) != 0 || header.TableOffset > m_File.Size() ||
+				header.StreamCount > (m_File.Size() - header.TableOffset) / sizeof(MeshStreamEntry))
+			{
+				return false;
+			}
+
+			for (std::uint32_t i = 0; i < header.StreamCount; ++i)
+			{
+				const MeshStreamEntry& stream = m_Streams[i];
+
+				if (stream.Offset % g_MeshStreamAlignment != 0 || stream.Offset > m_File.Size() ||
+					stream.Size > m_File.Size() - stream.Offset || stream.Type >= static_cast<std::uint32_t>(MeshStreamType::Count))
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		std::uint64_t MeshFile::UploadSize() const
+		{
+			std::uint64_t size = 0;
+
+			for (std::uint32_t i = 0; i < StreamCount(); ++i)
+			{
+				size = AlignMeshStream(size) + m_Streams[i].Size;
+			}
+
+			return AlignMeshStream(size);
+		}
+
+		void MeshFile::CopyStreams(void* uploadData, std::uint64_t* offsets) const
+		{
+			std::uint8_t* destination = static_cast<std::uint8_t*>(uploadData);
+			std::uint64_t offset = 0;
+
+			for (std::uint32_t i = 0; i < StreamCount(); ++i)
+			{
+				offset = AlignMeshStream(offset);
+				if (offsets)
+				{
+					offsets[i] = offset;
+				}
+
+				CopyStream(i, destination + offset);
+				offset += m_Streams[i].Size;
+			}
+		}
+
+		void MeshFile::CopyStream(std::uint32_t index, void* destination) const
+		{
+			std::memcpy(destination, StreamData(index), static_cast<size_t>(m_Streams[index].Size));
+		}
+
+		std::int32_t MeshFile::FindStream(MeshStreamType type) const
+		{
+			for (std::uint32_t i = 0; i < StreamCount(); ++i)
+			{
+				if (m_Streams[i].Type == static_cast<std::uint32_t>(type))
+				{
+					return static_cast<std::int32_t>(i);
+				}
+			}
+
+			return -1;
+		}
+	}
+}
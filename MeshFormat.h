@@ -0,0 +1,133 @@
+#pragma once
+
+#include "MappedFile.h"
+
+#include <cstdint>
+#include <cstddef>
+
+namespace PowerEngine {
+
+	namespace Assets {
+
+		// Cooked mesh container //
+		/*
+		   File layout :
+
+		   [MeshFileHeader]            64 bytes, fixed
+		   [MeshStreamEntry * N]       offset table, 32 bytes per stream
+		   [padding]
+		   [stream 0][padding][stream 1]...
+
+		   Every stream starts on a g_MeshStreamAlignment boundary and its size is padded
+		   to the same alignment, so the streams can be copied from the mapped file straight
+		   into an upload allocation without any parsing or intermediate heap buffer.
+		*/
+
+		constexpr std::uint32_t g_MeshFileMagic = 0x48534D50; // "PMSH"
+		constexpr std::uint32_t g_MeshFileVersion = 1;
+		constexpr std::uint64_t g_MeshStreamAlignment = 64;
+
+		enum class MeshStreamType : std::uint32_t
+		{
+			Vertices = 0,	// interleaved vertex data
+			Indices16,
+			Indices32,
+			Position,
+			Normal,
+			Tangent,
+			TexCoord,
+			Color,
+			Count
+		};
+
+		struct MeshFileHeader
+		{
+			std::uint32_t Magic;
+			std::uint32_t Version;
+			std::uint32_t StreamCount;
+			std::uint32_t Flags;
+			std::uint64_t FileSize;
+			std::uint64_t TableOffset;
+			std::uint32_t VertexCount;
+			std::uint32_t IndexCount;
+			float BoundsMin[3];
+			float BoundsMax[3];
+		};
+		static_assert(sizeof(MeshFileHeader) == 64, "MeshFileHeader must stay 64 bytes.");
+
+		struct MeshStreamEntry
+		{
+			std::uint32_t Type;			// MeshStreamType
+			std::uint32_t Stride;		// bytes per element
+			std::uint64_t Offset;		// from the start of the file, g_MeshStreamAlignment aligned
+			std::uint64_t Size;			// in bytes, without the trailing padding
+			std::uint32_t ElementCount;
+			std::uint32_t Format;		// DXGI_FORMAT of the elements, 0 for interleaved streams
+		};
+		static_assert(sizeof(MeshStreamEntry) == 32, "MeshStreamEntry must stay 32 bytes.");
+
+		inline std::uint64_t AlignMeshStream(std::uint64_t value)
+		{
+			return (value + g_MeshStreamAlignment - 1) & ~(g_MeshStreamAlignment - 1);
+		}
+
+		// Description of a stream handed to the cooker //
+
+		struct MeshStreamDesc
+		{
+			MeshStreamType Type;
+			std::uint32_t Stride;
+			std::uint32_t Format;
+			const void* Data;
+			std::uint64_t Size;
+		};
+
+		// Writes a cooked mesh file. Used by the asset cooker, never at runtime. //
+
+		bool WriteCookedMesh(const char* path, const MeshStreamDesc* streams, std::uint32_t streamCount,
+			std::uint32_t vertexCount, std::uint32_t indexCount, const float boundsMin[3], const float boundsMax[3]);
+
+		// Runtime view of a cooked mesh //
+		/*
+		   Open() maps the file and only validates the header and offset table.
+		   Stream data is never touched until it is copied into upload memory.
+		*/
+
+		class MeshFile
+		{
+		public:
+
+			bool Open(const char* path);
+			void Close();
+
+			// Size of an upload allocation holding every stream, each one 64 bytes aligned //
+
+			std::uint64_t UploadSize() const;
+
+			// Copy every stream into upload memory. offsets receives StreamCount() values //
+			// relative to uploadData, they are the same for every file with the same table. //
+
+			void CopyStreams(void* uploadData, std::uint64_t* offsets = nullptr) const;
+			void CopyStream(std::uint32_t index, void* destination) const;
+
+			// Getters //
+
+			const MeshFileHeader& Header() const { return *m_Header; }
+			std::uint32_t StreamCount() const { return m_Header ? m_Header->StreamCount : 0; }
+			const MeshStreamEntry& Stream(std::uint32_t index) const { return m_Streams[index]; }
+			const void* StreamData(std::uint32_t index) const { return m_File.Data() + m_Streams[index].Offset; }
+			std::int32_t FindStream(MeshStreamType type) const;
+			bool IsOpen() const { return m_Header != nullptr; }
+
+		private:
+
+			bool Validate() const;
+
+		private:
+
+			Core::MappedFile m_File;
+			const MeshFileHeader* m_Header = nullptr;
+			const MeshStreamEntry* m_Streams = nullptr;
+		};
+	}
+}
@@ -0,0 +1,552 @@
+#include "MipGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define POWERENGINE_MIP_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace PowerEngine
+{
+	namespace Assets
+	{
+		namespace
+		{
+			constexpr float g_Pi = 3.14159265358979f;
+			constexpr float g_FilterRadius = 3.0f;
+			constexpr float g_KaiserAlpha = 4.0f;
+			constexpr std::uint32_t g_RowGrain = 8;
+
+			// Float image in linear space, Channels floats per pixel, tightly packed //
+
+			struct LinearImage
+			{
+				std::uint32_t Width = 0;
+				std::uint32_t Height = 0;
+				std::vector<float> Pixels;
+			};
+
+			// Source pixels contributing to one destination pixel along one axis //
+
+			struct Contributor
+			{
+				std::uint32_t First;
+				std::uint32_t Count;
+				std::uint32_t WeightOffset;
+			};
+
+			struct FilterTable
+			{
+				std::vector<Contributor> Contributors;
+				std::vector<float> Weights;
+			};
+
+			float Sinc(float x)
+			{
+				if (std::fabs(x) < 1e-5f)
+				{
+					return 1.0f;
+				}
+
+				x *= g_Pi;
+				return std::sin(x) / x;
+			}
+
+			// Zeroth order modified Bessel function of the first kind, power series //
+
+			float BesselI0(float x)
+			{
+				float sum = 1.0f, term = 1.0f;
+				const float halfSquared = x * x * 0.25f;
+
+				for (std::uint32_t k = 1; k < 32 && term > sum * 1e-8f; ++k)
+				{
+					term *= halfSquared / static_cast<float>(k * k);
+					sum += term;
+				}
+
+				return sum;
+			}
+
+			float FilterValue(MipFilter filter, float x)
+			{
+				x = std::fabs(x);
+				if (x >= g_FilterRadius)
+				{
+					return 0.0f;
+				}
+
+				if (filter == MipFilter::Lanczos)
+				{
+					return Sinc(x) * Sinc(x / g_FilterRadius);
+				}
+
+				const float ratio = x / g_FilterRadius;
+				return Sinc(x) * BesselI0(g_KaiserAlpha * std::sqrt(1.0f - ratio * ratio)) / BesselI0(g_KaiserAlpha);
+			}
+
+			// Weights are normalized per destination pixel and edges clamp to the image //
+
+			FilterTable BuildFilterTable(std::uint32_t sourceSize, std::uint32_t destinationSize, MipFilter filter)
+			{
+				FilterTable table;
+				table.Contributors.resize(destinationSize);
+
+				const float scale = static_cast<float>(sourceSize) / static_cast<float>(destinationSize);
+				const float support = filter == MipFilter::Box ? scale * 0.5f : g_FilterRadius * std::max(scale, 1.0f);
+
+				for (std::uint32_t i = 0; i < destinationSize; ++i)
+				{
+					const float center = (static_cast<float>(i) + 0.5f) * scale;
+					const std::int32_t first = static_cast<std::int32_t>(std::floor(center - support));
+					const std::int32_t last = static_cast<std::int32_t>(std::ceil(center + support));
+
+					// Taps outside the image fold onto the edge pixel //
+
+					const std::int32_t clampedFirst = std::max(first, 0);
+					const std::int32_t clampedLast = std::min(last, static_cast<std::int32_t>(sourceSize)) - 1;
+
+					float weights[64] = {};
+					std::vector<float> wideWeights;
+					float* folded = weights;
+					if (clampedLast - clampedFirst + 1 > 64)
+					{
+						wideWeights.resize(static_cast<std::size_t>(clampedLast - clampedFirst + 1));
+						folded = wideWeights.data();
+					}
+
+					std::uint32_t lowest = sourceSize, highest = 0;
+					float total = 0.0f;
+
+					for (std::int32_t j = first; j < last; ++j)
+					{
+						float weight;
+						if (filter == MipFilter::Box)
+						{
+							// Overlap of [j, j + 1] with the destination footprint //
+							weight = std::min(static_cast<float>(j + 1), center + support) - std::max(static_cast<float>(j), center - support);
+						}
+						else
+						{
+							weight = FilterValue(filter, (static_cast<float>(j) + 0.5f - center) / std::max(scale, 1.0f));
+						}
+
+						if (weight == 0.0f || (filter == MipFilter::Box && weight < 0.0f))
+						{
+							continue;
+						}
+
+						const std::uint32_t source = static_cast<std::uint32_t>(std::min(std::max(j, 0), static_cast<std::int32_t>(sourceSize) - 1));
+						folded[source - clampedFirst] += weight;
+						total += weight;
+						lowest = std::min(lowest, source);
+						highest = std::max(highest, source);
+					}
+
+					Contributor& contributor = table.Contributors[i];
+					contributor.First = lowest;
+					contributor.Count = highest - lowest + 1;
+					contributor.WeightOffset = static_cast<std::uint32_t>(table.Weights.size());
+
+					for (std::uint32_t j = lowest; j <= highest; ++j)
+					{
+						table.Weights.push_back(folded[j - clampedFirst] / total);
+					}
+				}
+
+				return table;
+			}
+
+			// destination[n] += weight * source[n] //
+
+			void AccumulateRow(float* destination, const float* source, float weight, std::size_t count)
+			{
+				std::size_t n = 0;
+
+#if defined(POWERENGINE_MIP_SSE)
+				const __m128 factor = _mm_set1_ps(weight);
+				for (; n + 4 <= count; n += 4)
+				{
+					__m128 value = _mm_add_ps(_mm_loadu_ps(destination + n), _mm_mul_ps(factor, _mm_loadu_ps(source + n)));
+					_mm_storeu_ps(destination + n, value);
+				}
+#endif
+
+				for (; n < count; ++n)
+				{
+					destination[n] += weight * source[n];
+				}
+			}
+
+			void FilterHorizontal(const LinearImage& source, LinearImage& destination, std::uint32_t channels, const FilterTable& table,
+				std::uint32_t beginRow, std::uint32_t endRow)
+			{
+				for (std::uint32_t y = beginRow; y < endRow; ++y)
+				{
+					const float* sourceRow = source.Pixels.data() + std::size_t(y) * source.Width * channels;
+					float* destinationRow = destination.Pixels.data() + std::size_t(y) * destination.Width * channels;
+
+					for (std::uint32_t x = 0; x < destination.Width; ++x)
+					{
+						const Contributor& contributor = table.Contributors[x];
+						const float* weights = table.Weights.data() + contributor.WeightOffset;
+						const float* taps = sourceRow + std::size_t(contributor.First) * channels;
+
+#if defined(POWERENGINE_MIP_SSE)
+						if (channels == 4)
+						{
+							__m128 sum = _mm_setzero_ps();
+							for (std::uint32_t k = 0; k < contributor.Count; ++k)
+							{
+								sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(taps + k * 4)));
+							}
+							_mm_storeu_ps(destinationRow + x * 4, sum);
+							continue;
+						}
+#endif
+
+						for (std::uint32_t c = 0; c < channels; ++c)
+						{
+							float sum = 0.0f;
+							for (std::uint32_t k = 0; k < contributor.Count; ++k)
+							{
+								sum += weights[k] * taps[k * channels + c];
+							}
+							destinationRow[x * channels + c] = sum;
+						}
+					}
+				}
+			}
+
+			void FilterVertical(const LinearImage& source, LinearImage& destination, std::uint32_t channels, const FilterTable& table,
+				std::uint32_t beginRow, std::uint32_t endRow)
+			{
+				const std::size_t rowFloats = std::size_t(destination.Width) * channels;
+
+				for (std::uint32_t y = beginRow; y < endRow; ++y)
+				{
+					const Contributor& contributor = table.Contributors[y];
+					const float* weights = table.Weights.data() + contributor.WeightOffset;
+					float* destinationRow = destination.Pixels.data() + std::size_t(y) * rowFloats;
+
+					std::fill(destinationRow, destinationRow + rowFloats, 0.0f);
+
+					for (std::uint32_t k = 0; k < contributor.Count; ++k)
+					{
+						AccumulateRow(destinationRow, source.Pixels.data() + std::size_t(contributor.First + k) * rowFloats, weights[k], rowFloats);
+					}
+				}
+			}
+
+			// sRGB transfer functions //
+
+			const float* SrgbToLinearTable()
+			{
+				static const std::vector<float> table = []
+				{
+					std::vector<float> values(256);
+					for (std::uint32_t i = 0; i < 256; ++i)
+					{
+						float c = static_cast<float>(i) / 255.0f;
+						values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+					}
+					return values;
+				}();
+
+				return table.data();
+			}
+
+			float LinearToSrgb(float c)
+			{
+				c = std::min(std::max(c, 0.0f), 1.0f);
+				return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+			}
+
+			std::uint8_t ToUnorm8(float c)
+			{
+				return static_cast<std::uint8_t>(std::min(std::max(c, 0.0f), 1.0f) * 255.0f + 0.5f);
+			}
+
+			std::uint32_t ChannelCount(MipFormat format)
+			{
+				return format == MipFormat::R32F ? 1 : 4;
+			}
+
+			void LoadRows(const MipSource& source, LinearImage& image, std::uint32_t beginRow, std::uint32_t endRow)
+			{
+				const std::uint32_t channels = ChannelCount(source.Format);
+				const float* srgb = SrgbToLinearTable();
+
+				for (std::uint32_t y = beginRow; y < endRow; ++y)
+				{
+					const std::uint8_t* sourceRow = static_cast<const std::uint8_t*>(source.Pixels) + std::size_t(source.RowPitch) * y;
+					float* row = image.Pixels.data() + std::size_t(y) * image.Width * channels;
+
+					for (std::uint32_t x = 0; x < image.Width; ++x)
+					{
+						float* pixel = row + x * channels;
+
+						switch (source.Format)
+						{
+						case MipFormat::RGBA8:
+							for (std::uint32_t c = 0; c < 4; ++c)
+							{
+								pixel[c] = sourceRow[x * 4 + c] / 255.0f;
+							}
+							break;
+						case MipFormat::RGBA8Srgb:
+							// Alpha is linear already //
+							for (std::uint32_t c = 0; c < 3; ++c)
+							{
+								pixel[c] = srgb[sourceRow[x * 4 + c]];
+							}
+							pixel[3] = sourceRow[x * 4 + 3] / 255.0f;
+							break;
+						case MipFormat::RGBA16F:
+							for (std::uint32_t c = 0; c < 4; ++c)
+							{
+								std::uint16_t half;
+								std::memcpy(&half, sourceRow + x * 8 + c * 2, 2);
+								pixel[c] = HalfToFloat(half);
+							}
+							break;
+						case MipFormat::R32F:
+							std::memcpy(pixel, sourceRow + x * 4, 4);
+							break;
+						}
+					}
+				}
+			}
+
+			void StoreRows(const LinearImage& image, MipFormat format, std::uint8_t* destination, std::uint32_t rowPitch,
+				std::uint32_t beginRow, std::uint32_t endRow)
+			{
+				const std::uint32_t channels = ChannelCount(format);
+
+				for (std::uint32_t y = beginRow; y < endRow; ++y)
+				{
+					const float* row = image.Pixels.data() + std::size_t(y) * image.Width * channels;
+					std::uint8_t* destinationRow = destination + std::size_t(rowPitch) * y;
+
+					for (std::uint32_t x = 0; x < image.Width; ++x)
+					{
+						const float* pixel = row + x * channels;
+
+						switch (format)
+						{
+						case MipFormat::RGBA8:
+							for (std::uint32_t c = 0; c < 4; ++c)
+							{
+								destinationRow[x * 4 + c] = ToUnorm8(pixel[c]);
+							}
+							break;
+						case MipFormat::RGBA8Srgb:
+							for (std::uint32_t c = 0; c < 3; ++c)
+							{
+								destinationRow[x * 4 + c] = ToUnorm8(LinearToSrgb(pixel[c]));
+							}
+							destinationRow[x * 4 + 3] = ToUnorm8(pixel[3]);
+							break;
+						case MipFormat::RGBA16F:
+							for (std::uint32_t c = 0; c < 4; ++c)
+							{
+								std::uint16_t half = FloatToHalf(pixel[c]);
+								std::memcpy(destinationRow + x * 8 + c * 2, &half, 2);
+							}
+							break;
+						case MipFormat::R32F:
+							std::memcpy(destinationRow + x * 4, pixel, 4);
+							break;
+						}
+					}
+				}
+			}
+		}
+
+		std::uint32_t MipBytesPerPixel(MipFormat format)
+		{
+			return format == MipFormat::RGBA16F ? 8 : 4;
+		}
+
+		std::uint32_t MipLevelCount(std::uint32_t width, std::uint32_t height)
+		{
+			std::uint32_t levels = 1;
+			for (std::uint32_t size = std::max(width, height); size > 1; size >>= 1)
+			{
+				levels++;
+			}
+			return levels;
+		}
+
+		void GenerateMips(const MipSource& source, MipFilter filter, std::uint32_t mipCount,
+			std::uint8_t* destination, const MipLevelLayout* layouts, Core::ThreadPool& pool)
+		{
+			if (mipCount == 0)
+			{
+				return;
+			}
+
+			const std::uint32_t channels = ChannelCount(source.Format);
+			const std::size_t rowBytes = std::size_t(source.Width) * MipBytesPerPixel(source.Format);
+
+			// Level 0 is the source itself, copied bit exact //
+
+			pool.ParallelFor(source.Height, g_RowGrain * 4, [&](std::uint32_t begin, std::uint32_t end)
+			{
+				for (std::uint32_t y = begin; y < end; ++y)
+				{
+					std::memcpy(destination + layouts[0].Offset + std::size_t(layouts[0].RowPitch) * y,
+						static_cast<const std::uint8_t*>(source.Pixels) + std::size_t(source.RowPitch) * y, rowBytes);
+				}
+			});
+
+			if (mipCount == 1)
+			{
+				return;
+			}
+
+			LinearImage current;
+			current.Width = source.Width;
+			current.Height = source.Height;
+			current.Pixels.resize(std::size_t(current.Width) * current.Height * channels);
+
+			pool.ParallelFor(source.Height, g_RowGrain, [&](std::uint32_t begin, std::uint32_t end)
+			{
+				LoadRows(source, current, begin, end);
+			});
+
+			LinearImage horizontal;
+			LinearImage next;
+
+			for (std::uint32_t mip = 1; mip < mipCount; ++mip)
+			{
+				const std::uint32_t width = MipDimension(source.Width, mip);
+				const std::uint32_t height = MipDimension(source.Height, mip);
+
+				const FilterTable columns = BuildFilterTable(current.Width, width, filter);
+				const FilterTable rows = BuildFilterTable(current.Height, height, filter);
+
+				horizontal.Width = width;
+				horizontal.Height = current.Height;
+				horizontal.Pixels.resize(std::size_t(width) * current.Height * channels);
+
+				pool.ParallelFor(current.Height, g_RowGrain, [&](std::uint32_t begin, std::uint32_t end)
+				{
+					FilterHorizontal(current, horizontal, channels, columns, begin, end);
+				});
+
+				next.Width = width;
+				next.Height = height;
+				next.Pixels.resize(std::size_t(width) * height * channels);
+
+				// Each band of rows is filtered and stored by the same worker while it is hot in cache //
+
+				std::uint8_t* level = destination + layouts[mip].Offset;
+				pool.ParallelFor(height, g_RowGrain, [&](std::uint32_t begin, std::uint32_t end)
+				{
+					FilterVertical(horizontal, next, channels, rows, begin, end);
+					StoreRows(next, source.Format, level, layouts[mip].RowPitch, begin, end);
+				});
+
+				std::swap(current, next);
+			}
+		}
+
+		std::uint16_t FloatToHalf(float value)
+		{
+			std::uint32_t bits;
+			std::memcpy(&bits, &value, 4);
+
+			const std::uint32_t sign = (bits >> 16) & 0x8000;
+			const std::uint32_t exponent = (bits >> 23) & 0xFF;
+			std::uint32_t mantissa = bits & 0x7FFFFF;
+
+			if (exponent == 0xFF)
+			{
+				// Infinity stays infinity, NaN keeps a quiet payload //
+				return static_cast<std::uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+			}
+
+			const std::int32_t halfExponent = static_cast<std::int32_t>(exponent) - 127 + 15;
+
+			if (halfExponent >= 31)
+			{
+				return static_cast<std::uint16_t>(sign | 0x7C00);
+			}
+
+			if (halfExponent <= 0)
+			{
+				// Subnormal half or zero //
+				if (halfExponent < -10)
+				{
+					return static_cast<std::uint16_t>(sign);
+				}
+
+				mantissa |= 0x800000;
+				const std::uint32_t shift = static_cast<std::uint32_t>(14 - halfExponent);
+				std::uint32_t half = mantissa >> shift;
+				const std::uint32_t remainder = mantissa & ((1u << shift) - 1);
+				const std::uint32_t halfway = 1u << (shift - 1);
+
+				if (remainder > halfway || (remainder == halfway && (half & 1)))
+				{
+					half++;
+				}
+
+				return static_cast<std::uint16_t>(sign | half);
+			}
+
+			std::uint32_t half = (static_cast<std::uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+			const std::uint32_t remainder = mantissa & 0x1FFF;
+
+			// A carry out of the mantissa correctly bumps the exponent, up to infinity //
+
+			if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+			{
+				half++;
+			}
+
+			return static_cast<std::uint16_t>(sign | half);
+		}
+
+		float HalfToFloat(std::uint16_t value)
+		{
+			const std::uint32_t sign = std::uint32_t(value & 0x8000) << 16;
+			std::uint32_t exponent = (value >> 10) & 0x1F;
+			std::uint32_t mantissa = value & 0x3FF;
+			std::uint32_t bits;
+
+			if (exponent == 0x1F)
+			{
+				bits = sign | 0x7F800000 | (mantissa << 13);
+			}
+			else if (exponent != 0)
+			{
+				bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+			}
+			else if (mantissa == 0)
+			{
+				bits = sign;
+			}
+			else
+			{
+				// Normalize the subnormal //
+				exponent = 127 - 15 + 1;
+				while ((mantissa & 0x400) == 0)
+				{
+					mantissa <<= 1;
+					exponent--;
+				}
+				bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+			}
+
+			float result;
+			std::memcpy(&result, &bits, 4);
+			return result;
+		}
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "ThreadPool.h"
+
+#include <cstdint>
+
+namespace PowerEngine {
+
+	namespace Assets {
+
+		enum class MipFormat : std::uint8_t
+		{
+			RGBA8 = 0,		// DXGI_FORMAT_R8G8B8A8_UNORM
+			RGBA8Srgb,		// DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, filtered in linear space
+			RGBA16F,		// DXGI_FORMAT_R16G16B16A16_FLOAT
+			R32F			// DXGI_FORMAT_R32_FLOAT
+		};
+
+		enum class MipFilter : std::uint8_t
+		{
+			Box = 0,		// area average, exact 2x2 average on even sizes
+			Kaiser,			// Kaiser windowed sinc, radius 3
+			Lanczos			// Lanczos 3
+		};
+
+		// Placement of one mip in the destination buffer //
+		/*
+		   Mirrors D3D12_PLACED_SUBRESOURCE_FOOTPRINT : Offset and RowPitch are taken as is
+		   from D3DX12GetCopyableFootprints so the generator writes the upload buffer layout
+		   directly. See MipGeneratorD3D12.h for the conversion.
+		*/
+
+		struct MipLevelLayout
+		{
+			std::uint64_t Offset;
+			std::uint32_t RowPitch;
+		};
+
+		struct MipSource
+		{
+			const void* Pixels;
+			std::uint32_t Width;
+			std::uint32_t Height;
+			std::uint32_t RowPitch;
+			MipFormat Format;
+		};
+
+		std::uint32_t MipBytesPerPixel(MipFormat format);
+		std::uint32_t MipLevelCount(std::uint32_t width, std::uint32_t height);
+		inline std::uint32_t MipDimension(std::uint32_t size, std::uint32_t mip) { return (size >> mip) > 0 ? (size >> mip) : 1; }
+
+		// Writes mipCount levels, level 0 being a copy of the source. //
+		// Each level is filtered from the previous one at full float precision, rows being //
+		// split across the thread pool. Sizes need not be powers of two : a level is floor(size / 2). //
+
+		void GenerateMips(const MipSource& source, MipFilter filter, std::uint32_t mipCount,
+			std::uint8_t* destination, const MipLevelLayout* layouts, Core::ThreadPool& pool = Core::ThreadPool::Global());
+
+		// Half float conversions, round to nearest even //
+
+		std::uint16_t FloatToHalf(float value);
+		float HalfToFloat(std::uint16_t value);
+	}
+}
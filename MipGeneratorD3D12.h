@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Header.h"
+#include "MipGenerator.h"
+
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Assets {
+
+		// Layouts of the first mipCount subresources of desc, as CopyTextureRegion expects them //
+		/*
+		   totalBytes receives the upload buffer size. The same footprints are then used
+		   for the CD3DX12_TEXTURE_COPY_LOCATION of each mip. Returns an empty vector when
+		   desc has fewer than mipCount mips or its footprints can't be computed.
+		*/
+
+		inline std::vector<MipLevelLayout> MipLayoutsFromFootprints(const D3D12_RESOURCE_DESC& desc, std::uint32_t mipCount,
+			std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT>& footprints, UINT64& totalBytes, UINT64 baseOffset = 0)
+		{
+			// Past the last mip the footprints run into the next array slice //
+
+			if (mipCount > desc.MipLevels)
+			{
+				return {};
+			}
+
+			footprints.resize(mipCount);
+			if (!D3DX12GetCopyableFootprints(desc, 0, mipCount, baseOffset, footprints.data(), nullptr, nullptr, &totalBytes))
+			{
+				return {};
+			}
+
+			std::vector<MipLevelLayout> layouts(mipCount);
+			for (std::uint32_t mip = 0; mip < mipCount; ++mip)
+			{
+				layouts[mip].Offset = footprints[mip].Offset - baseOffset;
+				layouts[mip].RowPitch = footprints[mip].Footprint.RowPitch;
+			}
+
+			return layouts;
+		}
+
+		// False for a format GenerateMips can't filter, mipFormat is left untouched //
+
+		inline bool MipFormatFromDxgi(DXGI_FORMAT format, MipFormat& mipFormat)
+		{
+			switch (format)
+			{
+			case DXGI_FORMAT_R8G8B8A8_UNORM: mipFormat = MipFormat::RGBA8; return true;
+			case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB: mipFormat = MipFormat::RGBA8Srgb; return true;
+			case DXGI_FORMAT_R16G16B16A16_FLOAT: mipFormat = MipFormat::RGBA16F; return true;
+			case DXGI_FORMAT_R32_FLOAT: mipFormat = MipFormat::R32F; return true;
+			default: return false;
+			}
+		}
+	}
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// Keys the engine reacts to, the platform layer maps its own key codes to them //
+
+		enum class PlatformKey : std::uint8_t
+		{
+			Unknown,
+			V,
+			H,
+			Enter,
+			Escape,
+			F11,
+			F12
+		};
+
+		enum class PlatformEventType : std::uint8_t
+		{
+			Paint,		// time to produce a frame, sent by the headless platform and the render thread
+			Key,
+			Resize,
+			BeginFrame	// before the input of the next frame is handed over, the handler may wait in it
+		};
+
+		struct PlatformEvent
+		{
+			PlatformEventType Type = PlatformEventType::Paint;
+			PlatformKey Key = PlatformKey::Unknown;
+			bool Alt = false;
+			std::uint32_t Width = 0;		// Resize, client area in pixels
+			std::uint32_t Height = 0;
+			bool Sizing = false;			// Resize, the border is still being dragged, a final Resize follows
+		};
+
+		using PlatformEventHandler = std::function<void(const PlatformEvent&)>;
+
+		// What the engine needs from the operating system //
+		/*
+		   The engine core renders into whatever the platform gives it: a window's swap
+		   chain when NativeWindow() is not null, offscreen render targets otherwise. Events
+		   reach the handler on the thread calling ProcessEvents(). Quit() and
+		   SetFullScreen() may be called from any thread.
+		*/
+
+		class Platform
+		{
+		public:
+
+			virtual ~Platform() = default;
+
+			// Dispatches pending events to the handler, returns false once the application should quit //
+
+			virtual bool ProcessEvents() = 0;
+
+			virtual void Show() {}
+			virtual void Quit() = 0;
+			virtual void SetFullScreen(bool fullscreen) { (void)fullscreen; }
+
+			void SetEventHandler(PlatformEventHandler handler) { m_Handler = std::move(handler); }
+
+			// Getters //
+
+			virtual void* NativeWindow() const = 0;		// HWND on Windows, null when headless
+			virtual bool FullScreen() const { return false; }
+			bool Headless() const { return NativeWindow() == nullptr; }
+
+		protected:
+
+			void Dispatch(const PlatformEvent& event) const
+			{
+				if (m_Handler)
+				{
+					m_Handler(event);
+				}
+			}
+
+		private:
+
+			PlatformEventHandler m_Handler;
+		};
+	}
+}
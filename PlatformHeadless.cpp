@@ -0,0 +1,34 @@
+#include "PlatformHeadless.h"
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		PlatformHeadless::PlatformHeadless(std::uint64_t frameCount)
+			: m_FrameCount(frameCount)
+		{
+		}
+
+		bool PlatformHeadless::ProcessEvents()
+		{
+			if (m_Quit.load(std::memory_order_relaxed) || (m_FrameCount != 0 && m_Frames >= m_FrameCount))
+			{
+				return false;
+			}
+
+			++m_Frames;
+
+			PlatformEvent beginFrame;
+			beginFrame.Type = PlatformEventType::BeginFrame;
+			Dispatch(beginFrame);
+			Dispatch(PlatformEvent{});
+
+			return true;
+		}
+
+		void PlatformHeadless::Quit()
+		{
+			m_Quit.store(true, std::memory_order_relaxed);
+		}
+	}
+}
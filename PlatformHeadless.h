@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Platform.h"
+
+#include <atomic>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// No window, no swap chain: the engine renders into offscreen targets //
+		/*
+		   Every ProcessEvents() asks for one frame straight away, with no presentation or
+		   vsync to wait on, so frames come as fast as the device retires them. Used by
+		   batch render nodes and automated runs. Quit() may be called from any thread.
+		*/
+
+		class PlatformHeadless : public Platform
+		{
+		public:
+
+			// frameCount 0 renders until Quit() //
+
+			explicit PlatformHeadless(std::uint64_t frameCount = 0);
+
+			bool ProcessEvents() override;
+			void Quit() override;
+
+			// Getters //
+
+			void* NativeWindow() const override { return nullptr; }
+			std::uint64_t Frames() const { return m_Frames; }
+
+		private:
+
+			std::uint64_t m_FrameCount;
+			std::uint64_t m_Frames = 0;
+			std::atomic<bool> m_Quit{ false };
+		};
+	}
+}
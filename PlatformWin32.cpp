@@ -0,0 +1,274 @@
+#include "PlatformWin32.h"
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		namespace
+		{
+			const wchar_t* const g_WindowClassName = L"DX12WindowClass";
+
+			// Posted to the window so fullscreen switches run on the thread owning it, wParam is the new state //
+
+			constexpr UINT g_SetFullScreenMessage = WM_APP + 1;
+
+			PlatformKey TranslateKey(WPARAM key)
+			{
+				switch (key)
+				{
+				case 'V':			return PlatformKey::V;
+				case 'H':			return PlatformKey::H;
+				case VK_RETURN:		return PlatformKey::Enter;
+				case VK_ESCAPE:		return PlatformKey::Escape;
+				case VK_F11:		return PlatformKey::F11;
+				case VK_F12:		return PlatformKey::F12;
+				default:			return PlatformKey::Unknown;
+				}
+			}
+		}
+
+		PlatformWin32::PlatformWin32(HINSTANCE instance, const wchar_t* windowTitle, std::uint16_t width, std::uint16_t height)
+		{
+			RegisterWindowClass(instance, g_WindowClassName);
+			m_Window = CreateWindow(g_WindowClassName, instance, windowTitle, width, height, this);
+
+			::GetWindowRect(m_Window, &m_WindowRect);
+		}
+
+		PlatformWin32::~PlatformWin32()
+		{
+			if (m_Window)
+			{
+				::SetWindowLongPtrW(m_Window, GWLP_USERDATA, 0);
+				::DestroyWindow(m_Window);
+			}
+		}
+
+		bool PlatformWin32::ProcessEvents()
+		{
+			// Sleeps until a message arrives, 0 is WM_QUIT and -1 an error //
+
+			MSG msg = {};
+			if (::GetMessage(&msg, NULL, 0, 0) <= 0)
+			{
+				return false;
+			}
+
+			::TranslateMessage(&msg);
+			::DispatchMessage(&msg);
+
+			return true;
+		}
+
+		void PlatformWin32::Show()
+		{
+			::ShowWindow(m_Window, SW_SHOW);
+		}
+
+		void PlatformWin32::Quit()
+		{
+			::PostMessageW(m_Window, WM_CLOSE, 0, 0);
+		}
+
+		void PlatformWin32::SetFullScreen(bool fullscreen)
+		{
+			::PostMessageW(m_Window, g_SetFullScreenMessage, fullscreen ? 1 : 0, 0);
+		}
+
+		void PlatformWin32::ApplyFullScreen(bool fullscreen)
+		{
+			if (m_Fullscreen.load(std::memory_order_relaxed) != fullscreen)
+			{
+				m_Fullscreen.store(fullscreen, std::memory_order_relaxed);
+
+				if (fullscreen) // Switching to fullscreen.
+				{
+					// Store the current window dimensions so they can be restored when switching out of fullscreen state //
+					::GetWindowRect(m_Window, &m_WindowRect);
+
+					// Set the window style to a borderless window so the client area fills the entire screen //
+					UINT windowStyle = WS_OVERLAPPEDWINDOW & ~(WS_CAPTION | WS_SYSMENU | WS_THICKFRAME | WS_MINIMIZEBOX | WS_MAXIMIZEBOX);
+
+					::SetWindowLongW(m_Window, GWL_STYLE, windowStyle);
+
+					// Query the name of the nearest display device for the window.
+					// This is required to set the fullscreen dimensions of the window
+					// when using a multi-monitor setup
+
+					HMONITOR hMonitor = ::MonitorFromWindow(m_Window, MONITOR_DEFAULTTONEAREST);
+					MONITORINFOEX monitorInfo = {};
+					monitorInfo.cbSize = sizeof(MONITORINFOEX);
+					::GetMonitorInfo(hMonitor, &monitorInfo);
+
+					::SetWindowPos(m_Window, HWND_TOP,
+						monitorInfo.rcMonitor.left,
+						monitorInfo.rcMonitor.top,
+						monitorInfo.rcMonitor.right - monitorInfo.rcMonitor.left,
+						monitorInfo.rcMonitor.bottom - monitorInfo.rcMonitor.top,
+						SWP_FRAMECHANGED | SWP_NOACTIVATE);
+
+					::ShowWindow(m_Window, SW_MAXIMIZE);
+				}
+				else
+				{
+					// Restore all the window decorators.
+					::SetWindowLong(m_Window, GWL_STYLE, WS_OVERLAPPEDWINDOW);
+
+					::SetWindowPos(m_Window, HWND_NOTOPMOST,
+						m_WindowRect.left,
+						m_WindowRect.top,
+						m_WindowRect.right - m_WindowRect.left,
+						m_WindowRect.bottom - m_WindowRect.top,
+						SWP_FRAMECHANGED | SWP_NOACTIVATE);
+
+					::ShowWindow(m_Window, SW_NORMAL);
+				}
+			}
+		}
+
+		void PlatformWin32::RegisterWindowClass(HINSTANCE instance, const wchar_t* windowClassName)
+		{
+			// Register a window class for creating our render window with.
+			WNDCLASSEXW windowClass = {};
+
+			windowClass.cbSize = sizeof(WNDCLASSEX);
+			windowClass.style = CS_HREDRAW | CS_VREDRAW;
+			windowClass.lpfnWndProc = &WndProc;
+			windowClass.cbClsExtra = 0;
+			windowClass.cbWndExtra = 0;
+			windowClass.hInstance = instance;
+			windowClass.hIcon = ::LoadIcon(instance, NULL);
+			windowClass.hCursor = ::LoadCursor(NULL, IDC_ARROW);
+			windowClass.hbrBackground = (HBRUSH)(COLOR_WINDOW + 1);
+			windowClass.lpszMenuName = NULL;
+			windowClass.lpszClassName = windowClassName;
+			windowClass.hIconSm = ::LoadIcon(instance, NULL);
+
+			static ATOM atom = ::RegisterClassExW(&windowClass);
+			assert(atom > 0);
+		}
+
+		HWND PlatformWin32::CreateWindow(const wchar_t* windowClassName, HINSTANCE instance, const wchar_t* windowTitle, std::uint16_t width, std::uint16_t height, PlatformWin32* platform)
+		{
+			int screenWidth = ::GetSystemMetrics(SM_CXSCREEN);
+			int screenHeight = ::GetSystemMetrics(SM_CYSCREEN);
+
+			RECT windowRect = { 0, 0, static_cast<LONG>(width), static_cast<LONG>(height) };
+			::AdjustWindowRect(&windowRect, WS_OVERLAPPEDWINDOW, FALSE);
+
+			int windowWidth = windowRect.right - windowRect.left;
+			int windowHeight = windowRect.bottom - windowRect.top;
+
+			// Center the window within the screen. Clamp to 0, 0 for the top-left corner.
+			int windowX = std::max<int>(0, (screenWidth - windowWidth) / 2);
+			int windowY = std::max<int>(0, (screenHeight - windowHeight) / 2);
+
+			// The platform rides along to WM_NCCREATE, which stores it in the window's user data //
+
+			HWND hWnd = ::CreateWindowExW(
+				NULL,
+				windowClassName,
+				windowTitle,
+				WS_OVERLAPPEDWINDOW,
+				windowX,
+				windowY,
+				windowWidth,
+				windowHeight,
+				NULL,
+				NULL,
+				instance,
+				platform
+			);
+
+			assert(hWnd && "Failed to create window");
+
+			return hWnd;
+		}
+
+		LRESULT CALLBACK PlatformWin32::WndProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam)
+		{
+			if (message == WM_NCCREATE)
+			{
+				const CREATESTRUCTW* create = reinterpret_cast<const CREATESTRUCTW*>(lParam);
+				::SetWindowLongPtrW(hwnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(create->lpCreateParams));
+			}
+
+			PlatformWin32* platform = reinterpret_cast<PlatformWin32*>(::GetWindowLongPtrW(hwnd, GWLP_USERDATA));
+			if (!platform)
+			{
+				return ::DefWindowProcW(hwnd, message, wParam, lParam);
+			}
+
+			return platform->HandleMessage(hwnd, message, wParam, lParam);
+		}
+
+		LRESULT PlatformWin32::HandleMessage(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam)
+		{
+			PlatformEvent event;
+
+			switch (message)
+			{
+			case WM_PAINT:
+
+				::ValidateRect(hwnd, nullptr);
+
+				break;
+
+			case WM_SYSKEYDOWN:
+			case WM_KEYDOWN:
+
+				event.Type = PlatformEventType::Key;
+				event.Key = TranslateKey(wParam);
+				event.Alt = (::GetAsyncKeyState(VK_MENU) & 0x8000) != 0;
+				Dispatch(event);
+
+				break;
+
+			// The default window procedure will play a system notification sound 
+			// when pressing the Alt+Enter keyboard combination if this message is 
+			// not handled.
+			case WM_SYSCHAR:
+				break;
+
+			// While the border is dragged the sizes are only previews, WM_EXITSIZEMOVE sends the final one //
+
+			case WM_ENTERSIZEMOVE:
+
+				m_SizeMove = true;
+
+				break;
+
+			case WM_SIZE:
+			case WM_EXITSIZEMOVE:
+			{
+				m_SizeMove = m_SizeMove && message != WM_EXITSIZEMOVE;
+
+				RECT clientRect = {};
+				::GetClientRect(hwnd, &clientRect);
+
+				event.Type = PlatformEventType::Resize;
+				event.Width = static_cast<std::uint32_t>(clientRect.right - clientRect.left);
+				event.Height = static_cast<std::uint32_t>(clientRect.bottom - clientRect.top);
+				event.Sizing = m_SizeMove;
+				Dispatch(event);
+			}
+			break;
+
+			case g_SetFullScreenMessage:
+
+				ApplyFullScreen(wParam != 0);
+
+				break;
+
+			case WM_CLOSE:
+			case WM_DESTROY:
+				::PostQuitMessage(0);
+				break;
+			default:
+				return ::DefWindowProcW(hwnd, message, wParam, lParam);
+			}
+
+			return 0;
+		}
+	}
+}
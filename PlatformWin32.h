@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Header.h"
+#include "Platform.h"
+
+#include <atomic>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// A Win32 window the engine presents to //
+		/*
+		   Owns the window class, the window and its borderless fullscreen state. Key
+		   presses and client area changes become PlatformEvents, everything else goes to
+		   DefWindowProc. ProcessEvents() sleeps in GetMessage, frames come from a
+		   RenderThread, so WM_PAINT only validates the window. Closing the window quits
+		   but the window itself lives until the platform is destroyed, after the renderer
+		   is done presenting to it.
+		*/
+
+		class PlatformWin32 : public Platform
+		{
+		public:
+
+			PlatformWin32(HINSTANCE instance, const wchar_t* windowTitle, std::uint16_t width, std::uint16_t height);
+			~PlatformWin32();
+
+			bool ProcessEvents() override;
+
+			void Show() override;
+			void Quit() override;
+			void SetFullScreen(bool fullscreen) override;
+
+			// Getters //
+
+			void* NativeWindow() const override { return m_Window; }
+			bool FullScreen() const override { return m_Fullscreen.load(std::memory_order_relaxed); }
+
+		private:
+
+			static void RegisterWindowClass(HINSTANCE instance, const wchar_t* windowClassName);
+			static HWND CreateWindow(const wchar_t* windowClassName, HINSTANCE instance, const wchar_t* windowTitle, std::uint16_t width, std::uint16_t height, PlatformWin32* platform);
+
+			// CALLBACK //
+
+			static LRESULT CALLBACK WndProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam);
+
+			LRESULT HandleMessage(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam);
+
+			// Pump thread side of SetFullScreen() //
+
+			void ApplyFullScreen(bool fullscreen);
+
+		private:
+
+			HWND m_Window = nullptr;
+			RECT m_WindowRect = {};		// restored when leaving fullscreen
+			bool m_SizeMove = false;	// inside the modal move / size loop, pump thread only
+			std::atomic<bool> m_Fullscreen{ false };
+		};
+	}
+}
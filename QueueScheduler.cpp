@@ -0,0 +1,270 @@
+#include "QueueScheduler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <map>
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		PassId QueueScheduler::AddPass(const char* name, bool asyncComputeEligible, std::initializer_list<PassId> dependencies)
+		{
+			PassId id = static_cast<PassId>(m_Passes.size());
+
+			Pass pass;
+			pass.Name = name;
+			pass.AsyncComputeEligible = asyncComputeEligible;
+			m_Passes.push_back(std::move(pass));
+
+			for (PassId dependency : dependencies)
+			{
+				AddDependency(id, dependency);
+			}
+
+			return id;
+		}
+
+		void QueueScheduler::AddDependency(PassId pass, PassId dependsOn)
+		{
+			assert(dependsOn < pass && "A pass can only depend on passes added before it.");
+			m_Passes[pass].Dependencies.push_back(dependsOn);
+		}
+
+		void QueueScheduler::Clear()
+		{
+			m_Passes.clear();
+			m_Batches.clear();
+			m_ComputeJoinValue = 0;
+		}
+
+		void QueueScheduler::Compile(bool enableAsyncCompute)
+		{
+			constexpr std::size_t queueCount = static_cast<std::size_t>(QueueType::Count);
+
+			m_Batches.clear();
+			m_ComputeJoinValue = 0;
+
+			for (Pass& pass : m_Passes)
+			{
+				pass.Queue = enableAsyncCompute && pass.AsyncComputeEligible ? QueueType::Compute : QueueType::Direct;
+				pass.NeedsSignal = false;
+				pass.SignalValue = 0;
+			}
+
+			for (const Pass& pass : m_Passes)
+			{
+				for (PassId dependency : pass.Dependencies)
+				{
+					if (m_Passes[dependency].Queue != pass.Queue)
+					{
+						m_Passes[dependency].NeedsSignal = true;
+					}
+				}
+			}
+
+			ScheduledBatch current[queueCount];
+			std::uint64_t fenceValues[queueCount] = {};
+			std::uint64_t waited[queueCount][queueCount] = {};
+
+			for (std::size_t q = 0; q < queueCount; ++q)
+			{
+				current[q].Queue = static_cast<QueueType>(q);
+			}
+
+			auto close = [&](std::size_t q)
+			{
+				if (!current[q].Passes.empty())
+				{
+					m_Batches.push_back(std::move(current[q]));
+				}
+				current[q] = ScheduledBatch();
+				current[q].Queue = static_cast<QueueType>(q);
+			};
+
+			for (PassId id = 0; id < m_Passes.size(); ++id)
+			{
+				Pass& pass = m_Passes[id];
+				const std::size_t q = static_cast<std::size_t>(pass.Queue);
+
+				std::uint64_t required[queueCount] = {};
+				for (PassId dependency : pass.Dependencies)
+				{
+					const Pass& other = m_Passes[dependency];
+					if (other.Queue != pass.Queue)
+					{
+						std::size_t o = static_cast<std::size_t>(other.Queue);
+						required[o] = std::max(required[o], other.SignalValue);
+					}
+				}
+
+				std::vector<ScheduledWait> waits;
+				for (std::size_t o = 0; o < queueCount; ++o)
+				{
+					if (required[o] > waited[q][o])
+					{
+						waits.push_back({ static_cast<QueueType>(o), required[o] });
+						waited[q][o] = required[o];
+					}
+				}
+
+				// A wait applies to a whole command list, so it starts a new batch //
+
+				if (!waits.empty())
+				{
+					close(q);
+					current[q].Waits = std::move(waits);
+				}
+
+				current[q].Passes.push_back(id);
+
+				if (pass.NeedsSignal)
+				{
+					pass.SignalValue = ++fenceValues[q];
+					current[q].SignalValue = pass.SignalValue;
+					close(q);
+				}
+			}
+
+			// The frame ends on the direct queue, which joins the compute work still running //
+
+			const std::size_t compute = static_cast<std::size_t>(QueueType::Compute);
+			if (!current[compute].Passes.empty())
+			{
+				current[compute].SignalValue = ++fenceValues[compute];
+			}
+			m_ComputeJoinValue = fenceValues[compute];
+
+			close(static_cast<std::size_t>(QueueType::Direct));
+			close(compute);
+		}
+
+		double MeasureOverlap(const std::vector<PassTiming>& timings)
+		{
+			using Interval = std::pair<double, double>;
+
+			auto merged = [&](QueueType queue)
+			{
+				std::vector<Interval> intervals;
+				for (const PassTiming& timing : timings)
+				{
+					if (timing.Queue == queue)
+					{
+						intervals.emplace_back(timing.Begin, timing.End);
+					}
+				}
+
+				std::sort(intervals.begin(), intervals.end());
+
+				std::vector<Interval> result;
+				for (const Interval& interval : intervals)
+				{
+					if (!result.empty() && interval.first <= result.back().second)
+					{
+						result.back().second = std::max(result.back().second, interval.second);
+					}
+					else
+					{
+						result.push_back(interval);
+					}
+				}
+				return result;
+			};
+
+			std::vector<Interval> direct = merged(QueueType::Direct);
+			std::vector<Interval> compute = merged(QueueType::Compute);
+
+			double overlap = 0.0;
+			std::size_t i = 0, j = 0;
+			while (i < direct.size() && j < compute.size())
+			{
+				double begin = std::max(direct[i].first, compute[j].first);
+				double end = std::min(direct[i].second, compute[j].second);
+				if (end > begin)
+				{
+					overlap += end - begin;
+				}
+
+				if (direct[i].second < compute[j].second)
+				{
+					++i;
+				}
+				else
+				{
+					++j;
+				}
+			}
+
+			return overlap;
+		}
+
+		bool ValidateTimings(const QueueScheduler& scheduler, const std::vector<PassTiming>& timings)
+		{
+			std::vector<const PassTiming*> byPass(scheduler.PassCount(), nullptr);
+			for (const PassTiming& timing : timings)
+			{
+				byPass[timing.Pass] = &timing;
+			}
+
+			for (PassId pass = 0; pass < scheduler.PassCount(); ++pass)
+			{
+				if (!byPass[pass])
+				{
+					return false;
+				}
+
+				for (PassId dependency : scheduler.PassDependencies(pass))
+				{
+					if (!byPass[dependency] || byPass[dependency]->End > byPass[pass]->Begin)
+					{
+						return false;
+					}
+				}
+			}
+
+			return true;
+		}
+
+		std::vector<PassTiming> SimulateQueues(const QueueScheduler& scheduler, const std::vector<double>& passDurations)
+		{
+			constexpr std::size_t queueCount = static_cast<std::size_t>(QueueType::Count);
+
+			double queueTime[queueCount] = {};
+			std::map<std::uint64_t, double> signalTimes[queueCount];
+			std::vector<PassTiming> timings;
+			timings.reserve(scheduler.PassCount());
+
+			// Every wait refers to a batch earlier in the list, so list order is a valid execution order //
+
+			for (const ScheduledBatch& batch : scheduler.Batches())
+			{
+				const std::size_t q = static_cast<std::size_t>(batch.Queue);
+				double start = queueTime[q];
+
+				for (const ScheduledWait& wait : batch.Waits)
+				{
+					const std::map<std::uint64_t, double>& signals = signalTimes[static_cast<std::size_t>(wait.Queue)];
+					auto it = signals.lower_bound(wait.Value);
+					assert(it != signals.end() && "Wait on a value that is never signaled.");
+					start = std::max(start, it->second);
+				}
+
+				for (PassId pass : batch.Passes)
+				{
+					double duration = pass < passDurations.size() ? passDurations[pass] : 0.0;
+					timings.push_back({ pass, batch.Queue, start, start + duration });
+					start += duration;
+				}
+
+				queueTime[q] = start;
+
+				if (batch.SignalValue != 0)
+				{
+					signalTimes[q][batch.SignalValue] = start;
+				}
+			}
+
+			return timings;
+		}
+	}
+}
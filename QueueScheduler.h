@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		enum class QueueType : std::uint8_t
+		{
+			Direct = 0,
+			Compute,
+			Count
+		};
+
+		using PassId = std::uint32_t;
+
+		struct ScheduledWait
+		{
+			QueueType Queue;
+			std::uint64_t Value;
+		};
+
+		// A run of passes submitted as one command list on one queue //
+
+		struct ScheduledBatch
+		{
+			QueueType Queue = QueueType::Direct;
+			std::vector<PassId> Passes;
+			std::vector<ScheduledWait> Waits;		// GPU waits before the batch starts
+			std::uint64_t SignalValue = 0;			// 0 when nothing on another queue depends on it
+		};
+
+		struct PassTiming
+		{
+			PassId Pass;
+			QueueType Queue;
+			double Begin;
+			double End;
+		};
+
+		// Splits a frame's passes between the direct and the async compute queue //
+		/*
+		   Passes are added in submission order and may only depend on passes added before them.
+		   Compile() moves eligible passes to the compute queue and cuts the frame into batches,
+		   inserting a fence signal after every pass another queue depends on and a wait before
+		   the first pass that needs it. Waits already implied by an earlier wait are dropped.
+		   Fence values are relative to the frame, starting at 1 on each queue.
+		*/
+
+		class QueueScheduler
+		{
+		public:
+
+			PassId AddPass(const char* name, bool asyncComputeEligible, std::initializer_list<PassId> dependencies = {});
+			void AddDependency(PassId pass, PassId dependsOn);
+			void Clear();
+
+			void Compile(bool enableAsyncCompute = true);
+
+			// Getters //
+
+			const std::vector<ScheduledBatch>& Batches() const { return m_Batches; }
+			std::uint32_t PassCount() const { return static_cast<std::uint32_t>(m_Passes.size()); }
+			const std::string& PassName(PassId pass) const { return m_Passes[pass].Name; }
+			QueueType PassQueue(PassId pass) const { return m_Passes[pass].Queue; }
+			const std::vector<PassId>& PassDependencies(PassId pass) const { return m_Passes[pass].Dependencies; }
+
+			// Last compute value the direct queue waits on at the end of the frame, 0 if none //
+
+			std::uint64_t ComputeJoinValue() const { return m_ComputeJoinValue; }
+
+		private:
+
+			struct Pass
+			{
+				std::string Name;
+				bool AsyncComputeEligible = false;
+				std::vector<PassId> Dependencies;
+				QueueType Queue = QueueType::Direct;
+				bool NeedsSignal = false;
+				std::uint64_t SignalValue = 0;
+			};
+
+		private:
+
+			std::vector<Pass> m_Passes;
+			std::vector<ScheduledBatch> m_Batches;
+			std::uint64_t m_ComputeJoinValue = 0;
+		};
+
+		// Time both queues were busy at the same time //
+
+		double MeasureOverlap(const std::vector<PassTiming>& timings);
+
+		// True when every pass starts after all of its dependencies ended //
+
+		bool ValidateTimings(const QueueScheduler& scheduler, const std::vector<PassTiming>& timings);
+
+		// CPU stand-in for the GPU queues: runs the compiled batches with the given pass durations, //
+		// honouring queue order, waits and signals, and returns the resulting timeline. //
+
+		std::vector<PassTiming> SimulateQueues(const QueueScheduler& scheduler, const std::vector<double>& passDurations);
+	}
+}
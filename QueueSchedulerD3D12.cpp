@@ -0,0 +1,230 @@
+#include "QueueSchedulerD3D12.h"
+#include "CommandTraceD3D12.h"
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		QueueSchedulerD3D12::QueueSchedulerD3D12(ComPtr<ID3D12Device2> device, ComPtr<ID3D12CommandQueue> directQueue, ComPtr<ID3D12CommandQueue> computeQueue,
+			std::uint32_t framesInFlight, std::uint32_t maxPasses)
+			: m_Device(device)
+			, m_MaxPasses(maxPasses)
+		{
+			m_Queues[static_cast<std::size_t>(QueueType::Direct)].Queue = directQueue;
+			m_Queues[static_cast<std::size_t>(QueueType::Direct)].Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+			m_Queues[static_cast<std::size_t>(QueueType::Compute)].Queue = computeQueue;
+			m_Queues[static_cast<std::size_t>(QueueType::Compute)].Type = D3D12_COMMAND_LIST_TYPE_COMPUTE;
+
+			for (QueueState& queue : m_Queues)
+			{
+				ThrowIfFailed(m_Device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&queue.Fence)));
+
+				queue.Allocators.resize(framesInFlight);
+				for (ComPtr<ID3D12CommandAllocator>& allocator : queue.Allocators)
+				{
+					ThrowIfFailed(m_Device->CreateCommandAllocator(queue.Type, IID_PPV_ARGS(&allocator)));
+				}
+			}
+
+			// Two timestamps per pass and per frame slot //
+
+			D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
+			queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+			queryHeapDesc.Count = framesInFlight * maxPasses * 2;
+			ThrowIfFailed(m_Device->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&m_QueryHeap)));
+
+			m_Frames.resize(framesInFlight);
+			for (FrameQueries& frame : m_Frames)
+			{
+				CD3DX12_HEAP_PROPERTIES heapProperties(D3D12_HEAP_TYPE_READBACK);
+				CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(sizeof(UINT64) * maxPasses * 2);
+
+				ThrowIfFailed(m_Device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+					D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&frame.Readback)));
+			}
+		}
+
+		void QueueSchedulerD3D12::SetPassRecorder(PassId pass, RecordFunction recorder)
+		{
+			if (pass >= m_Recorders.size())
+			{
+				m_Recorders.resize(pass + 1);
+			}
+
+			m_Recorders[pass] = std::move(recorder);
+		}
+
+		void QueueSchedulerD3D12::Execute(const QueueScheduler& scheduler, std::uint32_t frameIndex)
+		{
+			constexpr std::size_t queueCount = static_cast<std::size_t>(QueueType::Count);
+
+			FrameQueries& frame = m_Frames[frameIndex];
+
+			// The previous use of this slot has retired, its timestamps are ready //
+
+			if (frame.Pending)
+			{
+				ReadTimings(frame);
+			}
+
+			frame.Passes.clear();
+			frame.Queues.clear();
+
+			std::uint64_t baseValues[queueCount];
+			std::size_t listCounts[queueCount] = {};
+
+			for (std::size_t q = 0; q < queueCount; ++q)
+			{
+				QueueState& queue = m_Queues[q];
+
+				ThrowIfFailed(queue.Allocators[frameIndex]->Reset());
+				ThrowIfFailed(queue.Queue->GetClockCalibration(&frame.GpuCalibration[q], &frame.CpuCalibration[q]));
+
+				baseValues[q] = queue.FenceValue;
+			}
+
+			const UINT queryBase = frameIndex * m_MaxPasses * 2;
+
+			for (const ScheduledBatch& batch : scheduler.Batches())
+			{
+				const std::size_t q = static_cast<std::size_t>(batch.Queue);
+				QueueState& queue = m_Queues[q];
+				ID3D12CommandAllocator* allocator = queue.Allocators[frameIndex].Get();
+
+				std::size_t listIndex = listCounts[q]++;
+				if (listIndex == queue.CommandLists.size())
+				{
+					ComPtr<ID3D12GraphicsCommandList> commandList;
+					ThrowIfFailed(m_Device->CreateCommandList(0, queue.Type, allocator, nullptr, IID_PPV_ARGS(&commandList)));
+					queue.CommandLists.push_back(commandList);
+				}
+				else
+				{
+					ThrowIfFailed(queue.CommandLists[listIndex]->Reset(allocator, nullptr));
+				}
+
+				ID3D12GraphicsCommandList* commandList = queue.CommandLists[listIndex].Get();
+				CommandCaptureD3D12::ResetList(commandList);
+
+				const UINT firstQuery = static_cast<UINT>(frame.Passes.size()) * 2;
+
+				for (PassId pass : batch.Passes)
+				{
+					const bool timed = frame.Passes.size() < m_MaxPasses;
+					const UINT query = queryBase + static_cast<UINT>(frame.Passes.size()) * 2;
+
+					if (timed)
+					{
+						commandList->EndQuery(m_QueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, query);
+					}
+
+					if (pass < m_Recorders.size() && m_Recorders[pass])
+					{
+						m_Recorders[pass](commandList);
+					}
+
+					if (timed)
+					{
+						commandList->EndQuery(m_QueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, query + 1);
+						frame.Passes.push_back(pass);
+						frame.Queues.push_back(batch.Queue);
+					}
+				}
+
+				const UINT queryCount = static_cast<UINT>(frame.Passes.size()) * 2 - firstQuery;
+				if (queryCount > 0)
+				{
+					commandList->ResolveQueryData(m_QueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, queryBase + firstQuery, queryCount,
+						frame.Readback.Get(), sizeof(UINT64) * firstQuery);
+				}
+
+				ThrowIfFailed(commandList->Close());
+				CommandCaptureD3D12::CloseList(commandList);
+
+				for (const ScheduledWait& wait : batch.Waits)
+				{
+					const QueueState& other = m_Queues[static_cast<std::size_t>(wait.Queue)];
+					const std::uint64_t waitValue = baseValues[static_cast<std::size_t>(wait.Queue)] + wait.Value;
+					ThrowIfFailed(queue.Queue->Wait(other.Fence.Get(), waitValue));
+					CommandCaptureD3D12::Wait(queue.Queue.Get(), other.Fence.Get(), waitValue);
+				}
+
+				ID3D12CommandList* const commandLists[] = { commandList };
+				queue.Queue->ExecuteCommandLists(_countof(commandLists), commandLists);
+				CommandCaptureD3D12::ExecuteLists(queue.Queue.Get(), _countof(commandLists), commandLists);
+
+				if (batch.SignalValue != 0)
+				{
+					queue.FenceValue = baseValues[q] + batch.SignalValue;
+					ThrowIfFailed(queue.Queue->Signal(queue.Fence.Get(), queue.FenceValue));
+					CommandCaptureD3D12::Signal(queue.Queue.Get(), queue.Fence.Get(), queue.FenceValue);
+				}
+			}
+
+			// The direct queue joins the compute queue so the frame fence covers both //
+
+			if (scheduler.ComputeJoinValue() != 0)
+			{
+				const QueueState& compute = m_Queues[static_cast<std::size_t>(QueueType::Compute)];
+				const QueueState& direct = m_Queues[static_cast<std::size_t>(QueueType::Direct)];
+				const std::uint64_t joinValue = baseValues[static_cast<std::size_t>(QueueType::Compute)] + scheduler.ComputeJoinValue();
+				ThrowIfFailed(direct.Queue->Wait(compute.Fence.Get(), joinValue));
+				CommandCaptureD3D12::Wait(direct.Queue.Get(), compute.Fence.Get(), joinValue);
+			}
+
+			frame.Pending = !frame.Passes.empty();
+			m_Recorders.clear();
+		}
+
+		void QueueSchedulerD3D12::ReadTimings(FrameQueries& frame)
+		{
+			frame.Pending = false;
+
+			const std::size_t queryCount = frame.Passes.size() * 2;
+
+			UINT64* ticks = nullptr;
+			CD3DX12_RANGE readRange(0, sizeof(UINT64) * queryCount);
+			ThrowIfFailed(frame.Readback->Map(0, &readRange, reinterpret_cast<void**>(&ticks)));
+
+			LARGE_INTEGER cpuFrequency;
+			::QueryPerformanceFrequency(&cpuFrequency);
+
+			UINT64 gpuFrequencies[static_cast<std::size_t>(QueueType::Count)];
+			for (std::size_t q = 0; q < static_cast<std::size_t>(QueueType::Count); ++q)
+			{
+				ThrowIfFailed(m_Queues[q].Queue->GetTimestampFrequency(&gpuFrequencies[q]));
+			}
+
+			// Both queues are brought to the CPU clock through their calibration pair //
+
+			auto toMilliseconds = [&](UINT64 timestamp, std::size_t q)
+			{
+				double gpuSeconds = (static_cast<double>(timestamp) - static_cast<double>(frame.GpuCalibration[q])) / static_cast<double>(gpuFrequencies[q]);
+				double cpuSeconds = static_cast<double>(frame.CpuCalibration[q]) / static_cast<double>(cpuFrequency.QuadPart);
+				return (cpuSeconds + gpuSeconds) * 1000.0;
+			};
+
+			m_LastTimings.clear();
+
+			double frameBegin = 0.0;
+			double frameEnd = 0.0;
+
+			for (std::size_t i = 0; i < frame.Passes.size(); ++i)
+			{
+				const std::size_t q = static_cast<std::size_t>(frame.Queues[i]);
+
+				PassTiming timing = { frame.Passes[i], frame.Queues[i], toMilliseconds(ticks[i * 2], q), toMilliseconds(ticks[i * 2 + 1], q) };
+				m_LastTimings.push_back(timing);
+
+				frameBegin = i == 0 ? timing.Begin : std::min(frameBegin, timing.Begin);
+				frameEnd = i == 0 ? timing.End : std::max(frameEnd, timing.End);
+			}
+
+			CD3DX12_RANGE writeRange(0, 0);
+			frame.Readback->Unmap(0, &writeRange);
+
+			m_LastOverlapMs = MeasureOverlap(m_LastTimings);
+			m_LastFrameGpuMs = frameEnd - frameBegin;
+		}
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Header.h"
+#include "HelperFile.h"
+#include "QueueScheduler.h"
+
+#include <functional>
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// Submits a compiled QueueScheduler on the direct and async compute queues //
+		/*
+		   Each batch is recorded into its own command list, preceded by its GPU waits and
+		   followed by its fence signal. Passes are bracketed with timestamp queries; once a
+		   frame slot comes around again its timestamps are read back, aligned between the
+		   two queues with GetClockCalibration, and turned into the measured overlap.
+		*/
+
+		class QueueSchedulerD3D12
+		{
+		public:
+
+			using RecordFunction = std::function<void(ID3D12GraphicsCommandList* commandList)>;
+
+			QueueSchedulerD3D12(ComPtr<ID3D12Device2> device, ComPtr<ID3D12CommandQueue> directQueue, ComPtr<ID3D12CommandQueue> computeQueue,
+				std::uint32_t framesInFlight, std::uint32_t maxPasses = 256);
+
+			// Recorders are indexed by PassId and cleared after every Execute() //
+
+			void SetPassRecorder(PassId pass, RecordFunction recorder);
+
+			// The frame slot must not be in use by the GPU anymore, EngineCore guarantees it //
+			// by waiting on m_FrameFenceValues before recording. //
+
+			void Execute(const QueueScheduler& scheduler, std::uint32_t frameIndex);
+
+			// Getters //
+
+			ComPtr<ID3D12Fence> Fence(QueueType queue) const { return m_Queues[static_cast<std::size_t>(queue)].Fence; }
+			const std::vector<PassTiming>& LastTimings() const { return m_LastTimings; }
+			double LastOverlapMs() const { return m_LastOverlapMs; }
+			double LastFrameGpuMs() const { return m_LastFrameGpuMs; }
+
+		private:
+
+			struct QueueState
+			{
+				ComPtr<ID3D12CommandQueue> Queue;
+				ComPtr<ID3D12Fence> Fence;
+				std::uint64_t FenceValue = 0;
+				std::vector<ComPtr<ID3D12CommandAllocator>> Allocators;	// one per frame slot
+				std::vector<ComPtr<ID3D12GraphicsCommandList>> CommandLists;
+				D3D12_COMMAND_LIST_TYPE Type;
+			};
+
+			struct FrameQueries
+			{
+				ComPtr<ID3D12Resource> Readback;
+				std::vector<PassId> Passes;
+				std::vector<QueueType> Queues;
+				UINT64 GpuCalibration[static_cast<std::size_t>(QueueType::Count)] = {};
+				UINT64 CpuCalibration[static_cast<std::size_t>(QueueType::Count)] = {};
+				bool Pending = false;
+			};
+
+			void ReadTimings(FrameQueries& frame);
+
+		private:
+
+			ComPtr<ID3D12Device2> m_Device;
+			QueueState m_Queues[static_cast<std::size_t>(QueueType::Count)];
+			std::vector<RecordFunction> m_Recorders;
+
+			ComPtr<ID3D12QueryHeap> m_QueryHeap;
+			std::uint32_t m_MaxPasses;
+			std::vector<FrameQueries> m_Frames;
+
+			std::vector<PassTiming> m_LastTimings;
+			double m_LastOverlapMs = 0.0;
+			double m_LastFrameGpuMs = 0.0;
+		};
+	}
+}
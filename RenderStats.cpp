@@ -0,0 +1,96 @@
+#include "RenderStats.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		const char* RenderCounterName(RenderCounter counter)
+		{
+			switch (counter)
+			{
+			case RenderCounter::Draws: return "Draws";
+			case RenderCounter::Dispatches: return "Dispatches";
+			case RenderCounter::Triangles: return "Triangles";
+			case RenderCounter::Barriers: return "Barriers";
+			case RenderCounter::PipelineChanges: return "PSO changes";
+			case RenderCounter::DescriptorAllocations: return "Descriptors";
+			case RenderCounter::UploadBytes: return "Upload KB";
+			default: return "Unknown";
+			}
+		}
+
+		RenderStats& RenderStats::Global()
+		{
+			static RenderStats* stats = new RenderStats();
+			return *stats;
+		}
+
+		void RenderStats::Count(RenderCounter counter, std::uint64_t amount)
+		{
+			Global().m_Counters.Add(static_cast<std::uint32_t>(counter), amount);
+		}
+
+		void RenderStats::EndFrame()
+		{
+			std::uint64_t totals[g_RenderCounterCount];
+			m_Counters.Sum(totals);
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			m_Totals.Frame++;
+			m_LastFrame.Frame = m_Totals.Frame;
+
+			for (std::uint32_t counter = 0; counter < g_RenderCounterCount; ++counter)
+			{
+				const std::uint64_t total = totals[counter];
+				m_LastFrame.Counters[counter] = total - m_Totals.Counters[counter];
+				m_PeakFrame.Counters[counter] = std::max(m_PeakFrame.Counters[counter], m_LastFrame.Counters[counter]);
+				m_Totals.Counters[counter] = total;
+			}
+
+			m_PeakFrame.Frame = m_Totals.Frame;
+		}
+
+		RenderFrameStats RenderStats::LastFrame() const
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			return m_LastFrame;
+		}
+
+		RenderFrameStats RenderStats::PeakFrame() const
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			return m_PeakFrame;
+		}
+
+		RenderFrameStats RenderStats::Totals() const
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			return m_Totals;
+		}
+
+		std::string RenderStats::Format(const RenderFrameStats& stats)
+		{
+			std::string text;
+			char field[64];
+
+			for (std::uint32_t counter = 0; counter < g_RenderCounterCount; ++counter)
+			{
+				std::uint64_t value = stats.Counters[counter];
+				if (counter == static_cast<std::uint32_t>(RenderCounter::UploadBytes))
+				{
+					value /= 1024;
+				}
+
+				std::snprintf(field, sizeof(field), "%s%s: %llu", counter > 0 ? "  " : "",
+					RenderCounterName(static_cast<RenderCounter>(counter)), static_cast<unsigned long long>(value));
+				text += field;
+			}
+
+			return text;
+		}
+	}
+}
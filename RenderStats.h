@@ -0,0 +1,80 @@
+#pragma once
+
+#include "ThreadCounterRegistry.h"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// What the command recording layer counts //
+
+		enum class RenderCounter : std::uint8_t
+		{
+			Draws,					// draw calls, an ExecuteIndirect counts as one
+			Dispatches,
+			Triangles,				// of CPU recorded draws, GPU generated draws are not known here
+			Barriers,				// individual barriers, not ResourceBarrier calls
+			PipelineChanges,
+			DescriptorAllocations,
+			UploadBytes,			// written to upload heaps for the GPU
+			Count
+		};
+
+		constexpr std::uint32_t g_RenderCounterCount = static_cast<std::uint32_t>(RenderCounter::Count);
+
+		const char* RenderCounterName(RenderCounter counter);
+
+		struct RenderFrameStats
+		{
+			std::uint64_t Frame = 0;
+			std::uint64_t Counters[g_RenderCounterCount] = {};
+
+			std::uint64_t operator[](RenderCounter counter) const { return Counters[static_cast<std::uint32_t>(counter)]; }
+		};
+
+		// Per frame render statistics //
+		/*
+		   Count() adds to counters owned by the calling thread (see ThreadCounterRegistry),
+		   so recording threads never contend. EndFrame() merges every thread once per
+		   frame: what the totals moved by since the previous merge is the frame's count.
+		   Perf tests read LastFrame(), or compare Totals() around the frames they measure.
+		*/
+
+		class RenderStats
+		{
+		public:
+
+			static void Count(RenderCounter counter, std::uint64_t amount = 1);
+
+			// Merges the thread counters, call once per frame after the frame is recorded //
+
+			void EndFrame();
+
+			RenderFrameStats LastFrame() const;
+			RenderFrameStats PeakFrame() const;		// largest value of each counter over any frame
+			RenderFrameStats Totals() const;		// since start, Frame is the number of merged frames
+
+			// "Draws: 12  Dispatches: 3 ..." on one line //
+
+			static std::string Format(const RenderFrameStats& stats);
+
+			static RenderStats& Global();
+
+		private:
+
+			RenderStats() = default;
+
+		private:
+
+			ThreadCounterRegistry<g_RenderCounterCount, RenderStats> m_Counters;
+			RenderFrameStats m_LastFrame;
+			RenderFrameStats m_PeakFrame;
+			RenderFrameStats m_Totals;
+			mutable std::mutex m_Mutex;
+		};
+	}
+}
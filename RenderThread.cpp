@@ -0,0 +1,124 @@
+#include "RenderThread.h"
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		RenderThread::RenderThread(PlatformEventHandler handler, std::function<void()> onFailure)
+			: m_Handler(std::move(handler)), m_OnFailure(std::move(onFailure))
+		{
+		}
+
+		RenderThread::~RenderThread()
+		{
+			Stop();
+		}
+
+		void RenderThread::Start()
+		{
+			if (m_Running.exchange(true))
+			{
+				return;
+			}
+
+			// A thread that failed has left the loop but was never joined //
+
+			if (m_Thread.joinable())
+			{
+				m_Thread.join();
+			}
+
+			m_Failure = nullptr;
+			m_Thread = std::thread(&RenderThread::Loop, this);
+		}
+
+		void RenderThread::Stop()
+		{
+			m_Running.store(false);
+
+			if (m_Thread.joinable())
+			{
+				m_Thread.join();
+			}
+		}
+
+		bool RenderThread::Post(const PlatformEvent& event)
+		{
+			if (event.Type == PlatformEventType::Resize)
+			{
+				const std::uint64_t size = (1ull << 63) | (event.Sizing ? 1ull << 62 : 0) | (std::uint64_t(event.Width & 0x3fffffffu) << 32) | event.Height;
+				m_PendingResize.store(size, std::memory_order_release);
+				return true;
+			}
+
+			if (!m_Events.Push(event))
+			{
+				m_DroppedEvents.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+
+			return true;
+		}
+
+		void RenderThread::RethrowFailure()
+		{
+			if (m_Failure)
+			{
+				std::rethrow_exception(std::exchange(m_Failure, nullptr));
+			}
+		}
+
+		void RenderThread::Loop()
+		{
+			try
+			{
+				RunFrames();
+			}
+			catch (...)
+			{
+				m_Failure = std::current_exception();
+				m_Running.store(false);
+
+				if (m_OnFailure)
+				{
+					m_OnFailure();
+				}
+			}
+		}
+
+		void RenderThread::RunFrames()
+		{
+			const PlatformEvent paint;
+
+			PlatformEvent beginFrame;
+			beginFrame.Type = PlatformEventType::BeginFrame;
+
+			while (m_Running.load(std::memory_order_relaxed))
+			{
+				// The handler may hold the frame back here, input posted meanwhile still makes it //
+
+				m_Handler(beginFrame);
+
+				PlatformEvent event;
+				while (m_Events.Pop(event))
+				{
+					m_Handler(event);
+				}
+
+				const std::uint64_t size = m_PendingResize.exchange(0, std::memory_order_acquire);
+				if (size != 0)
+				{
+					PlatformEvent resize;
+					resize.Type = PlatformEventType::Resize;
+					resize.Width = static_cast<std::uint32_t>(size >> 32) & 0x3fffffffu;
+					resize.Height = static_cast<std::uint32_t>(size);
+					resize.Sizing = (size & (1ull << 62)) != 0;
+					m_Handler(resize);
+				}
+
+				m_Handler(paint);
+				m_Frames.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+	}
+}
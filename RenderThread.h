@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Platform.h"
+#include "SpscQueue.h"
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <thread>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// Produces frames on its own thread, fed by the thread pumping window messages //
+		/*
+		   The pump thread Post()s key events into a lock-free queue. Resizes only keep the
+		   latest size, an interactive drag sends dozens per frame and only the last one
+		   matters. The render thread starts each frame with a BeginFrame event, then
+		   drains the queue, hands each event to the handler, then the pending resize if
+		   any, then asks for a frame with a Paint event, and starts over right away.
+		   Frames keep coming while the pump sits in a modal drag or resize loop. The
+		   handler only ever runs on the render thread.
+
+		   An exception leaving the handler would terminate the process. It ends the loop
+		   instead and onFailure runs on the render thread, which should wake the pump (a
+		   Platform::Quit() posts to its queue); RethrowFailure() rethrows it there.
+		*/
+
+		class RenderThread
+		{
+		public:
+
+			explicit RenderThread(PlatformEventHandler handler, std::function<void()> onFailure = nullptr);
+			~RenderThread();
+
+			RenderThread(const RenderThread&) = delete;
+			RenderThread& operator=(const RenderThread&) = delete;
+
+			void Start();
+
+			// Returns once the frame in progress is done, events still queued are dropped //
+
+			void Stop();
+
+			// Pump thread only, never blocks //
+			/*
+			   An event finding the queue full is dropped and counted rather than waited on:
+			   the render thread may itself be waiting on the pump inside Present(), which
+			   sends messages to the window's thread. Resizes are never dropped.
+			*/
+
+			bool Post(const PlatformEvent& event);
+
+			// After Stop(), rethrows the exception that ended the render thread if any //
+
+			void RethrowFailure();
+
+			// Getters //
+
+			bool Running() const { return m_Running.load(std::memory_order_relaxed); }
+			std::uint64_t Frames() const { return m_Frames.load(std::memory_order_relaxed); }
+			std::uint64_t DroppedEvents() const { return m_DroppedEvents.load(std::memory_order_relaxed); }
+
+		private:
+
+			void Loop();
+			void RunFrames();
+
+		private:
+
+			PlatformEventHandler m_Handler;
+			std::function<void()> m_OnFailure;
+			std::exception_ptr m_Failure;		// written by the render thread before it exits, read after the join
+			SpscQueue<PlatformEvent, 256> m_Events;
+
+			// Latest resize not yet handled: bit 63 set, bit 62 Sizing, width in bits 32..61, height in bits 0..31 //
+
+			std::atomic<std::uint64_t> m_PendingResize{ 0 };
+
+			std::thread m_Thread;
+			std::atomic<bool> m_Running{ false };
+			std::atomic<std::uint64_t> m_Frames{ 0 };
+			std::atomic<std::uint64_t> m_DroppedEvents{ 0 };
+		};
+	}
+}
@@ -0,0 +1,215 @@
+#include "ResidencyManager.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		namespace
+		{
+			std::uint32_t SegmentIndex(MemorySegment segment)
+			{
+				return static_cast<std::uint32_t>(segment);
+			}
+		}
+
+		ResidencyManager::ResidencyManager(double budgetFraction)
+			: m_BudgetFraction(budgetFraction)
+		{
+		}
+
+		ResidencyHandle ResidencyManager::Track(std::uint64_t size, MemorySegment segment)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			ResidencyHandle handle;
+			if (!m_FreeHandles.empty())
+			{
+				handle = m_FreeHandles.back();
+				m_FreeHandles.pop_back();
+			}
+			else
+			{
+				handle = static_cast<ResidencyHandle>(m_Objects.size());
+				m_Objects.emplace_back();
+			}
+
+			// Freshly created heaps and committed resources are resident. Never used, they go //
+			// first in the LRU, which keeps it in fence order for Update(). //
+
+			Object& object = m_Objects[handle];
+			object.Size = size;
+			object.LastUsed = 0;
+			object.Segment = segment;
+			object.Tracked = true;
+			object.Resident = true;
+			object.PendingResident = false;
+			object.Position = m_Lru[SegmentIndex(segment)].insert(m_Lru[SegmentIndex(segment)].begin(), handle);
+
+			ResidencySegmentStats& stats = m_Stats.Segments[SegmentIndex(segment)];
+			stats.TrackedBytes += size;
+			stats.ResidentBytes += size;
+
+			return handle;
+		}
+
+		void ResidencyManager::Untrack(ResidencyHandle handle)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			assert(handle < m_Objects.size() && m_Objects[handle].Tracked && "Untracking an unknown residency handle.");
+			Object& object = m_Objects[handle];
+			const std::uint32_t segment = SegmentIndex(object.Segment);
+
+			if (object.Resident)
+			{
+				m_Lru[segment].erase(object.Position);
+				m_Stats.Segments[segment].ResidentBytes -= object.Size;
+			}
+			if (object.PendingResident)
+			{
+				m_PendingResident.erase(std::find(m_PendingResident.begin(), m_PendingResident.end(), handle));
+				m_PendingBytes[segment] -= object.Size;
+			}
+
+			m_Stats.Segments[segment].TrackedBytes -= object.Size;
+			object = Object();
+			m_FreeHandles.push_back(handle);
+		}
+
+		void ResidencyManager::MarkUsed(ResidencyHandle handle, std::uint64_t fenceValue)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			assert(handle < m_Objects.size() && m_Objects[handle].Tracked && "Using an unknown residency handle.");
+			Object& object = m_Objects[handle];
+			object.LastUsed = std::max(object.LastUsed, fenceValue);
+
+			if (object.Resident)
+			{
+				std::list<ResidencyHandle>& lru = m_Lru[SegmentIndex(object.Segment)];
+				lru.splice(lru.end(), lru, object.Position);
+			}
+			else if (!object.PendingResident)
+			{
+				object.PendingResident = true;
+				m_PendingResident.push_back(handle);
+				m_PendingBytes[SegmentIndex(object.Segment)] += object.Size;
+			}
+		}
+
+		void ResidencyManager::Update(const MemoryBudget (&budgets)[g_MemorySegmentCount], std::uint64_t completedFenceValue, std::vector<ResidencyHandle>& evict)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			const std::size_t firstEviction = evict.size();
+			bool overBudget = false;
+			bool stalled = false;
+
+			for (std::uint32_t segment = 0; segment < g_MemorySegmentCount; ++segment)
+			{
+				m_Stats.Segments[segment].Budget = budgets[segment].Budget;
+				m_Stats.Segments[segment].Usage = budgets[segment].CurrentUsage;
+
+				// Objects waiting for MakeResident will add to the usage before the frame runs //
+
+				const std::uint64_t target = static_cast<std::uint64_t>(budgets[segment].Budget * m_BudgetFraction);
+				const std::uint64_t projected = budgets[segment].CurrentUsage + m_PendingBytes[segment];
+
+				if (projected <= target)
+				{
+					continue;
+				}
+
+				overBudget = true;
+				std::uint64_t excess = projected - target;
+
+				// The list is in fence order, the first object still in flight ends the search //
+
+				std::list<ResidencyHandle>& lru = m_Lru[segment];
+				while (excess > 0 && !lru.empty())
+				{
+					const ResidencyHandle handle = lru.front();
+					Object& object = m_Objects[handle];
+					if (object.LastUsed > completedFenceValue)
+					{
+						break;
+					}
+
+					lru.pop_front();
+					object.Resident = false;
+					m_Stats.Segments[segment].ResidentBytes -= object.Size;
+					m_Stats.Evictions++;
+					m_Stats.EvictedBytes += object.Size;
+
+					excess -= std::min(excess, object.Size);
+					evict.push_back(handle);
+				}
+
+				stalled |= excess > 0;
+			}
+
+			m_Stats.OverBudgetUpdates += overBudget ? 1 : 0;
+			m_Stats.StalledUpdates += stalled ? 1 : 0;
+			m_Stats.EvictionBatches += evict.size() > firstEviction ? 1 : 0;
+		}
+
+		void ResidencyManager::TakeMakeResident(std::vector<ResidencyHandle>& makeResident)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			if (m_PendingResident.empty())
+			{
+				return;
+			}
+
+			for (ResidencyHandle handle : m_PendingResident)
+			{
+				Object& object = m_Objects[handle];
+				const std::uint32_t segment = SegmentIndex(object.Segment);
+
+				object.PendingResident = false;
+				object.Resident = true;
+				object.Position = m_Lru[segment].insert(m_Lru[segment].end(), handle);
+
+				m_Stats.Segments[segment].ResidentBytes += object.Size;
+				m_Stats.MakeResidents++;
+				m_Stats.MadeResidentBytes += object.Size;
+			}
+
+			makeResident.insert(makeResident.end(), m_PendingResident.begin(), m_PendingResident.end());
+			m_PendingResident.clear();
+			std::fill(std::begin(m_PendingBytes), std::end(m_PendingBytes), 0);
+			m_Stats.MakeResidentBatches++;
+		}
+
+		bool ResidencyManager::IsResident(ResidencyHandle handle) const
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			return handle < m_Objects.size() && m_Objects[handle].Resident;
+		}
+
+		std::uint64_t ResidencyManager::ResidentBytes(MemorySegment segment) const
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			return m_Stats.Segments[SegmentIndex(segment)].ResidentBytes;
+		}
+
+		ResidencyStats ResidencyManager::Stats() const
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			return m_Stats;
+		}
+
+		void SimulatedVideoMemory::Query(const ResidencyManager& manager, MemoryBudget (&budgets)[g_MemorySegmentCount]) const
+		{
+			for (std::uint32_t segment = 0; segment < g_MemorySegmentCount; ++segment)
+			{
+				budgets[segment].Budget = Budget[segment];
+				budgets[segment].CurrentUsage = ExternalUsage[segment] + manager.ResidentBytes(static_cast<MemorySegment>(segment));
+			}
+		}
+	}
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// DXGI_MEMORY_SEGMENT_GROUP_LOCAL and _NON_LOCAL, UMA adapters only have Local //
+
+		enum class MemorySegment : std::uint8_t
+		{
+			Local,
+			NonLocal,
+			Count
+		};
+
+		constexpr std::uint32_t g_MemorySegmentCount = static_cast<std::uint32_t>(MemorySegment::Count);
+
+		// The two fields of DXGI_QUERY_VIDEO_MEMORY_INFO the policy looks at //
+
+		struct MemoryBudget
+		{
+			std::uint64_t Budget = 0;
+			std::uint64_t CurrentUsage = 0;
+		};
+
+		using ResidencyHandle = std::uint32_t;
+
+		constexpr ResidencyHandle g_InvalidResidencyHandle = ~0u;
+
+		struct ResidencySegmentStats
+		{
+			std::uint64_t Budget = 0;			// as of the last Update()
+			std::uint64_t Usage = 0;
+			std::uint64_t TrackedBytes = 0;
+			std::uint64_t ResidentBytes = 0;
+		};
+
+		struct ResidencyStats
+		{
+			ResidencySegmentStats Segments[g_MemorySegmentCount];
+			std::uint64_t Evictions = 0;
+			std::uint64_t EvictedBytes = 0;
+			std::uint64_t EvictionBatches = 0;
+			std::uint64_t MakeResidents = 0;
+			std::uint64_t MadeResidentBytes = 0;
+			std::uint64_t MakeResidentBatches = 0;
+			std::uint64_t OverBudgetUpdates = 0;	// updates that found a segment above its target
+			std::uint64_t StalledUpdates = 0;		// ... and could not get back under it, every candidate in flight
+		};
+
+		// Residency policy: an LRU of heaps/resources by last used fence value, per memory segment //
+		/*
+		   Objects start resident. Each frame Update() compares the segment usage with its
+		   budget; above budgetFraction of it the least recently used objects whose last
+		   fence value has completed are evicted until the projected usage fits. An object
+		   used while evicted is queued and handed back by TakeMakeResident() before the
+		   work using it is submitted, so evictions and MakeResident calls both go out in
+		   one batch per frame. Independent of D3D12, see ResidencyManagerD3D12.
+		*/
+
+		class ResidencyManager
+		{
+		public:
+
+			explicit ResidencyManager(double budgetFraction = 0.95);
+
+			ResidencyHandle Track(std::uint64_t size, MemorySegment segment);
+			void Untrack(ResidencyHandle handle);
+
+			// The object is referenced by work signaling fenceValue, values never decrease //
+
+			void MarkUsed(ResidencyHandle handle, std::uint64_t fenceValue);
+
+			// Appends the objects to evict this frame given the budgets of every segment //
+
+			void Update(const MemoryBudget (&budgets)[g_MemorySegmentCount], std::uint64_t completedFenceValue, std::vector<ResidencyHandle>& evict);
+
+			// Appends the evicted objects used since, they count as resident from now on //
+
+			void TakeMakeResident(std::vector<ResidencyHandle>& makeResident);
+
+			bool IsResident(ResidencyHandle handle) const;
+			std::uint64_t ResidentBytes(MemorySegment segment) const;
+			ResidencyStats Stats() const;
+
+		private:
+
+			struct Object
+			{
+				std::uint64_t Size = 0;
+				std::uint64_t LastUsed = 0;
+				MemorySegment Segment = MemorySegment::Local;
+				bool Tracked = false;
+				bool Resident = false;
+				bool PendingResident = false;
+				std::list<ResidencyHandle>::iterator Position;	// in m_Lru[Segment] while resident
+			};
+
+		private:
+
+			double m_BudgetFraction;
+			std::vector<Object> m_Objects;
+			std::vector<ResidencyHandle> m_FreeHandles;
+			std::list<ResidencyHandle> m_Lru[g_MemorySegmentCount];	// least recently used first
+			std::vector<ResidencyHandle> m_PendingResident;
+			std::uint64_t m_PendingBytes[g_MemorySegmentCount] = {};
+			ResidencyStats m_Stats;
+			mutable std::mutex m_Mutex;
+		};
+
+		// Stand-in for QueryVideoMemoryInfo: the manager's resident bytes plus usage it does not track //
+
+		struct SimulatedVideoMemory
+		{
+			std::uint64_t Budget[g_MemorySegmentCount] = {};
+			std::uint64_t ExternalUsage[g_MemorySegmentCount] = {};
+
+			void Query(const ResidencyManager& manager, MemoryBudget (&budgets)[g_MemorySegmentCount]) const;
+		};
+	}
+}
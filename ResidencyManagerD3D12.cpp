@@ -0,0 +1,145 @@
+#include "ResidencyManagerD3D12.h"
+#include "CommandTraceD3D12.h"
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		ResidencyManagerD3D12::ResidencyManagerD3D12(ComPtr<ID3D12Device2> device, ComPtr<IDXGIAdapter3> adapter, double budgetFraction)
+			: m_Device(device)
+			, m_Adapter(adapter)
+			, m_Manager(budgetFraction)
+		{
+			D3D12_FEATURE_DATA_ARCHITECTURE architecture = {};
+			ThrowIfFailed(m_Device->CheckFeatureSupport(D3D12_FEATURE_ARCHITECTURE, &architecture, sizeof(architecture)));
+			m_Uma = architecture.UMA != FALSE;
+
+			if (SUCCEEDED(m_Device.As(&m_Device3)))
+			{
+				ThrowIfFailed(m_Device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_ResidentFence)));
+			}
+		}
+
+		ResidencyHandle ResidencyManagerD3D12::Track(ID3D12Pageable* pageable, std::uint64_t size, D3D12_MEMORY_POOL pool)
+		{
+			const MemorySegment segment = m_Uma || pool != D3D12_MEMORY_POOL_L0 ? MemorySegment::Local : MemorySegment::NonLocal;
+			const ResidencyHandle handle = m_Manager.Track(size, segment);
+
+			if (handle >= m_Pageables.size())
+			{
+				m_Pageables.resize(handle + 1);
+			}
+			m_Pageables[handle] = pageable;
+
+			return handle;
+		}
+
+		ResidencyHandle ResidencyManagerD3D12::Track(ID3D12Heap* heap)
+		{
+			const D3D12_HEAP_DESC desc = heap->GetDesc();
+
+			D3D12_HEAP_PROPERTIES properties = desc.Properties;
+			if (properties.Type != D3D12_HEAP_TYPE_CUSTOM)
+			{
+				properties = m_Device->GetCustomHeapProperties(0, properties.Type);
+			}
+
+			return Track(heap, desc.SizeInBytes, properties.MemoryPoolPreference);
+		}
+
+		ResidencyHandle ResidencyManagerD3D12::Track(ID3D12Resource* resource)
+		{
+			const D3D12_RESOURCE_DESC desc = resource->GetDesc();
+			const D3D12_RESOURCE_ALLOCATION_INFO info = m_Device->GetResourceAllocationInfo(0, 1, &desc);
+
+			// Meant for committed resources, placed ones are tracked through their heap //
+
+			D3D12_HEAP_PROPERTIES properties;
+			D3D12_HEAP_FLAGS flags;
+			ThrowIfFailed(resource->GetHeapProperties(&properties, &flags));
+			if (properties.Type != D3D12_HEAP_TYPE_CUSTOM)
+			{
+				properties = m_Device->GetCustomHeapProperties(0, properties.Type);
+			}
+
+			return Track(resource, info.SizeInBytes, properties.MemoryPoolPreference);
+		}
+
+		void ResidencyManagerD3D12::Untrack(ResidencyHandle handle)
+		{
+			m_Manager.Untrack(handle);
+			m_Pageables[handle].Reset();
+		}
+
+		void ResidencyManagerD3D12::MarkUsed(ResidencyHandle handle)
+		{
+			if (handle != g_InvalidResidencyHandle)
+			{
+				m_Manager.MarkUsed(handle, m_FrameFenceValue);
+			}
+		}
+
+		void ResidencyManagerD3D12::Batch(const std::vector<ResidencyHandle>& handles)
+		{
+			m_Batch.clear();
+			for (ResidencyHandle handle : handles)
+			{
+				m_Batch.push_back(m_Pageables[handle].Get());
+			}
+		}
+
+		void ResidencyManagerD3D12::Update(std::uint64_t completedFenceValue, std::uint64_t frameFenceValue)
+		{
+			m_FrameFenceValue = frameFenceValue;
+
+			MemoryBudget budgets[g_MemorySegmentCount];
+
+			const DXGI_MEMORY_SEGMENT_GROUP groups[g_MemorySegmentCount] = { DXGI_MEMORY_SEGMENT_GROUP_LOCAL, DXGI_MEMORY_SEGMENT_GROUP_NON_LOCAL };
+			for (std::uint32_t segment = 0; segment < g_MemorySegmentCount; ++segment)
+			{
+				DXGI_QUERY_VIDEO_MEMORY_INFO info = {};
+				ThrowIfFailed(m_Adapter->QueryVideoMemoryInfo(0, groups[segment], &info));
+				budgets[segment].Budget = info.Budget;
+				budgets[segment].CurrentUsage = info.CurrentUsage;
+			}
+
+			m_Manager.Update(budgets, completedFenceValue, m_Handles);
+			if (!m_Handles.empty())
+			{
+				Batch(m_Handles);
+				ThrowIfFailed(m_Device->Evict(static_cast<UINT>(m_Batch.size()), m_Batch.data()));
+				m_Handles.clear();
+			}
+		}
+
+		void ResidencyManagerD3D12::MakeResident(std::initializer_list<ID3D12CommandQueue*> queues)
+		{
+			m_Manager.TakeMakeResident(m_Handles);
+			if (m_Handles.empty())
+			{
+				return;
+			}
+
+			Batch(m_Handles);
+			m_Handles.clear();
+
+			// Without ID3D12Device3 the thread blocks until the memory is paged in //
+
+			if (!m_Device3)
+			{
+				ThrowIfFailed(m_Device->MakeResident(static_cast<UINT>(m_Batch.size()), m_Batch.data()));
+				return;
+			}
+
+			m_ResidentFenceValue++;
+			ThrowIfFailed(m_Device3->EnqueueMakeResident(D3D12_RESIDENCY_FLAG_NONE, static_cast<UINT>(m_Batch.size()), m_Batch.data(),
+				m_ResidentFence.Get(), m_ResidentFenceValue));
+
+			for (ID3D12CommandQueue* queue : queues)
+			{
+				ThrowIfFailed(queue->Wait(m_ResidentFence.Get(), m_ResidentFenceValue));
+				CommandCaptureD3D12::Wait(queue, m_ResidentFence.Get(), m_ResidentFenceValue);
+			}
+		}
+	}
+}
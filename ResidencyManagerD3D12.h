@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Header.h"
+#include "HelperFile.h"
+#include "ResidencyManager.h"
+
+#include <initializer_list>
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// ResidencyManager fed by QueryVideoMemoryInfo and applied with Evict / MakeResident //
+		/*
+		   Heaps and committed resources are tracked with the segment their memory pool maps
+		   to: everything is local on UMA adapters, L0 is non local on discrete ones.
+		   Update() polls both budgets and evicts in one call at the start of a frame;
+		   MakeResident() pages the evicted objects used by the frame back in before any of
+		   its command lists are executed. With ID3D12Device3 that is EnqueueMakeResident:
+		   the queues wait on its fence on the GPU and the calling thread goes on.
+		*/
+
+		class ResidencyManagerD3D12
+		{
+		public:
+
+			ResidencyManagerD3D12(ComPtr<ID3D12Device2> device, ComPtr<IDXGIAdapter3> adapter, double budgetFraction = 0.95);
+
+			ResidencyHandle Track(ID3D12Heap* heap);
+			ResidencyHandle Track(ID3D12Resource* resource);
+			void Untrack(ResidencyHandle handle);
+
+			void MarkUsed(ResidencyHandle handle, std::uint64_t fenceValue) { m_Manager.MarkUsed(handle, fenceValue); }
+
+			// Used by the frame Update() started, null handles are ignored //
+
+			void MarkUsed(ResidencyHandle handle);
+
+			// frameFenceValue is the value the frame being recorded will signal //
+
+			void Update(std::uint64_t completedFenceValue, std::uint64_t frameFenceValue);
+
+			// Every queue running the frame's work waits for the paging //
+
+			void MakeResident(std::initializer_list<ID3D12CommandQueue*> queues);
+
+			// Getters //
+
+			ResidencyStats Stats() const { return m_Manager.Stats(); }
+
+		private:
+
+			ResidencyHandle Track(ID3D12Pageable* pageable, std::uint64_t size, D3D12_MEMORY_POOL pool);
+			void Batch(const std::vector<ResidencyHandle>& handles);
+
+		private:
+
+			ComPtr<ID3D12Device2> m_Device;
+			ComPtr<ID3D12Device3> m_Device3;		// null before EnqueueMakeResident existed
+			ComPtr<IDXGIAdapter3> m_Adapter;
+			bool m_Uma = false;
+
+			ComPtr<ID3D12Fence> m_ResidentFence;
+			std::uint64_t m_ResidentFenceValue = 0;
+			std::uint64_t m_FrameFenceValue = 0;
+
+			ResidencyManager m_Manager;
+			std::vector<ComPtr<ID3D12Pageable>> m_Pageables;	// indexed by handle
+
+			std::vector<ResidencyHandle> m_Handles;
+			std::vector<ID3D12Pageable*> m_Batch;
+		};
+	}
+}
@@ -0,0 +1,204 @@
+#include "SimulationPipeline.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		namespace
+		{
+			double MillisecondsSince(std::chrono::steady_clock::time_point start)
+			{
+				return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			}
+
+			DrawRequest Interpolate(const DrawRequest& previous, const DrawRequest& current, float alpha)
+			{
+				DrawRequest draw = current;
+				draw.Depth = previous.Depth + (current.Depth - previous.Depth) * alpha;
+
+				for (std::uint32_t row = 0; row < 3; ++row)
+				{
+					for (std::uint32_t column = 0; column < 4; ++column)
+					{
+						const float from = previous.Transform.Rows[row][column];
+						draw.Transform.Rows[row][column] = from + (current.Transform.Rows[row][column] - from) * alpha;
+					}
+				}
+
+				return draw;
+			}
+		}
+
+		FixedTimestep::FixedTimestep(double stepSeconds, std::uint32_t maxSteps)
+			: m_Step(stepSeconds), m_MaxSteps(std::max(maxSteps, 1u))
+		{
+		}
+
+		std::uint32_t FixedTimestep::Advance(double elapsedSeconds)
+		{
+			m_Accumulator += std::max(elapsedSeconds, 0.0);
+
+			std::uint32_t steps = 0;
+			while (m_Accumulator >= m_Step)
+			{
+				m_Accumulator -= m_Step;
+
+				if (steps == m_MaxSteps)
+				{
+					m_DroppedSteps++;
+					continue;
+				}
+
+				steps++;
+			}
+
+			m_Ticks += steps;
+			return steps;
+		}
+
+		void SubmitInterpolated(const RenderSnapshot& previous, const RenderSnapshot& current, float alpha, DrawBatcher& batcher)
+		{
+			const TaggedVector<SnapshotDraw, MemoryTag::Scene>& before = previous.Draws();
+
+			// Steps usually emit their objects in the same order, the lookup is only built when they don't //
+
+			std::unordered_map<std::uint32_t, std::uint32_t> lookup;
+
+			for (std::size_t i = 0; i < current.Draws().size(); ++i)
+			{
+				const SnapshotDraw& draw = current.Draws()[i];
+
+				const SnapshotDraw* match = nullptr;
+				if (draw.Object != 0)
+				{
+					if (i < before.size() && before[i].Object == draw.Object)
+					{
+						match = &before[i];
+					}
+					else
+					{
+						if (lookup.empty())
+						{
+							for (std::uint32_t j = 0; j < before.size(); ++j)
+							{
+								lookup.emplace(before[j].Object, j);
+							}
+						}
+
+						auto found = lookup.find(draw.Object);
+						if (found != lookup.end())
+						{
+							match = &before[found->second];
+						}
+					}
+				}
+
+				batcher.Submit(draw.Pass, match ? Interpolate(match->Draw, draw.Draw, alpha) : draw.Draw);
+			}
+		}
+
+		SimulationPipeline::SimulationPipeline(double stepSeconds, StepFunction step, ThreadPool& pool, std::uint32_t maxStepsPerFrame)
+			: m_Step(std::move(step)), m_Pool(pool), m_Timestep(stepSeconds, maxStepsPerFrame)
+		{
+		}
+
+		SimulationPipeline::~SimulationPipeline()
+		{
+			Wait();
+		}
+
+		void SimulationPipeline::BeginFrame(double elapsedSeconds, DrawBatcher& batcher)
+		{
+			// The first frame has nothing simulated ahead, it runs its simulation in series //
+
+			const bool first = !m_Primed;
+			if (first)
+			{
+				m_Primed = true;
+				Start(elapsedSeconds);
+			}
+
+			const auto waitStart = std::chrono::steady_clock::now();
+			Wait();
+			m_Stats.WaitMilliseconds = MillisecondsSince(waitStart);
+
+			const FrameSlot& ready = m_Slots[m_Simulating];
+			m_Simulating ^= 1;
+			Start(first ? 0.0 : elapsedSeconds);
+
+			SubmitInterpolated(ready.Previous, ready.Current, ready.Alpha, batcher);
+
+			m_Stats.Steps = ready.Steps;
+			m_Stats.SimulateMilliseconds = ready.SimulateMilliseconds;
+		}
+
+		void SimulationPipeline::Wait()
+		{
+			// A job still queued may sit behind other work, run that work here instead of blocking //
+
+			while (m_JobState.load(std::memory_order_acquire) == JobQueued)
+			{
+				if (!m_Pool.RunPendingJob())
+				{
+					std::this_thread::yield();
+				}
+			}
+
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_JobDone.wait(lock, [this]() { return m_JobState.load(std::memory_order_acquire) == JobIdle; });
+		}
+
+		void SimulationPipeline::Start(double elapsedSeconds)
+		{
+			const std::uint32_t steps = m_Timestep.Advance(elapsedSeconds);
+			const float alpha = m_Timestep.Alpha();
+			const std::uint32_t slot = m_Simulating;
+
+			m_JobState.store(JobQueued, std::memory_order_release);
+			m_Pool.Submit([this, slot, steps, alpha]()
+			{
+				m_JobState.store(JobRunning, std::memory_order_release);
+				Simulate(slot, steps, alpha);
+
+				// Notified under the lock, a waiter returning may destroy the pipeline right away //
+
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_JobState.store(JobIdle, std::memory_order_release);
+				m_JobDone.notify_all();
+			});
+		}
+
+		void SimulationPipeline::Simulate(std::uint32_t slot, std::uint32_t steps, float alpha)
+		{
+			const auto start = std::chrono::steady_clock::now();
+
+			// The other slot holds the latest ticks, the render thread only reads it meanwhile //
+
+			FrameSlot& frame = m_Slots[slot];
+			const FrameSlot& latest = m_Slots[slot ^ 1];
+
+			frame.Current = latest.Current;
+			if (steps == 0)
+			{
+				frame.Previous = latest.Previous;
+			}
+
+			for (std::uint32_t i = 0; i < steps; ++i)
+			{
+				std::swap(frame.Previous, frame.Current);
+				frame.Current.Clear();
+				m_Step(m_Timestep.Step(), frame.Current);	// Step() never changes, Advance() may run meanwhile
+			}
+
+			frame.Alpha = alpha;
+			frame.Steps = steps;
+			frame.SimulateMilliseconds = MillisecondsSince(start);
+		}
+	}
+}
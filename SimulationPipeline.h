@@ -0,0 +1,171 @@
+#pragma once
+
+#include "DrawBatcher.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// Turns variable frame times into a whole number of fixed simulation steps //
+		/*
+		   Elapsed time accumulates, each Advance() consumes as many steps as fit and
+		   Alpha() is how far the leftover time reaches into the next step, the weight
+		   rendering gives the latest state over the one before. Past maxSteps the extra
+		   time is dropped, a slow frame then slows the simulation down rather than making
+		   every following frame slower still.
+		*/
+
+		class FixedTimestep
+		{
+		public:
+
+			explicit FixedTimestep(double stepSeconds, std::uint32_t maxSteps = 8);
+
+			// Returns the number of steps to run for elapsedSeconds //
+
+			std::uint32_t Advance(double elapsedSeconds);
+
+			// Getters //
+
+			double Step() const { return m_Step; }
+			float Alpha() const { return static_cast<float>(m_Accumulator / m_Step); }
+			std::uint64_t Ticks() const { return m_Ticks; }
+			std::uint64_t DroppedSteps() const { return m_DroppedSteps; }
+
+		private:
+
+			double m_Step;
+			double m_Accumulator = 0.0;
+			std::uint32_t m_MaxSteps;
+			std::uint64_t m_Ticks = 0;
+			std::uint64_t m_DroppedSteps = 0;
+		};
+
+		// The draws of one simulation tick //
+		/*
+		   Object is a stable id matching a draw with the same object's draw of the tick
+		   before, so its transform can be interpolated. Object 0 is never interpolated.
+		*/
+
+		struct SnapshotDraw
+		{
+			std::uint32_t Object;
+			std::uint32_t Pass;
+			DrawRequest Draw;
+		};
+
+		class RenderSnapshot
+		{
+		public:
+
+			void Clear() { m_Draws.clear(); }
+			void Submit(std::uint32_t object, std::uint32_t pass, const DrawRequest& draw) { m_Draws.push_back({ object, pass, draw }); }
+
+			// Getters //
+
+			const TaggedVector<SnapshotDraw, MemoryTag::Scene>& Draws() const { return m_Draws; }
+
+		private:
+
+			TaggedVector<SnapshotDraw, MemoryTag::Scene> m_Draws;
+		};
+
+		// Submits current's draws to batcher, transforms and depths blended from previous by alpha //
+		/*
+		   Matrix rows are blended linearly, close enough for the rotation of one step.
+		   Objects new in current are drawn where they are.
+		*/
+
+		void SubmitInterpolated(const RenderSnapshot& previous, const RenderSnapshot& current, float alpha, DrawBatcher& batcher);
+
+		struct SimulationStats
+		{
+			std::uint32_t Steps = 0;				// fixed steps run for the frame
+			double SimulateMilliseconds = 0.0;		// spent in the step function, off the render thread
+			double WaitMilliseconds = 0.0;			// the render thread waited on the simulation
+		};
+
+		// Simulates the next frame on the thread pool while the render thread records this one //
+		/*
+		   BeginFrame() waits for the simulation started by the previous call, starts the
+		   next one and submits the finished one's draws, so simulation and submission of
+		   consecutive frames overlap; rendering shows the simulation one frame later than
+		   it would run back to back. The two frame slots are double buffered: the job
+		   writes one while the render thread reads the other. The step function runs on a
+		   pool thread and must only touch simulation state and the snapshot it is given.
+		*/
+
+		class SimulationPipeline
+		{
+		public:
+
+			// Advances the simulation by one step of stepSeconds and writes the draws of the new state //
+
+			using StepFunction = std::function<void(double stepSeconds, RenderSnapshot& snapshot)>;
+
+			SimulationPipeline(double stepSeconds, StepFunction step, ThreadPool& pool = ThreadPool::Global(), std::uint32_t maxStepsPerFrame = 8);
+			~SimulationPipeline();
+
+			SimulationPipeline(const SimulationPipeline&) = delete;
+			SimulationPipeline& operator=(const SimulationPipeline&) = delete;
+
+			// Render thread, once per frame before the batcher is built //
+
+			void BeginFrame(double elapsedSeconds, DrawBatcher& batcher);
+
+			// Waits for the simulation in flight, if any //
+
+			void Wait();
+
+			// Getters //
+
+			const SimulationStats& LastFrameStats() const { return m_Stats; }
+			const FixedTimestep& Timestep() const { return m_Timestep; }
+
+		private:
+
+			struct FrameSlot
+			{
+				RenderSnapshot Previous;
+				RenderSnapshot Current;
+				float Alpha = 0.0f;
+				std::uint32_t Steps = 0;
+				double SimulateMilliseconds = 0.0;
+			};
+
+			enum JobState : std::uint32_t
+			{
+				JobIdle,
+				JobQueued,
+				JobRunning
+			};
+
+			void Start(double elapsedSeconds);
+			void Simulate(std::uint32_t slot, std::uint32_t steps, float alpha);
+
+		private:
+
+			StepFunction m_Step;
+			ThreadPool& m_Pool;
+			FixedTimestep m_Timestep;
+
+			FrameSlot m_Slots[2];
+			std::uint32_t m_Simulating = 0;		// slot written by the job in flight
+			bool m_Primed = false;
+
+			std::atomic<std::uint32_t> m_JobState{ JobIdle };
+			std::mutex m_Mutex;
+			std::condition_variable m_JobDone;
+
+			SimulationStats m_Stats;
+		};
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// Lock-free ring buffer between exactly one producer thread and one consumer thread //
+		/*
+		   Push() is only called by the producer, Pop() only by the consumer. Each side
+		   owns one index and publishes it with a release store, the other side reads it
+		   with an acquire load, so neither ever waits on a lock. The indices live on
+		   separate cache lines to keep the two threads from invalidating each other's.
+		   Capacity must be a power of two.
+		*/
+
+		template<typename T, std::uint32_t Capacity>
+		class SpscQueue
+		{
+			static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two.");
+			static_assert(std::is_trivially_copyable<T>::value, "SpscQueue elements are copied in and out by value.");
+
+		public:
+
+			// Producer, returns false when the queue is full //
+
+			bool Push(const T& value)
+			{
+				const std::uint32_t tail = m_Tail.load(std::memory_order_relaxed);
+				if (tail - m_Head.load(std::memory_order_acquire) == Capacity)
+				{
+					return false;
+				}
+
+				m_Items[tail & (Capacity - 1)] = value;
+				m_Tail.store(tail + 1, std::memory_order_release);
+				return true;
+			}
+
+			// Consumer, returns false when the queue is empty //
+
+			bool Pop(T& value)
+			{
+				const std::uint32_t head = m_Head.load(std::memory_order_relaxed);
+				if (head == m_Tail.load(std::memory_order_acquire))
+				{
+					return false;
+				}
+
+				value = m_Items[head & (Capacity - 1)];
+				m_Head.store(head + 1, std::memory_order_release);
+				return true;
+			}
+
+			// Only exact when called from one of the two threads while the other is idle //
+
+			bool Empty() const { return m_Head.load(std::memory_order_acquire) == m_Tail.load(std::memory_order_acquire); }
+
+		private:
+
+			alignas(64) std::atomic<std::uint32_t> m_Head{ 0 };		// next item to pop, written by the consumer
+			alignas(64) std::atomic<std::uint32_t> m_Tail{ 0 };		// next slot to fill, written by the producer
+			alignas(64) T m_Items[Capacity];
+		};
+	}
+}
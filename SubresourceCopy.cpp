@@ -0,0 +1,155 @@
+#include "SubresourceCopy.h"
+
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define POWERENGINE_COPY_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		namespace
+		{
+			// Below this a streaming copy costs more in alignment fix-up than it saves //
+
+			constexpr std::size_t g_StreamingMinimum = 256;
+
+			// Work per pool chunk, big enough to amortize the dispatch //
+
+			constexpr std::uint64_t g_ChunkBytes = 512ull * 1024;
+
+			void CopySpan(void* destination, const void* source, std::size_t size, bool nonTemporal)
+			{
+				if (nonTemporal)
+				{
+					CopyMemoryStreaming(destination, source, size);
+				}
+				else
+				{
+					std::memcpy(destination, source, size);
+				}
+			}
+
+			// One contiguous span, cut into byte ranges //
+
+			void CopyContiguous(std::uint8_t* destination, const std::uint8_t* source, std::uint64_t size, ThreadPool* pool, bool nonTemporal)
+			{
+				if (pool == nullptr || size < g_ParallelCopyThreshold)
+				{
+					CopySpan(destination, source, static_cast<std::size_t>(size), nonTemporal);
+					return;
+				}
+
+				const std::uint32_t chunkCount = static_cast<std::uint32_t>((size + g_ChunkBytes - 1) / g_ChunkBytes);
+				pool->ParallelFor(chunkCount, 1, [&](std::uint32_t begin, std::uint32_t end)
+				{
+					const std::uint64_t first = std::uint64_t(begin) * g_ChunkBytes;
+					const std::uint64_t last = std::uint64_t(end) * g_ChunkBytes < size ? std::uint64_t(end) * g_ChunkBytes : size;
+					CopySpan(destination + first, source + first, static_cast<std::size_t>(last - first), nonTemporal);
+				});
+			}
+		}
+
+		void CopyMemoryStreaming(void* destination, const void* source, std::size_t size)
+		{
+#if defined(POWERENGINE_COPY_SSE)
+			if (size >= g_StreamingMinimum)
+			{
+				std::uint8_t* out = static_cast<std::uint8_t*>(destination);
+				const std::uint8_t* in = static_cast<const std::uint8_t*>(source);
+
+				// Align the destination to 16 bytes, streaming stores need it //
+
+				const std::size_t head = (16 - (reinterpret_cast<std::uintptr_t>(out) & 15)) & 15;
+				std::memcpy(out, in, head);
+				out += head;
+				in += head;
+				size -= head;
+
+				// 64 bytes per iteration fills a whole write-combining buffer //
+
+				for (; size >= 64; size -= 64, out += 64, in += 64)
+				{
+					const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+					const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16));
+					const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 32));
+					const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 48));
+					_mm_stream_si128(reinterpret_cast<__m128i*>(out), a);
+					_mm_stream_si128(reinterpret_cast<__m128i*>(out + 16), b);
+					_mm_stream_si128(reinterpret_cast<__m128i*>(out + 32), c);
+					_mm_stream_si128(reinterpret_cast<__m128i*>(out + 48), d);
+				}
+
+				for (; size >= 16; size -= 16, out += 16, in += 16)
+				{
+					_mm_stream_si128(reinterpret_cast<__m128i*>(out), _mm_loadu_si128(reinterpret_cast<const __m128i*>(in)));
+				}
+
+				std::memcpy(out, in, size);
+
+				// Streaming stores are weakly ordered, make them visible before the GPU is told to read //
+
+				_mm_sfence();
+				return;
+			}
+#endif
+
+			std::memcpy(destination, source, size);
+		}
+
+		void CopySubresource(const SubresourceDestination& destination, const SubresourceSource& source, std::uint64_t rowSize,
+			std::uint32_t numRows, std::uint32_t numSlices, ThreadPool* pool, bool nonTemporal)
+		{
+			std::uint8_t* destinationData = static_cast<std::uint8_t*>(destination.Data);
+			const std::uint8_t* sourceData = static_cast<const std::uint8_t*>(source.Data);
+
+			const bool rowsContiguous = destination.RowPitch == rowSize && source.RowPitch == rowSize;
+			const std::uint64_t sliceSize = rowSize * numRows;
+
+			// Whole subresource in one span //
+
+			if (rowsContiguous && (numSlices == 1 || (destination.SlicePitch == sliceSize && source.SlicePitch == sliceSize)))
+			{
+				CopyContiguous(destinationData, sourceData, sliceSize * numSlices, pool, nonTemporal);
+				return;
+			}
+
+			// One span per slice //
+
+			if (rowsContiguous)
+			{
+				for (std::uint32_t z = 0; z < numSlices; ++z)
+				{
+					CopyContiguous(destinationData + destination.SlicePitch * z, sourceData + source.SlicePitch * z, sliceSize, pool, nonTemporal);
+				}
+				return;
+			}
+
+			// Pitched rows, chunks of whole rows across every slice //
+
+			const std::uint32_t totalRows = numRows * numSlices;
+			auto copyRows = [&](std::uint32_t begin, std::uint32_t end)
+			{
+				for (std::uint32_t row = begin; row < end; ++row)
+				{
+					const std::uint32_t z = row / numRows;
+					const std::uint32_t y = row % numRows;
+					CopySpan(destinationData + destination.SlicePitch * z + destination.RowPitch * y,
+						sourceData + source.SlicePitch * z + source.RowPitch * y, static_cast<std::size_t>(rowSize), nonTemporal);
+				}
+			};
+
+			if (pool == nullptr || rowSize * totalRows < g_ParallelCopyThreshold || rowSize == 0)
+			{
+				copyRows(0, totalRows);
+				return;
+			}
+
+			const std::uint32_t rowsPerChunk = static_cast<std::uint32_t>((g_ChunkBytes + rowSize - 1) / rowSize);
+			pool->ParallelFor(totalRows, rowsPerChunk, copyRows);
+		}
+	}
+}
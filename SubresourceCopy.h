@@ -0,0 +1,49 @@
+#pragma once
+
+#include "ThreadPool.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// Same meaning as D3D12_MEMCPY_DEST and D3D12_SUBRESOURCE_DATA //
+
+		struct SubresourceDestination
+		{
+			void* Data;
+			std::uint64_t RowPitch;
+			std::uint64_t SlicePitch;
+		};
+
+		struct SubresourceSource
+		{
+			const void* Data;
+			std::uint64_t RowPitch;
+			std::uint64_t SlicePitch;
+		};
+
+		// Copies above this size are split across the thread pool //
+
+		constexpr std::uint64_t g_ParallelCopyThreshold = 2ull * 1024 * 1024;
+
+		// Drop-in replacement for MemcpySubresource //
+		/*
+		   Rows are merged into a single span when both pitches equal the row size, and
+		   slices too when both slice pitches equal the slice size. The destination is
+		   written with non-temporal stores, which is what write-combined upload heap
+		   memory wants; pass nonTemporal = false for cached destinations that are read
+		   back soon. Large copies are cut into chunks of whole rows or bytes and run on
+		   the pool, pass nullptr to stay on the calling thread.
+		*/
+
+		void CopySubresource(const SubresourceDestination& destination, const SubresourceSource& source, std::uint64_t rowSize,
+			std::uint32_t numRows, std::uint32_t numSlices, ThreadPool* pool = &ThreadPool::Global(), bool nonTemporal = true);
+
+		// memcpy with streaming stores when available //
+
+		void CopyMemoryStreaming(void* destination, const void* source, std::size_t size);
+	}
+}
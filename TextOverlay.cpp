@@ -0,0 +1,175 @@
+#include "TextOverlay.h"
+
+#include <algorithm>
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		namespace
+		{
+			const std::uint8_t g_OverlayFont[g_OverlayFontGlyphCount][g_OverlayGlyphHeight] =
+			{
+				{ 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000 },	// ' '
+				{ 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00000, 0b00100 },	// '!'
+				{ 0b01010, 0b01010, 0b01010, 0b00000, 0b00000, 0b00000, 0b00000 },	// '"'
+				{ 0b01010, 0b01010, 0b11111, 0b01010, 0b11111, 0b01010, 0b01010 },	// '#'
+				{ 0b00100, 0b01111, 0b10100, 0b01110, 0b00101, 0b11110, 0b00100 },	// '$'
+				{ 0b11000, 0b11001, 0b00010, 0b00100, 0b01000, 0b10011, 0b00011 },	// '%'
+				{ 0b01100, 0b10010, 0b10100, 0b01000, 0b10101, 0b10010, 0b01101 },	// '&'
+				{ 0b00100, 0b00100, 0b01000, 0b00000, 0b00000, 0b00000, 0b00000 },	// '''
+				{ 0b00010, 0b00100, 0b01000, 0b01000, 0b01000, 0b00100, 0b00010 },	// '('
+				{ 0b01000, 0b00100, 0b00010, 0b00010, 0b00010, 0b00100, 0b01000 },	// ')'
+				{ 0b00000, 0b00100, 0b10101, 0b01110, 0b10101, 0b00100, 0b00000 },	// '*'
+				{ 0b00000, 0b00100, 0b00100, 0b11111, 0b00100, 0b00100, 0b00000 },	// '+'
+				{ 0b00000, 0b00000, 0b00000, 0b00000, 0b01100, 0b00100, 0b01000 },	// ','
+				{ 0b00000, 0b00000, 0b00000, 0b11111, 0b00000, 0b00000, 0b00000 },	// '-'
+				{ 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b01100, 0b01100 },	// '.'
+				{ 0b00000, 0b00001, 0b00010, 0b00100, 0b01000, 0b10000, 0b00000 },	// '/'
+				{ 0b01110, 0b10001, 0b10011, 0b10101, 0b11001, 0b10001, 0b01110 },	// '0'
+				{ 0b00100, 0b01100, 0b00100, 0b00100, 0b00100, 0b00100, 0b01110 },	// '1'
+				{ 0b01110, 0b10001, 0b00001, 0b00010, 0b00100, 0b01000, 0b11111 },	// '2'
+				{ 0b11111, 0b00010, 0b00100, 0b00010, 0b00001, 0b10001, 0b01110 },	// '3'
+				{ 0b00010, 0b00110, 0b01010, 0b10010, 0b11111, 0b00010, 0b00010 },	// '4'
+				{ 0b11111, 0b10000, 0b11110, 0b00001, 0b00001, 0b10001, 0b01110 },	// '5'
+				{ 0b00110, 0b01000, 0b10000, 0b11110, 0b10001, 0b10001, 0b01110 },	// '6'
+				{ 0b11111, 0b00001, 0b00010, 0b00100, 0b01000, 0b01000, 0b01000 },	// '7'
+				{ 0b01110, 0b10001, 0b10001, 0b01110, 0b10001, 0b10001, 0b01110 },	// '8'
+				{ 0b01110, 0b10001, 0b10001, 0b01111, 0b00001, 0b00010, 0b01100 },	// '9'
+				{ 0b00000, 0b01100, 0b01100, 0b00000, 0b01100, 0b01100, 0b00000 },	// ':'
+				{ 0b00000, 0b01100, 0b01100, 0b00000, 0b01100, 0b00100, 0b01000 },	// ';'
+				{ 0b00010, 0b00100, 0b01000, 0b10000, 0b01000, 0b00100, 0b00010 },	// '<'
+				{ 0b00000, 0b00000, 0b11111, 0b00000, 0b11111, 0b00000, 0b00000 },	// '='
+				{ 0b01000, 0b00100, 0b00010, 0b00001, 0b00010, 0b00100, 0b01000 },	// '>'
+				{ 0b01110, 0b10001, 0b00001, 0b00010, 0b00100, 0b00000, 0b00100 },	// '?'
+				{ 0b01110, 0b10001, 0b00001, 0b01101, 0b10101, 0b10101, 0b01110 },	// '@'
+				{ 0b01110, 0b10001, 0b10001, 0b11111, 0b10001, 0b10001, 0b10001 },	// 'A'
+				{ 0b11110, 0b10001, 0b10001, 0b11110, 0b10001, 0b10001, 0b11110 },	// 'B'
+				{ 0b01110, 0b10001, 0b10000, 0b10000, 0b10000, 0b10001, 0b01110 },	// 'C'
+				{ 0b11100, 0b10010, 0b10001, 0b10001, 0b10001, 0b10010, 0b11100 },	// 'D'
+				{ 0b11111, 0b10000, 0b10000, 0b11110, 0b10000, 0b10000, 0b11111 },	// 'E'
+				{ 0b11111, 0b10000, 0b10000, 0b11110, 0b10000, 0b10000, 0b10000 },	// 'F'
+				{ 0b01110, 0b10001, 0b10000, 0b10111, 0b10001, 0b10001, 0b01111 },	// 'G'
+				{ 0b10001, 0b10001, 0b10001, 0b11111, 0b10001, 0b10001, 0b10001 },	// 'H'
+				{ 0b01110, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b01110 },	// 'I'
+				{ 0b00111, 0b00010, 0b00010, 0b00010, 0b00010, 0b10010, 0b01100 },	// 'J'
+				{ 0b10001, 0b10010, 0b10100, 0b11000, 0b10100, 0b10010, 0b10001 },	// 'K'
+				{ 0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b11111 },	// 'L'
+				{ 0b10001, 0b11011, 0b10101, 0b10101, 0b10001, 0b10001, 0b10001 },	// 'M'
+				{ 0b10001, 0b10001, 0b11001, 0b10101, 0b10011, 0b10001, 0b10001 },	// 'N'
+				{ 0b01110, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01110 },	// 'O'
+				{ 0b11110, 0b10001, 0b10001, 0b11110, 0b10000, 0b10000, 0b10000 },	// 'P'
+				{ 0b01110, 0b10001, 0b10001, 0b10001, 0b10101, 0b10010, 0b01101 },	// 'Q'
+				{ 0b11110, 0b10001, 0b10001, 0b11110, 0b10100, 0b10010, 0b10001 },	// 'R'
+				{ 0b01111, 0b10000, 0b10000, 0b01110, 0b00001, 0b00001, 0b11110 },	// 'S'
+				{ 0b11111, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100 },	// 'T'
+				{ 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01110 },	// 'U'
+				{ 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01010, 0b00100 },	// 'V'
+				{ 0b10001, 0b10001, 0b10001, 0b10101, 0b10101, 0b10101, 0b01010 },	// 'W'
+				{ 0b10001, 0b10001, 0b01010, 0b00100, 0b01010, 0b10001, 0b10001 },	// 'X'
+				{ 0b10001, 0b10001, 0b10001, 0b01010, 0b00100, 0b00100, 0b00100 },	// 'Y'
+				{ 0b11111, 0b00001, 0b00010, 0b00100, 0b01000, 0b10000, 0b11111 },	// 'Z'
+				{ 0b01110, 0b01000, 0b01000, 0b01000, 0b01000, 0b01000, 0b01110 },	// '['
+				{ 0b00000, 0b10000, 0b01000, 0b00100, 0b00010, 0b00001, 0b00000 },	// '\'
+				{ 0b01110, 0b00010, 0b00010, 0b00010, 0b00010, 0b00010, 0b01110 },	// ']'
+				{ 0b00100, 0b01010, 0b10001, 0b00000, 0b00000, 0b00000, 0b00000 },	// '^'
+				{ 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b11111 }	// '_'
+			};
+
+			constexpr char g_OverlayFirstCharacter = ' ';
+
+			std::uint32_t Blend(std::uint32_t source, std::uint32_t destination)
+			{
+				const std::uint32_t alpha = source >> 24;
+				std::uint32_t result = 0;
+
+				for (std::uint32_t shift = 0; shift < 24; shift += 8)
+				{
+					const std::uint32_t s = (source >> shift) & 0xFF;
+					const std::uint32_t d = (destination >> shift) & 0xFF;
+					result |= ((s * alpha + d * (255 - alpha) + 127) / 255) << shift;
+				}
+
+				const std::uint32_t d = destination >> 24;
+				return result | ((alpha + (d * (255 - alpha) + 127) / 255) << 24);
+			}
+		}
+
+		std::uint32_t OverlayFontIndex(char character)
+		{
+			if (character >= 'a' && character <= 'z')
+			{
+				character = static_cast<char>(character - 'a' + 'A');
+			}
+
+			const int index = character - g_OverlayFirstCharacter;
+			return index >= 0 && index < static_cast<int>(g_OverlayFontGlyphCount) ? static_cast<std::uint32_t>(index) : OverlayFontIndex('?');
+		}
+
+		const std::uint8_t* OverlayFontRows(std::uint32_t fontIndex)
+		{
+			return g_OverlayFont[std::min(fontIndex, g_OverlayFontGlyphCount - 1)];
+		}
+
+		TextOverlay::TextOverlay(std::uint32_t scale)
+			: m_Scale(std::max(scale, 1u))
+		{
+		}
+
+		void TextOverlay::Print(float x, float y, const char* text, std::uint32_t color)
+		{
+			const float cellWidth = static_cast<float>(g_OverlayCellWidth * m_Scale);
+			const float cellHeight = static_cast<float>(g_OverlayCellHeight * m_Scale);
+
+			float penX = x;
+			for (const char* character = text; *character; ++character)
+			{
+				if (*character == '\n')
+				{
+					penX = x;
+					y += cellHeight;
+					continue;
+				}
+
+				m_Glyphs.push_back({ penX, y, OverlayFontIndex(*character), color });
+				penX += cellWidth;
+			}
+		}
+
+		void TextOverlay::Rasterize(std::uint32_t* pixels, std::uint32_t width, std::uint32_t height) const
+		{
+			if (!m_Visible)
+			{
+				return;
+			}
+
+			const std::int64_t cellWidth = g_OverlayCellWidth * m_Scale;
+			const std::int64_t cellHeight = g_OverlayCellHeight * m_Scale;
+
+			// Same pixel coverage as the overlay shader: cells start on whole pixels, one font pixel of margin above the glyph //
+
+			for (const OverlayGlyph& glyph : m_Glyphs)
+			{
+				const std::int64_t left = static_cast<std::int64_t>(glyph.X);
+				const std::int64_t top = static_cast<std::int64_t>(glyph.Y);
+				const std::uint8_t* rows = OverlayFontRows(glyph.FontIndex);
+
+				for (std::int64_t py = std::max<std::int64_t>(top, 0); py < std::min<std::int64_t>(top + cellHeight, height); ++py)
+				{
+					const std::int64_t row = (py - top) / m_Scale - 1;
+
+					for (std::int64_t px = std::max<std::int64_t>(left, 0); px < std::min<std::int64_t>(left + cellWidth, width); ++px)
+					{
+						const std::int64_t column = (px - left) / m_Scale;
+
+						const bool set = row >= 0 && row < g_OverlayGlyphHeight && column < g_OverlayGlyphWidth &&
+							((rows[row] >> (g_OverlayGlyphWidth - 1 - column)) & 1) != 0;
+
+						std::uint32_t& pixel = pixels[py * width + px];
+						pixel = Blend(set ? glyph.Color : m_Background, pixel);
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "MemoryTracker.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// Built in 5x7 bitmap font, ASCII 32 to 95; lower case draws as upper case, anything else as '?' //
+
+		constexpr std::uint32_t g_OverlayGlyphWidth = 5;
+		constexpr std::uint32_t g_OverlayGlyphHeight = 7;
+		constexpr std::uint32_t g_OverlayCellWidth = 6;		// glyph plus spacing, in font pixels
+		constexpr std::uint32_t g_OverlayCellHeight = 9;
+		constexpr std::uint32_t g_OverlayFontGlyphCount = 64;
+
+		std::uint32_t OverlayFontIndex(char character);
+
+		// g_OverlayGlyphHeight rows, top first, bit 4 is the leftmost pixel //
+
+		const std::uint8_t* OverlayFontRows(std::uint32_t fontIndex);
+
+		// One character cell, in screen pixels; matches the structured buffer read by the overlay shader //
+
+		struct OverlayGlyph
+		{
+			float X;
+			float Y;
+			std::uint32_t FontIndex;
+			std::uint32_t Color;		// 0xAABBGGRR
+		};
+
+		static_assert(sizeof(OverlayGlyph) == 16, "OverlayGlyph is mirrored by the overlay shader.");
+
+		// Text laid out into glyph cells, drawn with one instanced draw by TextOverlayD3D12 //
+		/*
+		   Font pixels are scaled by Scale() on screen. Every character gets a cell, spaces
+		   included, so the background color forms a box behind each line. Rasterize() is
+		   the CPU reference of the overlay shader, for tests and headless captures.
+		*/
+
+		class TextOverlay
+		{
+		public:
+
+			explicit TextOverlay(std::uint32_t scale = 2);
+
+			void Clear() { m_Glyphs.clear(); }
+
+			// Lays out text from pixel (x, y), '\n' starts a new line //
+
+			void Print(float x, float y, const char* text, std::uint32_t color = 0xFFFFFFFF);
+
+			void SetBackground(std::uint32_t color) { m_Background = color; }
+			void SetVisible(bool visible) { m_Visible = visible; }
+
+			// Blends the glyphs over an RGBA8 image of width x height pixels //
+
+			void Rasterize(std::uint32_t* pixels, std::uint32_t width, std::uint32_t height) const;
+
+			// Getters //
+
+			const TaggedVector<OverlayGlyph, MemoryTag::Render>& Glyphs() const { return m_Glyphs; }
+			std::uint32_t Scale() const { return m_Scale; }
+			std::uint32_t Background() const { return m_Background; }
+			bool Visible() const { return m_Visible; }
+
+		private:
+
+			TaggedVector<OverlayGlyph, MemoryTag::Render> m_Glyphs;
+			std::uint32_t m_Scale;
+			std::uint32_t m_Background = 0xA0000000;
+			bool m_Visible = true;
+		};
+	}
+}
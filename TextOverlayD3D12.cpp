@@ -0,0 +1,263 @@
+#include "TextOverlayD3D12.h"
+#include "RenderStats.h"
+#include "CommandTraceD3D12.h"
+
+#include <cstring>
+#include <string>
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		namespace
+		{
+			enum OverlayRootParameter : UINT
+			{
+				OverlayConstantsParameter,
+				GlyphsParameter,
+				FontParameter,
+				OverlayParameterCount
+			};
+
+			struct OverlayConstants
+			{
+				float ScreenSize[2];
+				float Scale;
+				std::uint32_t Background;
+			};
+
+			// Mirrored by TextOverlay::Rasterize(), glyph metrics come in as macros //
+
+			const char g_OverlayShaderSource[] = R"(
+struct Glyph
+{
+	float2 Position;
+	uint FontIndex;
+	uint Color;
+};
+
+cbuffer OverlayConstants : register(b0)
+{
+	float2 ScreenSize;
+	float Scale;
+	uint Background;
+};
+
+StructuredBuffer<Glyph> Glyphs : register(t0);
+StructuredBuffer<uint2> Font : register(t1);
+
+struct VertexOutput
+{
+	float4 Position : SV_Position;
+	float2 Local : TEXCOORD0;
+	nointerpolation uint FontIndex : FONT;
+	nointerpolation uint Color : COLOR;
+};
+
+VertexOutput OverlayVS(uint vertex : SV_VertexID, uint instance : SV_InstanceID)
+{
+	Glyph glyph = Glyphs[instance];
+
+	float2 corner = float2(vertex & 1, vertex >> 1);
+	float2 cell = float2(CELL_WIDTH, CELL_HEIGHT);
+	float2 pixel = floor(glyph.Position) + corner * cell * Scale;
+
+	VertexOutput output;
+	output.Position = float4(pixel.x / ScreenSize.x * 2.0f - 1.0f, 1.0f - pixel.y / ScreenSize.y * 2.0f, 0.0f, 1.0f);
+	output.Local = corner * cell;
+	output.FontIndex = glyph.FontIndex;
+	output.Color = glyph.Color;
+	return output;
+}
+
+float4 UnpackColor(uint color)
+{
+	return float4(color & 0xFF, (color >> 8) & 0xFF, (color >> 16) & 0xFF, color >> 24) / 255.0f;
+}
+
+float4 OverlayPS(VertexOutput input) : SV_Target
+{
+	int2 local = int2(input.Local);
+	int row = local.y - 1;
+
+	bool set = false;
+	if (row >= 0 && row < GLYPH_HEIGHT && local.x < GLYPH_WIDTH)
+	{
+		uint2 rows = Font[input.FontIndex];
+		uint bits = row < 4 ? rows.x >> (row * 8) : rows.y >> ((row - 4) * 8);
+		set = ((bits >> (GLYPH_WIDTH - 1 - local.x)) & 1) != 0;
+	}
+
+	return UnpackColor(set ? input.Color : Background);
+}
+)";
+
+			ComPtr<ID3DBlob> CompileOverlayShader(const char* entryPoint, const char* target)
+			{
+				UINT flags = D3DCOMPILE_OPTIMIZATION_LEVEL3;
+				#if defined(_DEBUG)
+				flags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+				#endif
+
+				const std::string glyphWidth = std::to_string(g_OverlayGlyphWidth);
+				const std::string glyphHeight = std::to_string(g_OverlayGlyphHeight);
+				const std::string cellWidth = std::to_string(g_OverlayCellWidth);
+				const std::string cellHeight = std::to_string(g_OverlayCellHeight);
+
+				const D3D_SHADER_MACRO macros[] =
+				{
+					{ "GLYPH_WIDTH", glyphWidth.c_str() },
+					{ "GLYPH_HEIGHT", glyphHeight.c_str() },
+					{ "CELL_WIDTH", cellWidth.c_str() },
+					{ "CELL_HEIGHT", cellHeight.c_str() },
+					{ nullptr, nullptr }
+				};
+
+				ComPtr<ID3DBlob> shader;
+				ComPtr<ID3DBlob> error;
+				HRESULT hr = D3DCompile(g_OverlayShaderSource, sizeof(g_OverlayShaderSource) - 1, "TextOverlay", macros, nullptr,
+					entryPoint, target, flags, 0, &shader, &error);
+
+				if (FAILED(hr) && error)
+				{
+					OutputDebugStringA(static_cast<const char*>(error->GetBufferPointer()));
+				}
+				ThrowIfFailed(hr);
+
+				return shader;
+			}
+		}
+
+		TextOverlayD3D12::TextOverlayD3D12(ComPtr<ID3D12Device2> device, std::uint32_t framesInFlight, DXGI_FORMAT renderTargetFormat, std::uint32_t glyphCapacity)
+			: m_Device(device)
+			, m_GlyphCapacity(std::max(glyphCapacity, 1u))
+			, m_FramesInFlight(std::max(framesInFlight, 1u))
+		{
+			CreatePipeline(renderTargetFormat);
+
+			// Rows 0-3 in x, rows 4-6 in y, one byte per row //
+
+			std::uint8_t* font = nullptr;
+			m_Font = CreateUploadBuffer(g_OverlayFontGlyphCount * 2 * sizeof(std::uint32_t), &font);
+
+			for (std::uint32_t glyph = 0; glyph < g_OverlayFontGlyphCount; ++glyph)
+			{
+				const std::uint8_t* rows = OverlayFontRows(glyph);
+
+				std::uint32_t packed[2] = {};
+				for (std::uint32_t row = 0; row < g_OverlayGlyphHeight; ++row)
+				{
+					packed[row / 4] |= std::uint32_t(rows[row]) << ((row % 4) * 8);
+				}
+
+				std::memcpy(font + glyph * sizeof(packed), packed, sizeof(packed));
+			}
+
+			m_Glyphs = CreateUploadBuffer(std::uint64_t(m_GlyphCapacity) * m_FramesInFlight * sizeof(OverlayGlyph), &m_GlyphData);
+		}
+
+		ComPtr<ID3D12Resource> TextOverlayD3D12::CreateUploadBuffer(std::uint64_t size, std::uint8_t** data)
+		{
+			CD3DX12_HEAP_PROPERTIES heapProperties(D3D12_HEAP_TYPE_UPLOAD);
+			CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(size);
+
+			ComPtr<ID3D12Resource> buffer;
+			ThrowIfFailed(m_Device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+				D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&buffer)));
+
+			CD3DX12_RANGE readRange(0, 0);
+			ThrowIfFailed(buffer->Map(0, &readRange, reinterpret_cast<void**>(data)));
+
+			return buffer;
+		}
+
+		void TextOverlayD3D12::CreatePipeline(DXGI_FORMAT renderTargetFormat)
+		{
+			CD3DX12_ROOT_PARAMETER1 parameters[OverlayParameterCount];
+			parameters[OverlayConstantsParameter].InitAsConstants(sizeof(OverlayConstants) / sizeof(std::uint32_t), 0);
+			parameters[GlyphsParameter].InitAsShaderResourceView(0, 0, D3D12_ROOT_DESCRIPTOR_FLAG_NONE, D3D12_SHADER_VISIBILITY_VERTEX);
+			parameters[FontParameter].InitAsShaderResourceView(1, 0, D3D12_ROOT_DESCRIPTOR_FLAG_NONE, D3D12_SHADER_VISIBILITY_PIXEL);
+
+			CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC desc;
+			desc.Init_1_1(_countof(parameters), parameters, 0, nullptr, D3D12_ROOT_SIGNATURE_FLAG_NONE);
+
+			ComPtr<ID3DBlob> signature;
+			ComPtr<ID3DBlob> error;
+			ThrowIfFailed(D3DX12SerializeVersionedRootSignature(&desc, D3D_ROOT_SIGNATURE_VERSION_1_1, &signature, &error));
+			ThrowIfFailed(m_Device->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&m_RootSignature)));
+
+			ComPtr<ID3DBlob> vertexShader = CompileOverlayShader("OverlayVS", "vs_5_1");
+			ComPtr<ID3DBlob> pixelShader = CompileOverlayShader("OverlayPS", "ps_5_1");
+
+			// Straight alpha over the frame, TextOverlay::Rasterize() blends the same way //
+
+			CD3DX12_BLEND_DESC blendDesc(D3D12_DEFAULT);
+			D3D12_RENDER_TARGET_BLEND_DESC& blend = blendDesc.RenderTarget[0];
+			blend.BlendEnable = TRUE;
+			blend.SrcBlend = D3D12_BLEND_SRC_ALPHA;
+			blend.DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+			blend.BlendOp = D3D12_BLEND_OP_ADD;
+			blend.SrcBlendAlpha = D3D12_BLEND_ONE;
+			blend.DestBlendAlpha = D3D12_BLEND_INV_SRC_ALPHA;
+			blend.BlendOpAlpha = D3D12_BLEND_OP_ADD;
+
+			CD3DX12_RASTERIZER_DESC rasterizerDesc(D3D12_DEFAULT);
+			rasterizerDesc.CullMode = D3D12_CULL_MODE_NONE;
+
+			CD3DX12_DEPTH_STENCIL_DESC depthStencilDesc(D3D12_DEFAULT);
+			depthStencilDesc.DepthEnable = FALSE;
+
+			D3D12_GRAPHICS_PIPELINE_STATE_DESC pipelineDesc = {};
+			pipelineDesc.pRootSignature = m_RootSignature.Get();
+			pipelineDesc.VS = CD3DX12_SHADER_BYTECODE(vertexShader.Get());
+			pipelineDesc.PS = CD3DX12_SHADER_BYTECODE(pixelShader.Get());
+			pipelineDesc.BlendState = blendDesc;
+			pipelineDesc.SampleMask = UINT_MAX;
+			pipelineDesc.RasterizerState = rasterizerDesc;
+			pipelineDesc.DepthStencilState = depthStencilDesc;
+			pipelineDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+			pipelineDesc.NumRenderTargets = 1;
+			pipelineDesc.RTVFormats[0] = renderTargetFormat;
+			pipelineDesc.SampleDesc.Count = 1;
+
+			ThrowIfFailed(m_Device->CreateGraphicsPipelineState(&pipelineDesc, IID_PPV_ARGS(&m_PipelineState)));
+		}
+
+		void TextOverlayD3D12::Record(ID3D12GraphicsCommandList* commandList, const TextOverlay& overlay, std::uint32_t frameIndex, std::uint32_t width, std::uint32_t height)
+		{
+			if (!overlay.Visible() || overlay.Glyphs().empty())
+			{
+				return;
+			}
+
+			assert(frameIndex < m_FramesInFlight && "Frame index out of range.");
+
+			const std::uint32_t count = static_cast<std::uint32_t>(std::min<std::size_t>(overlay.Glyphs().size(), m_GlyphCapacity));
+			const std::uint64_t offset = std::uint64_t(frameIndex) * m_GlyphCapacity * sizeof(OverlayGlyph);
+			const std::uint64_t size = std::uint64_t(count) * sizeof(OverlayGlyph);
+
+			std::memcpy(m_GlyphData + offset, overlay.Glyphs().data(), static_cast<size_t>(size));
+
+			OverlayConstants constants;
+			constants.ScreenSize[0] = static_cast<float>(std::max(width, 1u));
+			constants.ScreenSize[1] = static_cast<float>(std::max(height, 1u));
+			constants.Scale = static_cast<float>(overlay.Scale());
+			constants.Background = overlay.Background();
+
+			commandList->SetGraphicsRootSignature(m_RootSignature.Get());
+			commandList->SetPipelineState(m_PipelineState.Get());
+			CommandCaptureD3D12::SetPipeline(commandList, m_PipelineState.Get());
+			commandList->SetGraphicsRoot32BitConstants(OverlayConstantsParameter, sizeof(constants) / sizeof(std::uint32_t), &constants, 0);
+			commandList->SetGraphicsRootShaderResourceView(GlyphsParameter, m_Glyphs->GetGPUVirtualAddress() + offset);
+			commandList->SetGraphicsRootShaderResourceView(FontParameter, m_Font->GetGPUVirtualAddress());
+			commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+			commandList->DrawInstanced(4, count, 0, 0);
+			CommandCaptureD3D12::Draw(commandList, 4, count, false);
+
+			RenderStats::Count(RenderCounter::Draws);
+			RenderStats::Count(RenderCounter::Triangles, std::uint64_t(count) * 2);
+			RenderStats::Count(RenderCounter::PipelineChanges);
+			RenderStats::Count(RenderCounter::UploadBytes, size);
+		}
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Header.h"
+#include "HelperFile.h"
+#include "TextOverlay.h"
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// Draws a TextOverlay on top of the frame with one instanced draw //
+		/*
+		   Each glyph cell is a four vertex strip instance generated from SV_VertexID, the
+		   glyph and font tables are root SRVs in upload heaps, so the overlay needs no
+		   descriptors, vertex buffers or copies. Each frame slot has its own glyph buffer,
+		   only rewritten once the slot's previous frame has retired. Shaders are built with
+		   D3DCompile at startup.
+		*/
+
+		class TextOverlayD3D12
+		{
+		public:
+
+			TextOverlayD3D12(ComPtr<ID3D12Device2> device, std::uint32_t framesInFlight, DXGI_FORMAT renderTargetFormat, std::uint32_t glyphCapacity = 8192);
+
+			// Blends over the bound render target, viewport and scissor are left to the caller //
+			/*
+			   Glyphs past the capacity are dropped. The root signature and the pipeline are
+			   left bound, callers drawing afterwards must set their own.
+			*/
+
+			void Record(ID3D12GraphicsCommandList* commandList, const TextOverlay& overlay, std::uint32_t frameIndex, std::uint32_t width, std::uint32_t height);
+
+		private:
+
+			void CreatePipeline(DXGI_FORMAT renderTargetFormat);
+
+			ComPtr<ID3D12Resource> CreateUploadBuffer(std::uint64_t size, std::uint8_t** data);
+
+		private:
+
+			ComPtr<ID3D12Device2> m_Device;
+			std::uint32_t m_GlyphCapacity;
+
+			ComPtr<ID3D12RootSignature> m_RootSignature;
+			ComPtr<ID3D12PipelineState> m_PipelineState;
+
+			// Font rows packed as uint2 per glyph, written once //
+
+			ComPtr<ID3D12Resource> m_Font;
+
+			// m_GlyphCapacity glyphs per frame slot, persistently mapped //
+
+			ComPtr<ID3D12Resource> m_Glyphs;
+			std::uint8_t* m_GlyphData = nullptr;
+			std::uint32_t m_FramesInFlight;
+		};
+	}
+}
@@ -0,0 +1,832 @@
+#include "TextureCompressor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define POWERENGINE_COMPRESSOR_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define POWERENGINE_TARGET_AVX2
+#else
+#define POWERENGINE_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+namespace PowerEngine
+{
+	namespace Assets
+	{
+		namespace
+		{
+			// 4x4 block in structure of arrays, values in [0, 255] //
+
+			struct Block
+			{
+				alignas(32) float Channels[4][16];
+			};
+
+			using Palette = float[16][4];
+
+			// Writes the index of the closest palette entry for every pixel, returns the summed error //
+
+			using FindIndicesFunction = float(*)(const Block& block, const Palette& palette, std::uint32_t count, const float weights[4], std::uint8_t indices[16]);
+
+#if !defined(POWERENGINE_COMPRESSOR_X86)
+			float FindIndicesScalar(const Block& block, const Palette& palette, std::uint32_t count, const float weights[4], std::uint8_t indices[16])
+			{
+				float total = 0.0f;
+
+				for (std::uint32_t i = 0; i < 16; ++i)
+				{
+					float best = 3.402823466e+38f;
+					std::uint8_t bestIndex = 0;
+
+					for (std::uint32_t p = 0; p < count; ++p)
+					{
+						float error = 0.0f;
+						for (std::uint32_t c = 0; c < 4; ++c)
+						{
+							float delta = block.Channels[c][i] - palette[p][c];
+							error += weights[c] * delta * delta;
+						}
+
+						if (error < best)
+						{
+							best = error;
+							bestIndex = static_cast<std::uint8_t>(p);
+						}
+					}
+
+					indices[i] = bestIndex;
+					total += best;
+				}
+
+				return total;
+			}
+#endif
+
+#if defined(POWERENGINE_COMPRESSOR_X86)
+			float FindIndicesSse2(const Block& block, const Palette& palette, std::uint32_t count, const float weights[4], std::uint8_t indices[16])
+			{
+				__m128 total = _mm_setzero_ps();
+
+				for (std::uint32_t i = 0; i < 16; i += 4)
+				{
+					__m128 channels[4];
+					for (std::uint32_t c = 0; c < 4; ++c)
+					{
+						channels[c] = _mm_load_ps(&block.Channels[c][i]);
+					}
+
+					__m128 best = _mm_set1_ps(3.402823466e+38f);
+					__m128i bestIndex = _mm_setzero_si128();
+
+					for (std::uint32_t p = 0; p < count; ++p)
+					{
+						__m128 error = _mm_setzero_ps();
+						for (std::uint32_t c = 0; c < 4; ++c)
+						{
+							__m128 delta = _mm_sub_ps(channels[c], _mm_set1_ps(palette[p][c]));
+							error = _mm_add_ps(error, _mm_mul_ps(_mm_set1_ps(weights[c]), _mm_mul_ps(delta, delta)));
+						}
+
+						__m128i closer = _mm_castps_si128(_mm_cmplt_ps(error, best));
+						best = _mm_min_ps(error, best);
+						bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(static_cast<int>(p))), _mm_andnot_si128(closer, bestIndex));
+					}
+
+					alignas(16) std::int32_t lanes[4];
+					_mm_store_si128(reinterpret_cast<__m128i*>(lanes), bestIndex);
+					for (std::uint32_t l = 0; l < 4; ++l)
+					{
+						indices[i + l] = static_cast<std::uint8_t>(lanes[l]);
+					}
+
+					total = _mm_add_ps(total, best);
+				}
+
+				alignas(16) float sums[4];
+				_mm_store_ps(sums, total);
+				return sums[0] + sums[1] + sums[2] + sums[3];
+			}
+
+			POWERENGINE_TARGET_AVX2 float FindIndicesAvx2(const Block& block, const Palette& palette, std::uint32_t count, const float weights[4], std::uint8_t indices[16])
+			{
+				__m256 total = _mm256_setzero_ps();
+
+				for (std::uint32_t i = 0; i < 16; i += 8)
+				{
+					__m256 channels[4];
+					for (std::uint32_t c = 0; c < 4; ++c)
+					{
+						channels[c] = _mm256_load_ps(&block.Channels[c][i]);
+					}
+
+					__m256 best = _mm256_set1_ps(3.402823466e+38f);
+					__m256i bestIndex = _mm256_setzero_si256();
+
+					for (std::uint32_t p = 0; p < count; ++p)
+					{
+						__m256 error = _mm256_setzero_ps();
+						for (std::uint32_t c = 0; c < 4; ++c)
+						{
+							__m256 delta = _mm256_sub_ps(channels[c], _mm256_set1_ps(palette[p][c]));
+							error = _mm256_fmadd_ps(_mm256_set1_ps(weights[c]), _mm256_mul_ps(delta, delta), error);
+						}
+
+						__m256 closer = _mm256_cmp_ps(error, best, _CMP_LT_OQ);
+						best = _mm256_min_ps(error, best);
+						bestIndex = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(bestIndex),
+							_mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>(p))), closer));
+					}
+
+					alignas(32) std::int32_t lanes[8];
+					_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), bestIndex);
+					for (std::uint32_t l = 0; l < 8; ++l)
+					{
+						indices[i + l] = static_cast<std::uint8_t>(lanes[l]);
+					}
+
+					total = _mm256_add_ps(total, best);
+				}
+
+				alignas(32) float sums[8];
+				_mm256_store_ps(sums, total);
+				return sums[0] + sums[1] + sums[2] + sums[3] + sums[4] + sums[5] + sums[6] + sums[7];
+			}
+
+			bool CpuSupportsAvx2()
+			{
+#if defined(_MSC_VER)
+				int info[4];
+				__cpuid(info, 0);
+				if (info[0] < 7)
+				{
+					return false;
+				}
+
+				__cpuid(info, 1);
+				const bool osxsave = (info[2] & (1 << 27)) != 0;
+				const bool fma = (info[2] & (1 << 12)) != 0;
+				if (!osxsave || !fma || (_xgetbv(0) & 0x6) != 0x6)
+				{
+					return false;
+				}
+
+				__cpuidex(info, 7, 0);
+				return (info[1] & (1 << 5)) != 0;
+#else
+				return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+			}
+#endif
+
+			struct Kernel
+			{
+				FindIndicesFunction Function;
+				const char* Name;
+			};
+
+			const Kernel& SelectKernel()
+			{
+#if defined(POWERENGINE_COMPRESSOR_X86)
+				static const Kernel kernel = CpuSupportsAvx2() ? Kernel{ &FindIndicesAvx2, "avx2" } : Kernel{ &FindIndicesSse2, "sse2" };
+#else
+				static const Kernel kernel = { &FindIndicesScalar, "scalar" };
+#endif
+				return kernel;
+			}
+
+			// Little endian bit packing for the 128 bit BC7 block //
+
+			class BitWriter
+			{
+			public:
+
+				explicit BitWriter(std::uint8_t* destination)
+					: m_Destination(destination)
+				{
+					std::memset(m_Destination, 0, 16);
+				}
+
+				void Write(std::uint32_t value, std::uint32_t bits)
+				{
+					for (std::uint32_t b = 0; b < bits; ++b, ++m_Position)
+					{
+						if (value & (1u << b))
+						{
+							m_Destination[m_Position >> 3] |= static_cast<std::uint8_t>(1u << (m_Position & 7));
+						}
+					}
+				}
+
+			private:
+
+				std::uint8_t* m_Destination;
+				std::uint32_t m_Position = 0;
+			};
+
+			Block LoadBlock(const std::uint8_t pixels[64])
+			{
+				Block block;
+				for (std::uint32_t i = 0; i < 16; ++i)
+				{
+					for (std::uint32_t c = 0; c < 4; ++c)
+					{
+						block.Channels[c][i] = static_cast<float>(pixels[i * 4 + c]);
+					}
+				}
+				return block;
+			}
+
+			// Endpoints along the principal axis of the selected channels, or the bounding box in preview //
+
+			void FindEndpoints(const Block& block, std::uint32_t channelCount, CompressionQuality quality, float low[4], float high[4])
+			{
+				float minimum[4], maximum[4], mean[4] = {};
+
+				for (std::uint32_t c = 0; c < channelCount; ++c)
+				{
+					minimum[c] = *std::min_element(block.Channels[c], block.Channels[c] + 16);
+					maximum[c] = *std::max_element(block.Channels[c], block.Channels[c] + 16);
+				}
+
+				if (quality == CompressionQuality::Preview)
+				{
+					// Inset the box slightly, the extremes are rarely the best endpoints //
+
+					for (std::uint32_t c = 0; c < channelCount; ++c)
+					{
+						float inset = (maximum[c] - minimum[c]) / 16.0f;
+						low[c] = minimum[c] + inset;
+						high[c] = maximum[c] - inset;
+					}
+					return;
+				}
+
+				for (std::uint32_t c = 0; c < channelCount; ++c)
+				{
+					for (std::uint32_t i = 0; i < 16; ++i)
+					{
+						mean[c] += block.Channels[c][i];
+					}
+					mean[c] /= 16.0f;
+				}
+
+				float covariance[4][4] = {};
+				for (std::uint32_t i = 0; i < 16; ++i)
+				{
+					for (std::uint32_t a = 0; a < channelCount; ++a)
+					{
+						for (std::uint32_t b = 0; b < channelCount; ++b)
+						{
+							covariance[a][b] += (block.Channels[a][i] - mean[a]) * (block.Channels[b][i] - mean[b]);
+						}
+					}
+				}
+
+				// Power iteration, seeded with the bounding box diagonal //
+
+				float axis[4] = {};
+				for (std::uint32_t c = 0; c < channelCount; ++c)
+				{
+					axis[c] = maximum[c] - minimum[c];
+				}
+
+				for (std::uint32_t iteration = 0; iteration < 8; ++iteration)
+				{
+					float next[4] = {};
+					float length = 0.0f;
+					for (std::uint32_t a = 0; a < channelCount; ++a)
+					{
+						for (std::uint32_t b = 0; b < channelCount; ++b)
+						{
+							next[a] += covariance[a][b] * axis[b];
+						}
+						length = std::max(length, std::fabs(next[a]));
+					}
+
+					if (length == 0.0f)
+					{
+						break;
+					}
+
+					for (std::uint32_t c = 0; c < channelCount; ++c)
+					{
+						axis[c] = next[c] / length;
+					}
+				}
+
+				float lowest = 0.0f, highest = 0.0f;
+				for (std::uint32_t i = 0; i < 16; ++i)
+				{
+					float projection = 0.0f;
+					for (std::uint32_t c = 0; c < channelCount; ++c)
+					{
+						projection += (block.Channels[c][i] - mean[c]) * axis[c];
+					}
+					lowest = std::min(lowest, projection);
+					highest = std::max(highest, projection);
+				}
+
+				float axisLength = 0.0f;
+				for (std::uint32_t c = 0; c < channelCount; ++c)
+				{
+					axisLength += axis[c] * axis[c];
+				}
+				axisLength = axisLength > 0.0f ? axisLength : 1.0f;
+
+				for (std::uint32_t c = 0; c < channelCount; ++c)
+				{
+					low[c] = std::min(std::max(mean[c] + axis[c] * lowest / axisLength, 0.0f), 255.0f);
+					high[c] = std::min(std::max(mean[c] + axis[c] * highest / axisLength, 0.0f), 255.0f);
+				}
+			}
+
+			// Least squares endpoints for fixed indices, weights[i] is the interpolation factor of index i //
+
+			bool RefineEndpoints(const Block& block, std::uint32_t channelCount, const std::uint8_t indices[16], const float* factors, float low[4], float high[4])
+			{
+				float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+				float ax[4] = {}, bx[4] = {};
+
+				for (std::uint32_t i = 0; i < 16; ++i)
+				{
+					float t = factors[indices[i]];
+					float s = 1.0f - t;
+					aa += s * s;
+					ab += s * t;
+					bb += t * t;
+
+					for (std::uint32_t c = 0; c < channelCount; ++c)
+					{
+						ax[c] += s * block.Channels[c][i];
+						bx[c] += t * block.Channels[c][i];
+					}
+				}
+
+				float determinant = aa * bb - ab * ab;
+				if (std::fabs(determinant) < 1e-6f)
+				{
+					return false;
+				}
+
+				for (std::uint32_t c = 0; c < channelCount; ++c)
+				{
+					low[c] = std::min(std::max((ax[c] * bb - bx[c] * ab) / determinant, 0.0f), 255.0f);
+					high[c] = std::min(std::max((bx[c] * aa - ax[c] * ab) / determinant, 0.0f), 255.0f);
+				}
+
+				return true;
+			}
+
+			// BC1 //
+
+			std::uint16_t QuantizeRgb565(const float color[3])
+			{
+				std::uint32_t r = static_cast<std::uint32_t>(color[0] * 31.0f / 255.0f + 0.5f);
+				std::uint32_t g = static_cast<std::uint32_t>(color[1] * 63.0f / 255.0f + 0.5f);
+				std::uint32_t b = static_cast<std::uint32_t>(color[2] * 31.0f / 255.0f + 0.5f);
+				return static_cast<std::uint16_t>((r << 11) | (g << 5) | b);
+			}
+
+			void ExpandRgb565(std::uint16_t packed, float color[4])
+			{
+				std::uint32_t r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+				color[0] = static_cast<float>((r << 3) | (r >> 2));
+				color[1] = static_cast<float>((g << 2) | (g >> 4));
+				color[2] = static_cast<float>((b << 3) | (b >> 2));
+				color[3] = 0.0f;
+			}
+
+			float EncodeBC1Candidate(const Block& block, const float low[4], const float high[4], std::uint16_t& color0, std::uint16_t& color1, std::uint8_t indices[16])
+			{
+				static const float weights[4] = { 1.0f, 1.0f, 1.0f, 0.0f };
+
+				color0 = QuantizeRgb565(high);
+				color1 = QuantizeRgb565(low);
+
+				// color0 > color1 selects the four color mode, which BC3 always uses //
+
+				if (color0 < color1)
+				{
+					std::swap(color0, color1);
+				}
+
+				if (color0 == color1)
+				{
+					std::fill(indices, indices + 16, std::uint8_t(0));
+
+					Palette palette;
+					ExpandRgb565(color0, palette[0]);
+					return SelectKernel().Function(block, palette, 1, weights, indices);
+				}
+
+				Palette palette;
+				ExpandRgb565(color0, palette[0]);
+				ExpandRgb565(color1, palette[1]);
+				for (std::uint32_t c = 0; c < 4; ++c)
+				{
+					palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+					palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+				}
+
+				return SelectKernel().Function(block, palette, 4, weights, indices);
+			}
+
+			void EncodeBC1(const Block& block, CompressionQuality quality, std::uint8_t* destination)
+			{
+				// Interpolation factor from color0 for each BC1 index //
+				static const float factors[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+				float low[4], high[4];
+				FindEndpoints(block, 3, quality, low, high);
+
+				std::uint16_t color0, color1;
+				std::uint8_t indices[16];
+				float error = EncodeBC1Candidate(block, low, high, color0, color1, indices);
+
+				if (quality == CompressionQuality::High)
+				{
+					for (std::uint32_t iteration = 0; iteration < 2 && error > 0.0f && color0 != color1; ++iteration)
+					{
+						float refinedLow[4], refinedHigh[4];
+
+						// Refinement solves for (color0, color1), i.e. (high, low) //
+
+						if (!RefineEndpoints(block, 3, indices, factors, refinedHigh, refinedLow))
+						{
+							break;
+						}
+
+						std::uint16_t refined0, refined1;
+						std::uint8_t refinedIndices[16];
+						float refinedError = EncodeBC1Candidate(block, refinedLow, refinedHigh, refined0, refined1, refinedIndices);
+
+						if (refinedError >= error)
+						{
+							break;
+						}
+
+						error = refinedError;
+						color0 = refined0;
+						color1 = refined1;
+						std::memcpy(indices, refinedIndices, sizeof(indices));
+					}
+				}
+
+				std::uint32_t packedIndices = 0;
+				for (std::uint32_t i = 0; i < 16; ++i)
+				{
+					packedIndices |= std::uint32_t(indices[i]) << (i * 2);
+				}
+
+				destination[0] = static_cast<std::uint8_t>(color0);
+				destination[1] = static_cast<std::uint8_t>(color0 >> 8);
+				destination[2] = static_cast<std::uint8_t>(color1);
+				destination[3] = static_cast<std::uint8_t>(color1 >> 8);
+				std::memcpy(destination + 4, &packedIndices, 4);
+			}
+
+			// BC4, channel selects which channel of the block is encoded //
+
+			float EncodeBC4Candidate(const Block& block, std::uint8_t endpoint0, std::uint8_t endpoint1, std::uint8_t indices[16])
+			{
+				static const float weights[4] = { 1.0f, 0.0f, 0.0f, 0.0f };
+
+				Palette palette = {};
+				palette[0][0] = endpoint0;
+				palette[1][0] = endpoint1;
+
+				if (endpoint0 > endpoint1)
+				{
+					for (std::uint32_t k = 1; k <= 6; ++k)
+					{
+						palette[k + 1][0] = ((7.0f - k) * endpoint0 + k * endpoint1) / 7.0f;
+					}
+				}
+				else
+				{
+					for (std::uint32_t k = 1; k <= 4; ++k)
+					{
+						palette[k + 1][0] = ((5.0f - k) * endpoint0 + k * endpoint1) / 5.0f;
+					}
+					palette[6][0] = 0.0f;
+					palette[7][0] = 255.0f;
+				}
+
+				return SelectKernel().Function(block, palette, 8, weights, indices);
+			}
+
+			void EncodeBC4(const Block& source, std::uint32_t channel, CompressionQuality quality, std::uint8_t* destination)
+			{
+				Block block = {};
+				std::memcpy(block.Channels[0], source.Channels[channel], sizeof(block.Channels[0]));
+
+				const float* values = block.Channels[0];
+				std::uint8_t minimum = static_cast<std::uint8_t>(*std::min_element(values, values + 16));
+				std::uint8_t maximum = static_cast<std::uint8_t>(*std::max_element(values, values + 16));
+
+				std::uint8_t endpoint0 = maximum, endpoint1 = minimum;
+				std::uint8_t indices[16];
+				float error;
+
+				if (maximum == minimum)
+				{
+					std::fill(indices, indices + 16, std::uint8_t(0));
+					error = 0.0f;
+				}
+				else
+				{
+					error = EncodeBC4Candidate(block, endpoint0, endpoint1, indices);
+				}
+
+				// The six value mode keeps exact 0 and 255, better for blocks mixing extremes with a narrow range //
+
+				if (quality == CompressionQuality::High && error > 0.0f)
+				{
+					std::uint8_t inner0 = 255, inner1 = 0;
+					for (std::uint32_t i = 0; i < 16; ++i)
+					{
+						std::uint8_t value = static_cast<std::uint8_t>(values[i]);
+						if (value != 0 && value != 255)
+						{
+							inner0 = std::min(inner0, value);
+							inner1 = std::max(inner1, value);
+						}
+					}
+
+					if (inner0 <= inner1)
+					{
+						std::uint8_t candidateIndices[16];
+						float candidateError = EncodeBC4Candidate(block, inner0, inner1, candidateIndices);
+						if (candidateError < error)
+						{
+							error = candidateError;
+							endpoint0 = inner0;
+							endpoint1 = inner1;
+							std::memcpy(indices, candidateIndices, sizeof(indices));
+						}
+					}
+				}
+
+				std::uint64_t packedIndices = 0;
+				for (std::uint32_t i = 0; i < 16; ++i)
+				{
+					packedIndices |= std::uint64_t(indices[i]) << (i * 3);
+				}
+
+				destination[0] = endpoint0;
+				destination[1] = endpoint1;
+				for (std::uint32_t b = 0; b < 6; ++b)
+				{
+					destination[2 + b] = static_cast<std::uint8_t>(packedIndices >> (b * 8));
+				}
+			}
+
+			// BC7, mode 6 : one subset, RGBA 7.7.7.7 endpoints with a unique p-bit, 4 bit indices //
+
+			const std::uint32_t g_Bc7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+			void QuantizeBc7Endpoint(const float color[4], std::uint8_t quantized[4], std::uint32_t& pbit)
+			{
+				float bestError = 3.402823466e+38f;
+
+				for (std::uint32_t p = 0; p < 2; ++p)
+				{
+					std::uint8_t candidate[4];
+					float error = 0.0f;
+
+					for (std::uint32_t c = 0; c < 4; ++c)
+					{
+						float value = std::round((color[c] - static_cast<float>(p)) / 2.0f);
+						candidate[c] = static_cast<std::uint8_t>(std::min(std::max(value, 0.0f), 127.0f));
+
+						float delta = static_cast<float>((candidate[c] << 1) | p) - color[c];
+						error += delta * delta;
+					}
+
+					if (error < bestError)
+					{
+						bestError = error;
+						pbit = p;
+						std::memcpy(quantized, candidate, 4);
+					}
+				}
+			}
+
+			float EncodeBC7Candidate(const Block& block, const float low[4], const float high[4],
+				std::uint8_t endpoints[2][4], std::uint32_t pbits[2], std::uint8_t indices[16])
+			{
+				static const float weights[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+				QuantizeBc7Endpoint(low, endpoints[0], pbits[0]);
+				QuantizeBc7Endpoint(high, endpoints[1], pbits[1]);
+
+				float expanded[2][4];
+				for (std::uint32_t e = 0; e < 2; ++e)
+				{
+					for (std::uint32_t c = 0; c < 4; ++c)
+					{
+						expanded[e][c] = static_cast<float>((endpoints[e][c] << 1) | pbits[e]);
+					}
+				}
+
+				Palette palette;
+				for (std::uint32_t i = 0; i < 16; ++i)
+				{
+					for (std::uint32_t c = 0; c < 4; ++c)
+					{
+						std::uint32_t value = ((64 - g_Bc7Weights4[i]) * static_cast<std::uint32_t>(expanded[0][c]) +
+							g_Bc7Weights4[i] * static_cast<std::uint32_t>(expanded[1][c]) + 32) >> 6;
+						palette[i][c] = static_cast<float>(value);
+					}
+				}
+
+				return SelectKernel().Function(block, palette, 16, weights, indices);
+			}
+
+			void EncodeBC7(const Block& block, CompressionQuality quality, std::uint8_t* destination)
+			{
+				float factors[16];
+				for (std::uint32_t i = 0; i < 16; ++i)
+				{
+					factors[i] = g_Bc7Weights4[i] / 64.0f;
+				}
+
+				float low[4], high[4];
+				FindEndpoints(block, 4, quality, low, high);
+
+				std::uint8_t endpoints[2][4];
+				std::uint32_t pbits[2];
+				std::uint8_t indices[16];
+				float error = EncodeBC7Candidate(block, low, high, endpoints, pbits, indices);
+
+				if (quality == CompressionQuality::High)
+				{
+					for (std::uint32_t iteration = 0; iteration < 2 && error > 0.0f; ++iteration)
+					{
+						float refinedLow[4], refinedHigh[4];
+						if (!RefineEndpoints(block, 4, indices, factors, refinedLow, refinedHigh))
+						{
+							break;
+						}
+
+						std::uint8_t refinedEndpoints[2][4];
+						std::uint32_t refinedPbits[2];
+						std::uint8_t refinedIndices[16];
+						float refinedError = EncodeBC7Candidate(block, refinedLow, refinedHigh, refinedEndpoints, refinedPbits, refinedIndices);
+
+						if (refinedError >= error)
+						{
+							break;
+						}
+
+						error = refinedError;
+						std::memcpy(endpoints, refinedEndpoints, sizeof(endpoints));
+						std::memcpy(pbits, refinedPbits, sizeof(pbits));
+						std::memcpy(indices, refinedIndices, sizeof(indices));
+					}
+				}
+
+				// The anchor index is stored with 3 bits, its top bit must be 0 //
+
+				if (indices[0] & 8)
+				{
+					std::swap(endpoints[0], endpoints[1]);
+					std::swap(pbits[0], pbits[1]);
+					for (std::uint8_t& index : indices)
+					{
+						index = static_cast<std::uint8_t>(15 - index);
+					}
+				}
+
+				BitWriter writer(destination);
+				writer.Write(1u << 6, 7);
+
+				for (std::uint32_t c = 0; c < 4; ++c)
+				{
+					writer.Write(endpoints[0][c], 7);
+					writer.Write(endpoints[1][c], 7);
+				}
+
+				writer.Write(pbits[0], 1);
+				writer.Write(pbits[1], 1);
+
+				writer.Write(indices[0], 3);
+				for (std::uint32_t i = 1; i < 16; ++i)
+				{
+					writer.Write(indices[i], 4);
+				}
+			}
+
+			void EncodeBlock(const Block& block, BlockFormat format, CompressionQuality quality, std::uint8_t* destination)
+			{
+				switch (format)
+				{
+				case BlockFormat::BC1:
+					EncodeBC1(block, quality, destination);
+					break;
+				case BlockFormat::BC3:
+					EncodeBC4(block, 3, quality, destination);
+					EncodeBC1(block, quality, destination + 8);
+					break;
+				case BlockFormat::BC4:
+					EncodeBC4(block, 0, quality, destination);
+					break;
+				case BlockFormat::BC5:
+					EncodeBC4(block, 0, quality, destination);
+					EncodeBC4(block, 1, quality, destination + 8);
+					break;
+				case BlockFormat::BC7:
+					EncodeBC7(block, quality, destination);
+					break;
+				}
+			}
+		}
+
+		std::uint32_t BlockBytes(BlockFormat format)
+		{
+			return format == BlockFormat::BC1 || format == BlockFormat::BC4 ? 8 : 16;
+		}
+
+		std::uint32_t DxgiFormat(BlockFormat format, bool srgb)
+		{
+			// Values of DXGI_FORMAT, kept numeric so this file does not need the DXGI headers //
+
+			switch (format)
+			{
+			case BlockFormat::BC1: return srgb ? 72 : 71;	// DXGI_FORMAT_BC1_UNORM(_SRGB)
+			case BlockFormat::BC3: return srgb ? 78 : 77;	// DXGI_FORMAT_BC3_UNORM(_SRGB)
+			case BlockFormat::BC4: return 80;				// DXGI_FORMAT_BC4_UNORM
+			case BlockFormat::BC5: return 83;				// DXGI_FORMAT_BC5_UNORM
+			case BlockFormat::BC7: return srgb ? 99 : 98;	// DXGI_FORMAT_BC7_UNORM(_SRGB)
+			}
+			return 0;
+		}
+
+		void CompressBlock(const std::uint8_t pixels[64], BlockFormat format, CompressionQuality quality, std::uint8_t* destination)
+		{
+			EncodeBlock(LoadBlock(pixels), format, quality, destination);
+		}
+
+		void CompressTexture(const CompressorSource& source, BlockFormat format, CompressionQuality quality,
+			std::uint8_t* destination, std::uint64_t destinationRowPitch, Core::ThreadPool& pool)
+		{
+			constexpr std::uint32_t tileBlocks = 8;
+
+			const std::uint32_t blocksX = BlockCount(source.Width);
+			const std::uint32_t blocksY = BlockCount(source.Height);
+			const std::uint32_t tilesX = (blocksX + tileBlocks - 1) / tileBlocks;
+			const std::uint32_t tilesY = (blocksY + tileBlocks - 1) / tileBlocks;
+			const std::uint32_t blockBytes = BlockBytes(format);
+
+			pool.ParallelFor(tilesX * tilesY, 1, [&](std::uint32_t begin, std::uint32_t end)
+			{
+				for (std::uint32_t tile = begin; tile < end; ++tile)
+				{
+					const std::uint32_t tileX = tile % tilesX;
+					const std::uint32_t tileY = tile / tilesX;
+					const std::uint32_t lastX = std::min((tileX + 1) * tileBlocks, blocksX);
+					const std::uint32_t lastY = std::min((tileY + 1) * tileBlocks, blocksY);
+
+					for (std::uint32_t by = tileY * tileBlocks; by < lastY; ++by)
+					{
+						std::uint8_t* row = destination + destinationRowPitch * by;
+
+						for (std::uint32_t bx = tileX * tileBlocks; bx < lastX; ++bx)
+						{
+							// Partial edge blocks repeat the last row and column //
+
+							Block block;
+							for (std::uint32_t y = 0; y < 4; ++y)
+							{
+								const std::uint32_t sy = std::min(by * 4 + y, source.Height - 1);
+								const std::uint8_t* sourceRow = source.Pixels + std::uint64_t(source.RowPitch) * sy;
+
+								for (std::uint32_t x = 0; x < 4; ++x)
+								{
+									const std::uint32_t sx = std::min(bx * 4 + x, source.Width - 1);
+									for (std::uint32_t c = 0; c < 4; ++c)
+									{
+										block.Channels[c][y * 4 + x] = static_cast<float>(sourceRow[sx * 4 + c]);
+									}
+								}
+							}
+
+							EncodeBlock(block, format, quality, row + std::uint64_t(bx) * blockBytes);
+						}
+					}
+				}
+			});
+		}
+
+		const char* CompressorKernelName()
+		{
+			return SelectKernel().Name;
+		}
+	}
+}
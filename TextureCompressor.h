@@ -0,0 +1,65 @@
+#pragma once
+
+#include "ThreadPool.h"
+
+#include <cstdint>
+
+namespace PowerEngine {
+
+	namespace Assets {
+
+		enum class BlockFormat : std::uint8_t
+		{
+			BC1 = 0,	// RGB, 8 bytes per block
+			BC3,		// RGBA, BC4 alpha + BC1 color, 16 bytes per block
+			BC4,		// R, 8 bytes per block
+			BC5,		// RG, two BC4 blocks, 16 bytes per block
+			BC7			// RGBA, 16 bytes per block
+		};
+
+		enum class CompressionQuality : std::uint8_t
+		{
+			Preview = 0,	// bounding box endpoints, one index pass
+			High			// principal axis endpoints refined by least squares
+		};
+
+		// RGBA8 source image //
+
+		struct CompressorSource
+		{
+			const std::uint8_t* Pixels;
+			std::uint32_t Width;
+			std::uint32_t Height;
+			std::uint32_t RowPitch;
+		};
+
+		// Layout helpers //
+		/*
+		   Block compressed formats have a width and height alignment of 4 in
+		   D3D12_PROPERTY_LAYOUT_FORMAT_TABLE. One row of the compressed image holds one row
+		   of 4x4 blocks, so a destination laid out by D3DX12GetCopyableFootprints (NumRows
+		   block rows of RowPitch bytes) can be written directly.
+		*/
+
+		std::uint32_t BlockBytes(BlockFormat format);
+		std::uint32_t DxgiFormat(BlockFormat format, bool srgb);
+
+		inline std::uint32_t BlockCount(std::uint32_t pixels) { return (pixels + 3) / 4; }
+		inline std::uint64_t CompressedRowSize(BlockFormat format, std::uint32_t width) { return std::uint64_t(BlockCount(width)) * BlockBytes(format); }
+		inline std::uint64_t CompressedSize(BlockFormat format, std::uint32_t width, std::uint32_t height) { return CompressedRowSize(format, width) * BlockCount(height); }
+
+		// Compresses a whole image in tiles of blocks spread over the thread pool. //
+		// destinationRowPitch is the byte distance between two rows of blocks. //
+
+		void CompressTexture(const CompressorSource& source, BlockFormat format, CompressionQuality quality,
+			std::uint8_t* destination, std::uint64_t destinationRowPitch, Core::ThreadPool& pool = Core::ThreadPool::Global());
+
+		// Compresses a single 4x4 block of RGBA8 pixels stored row by row //
+
+		void CompressBlock(const std::uint8_t pixels[64], BlockFormat format, CompressionQuality quality, std::uint8_t* destination);
+
+		// Name of the index search kernel picked for this CPU : "avx2", "sse2" or "scalar" //
+
+		const char* CompressorKernelName();
+	}
+}
@@ -0,0 +1,343 @@
+#include "TextureStreamer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+namespace PowerEngine
+{
+	namespace Assets
+	{
+		TextureStreamer::TextureStreamer(ITextureStreamingBackend& backend, std::uint64_t budgetBytes)
+			: m_Backend(backend)
+		{
+			m_Stats.BudgetBytes = budgetBytes;
+		}
+
+		TextureId TextureStreamer::RegisterTexture(const StreamingTextureDesc& desc)
+		{
+			assert(desc.MipCount > 0 && desc.MipSizes && "A streamed texture needs at least one mip.");
+
+			TextureId id;
+			if (!m_FreeIds.empty())
+			{
+				id = m_FreeIds.back();
+				m_FreeIds.pop_back();
+			}
+			else
+			{
+				id = static_cast<TextureId>(m_Textures.size());
+				m_Textures.emplace_back();
+			}
+
+			TextureState& state = m_Textures[id];
+			state = TextureState();
+			state.MipSizes.assign(desc.MipSizes, desc.MipSizes + desc.MipCount);
+			state.Width = desc.Width;
+			state.Height = desc.Height;
+			state.MipCount = desc.MipCount;
+
+			// At least the smallest mip stays resident so the texture can always be sampled //
+
+			std::uint32_t pinned = std::min(std::max(desc.PinnedMips, 1u), desc.MipCount);
+			state.PinnedMip = desc.MipCount - pinned;
+			state.ResidentMip = state.PinnedMip;
+			state.DesiredMip = state.PinnedMip;
+			state.Registered = true;
+
+			for (std::uint32_t mip = state.PinnedMip; mip < state.MipCount; ++mip)
+			{
+				m_Stats.ResidentBytes += state.MipSizes[mip];
+			}
+
+			return id;
+		}
+
+		void TextureStreamer::UnregisterTexture(TextureId texture)
+		{
+			TextureState& state = m_Textures[texture];
+			assert(state.Registered);
+
+			for (std::uint32_t mip = state.ResidentMip; mip < state.MipCount; ++mip)
+			{
+				m_Stats.ResidentBytes -= state.MipSizes[mip];
+			}
+
+			state.Registered = false;
+
+			// An in-flight upload keeps the slot alive until it reports back //
+
+			if (state.PendingMip == ~0u)
+			{
+				ReleaseSlot(texture);
+			}
+		}
+
+		void TextureStreamer::ReleaseSlot(TextureId texture)
+		{
+			m_Textures[texture] = TextureState();
+			m_FreeIds.push_back(texture);
+		}
+
+		void TextureStreamer::ReportUsage(TextureId texture, float screenArea, float uvArea)
+		{
+			TextureState& state = m_Textures[texture];
+
+			if (screenArea <= 0.0f || !state.Registered)
+			{
+				return;
+			}
+
+			float texels = static_cast<float>(state.Width) * static_cast<float>(state.Height) * uvArea;
+			float density = texels / screenArea;
+
+			if (state.Coverage == 0.0f || density < state.TexelDensity)
+			{
+				state.TexelDensity = density;
+			}
+			state.Coverage = std::max(state.Coverage, screenArea);
+		}
+
+		float TextureStreamer::MipPriority(const TextureState& state, std::uint32_t mip) const
+		{
+			if (state.Coverage == 0.0f || mip < state.DesiredMip)
+			{
+				return 0.0f;
+			}
+
+			// Coarse mips serve the whole coverage before any finer one is useful //
+
+			return state.Coverage * std::exp2(2.0f * static_cast<float>(mip - state.DesiredMip));
+		}
+
+		void TextureStreamer::EvictMip(TextureId texture)
+		{
+			TextureState& state = m_Textures[texture];
+			assert(state.ResidentMip < state.PinnedMip);
+
+			m_Backend.Evict(texture, state.ResidentMip);
+
+			m_Stats.ResidentBytes -= state.MipSizes[state.ResidentMip];
+			m_Stats.Evictions++;
+			state.ResidentMip++;
+		}
+
+		void TextureStreamer::Update(double timeSeconds)
+		{
+			struct Candidate
+			{
+				float Priority;
+				TextureId Texture;
+
+				bool operator<(const Candidate& other) const { return Priority > other.Priority; }
+			};
+
+			std::vector<Candidate> loads;
+			std::priority_queue<Candidate> evictions; // lowest priority on top
+
+			// Every mip level holds a quarter of the texels of the previous one //
+
+			for (TextureId id = 0; id < m_Textures.size(); ++id)
+			{
+				TextureState& state = m_Textures[id];
+				if (!state.Registered)
+				{
+					continue;
+				}
+
+				if (state.Coverage > 0.0f)
+				{
+					float mip = std::floor(0.5f * std::log2(std::max(state.TexelDensity, 1.0f)));
+					state.DesiredMip = std::min(static_cast<std::uint32_t>(mip), state.PinnedMip);
+				}
+				else
+				{
+					state.DesiredMip = state.PinnedMip;
+				}
+
+				if (state.PendingMip != ~0u)
+				{
+					continue;
+				}
+
+				if (state.ResidentMip > state.DesiredMip)
+				{
+					loads.push_back({ MipPriority(state, state.ResidentMip - 1), id });
+				}
+
+				if (state.ResidentMip < state.PinnedMip)
+				{
+					evictions.push({ MipPriority(state, state.ResidentMip), id });
+				}
+			}
+
+			// Pops the cheapest eviction candidate below maxPriority, skipping stale entries //
+
+			auto evictOne = [&](float maxPriority, TextureId keep) -> bool
+			{
+				while (!evictions.empty())
+				{
+					Candidate candidate = evictions.top();
+					TextureState& state = m_Textures[candidate.Texture];
+
+					if (candidate.Texture == keep || state.PendingMip != ~0u || state.ResidentMip >= state.PinnedMip ||
+						candidate.Priority != MipPriority(state, state.ResidentMip))
+					{
+						evictions.pop();
+						continue;
+					}
+
+					if (candidate.Priority >= maxPriority)
+					{
+						return false;
+					}
+
+					evictions.pop();
+					EvictMip(candidate.Texture);
+
+					if (state.ResidentMip < state.PinnedMip)
+					{
+						evictions.push({ MipPriority(state, state.ResidentMip), candidate.Texture });
+					}
+
+					return true;
+				}
+
+				return false;
+			};
+
+			// A lowered budget is enforced before anything new is requested //
+
+			while (m_Stats.ResidentBytes > m_Stats.BudgetBytes && evictOne(std::numeric_limits<float>::infinity(), g_InvalidTexture))
+			{
+			}
+
+			std::sort(loads.begin(), loads.end(), [](const Candidate& a, const Candidate& b) { return a.Priority > b.Priority; });
+
+			for (const Candidate& load : loads)
+			{
+				if (m_Stats.PendingRequests >= m_MaxPendingRequests)
+				{
+					break;
+				}
+
+				TextureState& state = m_Textures[load.Texture];
+				std::uint32_t mip = state.ResidentMip - 1;
+				std::uint64_t size = state.MipSizes[mip];
+
+				bool fits = true;
+				while (m_Stats.ResidentBytes + m_Stats.PendingBytes + size > m_Stats.BudgetBytes)
+				{
+					if (!evictOne(load.Priority, load.Texture))
+					{
+						fits = false;
+						break;
+					}
+				}
+
+				if (!fits)
+				{
+					continue;
+				}
+
+				state.PendingMip = mip;
+				state.RequestTime = timeSeconds;
+
+				m_Stats.PendingBytes += size;
+				m_Stats.PendingRequests++;
+
+				m_Backend.BeginUpload(load.Texture, mip);
+			}
+
+			// Usage is reported again every frame //
+
+			for (TextureState& state : m_Textures)
+			{
+				state.Coverage = 0.0f;
+				state.TexelDensity = 0.0f;
+			}
+		}
+
+		void TextureStreamer::OnMipResident(TextureId texture, std::uint32_t mip, double timeSeconds)
+		{
+			TextureState& state = m_Textures[texture];
+
+			if (state.PendingMip != mip)
+			{
+				return;
+			}
+
+			std::uint64_t size = state.MipSizes[mip];
+
+			m_Stats.PendingBytes -= size;
+			m_Stats.PendingRequests--;
+
+			double latencyMs = (timeSeconds - state.RequestTime) * 1000.0;
+			m_TotalLatency += latencyMs;
+			m_LatencySamples++;
+			m_Stats.AverageLatencyMs = m_TotalLatency / static_cast<double>(m_LatencySamples);
+			m_Stats.MaxLatencyMs = std::max(m_Stats.MaxLatencyMs, latencyMs);
+
+			state.PendingMip = ~0u;
+
+			if (!state.Registered)
+			{
+				ReleaseSlot(texture);
+				return;
+			}
+
+			state.ResidentMip = mip;
+			m_Stats.ResidentBytes += size;
+			m_Stats.Uploads++;
+		}
+
+		void TextureStreamer::OnUploadCancelled(TextureId texture, std::uint32_t mip)
+		{
+			TextureState& state = m_Textures[texture];
+
+			if (state.PendingMip != mip)
+			{
+				return;
+			}
+
+			m_Stats.PendingBytes -= state.MipSizes[mip];
+			m_Stats.PendingRequests--;
+			state.PendingMip = ~0u;
+
+			if (!state.Registered)
+			{
+				ReleaseSlot(texture);
+			}
+		}
+
+		void TextureStreamer::SetBudget(std::uint64_t budgetBytes)
+		{
+			m_Stats.BudgetBytes = budgetBytes;
+		}
+
+		void TextureStreamer::SetMaxPendingRequests(std::uint32_t count)
+		{
+			m_MaxPendingRequests = std::max(count, 1u);
+		}
+
+		void TextureStreamer::ResetLatencyStats()
+		{
+			m_TotalLatency = 0.0;
+			m_LatencySamples = 0;
+			m_Stats.AverageLatencyMs = 0.0;
+			m_Stats.MaxLatencyMs = 0.0;
+		}
+
+		std::uint32_t TextureStreamer::ResidentMip(TextureId texture) const
+		{
+			return m_Textures[texture].ResidentMip;
+		}
+
+		std::uint32_t TextureStreamer::DesiredMip(TextureId texture) const
+		{
+			return m_Textures[texture].DesiredMip;
+		}
+	}
+}
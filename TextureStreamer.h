@@ -0,0 +1,132 @@
+#pragma once
+
+#include "MemoryTracker.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Assets {
+
+		using TextureId = std::uint32_t;
+		constexpr TextureId g_InvalidTexture = ~0u;
+
+		// Description handed to the streamer when a texture is registered //
+
+		struct StreamingTextureDesc
+		{
+			std::uint32_t Width;
+			std::uint32_t Height;
+			std::uint32_t MipCount;
+			std::uint32_t PinnedMips;			// smallest mips, always resident
+			const std::uint64_t* MipSizes;		// MipCount values, bytes of each mip in GPU memory
+		};
+
+		struct TextureStreamingStats
+		{
+			std::uint64_t BudgetBytes = 0;
+			std::uint64_t ResidentBytes = 0;
+			std::uint64_t PendingBytes = 0;
+			std::uint32_t PendingRequests = 0;
+			std::uint64_t Uploads = 0;
+			std::uint64_t Evictions = 0;
+			double AverageLatencyMs = 0.0;
+			double MaxLatencyMs = 0.0;
+		};
+
+		// Does the actual memory work for the streamer //
+		/*
+		   The streamer only decides which mips should be resident. A backend turns
+		   those decisions into GPU copies and evictions, and reports back through
+		   TextureStreamer::OnMipResident once a copy has completed, or through
+		   TextureStreamer::OnUploadCancelled when it drops one.
+		   A CPU stand-in backend is enough to exercise the whole policy.
+		*/
+
+		class ITextureStreamingBackend
+		{
+		public:
+
+			virtual ~ITextureStreamingBackend() = default;
+
+			virtual void BeginUpload(TextureId texture, std::uint32_t mip) = 0;
+			virtual void Evict(TextureId texture, std::uint32_t mip) = 0;
+		};
+
+		// Priority-driven mip streaming under a fixed memory budget //
+		/*
+		   A texture always holds a contiguous mip chain [ResidentMip, MipCount).
+		   Every frame the objects using a texture report their projected screen coverage,
+		   which gives the finest mip worth having. Missing mips are requested one level
+		   at a time, coarse first, and when the budget is exhausted the finest mips with
+		   the lowest priority are evicted to make room.
+		*/
+
+		class TextureStreamer
+		{
+		public:
+
+			TextureStreamer(ITextureStreamingBackend& backend, std::uint64_t budgetBytes);
+
+			TextureId RegisterTexture(const StreamingTextureDesc& desc);
+			void UnregisterTexture(TextureId texture);
+
+			// Per object and per frame, before Update(). uvArea is the fraction of the texture //
+			// mapped on the object, screenArea its projected size in pixels. //
+
+			void ReportUsage(TextureId texture, float screenArea, float uvArea = 1.0f);
+
+			void Update(double timeSeconds);
+			void OnMipResident(TextureId texture, std::uint32_t mip, double timeSeconds);
+
+			// The backend dropped an upload before it ran, the mip is requested again by a later Update() //
+
+			void OnUploadCancelled(TextureId texture, std::uint32_t mip);
+
+			void SetBudget(std::uint64_t budgetBytes);
+			void SetMaxPendingRequests(std::uint32_t count);
+			void ResetLatencyStats();
+
+			// Getters //
+
+			std::uint32_t ResidentMip(TextureId texture) const;
+			std::uint32_t DesiredMip(TextureId texture) const;
+			const TextureStreamingStats& Stats() const { return m_Stats; }
+
+		private:
+
+			struct TextureState
+			{
+				Core::TaggedVector<std::uint64_t, Core::MemoryTag::Streaming> MipSizes;
+				std::uint32_t Width = 0;
+				std::uint32_t Height = 0;
+				std::uint32_t MipCount = 0;
+				std::uint32_t PinnedMip = 0;		// first always-resident mip
+				std::uint32_t ResidentMip = 0;
+				std::uint32_t DesiredMip = 0;
+				std::uint32_t PendingMip = ~0u;
+				double RequestTime = 0.0;
+				float TexelDensity = 0.0f;			// texels per pixel of the best reported usage
+				float Coverage = 0.0f;				// screen pixels of the best reported usage
+				bool Registered = false;
+			};
+
+			float MipPriority(const TextureState& state, std::uint32_t mip) const;
+			void EvictMip(TextureId texture);
+			void ReleaseSlot(TextureId texture);
+
+		private:
+
+			ITextureStreamingBackend& m_Backend;
+			Core::TaggedVector<TextureState, Core::MemoryTag::Streaming> m_Textures;
+			Core::TaggedVector<TextureId, Core::MemoryTag::Streaming> m_FreeIds;
+			std::uint32_t m_MaxPendingRequests = 16;
+
+			double m_TotalLatency = 0.0;
+			std::uint64_t m_LatencySamples = 0;
+
+			TextureStreamingStats m_Stats;
+		};
+	}
+}
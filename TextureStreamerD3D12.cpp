@@ -0,0 +1,236 @@
+#include "TextureStreamerD3D12.h"
+#include "FootprintCacheD3D12.h"
+#include "SubresourceCopy.h"
+#include "RenderStats.h"
+#include "CommandTraceD3D12.h"
+
+namespace PowerEngine
+{
+	namespace Assets
+	{
+		TextureStreamingBackendD3D12::TextureStreamingBackendD3D12(ComPtr<ID3D12Device2> device, Core::BindlessHeapD3D12& bindless)
+			: m_Device(device)
+			, m_Bindless(bindless)
+		{
+		}
+
+		void TextureStreamingBackendD3D12::ComputeMipSizes(const D3D12_RESOURCE_DESC& desc, std::vector<std::uint64_t>& mipSizes)
+		{
+			mipSizes.resize(desc.MipLevels);
+
+			for (UINT mip = 0; mip < desc.MipLevels; ++mip)
+			{
+				const std::shared_ptr<const Core::SubresourceFootprints> footprints = Core::GetCopyableFootprints(desc, mip, 1);
+				ThrowIfFailed(footprints ? S_OK : E_INVALIDARG);
+				const UINT64 totalBytes = footprints->TotalBytes;
+
+				// Placed subresources start on D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT //
+
+				mipSizes[mip] = D3DX12Align<UINT64>(totalBytes, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+			}
+		}
+
+		void TextureStreamingBackendD3D12::AddTexture(TextureId texture, ComPtr<ID3D12Resource> resource, const D3D12_SUBRESOURCE_DATA* mipData, std::uint32_t residentMip)
+		{
+			if (texture >= m_Textures.size())
+			{
+				m_Textures.resize(texture + 1);
+			}
+
+			StreamedTexture& streamed = m_Textures[texture];
+			streamed.Resource = resource;
+			streamed.MipData = mipData;
+			streamed.Residency = m_Residency ? m_Residency->Track(resource.Get()) : Core::g_InvalidResidencyHandle;
+
+			ReplaceSrv(streamed, residentMip);
+		}
+
+		void TextureStreamingBackendD3D12::RemoveTexture(TextureId texture, TextureStreamer& streamer)
+		{
+			RetireTexture(m_Textures[texture]);
+
+			// Never recorded, the streamer would otherwise count them pending forever //
+
+			m_Queued.erase(std::remove_if(m_Queued.begin(), m_Queued.end(), [&](const Upload& upload)
+			{
+				if (upload.Texture != texture)
+				{
+					return false;
+				}
+
+				streamer.OnUploadCancelled(upload.Texture, upload.Mip);
+				return true;
+			}), m_Queued.end());
+		}
+
+		void TextureStreamingBackendD3D12::RetireTexture(StreamedTexture& texture)
+		{
+			if (!texture.Srv.IsNull())
+			{
+				m_ReplacedViews.push_back(texture.Srv);
+			}
+
+			// Untracked, it stays resident until its frames retire and it is released //
+
+			if (texture.Residency != Core::g_InvalidResidencyHandle)
+			{
+				m_Residency->Untrack(texture.Residency);
+			}
+
+			if (texture.Resource)
+			{
+				m_RemovedResources.push_back(std::move(texture.Resource));
+			}
+
+			texture = StreamedTexture();
+		}
+
+		void TextureStreamingBackendD3D12::BeginUpload(TextureId texture, std::uint32_t mip)
+		{
+			m_Queued.push_back({ texture, mip, nullptr, nullptr, 0 });
+		}
+
+		void TextureStreamingBackendD3D12::Evict(TextureId texture, std::uint32_t mip)
+		{
+			// The memory stays committed, the clamp only stops shaders from reading the evicted mip //
+
+			ReplaceSrv(m_Textures[texture], mip + 1);
+		}
+
+		void TextureStreamingBackendD3D12::RecordUploads(ID3D12GraphicsCommandList* commandList, std::uint64_t fenceValue)
+		{
+			// Frames recorded up to this one may have bound what was replaced or removed since the last call //
+
+			for (Core::BindlessHandle view : m_ReplacedViews)
+			{
+				m_Bindless.Free(view, fenceValue);
+			}
+			m_ReplacedViews.clear();
+
+			for (ComPtr<ID3D12Resource>& resource : m_RemovedResources)
+			{
+				m_Retired.Push(std::move(resource), fenceValue);
+			}
+			m_RemovedResources.clear();
+
+			if (m_Queued.empty())
+			{
+				return;
+			}
+
+			std::vector<CD3DX12_RESOURCE_BARRIER> barriers;
+			barriers.reserve(m_Queued.size());
+			std::uint64_t uploadBytes = 0;
+
+			for (Upload& upload : m_Queued)
+			{
+				const StreamedTexture& texture = m_Textures[upload.Texture];
+				const std::shared_ptr<const Core::SubresourceFootprints> footprints = Core::GetCopyableFootprints(texture.Resource->GetDesc(), upload.Mip, 1);
+				ThrowIfFailed(footprints ? S_OK : E_INVALIDARG);
+				const Core::PlacedFootprint& layout = footprints->Layouts[0];
+				const UINT numRows = footprints->NumRows[0];
+				const UINT64 rowSize = footprints->RowSizes[0];
+				const UINT64 totalBytes = footprints->TotalBytes;
+				uploadBytes += totalBytes;
+
+				CD3DX12_HEAP_PROPERTIES heapProperties(D3D12_HEAP_TYPE_UPLOAD);
+				CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(totalBytes);
+
+				ThrowIfFailed(m_Device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+					D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&upload.UploadBuffer)));
+
+				void* mapped = nullptr;
+				CD3DX12_RANGE readRange(0, 0);
+				ThrowIfFailed(upload.UploadBuffer->Map(0, &readRange, &mapped));
+
+				const D3D12_SUBRESOURCE_DATA& mipData = texture.MipData[upload.Mip];
+				const std::uint64_t rowPitch = layout.RowPitch;
+				Core::CopySubresource({ static_cast<BYTE*>(mapped) + layout.Offset, rowPitch, rowPitch * numRows },
+					{ mipData.pData, static_cast<std::uint64_t>(mipData.RowPitch), static_cast<std::uint64_t>(mipData.SlicePitch) },
+					rowSize, numRows, layout.Depth);
+
+				upload.UploadBuffer->Unmap(0, nullptr);
+				upload.Destination = texture.Resource;
+				upload.FenceValue = fenceValue;
+
+				if (texture.Residency != Core::g_InvalidResidencyHandle)
+				{
+					m_Residency->MarkUsed(texture.Residency, fenceValue);
+				}
+
+				barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(texture.Resource.Get(),
+					D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_COPY_DEST, upload.Mip));
+			}
+
+			commandList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+			Core::CommandCaptureD3D12::Barriers(commandList, static_cast<UINT>(barriers.size()), barriers.data());
+
+			for (Upload& upload : m_Queued)
+			{
+				const D3D12_PLACED_SUBRESOURCE_FOOTPRINT layout = Core::ToD3D12(Core::GetCopyableFootprints(upload.Destination->GetDesc(), upload.Mip, 1)->Layouts[0]);
+
+				CD3DX12_TEXTURE_COPY_LOCATION destination(upload.Destination.Get(), upload.Mip);
+				CD3DX12_TEXTURE_COPY_LOCATION source(upload.UploadBuffer.Get(), layout);
+				commandList->CopyTextureRegion(&destination, 0, 0, 0, &source, nullptr);
+				Core::CommandCaptureD3D12::CopyTexture(commandList, destination, source);
+			}
+
+			for (CD3DX12_RESOURCE_BARRIER& barrier : barriers)
+			{
+				std::swap(barrier.Transition.StateBefore, barrier.Transition.StateAfter);
+			}
+			commandList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+			Core::CommandCaptureD3D12::Barriers(commandList, static_cast<UINT>(barriers.size()), barriers.data());
+
+			Core::RenderStats::Count(Core::RenderCounter::Barriers, barriers.size() * 2);
+			Core::RenderStats::Count(Core::RenderCounter::UploadBytes, uploadBytes);
+
+			m_InFlight.insert(m_InFlight.end(), m_Queued.begin(), m_Queued.end());
+			m_Queued.clear();
+		}
+
+		void TextureStreamingBackendD3D12::Retire(std::uint64_t completedFenceValue, TextureStreamer& streamer, double timeSeconds)
+		{
+			auto it = std::remove_if(m_InFlight.begin(), m_InFlight.end(), [&](const Upload& upload)
+			{
+				if (upload.FenceValue > completedFenceValue)
+				{
+					return false;
+				}
+
+				// Removed textures still report so the streamer can free the slot //
+
+				StreamedTexture& texture = m_Textures[upload.Texture];
+				if (texture.Resource == upload.Destination)
+				{
+					ReplaceSrv(texture, upload.Mip);
+				}
+
+				streamer.OnMipResident(upload.Texture, upload.Mip, timeSeconds);
+				return true;
+			});
+
+			m_InFlight.erase(it, m_InFlight.end());
+			m_Retired.Retire(completedFenceValue);
+		}
+
+		void TextureStreamingBackendD3D12::ReplaceSrv(StreamedTexture& texture, std::uint32_t mostDetailedMip)
+		{
+			const D3D12_RESOURCE_DESC desc = texture.Resource->GetDesc();
+
+			D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+			srvDesc.Format = desc.Format;
+			srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+			srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+			srvDesc.Texture2D.MostDetailedMip = 0;
+			srvDesc.Texture2D.MipLevels = desc.MipLevels;
+			srvDesc.Texture2D.ResourceMinLODClamp = static_cast<FLOAT>(mostDetailedMip);
+
+			if (!texture.Srv.IsNull())
+			{
+				m_ReplacedViews.push_back(texture.Srv);
+			}
+			texture.Srv = m_Bindless.CreateShaderResourceView(texture.Resource.Get(), &srvDesc);
+		}
+	}
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "Header.h"
+#include "HelperFile.h"
+#include "TextureStreamer.h"
+#include "BindlessHeapD3D12.h"
+#include "ResidencyManagerD3D12.h"
+#include "DeferredRelease.h"
+
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Assets {
+
+		// D3D12 backend of the texture streamer //
+		/*
+		   Textures are committed with their full mip chain; residency is expressed through
+		   the SRV ResourceMinLODClamp so shaders never sample a mip that is not uploaded yet.
+		   Frames in flight may still read a texture's view, so a new clamp never rewrites
+		   it: the texture gets a new bindless view and the old one, like the resource of a
+		   removed texture, is freed with the fence value of the next RecordUploads().
+		   Uploads use the layouts from D3DX12GetCopyableFootprints and are recorded on the
+		   command list handed to RecordUploads().
+		*/
+
+		class TextureStreamingBackendD3D12 : public ITextureStreamingBackend
+		{
+		public:
+
+			TextureStreamingBackendD3D12(ComPtr<ID3D12Device2> device, Core::BindlessHeapD3D12& bindless);
+
+			// Textures added from now on are tracked, their uploads mark them used //
+
+			void SetResidency(Core::ResidencyManagerD3D12* residency) { m_Residency = residency; }
+
+			// Bytes of every mip of a texture, as laid out for a copy //
+
+			static void ComputeMipSizes(const D3D12_RESOURCE_DESC& desc, std::vector<std::uint64_t>& mipSizes);
+
+			// mipData points to MipCount subresources in CPU memory, it must stay valid while the texture is registered //
+
+			void AddTexture(TextureId texture, ComPtr<ID3D12Resource> resource, const D3D12_SUBRESOURCE_DATA* mipData, std::uint32_t residentMip);
+
+			// Queued uploads are cancelled with the streamer, those already recorded still report through Retire() //
+
+			void RemoveTexture(TextureId texture, TextureStreamer& streamer);
+
+			void BeginUpload(TextureId texture, std::uint32_t mip) override;
+			void Evict(TextureId texture, std::uint32_t mip) override;
+
+			// Record the queued copies, fenceValue is the value signaled after this list executes. //
+			// Called once per frame, even with nothing queued, it also dates the views replaced since the last call. //
+
+			void RecordUploads(ID3D12GraphicsCommandList* commandList, std::uint64_t fenceValue);
+
+			// Report every upload whose fence has completed and drop the resources of retired frames //
+
+			void Retire(std::uint64_t completedFenceValue, TextureStreamer& streamer, double timeSeconds);
+
+			// Getters //
+
+			// Changes whenever the resident mips do, read it when binding the texture //
+
+			Core::BindlessHandle Srv(TextureId texture) const { return m_Textures[texture].Srv; }
+
+			// Frames drawing the texture mark it used, see EngineCore::MarkResident() //
+
+			Core::ResidencyHandle Residency(TextureId texture) const { return m_Textures[texture].Residency; }
+
+		private:
+
+			struct StreamedTexture
+			{
+				ComPtr<ID3D12Resource> Resource;
+				const D3D12_SUBRESOURCE_DATA* MipData = nullptr;
+				Core::BindlessHandle Srv;
+				Core::ResidencyHandle Residency = Core::g_InvalidResidencyHandle;
+			};
+
+			struct Upload
+			{
+				TextureId Texture;
+				std::uint32_t Mip;
+				ComPtr<ID3D12Resource> UploadBuffer;
+				ComPtr<ID3D12Resource> Destination;
+				std::uint64_t FenceValue;
+			};
+
+			void ReplaceSrv(StreamedTexture& texture, std::uint32_t mostDetailedMip);
+			void RetireTexture(StreamedTexture& texture);
+
+		private:
+
+			ComPtr<ID3D12Device2> m_Device;
+			Core::BindlessHeapD3D12& m_Bindless;
+			Core::ResidencyManagerD3D12* m_Residency = nullptr;
+			Core::TaggedVector<StreamedTexture, Core::MemoryTag::Streaming> m_Textures;
+			Core::TaggedVector<Upload, Core::MemoryTag::Streaming> m_Queued;
+			Core::TaggedVector<Upload, Core::MemoryTag::Streaming> m_InFlight;
+
+			// Views and resources frames in flight may still read, waiting for the next fence value //
+
+			std::vector<Core::BindlessHandle> m_ReplacedViews;
+			std::vector<ComPtr<ID3D12Resource>> m_RemovedResources;
+			Core::DeferredReleaseQueue<ComPtr<ID3D12Resource>> m_Retired;
+		};
+	}
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// N counters per thread, summed over every thread on demand //
+		/*
+		   Add() writes counters owned by the calling thread with plain relaxed stores, so
+		   counting never contends; Sum() adds up the threads under the lock. Counters of
+		   exited threads are folded into a retired total, which also takes counts made
+		   after a thread's thread_local storage is gone. A thread registers with the first
+		   registry of its type it counts into, Owner keeps the types apart: one registry
+		   per Owner, held by a singleton that is never destroyed.
+		*/
+
+		template<std::uint32_t N, typename Owner>
+		class ThreadCounterRegistry
+		{
+		public:
+
+			void Add(std::uint32_t counter, std::uint64_t amount)
+			{
+				if (Counters* counters = ThreadCounters())
+				{
+					Accumulate(counters->Values[counter], amount);
+					return;
+				}
+
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				Accumulate(m_Retired.Values[counter], amount);
+			}
+
+			// Totals since start of every counter, live and exited threads //
+
+			void Sum(std::uint64_t (&totals)[N]) const
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+
+				for (std::uint32_t counter = 0; counter < N; ++counter)
+				{
+					totals[counter] = Load(m_Retired.Values[counter]);
+					for (const Counters* counters : m_Threads)
+					{
+						totals[counter] += Load(counters->Values[counter]);
+					}
+				}
+			}
+
+		private:
+
+			struct Counters
+			{
+				std::atomic<std::uint64_t> Values[N] = {};
+			};
+
+			static std::uint64_t Load(const std::atomic<std::uint64_t>& value)
+			{
+				return value.load(std::memory_order_relaxed);
+			}
+
+			// Only the owning thread writes its counters, no read-modify-write needed //
+
+			static void Accumulate(std::atomic<std::uint64_t>& value, std::uint64_t amount)
+			{
+				value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+			}
+
+			// The calling thread's counters, null once its thread_local storage is gone //
+
+			Counters* ThreadCounters()
+			{
+				struct Registration
+				{
+					ThreadCounterRegistry* Registry;
+					Counters Values;
+
+					explicit Registration(ThreadCounterRegistry* registry) : Registry(registry) { Registry->Register(&Values); }
+					~Registration()
+					{
+						Registry->Retire(&Values);
+						t_CountersDestroyed = true;
+					}
+				};
+
+				if (t_CountersDestroyed)
+				{
+					return nullptr;
+				}
+
+				thread_local Registration registration(this);
+				return &registration.Values;
+			}
+
+			void Register(Counters* counters)
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Threads.push_back(counters);
+			}
+
+			void Retire(Counters* counters)
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+
+				for (std::uint32_t counter = 0; counter < N; ++counter)
+				{
+					Accumulate(m_Retired.Values[counter], Load(counters->Values[counter]));
+				}
+
+				m_Threads.erase(std::find(m_Threads.begin(), m_Threads.end(), counters));
+			}
+
+		private:
+
+			// Trivially destructible, so it can still be read after the thread_local counters are gone //
+
+			static inline thread_local bool t_CountersDestroyed = false;
+
+			std::vector<Counters*> m_Threads;
+			Counters m_Retired;
+			mutable std::mutex m_Mutex;
+		};
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// Unique across the process and never 0, an allocator takes a new one every frame //
+
+		inline std::uint64_t NextThreadEpoch()
+		{
+			static std::atomic<std::uint64_t> nextEpoch{ 1 };
+			return nextEpoch.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		// Per thread entries tagged with the epoch they were filled in, Entry has an Epoch member //
+		/*
+		   A few entries so that a thread feeding several allocators keeps one in each;
+		   epochs are unique, so a matching epoch means the same allocator and frame. A miss
+		   hands back the entry with the oldest epoch, its Epoch cleared for the caller to
+		   refill. Each Entry type has its own entries.
+		*/
+
+		template<typename Entry, std::uint32_t Count = 4>
+		Entry& FindThreadEntry(std::uint64_t epoch)
+		{
+			thread_local Entry t_Entries[Count];
+
+			Entry* oldest = &t_Entries[0];
+			for (Entry& entry : t_Entries)
+			{
+				if (entry.Epoch == epoch)
+				{
+					return entry;
+				}
+				if (entry.Epoch < oldest->Epoch)
+				{
+					oldest = &entry;
+				}
+			}
+
+			oldest->Epoch = 0;
+			return *oldest;
+		}
+	}
+}
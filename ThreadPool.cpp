@@ -0,0 +1,177 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace PowerEngine
+{
+	namespace Core
+	{
+		ThreadPool::ThreadPool(std::uint32_t threadCount)
+		{
+			if (threadCount == 0)
+			{
+				threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+			}
+
+			m_Threads.reserve(threadCount);
+			for (std::uint32_t i = 0; i < threadCount; ++i)
+			{
+				m_Threads.emplace_back(&ThreadPool::WorkerLoop, this);
+			}
+		}
+
+		ThreadPool::~ThreadPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Stop = true;
+			}
+			m_JobAvailable.notify_all();
+
+			for (std::thread& thread : m_Threads)
+			{
+				thread.join();
+			}
+		}
+
+		void ThreadPool::Submit(std::function<void()> job)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Jobs.push_back(std::move(job));
+			}
+			m_JobAvailable.notify_one();
+		}
+
+		void ThreadPool::ParallelFor(std::uint32_t count, std::uint32_t grain, const std::function<void(std::uint32_t begin, std::uint32_t end)>& function)
+		{
+			if (count == 0)
+			{
+				return;
+			}
+
+			grain = std::max(grain, 1u);
+			const std::uint32_t chunkCount = (count + grain - 1) / grain;
+
+			if (chunkCount == 1 || m_Threads.empty())
+			{
+				function(0, count);
+				return;
+			}
+
+			struct Shared
+			{
+				std::atomic<std::uint32_t> NextChunk{ 0 };
+				std::atomic<std::uint32_t> RunningHelpers{ 0 };
+			};
+			Shared shared;
+
+			auto work = [&]()
+			{
+				for (std::uint32_t chunk = shared.NextChunk++; chunk < chunkCount; chunk = shared.NextChunk++)
+				{
+					std::uint32_t begin = chunk * grain;
+					function(begin, std::min(begin + grain, count));
+				}
+			};
+
+			const std::uint32_t helpers = std::min(chunkCount - 1, ThreadCount());
+			shared.RunningHelpers = helpers;
+
+			for (std::uint32_t i = 0; i < helpers; ++i)
+			{
+				Submit([&]()
+				{
+					work();
+					shared.RunningHelpers--;
+				});
+			}
+
+			work();
+
+			// Helpers may still be queued behind other jobs; run those jobs here instead of blocking, //
+			// so nested ParallelFor calls from a worker cannot deadlock the pool. //
+
+			while (shared.RunningHelpers.load() != 0)
+			{
+				if (!RunPendingJob())
+				{
+					std::this_thread::yield();
+				}
+			}
+		}
+
+		bool ThreadPool::RunPendingJob()
+		{
+			std::function<void()> job;
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				if (m_Jobs.empty())
+				{
+					return false;
+				}
+
+				job = std::move(m_Jobs.front());
+				m_Jobs.pop_front();
+				m_ActiveJobs++;
+			}
+
+			job();
+
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_ActiveJobs--;
+				if (m_Jobs.empty() && m_ActiveJobs == 0)
+				{
+					m_Idle.notify_all();
+				}
+			}
+
+			return true;
+		}
+
+		void ThreadPool::WaitIdle()
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Idle.wait(lock, [this]() { return m_Jobs.empty() && m_ActiveJobs == 0; });
+		}
+
+		ThreadPool& ThreadPool::Global()
+		{
+			static ThreadPool pool;
+			return pool;
+		}
+
+		void ThreadPool::WorkerLoop()
+		{
+			for (;;)
+			{
+				std::function<void()> job;
+				{
+					std::unique_lock<std::mutex> lock(m_Mutex);
+					m_JobAvailable.wait(lock, [this]() { return m_Stop || !m_Jobs.empty(); });
+
+					if (m_Stop && m_Jobs.empty())
+					{
+						return;
+					}
+
+					job = std::move(m_Jobs.front());
+					m_Jobs.pop_front();
+					m_ActiveJobs++;
+				}
+
+				job();
+
+				{
+					std::lock_guard<std::mutex> lock(m_Mutex);
+					m_ActiveJobs--;
+					if (m_Jobs.empty() && m_ActiveJobs == 0)
+					{
+						m_Idle.notify_all();
+					}
+				}
+			}
+		}
+	}
+}
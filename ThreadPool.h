@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace PowerEngine {
+
+	namespace Core {
+
+		// Fixed set of worker threads shared by the engine subsystems //
+
+		class ThreadPool
+		{
+		public:
+
+			// threadCount == 0 uses one worker per hardware thread, minus the caller //
+
+			explicit ThreadPool(std::uint32_t threadCount = 0);
+			~ThreadPool();
+
+			ThreadPool(const ThreadPool&) = delete;
+			ThreadPool& operator=(const ThreadPool&) = delete;
+
+			void Submit(std::function<void()> job);
+
+			// Splits [0, count) in chunks of at least grain items and runs them on the workers. //
+			// The calling thread takes part in the work and returns once every chunk is done. //
+
+			void ParallelFor(std::uint32_t count, std::uint32_t grain, const std::function<void(std::uint32_t begin, std::uint32_t end)>& function);
+
+			// Runs one queued job on the calling thread, returns false if the queue was empty //
+
+			bool RunPendingJob();
+			void WaitIdle();
+
+			std::uint32_t ThreadCount() const { return static_cast<std::uint32_t>(m_Threads.size()); }
+
+			static ThreadPool& Global();
+
+		private:
+
+			void WorkerLoop();
+
+		private:
+
+			std::vector<std::thread> m_Threads;
+			std::deque<std::function<void()>> m_Jobs;
+			std::mutex m_Mutex;
+			std::condition_variable m_JobAvailable;
+			std::condition_variable m_Idle;
+			std::uint32_t m_ActiveJobs = 0;
+			bool m_Stop = false;
+		};
+	}
+}
@@ -0,0 +1,331 @@
+// Loads a synthetic asset set headless through the whole AssetLoader pipeline //
+/*
+   AssetLoadBench <directory> [--size <MB>] [--file-size <MB>] [--compressed <percent>] [--batch <count>]
+                  [--max-buffered <MB>] [--no-write] [--keep]
+
+   Writes --size MB of assets (10240 by default) as asset_<n>.bin files of --file-size
+   MB (64 by default) into the directory, --compressed percent of them (50 by
+   default) as LZ4 blocks of about 40 percent of their size. Then loads every file
+   through AssetLoader with a CPU stand-in uploader copying into a 64 MB buffer, the
+   I/O thread reading --batch requests at once (32 by default) under a --max-buffered
+   MB cap (256 by default). Prints the wall time, MB/s read from disk and uploaded,
+   the busy MB/s of each stage and the peak buffered bytes; fails when a request
+   fails or the cap was exceeded by more than one file. --no-write loads the files of
+   an earlier run with --keep, e.g. after dropping the page cache for cold reads.
+
+   Build with AssetLoader.cpp, ThreadPool.cpp, MemoryTracker.cpp and TextureCompressor.cpp,
+   plus -luring where liburing is installed, runs on any platform.
+*/
+
+#include "../AssetLoader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace PowerEngine;
+using namespace PowerEngine::Assets;
+
+namespace
+{
+	constexpr std::uint64_t g_LiteralRun = 64;		// literals per LZ4 sequence, followed by a match
+	constexpr std::uint64_t g_MatchRun = 128;
+
+	// Stands in for the copy queue, every copy lands at once //
+
+	class MemoryUploader : public IAssetUploader
+	{
+	public:
+
+		MemoryUploader()
+			: m_Memory(64ull * 1024 * 1024)
+		{
+		}
+
+		std::uint64_t Upload(const AssetRequestDesc&, const void* data, std::uint64_t size) override
+		{
+			const std::uint8_t* source = static_cast<const std::uint8_t*>(data);
+
+			while (size > 0)
+			{
+				const std::uint64_t chunk = std::min<std::uint64_t>(size, m_Memory.size() - m_Offset);
+				std::memcpy(m_Memory.data() + m_Offset, source, static_cast<size_t>(chunk));
+
+				m_Offset = (m_Offset + chunk) % m_Memory.size();
+				source += chunk;
+				size -= chunk;
+			}
+
+			return m_Recorded + 1;
+		}
+
+		void Submit() override
+		{
+			m_Recorded++;
+			m_Completed = m_Recorded;
+		}
+
+		std::uint64_t CompletedValue() override
+		{
+			return m_Completed;
+		}
+
+	private:
+
+		std::vector<std::uint8_t> m_Memory;
+		std::uint64_t m_Offset = 0;
+		std::uint64_t m_Recorded = 0;
+		std::atomic<std::uint64_t> m_Completed{ 0 };
+	};
+
+	struct AssetFile
+	{
+		std::string Path;
+		std::uint64_t UncompressedSize = 0;		// 0 when stored uncompressed
+	};
+
+	std::string AssetPath(const std::string& directory, std::uint32_t index)
+	{
+		char name[32];
+		std::snprintf(name, sizeof(name), "/asset_%04u.bin", index);
+		return directory + name;
+	}
+
+	void WriteLength(std::vector<std::uint8_t>& output, std::uint64_t length)
+	{
+		for (length -= 15; length >= 255; length -= 255)
+		{
+			output.push_back(255);
+		}
+		output.push_back(static_cast<std::uint8_t>(length));
+	}
+
+	// A valid LZ4 block of literal runs each repeated by a match, the last sequence literals only //
+
+	std::vector<std::uint8_t> SyntheticLz4(std::uint64_t uncompressedSize, std::uint32_t seed)
+	{
+		std::vector<std::uint8_t> output;
+		output.reserve(static_cast<size_t>(uncompressedSize / 2));
+
+		std::uint32_t state = seed * 2654435761u + 1;
+		auto literals = [&](std::uint64_t count)
+		{
+			for (std::uint64_t i = 0; i < count; ++i)
+			{
+				state = state * 1664525u + 1013904223u;
+				output.push_back(static_cast<std::uint8_t>(state >> 24));
+			}
+		};
+
+		const std::uint64_t sequence = g_LiteralRun + g_MatchRun;
+		std::uint64_t produced = 0;
+
+		while (produced + sequence + g_LiteralRun <= uncompressedSize)
+		{
+			output.push_back(static_cast<std::uint8_t>((15 << 4) | 15));
+			WriteLength(output, g_LiteralRun);
+			literals(g_LiteralRun);
+
+			output.push_back(static_cast<std::uint8_t>(g_LiteralRun & 0xFF));
+			output.push_back(static_cast<std::uint8_t>(g_LiteralRun >> 8));
+			WriteLength(output, g_MatchRun - 4);
+
+			produced += sequence;
+		}
+
+		const std::uint64_t last = uncompressedSize - produced;
+		output.push_back(static_cast<std::uint8_t>((last >= 15 ? 15 : last) << 4));
+		if (last >= 15)
+		{
+			WriteLength(output, last);
+		}
+		literals(last);
+
+		return output;
+	}
+
+	bool WriteAssets(const std::string& directory, std::uint32_t fileCount, std::uint64_t fileSize, std::uint32_t compressedPercent,
+		std::vector<AssetFile>& files)
+	{
+		std::vector<std::uint8_t> raw(static_cast<size_t>(fileSize));
+		for (size_t i = 0; i < raw.size(); ++i)
+		{
+			raw[i] = static_cast<std::uint8_t>(i * 31 + (i >> 12));
+		}
+
+		for (std::uint32_t i = 0; i < fileCount; ++i)
+		{
+			AssetFile file;
+			file.Path = AssetPath(directory, i);
+
+			std::ofstream stream(file.Path, std::ios::binary | std::ios::trunc);
+			if (i % 100 < compressedPercent)
+			{
+				file.UncompressedSize = fileSize;
+				const std::vector<std::uint8_t> block = SyntheticLz4(fileSize, i);
+				stream.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(block.size()));
+			}
+			else
+			{
+				stream.write(reinterpret_cast<const char*>(raw.data()), static_cast<std::streamsize>(raw.size()));
+			}
+
+			if (!stream)
+			{
+				return false;
+			}
+
+			files.push_back(file);
+		}
+
+		return true;
+	}
+
+	double ToMegabytes(std::uint64_t bytes)
+	{
+		return static_cast<double>(bytes) / (1024.0 * 1024.0);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const char* directory = nullptr;
+	std::uint64_t sizeMegabytes = 10240;
+	std::uint64_t fileMegabytes = 64;
+	std::uint32_t compressedPercent = 50;
+	std::uint32_t batchSize = 32;
+	std::uint64_t maxBufferedMegabytes = 256;
+	bool write = true;
+	bool keep = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+		{
+			sizeMegabytes = std::max(1ull, std::strtoull(argv[++i], nullptr, 10));
+		}
+		else if (std::strcmp(argv[i], "--file-size") == 0 && i + 1 < argc)
+		{
+			fileMegabytes = std::max(1ull, std::strtoull(argv[++i], nullptr, 10));
+		}
+		else if (std::strcmp(argv[i], "--compressed") == 0 && i + 1 < argc)
+		{
+			compressedPercent = static_cast<std::uint32_t>(std::min(100l, std::max(0l, std::strtol(argv[++i], nullptr, 10))));
+		}
+		else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc)
+		{
+			batchSize = static_cast<std::uint32_t>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--max-buffered") == 0 && i + 1 < argc)
+		{
+			maxBufferedMegabytes = std::max(1ull, std::strtoull(argv[++i], nullptr, 10));
+		}
+		else if (std::strcmp(argv[i], "--no-write") == 0)
+		{
+			write = false;
+		}
+		else if (std::strcmp(argv[i], "--keep") == 0)
+		{
+			keep = true;
+		}
+		else
+		{
+			directory = argv[i];
+		}
+	}
+
+	if (!directory)
+	{
+		std::fprintf(stderr, "AssetLoadBench <directory> [--size <MB>] [--file-size <MB>] [--compressed <percent>] [--batch <count>] "
+			"[--max-buffered <MB>] [--no-write] [--keep]\n");
+		return 2;
+	}
+
+	const std::uint64_t fileSize = fileMegabytes << 20;
+	const std::uint32_t fileCount = static_cast<std::uint32_t>(std::max<std::uint64_t>(sizeMegabytes / fileMegabytes, 1));
+
+	// Without writing, the compressed files are found from the same pattern as when they were written //
+
+	std::vector<AssetFile> files;
+	if (write)
+	{
+		if (!WriteAssets(directory, fileCount, fileSize, compressedPercent, files))
+		{
+			std::fprintf(stderr, "Can't write assets to %s.\n", directory);
+			return 2;
+		}
+	}
+	else
+	{
+		for (std::uint32_t i = 0; i < fileCount; ++i)
+		{
+			files.push_back({ AssetPath(directory, i), i % 100 < compressedPercent ? fileSize : 0 });
+		}
+	}
+
+	MemoryUploader uploader;
+	std::atomic<std::uint32_t> finished{ 0 };
+	std::atomic<std::uint32_t> failed{ 0 };
+	AssetLoaderStats stats;
+
+	const auto start = std::chrono::steady_clock::now();
+	{
+		AssetLoader loader(uploader, Core::ThreadPool::Global(), batchSize, maxBufferedMegabytes << 20);
+
+		for (const AssetFile& file : files)
+		{
+			AssetRequestDesc request;
+			request.Path = file.Path;
+			request.Compression = file.UncompressedSize ? AssetCompression::Lz4 : AssetCompression::None;
+			request.UncompressedSize = file.UncompressedSize;
+			request.OnComplete = [&](AssetRequestId, AssetStatus status)
+			{
+				failed += status == AssetStatus::Completed ? 0 : 1;
+				finished++;
+			};
+			loader.Load(std::move(request));
+		}
+
+		// The frame loop of a headless run, completions are delivered once per frame //
+
+		while (finished.load() < files.size())
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			loader.Update();
+		}
+
+		stats = loader.Stats();
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	if (!keep)
+	{
+		for (const AssetFile& file : files)
+		{
+			std::remove(file.Path.c_str());
+		}
+	}
+
+	std::printf("%zu files in %.2f s: read %.0f MB at %.0f MB/s, uploaded %.0f MB at %.0f MB/s\n", files.size(), seconds,
+		ToMegabytes(stats.Read.Bytes), ToMegabytes(stats.Read.Bytes) / seconds, ToMegabytes(stats.Upload.Bytes), ToMegabytes(stats.Upload.Bytes) / seconds);
+	std::printf("Stages busy: read %.0f MB/s, decompress %.0f MB/s, upload %.0f MB/s\n",
+		stats.Read.MegabytesPerSecond(), stats.Decompress.MegabytesPerSecond(), stats.Upload.MegabytesPerSecond());
+	std::printf("Peak buffered %.0f MB of %llu MB, %llu completed, %u failed\n", ToMegabytes(stats.PeakBufferedBytes),
+		static_cast<unsigned long long>(maxBufferedMegabytes), static_cast<unsigned long long>(stats.Completed), failed.load());
+
+	// A single file may go over the cap, alone //
+
+	const std::uint64_t largestRequest = fileSize * (compressedPercent > 0 ? 2 : 1);
+	if (failed.load() != 0 || stats.PeakBufferedBytes > std::max(maxBufferedMegabytes << 20, largestRequest))
+	{
+		return 1;
+	}
+
+	return 0;
+}
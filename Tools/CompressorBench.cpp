@@ -0,0 +1,320 @@
+// Measures block compression throughput and quality of every format //
+/*
+   CompressorBench [--size <pixels>] [--repeat <count>] [--threads <count>] [--min-psnr <dB>]
+
+   Compresses a synthetic --size x --size RGBA8 image (2048 by default: gradients,
+   hard edges and noise, alpha varying) to BC1, BC3, BC4, BC5 and BC7 at both
+   qualities, block by block on one thread and with CompressTexture across a pool
+   of --threads workers (one per hardware thread by default), each --repeat times
+   (3 by default) keeping the fastest. Prints megapixels/s of both and the PSNR of
+   the channels each format stores, decoded here from the blocks of the endpoint
+   formats (BC7 is timed only). With --min-psnr, fails when a BC1/BC3/BC4/BC5
+   result falls below that many dB.
+
+   Build with TextureCompressor.cpp and ThreadPool.cpp, runs on any platform.
+*/
+
+#include "../TextureCompressor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace PowerEngine;
+using namespace PowerEngine::Assets;
+
+namespace
+{
+	struct FormatCase
+	{
+		const char* Name;
+		BlockFormat Format;
+		std::uint32_t Channels;		// leading RGBA channels the format stores, 0 when not decoded here
+	};
+
+	std::vector<std::uint8_t> SyntheticImage(std::uint32_t size)
+	{
+		std::vector<std::uint8_t> pixels(std::size_t(size) * size * 4);
+
+		std::uint32_t state = 1;
+		for (std::uint32_t y = 0; y < size; ++y)
+		{
+			for (std::uint32_t x = 0; x < size; ++x)
+			{
+				state = state * 1664525u + 1013904223u;
+				const std::uint32_t noise = (state >> 24) & 15;
+				const bool edge = ((x / 64) + (y / 64)) % 2 == 0;
+
+				std::uint8_t* pixel = &pixels[(std::size_t(y) * size + x) * 4];
+				pixel[0] = static_cast<std::uint8_t>(std::min<std::uint32_t>(x * 255 / size + noise, 255));
+				pixel[1] = static_cast<std::uint8_t>(std::min<std::uint32_t>(y * 255 / size + noise, 255));
+				pixel[2] = static_cast<std::uint8_t>(edge ? 200 + noise : 40 + noise);
+				pixel[3] = static_cast<std::uint8_t>((x + y) * 255 / (2 * size));
+			}
+		}
+
+		return pixels;
+	}
+
+	// Reference decoders of the endpoint formats, enough to score the encoder //
+
+	void DecodeColor(const std::uint8_t* block, bool forceFourColors, float colors[16][3])
+	{
+		const std::uint16_t c0 = static_cast<std::uint16_t>(block[0] | (block[1] << 8));
+		const std::uint16_t c1 = static_cast<std::uint16_t>(block[2] | (block[3] << 8));
+
+		float palette[4][3];
+		for (std::uint32_t i = 0; i < 2; ++i)
+		{
+			const std::uint16_t c = i == 0 ? c0 : c1;
+			palette[i][0] = static_cast<float>(((c >> 11) & 31) * 255 / 31);
+			palette[i][1] = static_cast<float>(((c >> 5) & 63) * 255 / 63);
+			palette[i][2] = static_cast<float>((c & 31) * 255 / 31);
+		}
+
+		const bool fourColors = forceFourColors || c0 > c1;
+		for (std::uint32_t c = 0; c < 3; ++c)
+		{
+			palette[2][c] = fourColors ? (2.0f * palette[0][c] + palette[1][c]) / 3.0f : (palette[0][c] + palette[1][c]) / 2.0f;
+			palette[3][c] = fourColors ? (palette[0][c] + 2.0f * palette[1][c]) / 3.0f : 0.0f;
+		}
+
+		const std::uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | (std::uint32_t(block[7]) << 24);
+		for (std::uint32_t i = 0; i < 16; ++i)
+		{
+			std::memcpy(colors[i], palette[(indices >> (2 * i)) & 3], sizeof(colors[i]));
+		}
+	}
+
+	void DecodeChannel(const std::uint8_t* block, float values[16])
+	{
+		const float a0 = block[0];
+		const float a1 = block[1];
+
+		float palette[8] = { a0, a1 };
+		for (std::uint32_t i = 1; i < 7; ++i)
+		{
+			if (a0 > a1)
+			{
+				palette[i + 1] = ((7 - i) * a0 + i * a1) / 7.0f;
+			}
+			else if (i < 5)
+			{
+				palette[i + 1] = ((5 - i) * a0 + i * a1) / 5.0f;
+			}
+		}
+		if (a0 <= a1)
+		{
+			palette[6] = 0.0f;
+			palette[7] = 255.0f;
+		}
+
+		std::uint64_t indices = 0;
+		for (std::uint32_t i = 0; i < 6; ++i)
+		{
+			indices |= std::uint64_t(block[2 + i]) << (8 * i);
+		}
+
+		for (std::uint32_t i = 0; i < 16; ++i)
+		{
+			values[i] = palette[(indices >> (3 * i)) & 7];
+		}
+	}
+
+	// Decodes every block and returns the PSNR over the stored channels //
+
+	double MeasurePsnr(const std::vector<std::uint8_t>& pixels, std::uint32_t size, const std::vector<std::uint8_t>& blocks, BlockFormat format, std::uint32_t channels)
+	{
+		const std::uint32_t blocksPerRow = BlockCount(size);
+		const std::uint32_t blockBytes = BlockBytes(format);
+		double squaredError = 0.0;
+
+		for (std::uint32_t by = 0; by < BlockCount(size); ++by)
+		{
+			for (std::uint32_t bx = 0; bx < blocksPerRow; ++bx)
+			{
+				const std::uint8_t* block = &blocks[(std::size_t(by) * blocksPerRow + bx) * blockBytes];
+				float decoded[16][4] = {};
+
+				if (format == BlockFormat::BC1 || format == BlockFormat::BC3)
+				{
+					float colors[16][3];
+					DecodeColor(format == BlockFormat::BC3 ? block + 8 : block, format == BlockFormat::BC3, colors);
+					for (std::uint32_t i = 0; i < 16; ++i)
+					{
+						std::memcpy(decoded[i], colors[i], sizeof(colors[i]));
+					}
+				}
+
+				if (format == BlockFormat::BC3 || format == BlockFormat::BC4 || format == BlockFormat::BC5)
+				{
+					// BC3 keeps alpha in its first half, BC4 and BC5 red then green //
+
+					const std::uint32_t first = format == BlockFormat::BC3 ? 3 : 0;
+					const std::uint32_t count = format == BlockFormat::BC5 ? 2 : 1;
+					for (std::uint32_t c = 0; c < count; ++c)
+					{
+						float values[16];
+						DecodeChannel(block + 8 * c, values);
+						for (std::uint32_t i = 0; i < 16; ++i)
+						{
+							decoded[i][first + c] = values[i];
+						}
+					}
+				}
+
+				for (std::uint32_t i = 0; i < 16; ++i)
+				{
+					const std::uint32_t x = bx * 4 + i % 4;
+					const std::uint32_t y = by * 4 + i / 4;
+					if (x >= size || y >= size)
+					{
+						continue;
+					}
+
+					const std::uint8_t* pixel = &pixels[(std::size_t(y) * size + x) * 4];
+					for (std::uint32_t c = 0; c < channels; ++c)
+					{
+						const double difference = static_cast<double>(pixel[c]) - decoded[i][c];
+						squaredError += difference * difference;
+					}
+				}
+			}
+		}
+
+		const double meanSquaredError = squaredError / (double(size) * size * channels);
+		return meanSquaredError > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / meanSquaredError) : 99.0;
+	}
+
+	// The single thread reference, block by block through CompressBlock //
+
+	void CompressSerial(const std::vector<std::uint8_t>& pixels, std::uint32_t size, BlockFormat format, CompressionQuality quality, std::vector<std::uint8_t>& blocks)
+	{
+		const std::uint32_t blocksPerRow = BlockCount(size);
+		const std::uint32_t blockBytes = BlockBytes(format);
+		std::uint8_t block[64];
+
+		for (std::uint32_t by = 0; by < BlockCount(size); ++by)
+		{
+			for (std::uint32_t bx = 0; bx < blocksPerRow; ++bx)
+			{
+				for (std::uint32_t y = 0; y < 4; ++y)
+				{
+					const std::uint32_t sy = std::min(by * 4 + y, size - 1);
+					for (std::uint32_t x = 0; x < 4; ++x)
+					{
+						const std::uint32_t sx = std::min(bx * 4 + x, size - 1);
+						std::memcpy(&block[(y * 4 + x) * 4], &pixels[(std::size_t(sy) * size + sx) * 4], 4);
+					}
+				}
+
+				CompressBlock(block, format, quality, &blocks[(std::size_t(by) * blocksPerRow + bx) * blockBytes]);
+			}
+		}
+	}
+
+	template<typename Function>
+	double FastestSeconds(std::uint32_t repeat, Function&& function)
+	{
+		double best = 0.0;
+		for (std::uint32_t run = 0; run < repeat; ++run)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			function();
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			best = run == 0 ? seconds : std::min(best, seconds);
+		}
+		return best;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::uint32_t size = 2048;
+	std::uint32_t repeat = 3;
+	std::uint32_t threads = 0;
+	double minPsnr = -1.0;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+		{
+			size = static_cast<std::uint32_t>(std::max(4l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+		{
+			repeat = static_cast<std::uint32_t>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+		{
+			threads = static_cast<std::uint32_t>(std::max(0l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--min-psnr") == 0 && i + 1 < argc)
+		{
+			minPsnr = std::strtod(argv[++i], nullptr);
+		}
+		else
+		{
+			std::fprintf(stderr, "CompressorBench [--size <pixels>] [--repeat <count>] [--threads <count>] [--min-psnr <dB>]\n");
+			return 2;
+		}
+	}
+
+	const FormatCase formats[] =
+	{
+		{ "BC1", BlockFormat::BC1, 3 },
+		{ "BC3", BlockFormat::BC3, 4 },
+		{ "BC4", BlockFormat::BC4, 1 },
+		{ "BC5", BlockFormat::BC5, 2 },
+		{ "BC7", BlockFormat::BC7, 0 },
+	};
+
+	Core::ThreadPool pool(threads);
+	const std::vector<std::uint8_t> pixels = SyntheticImage(size);
+	const double megapixels = double(size) * size / 1e6;
+
+	std::printf("%ux%u RGBA8, %s kernel, %u workers\n", size, size, CompressorKernelName(), pool.ThreadCount());
+
+	bool passed = true;
+	for (const FormatCase& format : formats)
+	{
+		for (CompressionQuality quality : { CompressionQuality::Preview, CompressionQuality::High })
+		{
+			std::vector<std::uint8_t> blocks(static_cast<std::size_t>(CompressedSize(format.Format, size, size)));
+
+			const double serialSeconds = FastestSeconds(repeat, [&]()
+			{
+				CompressSerial(pixels, size, format.Format, quality, blocks);
+			});
+
+			const double poolSeconds = FastestSeconds(repeat, [&]()
+			{
+				CompressTexture({ pixels.data(), size, size, size * 4 }, format.Format, quality, blocks.data(), CompressedRowSize(format.Format, size), pool);
+			});
+
+			std::printf("%s %-7s: %8.1f MP/s on one thread, %8.1f MP/s on the pool", format.Name, quality == CompressionQuality::High ? "high" : "preview",
+				megapixels / serialSeconds, megapixels / poolSeconds);
+
+			if (format.Channels > 0)
+			{
+				const double psnr = MeasurePsnr(pixels, size, blocks, format.Format, format.Channels);
+				std::printf(", %.2f dB", psnr);
+				passed = passed && (minPsnr < 0.0 || psnr >= minPsnr);
+			}
+
+			std::printf("\n");
+		}
+	}
+
+	if (!passed)
+	{
+		std::printf("A format scored under %.2f dB\n", minPsnr);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,194 @@
+// Times the draw sort on a large frame and counts the state changes it saves //
+/*
+   DrawSortBench [--draws <count>] [--pipelines <count>] [--materials <count>] [--meshes <count>]
+                 [--repeat <count>] [--threads <count>]
+
+   Submits --draws opaque draws (500000 by default) to a DrawBatcher in scene order,
+   each picking one of --pipelines pipelines (32), --materials materials (512) and
+   --meshes meshes (128) with a random depth, the way a culled scene walk hands them
+   over. Builds the frame unsorted, sorted on one thread and sorted across a pool of
+   --threads workers (one per hardware thread by default), each --repeat times (5 by
+   default) keeping the fastest. Prints the sort and build times, and the
+   SetPipelineState, material and mesh binds of the draws as submitted, sorted and
+   sorted then instanced. Also radix sorts the frame's keys and checks them against
+   std::stable_sort; fails when they differ or sorting doesn't reduce the binds.
+
+   Build with DrawBatcher.cpp, DrawSortKey.cpp, MemoryTracker.cpp and ThreadPool.cpp, runs on any platform.
+*/
+
+#include "../DrawBatcher.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+using namespace PowerEngine::Core;
+
+namespace
+{
+	struct BuildResult
+	{
+		double SortMilliseconds = 0.0;
+		double BuildMilliseconds = 0.0;
+		DrawBatchStats Stats;
+	};
+
+	std::vector<DrawRequest> SceneDraws(std::uint32_t count, std::uint32_t pipelines, std::uint32_t materials, std::uint32_t meshes)
+	{
+		std::vector<DrawRequest> draws(count);
+
+		std::uint32_t state = 7;
+		auto next = [&state]()
+		{
+			state = state * 1664525u + 1013904223u;
+			return state >> 8;
+		};
+
+		for (DrawRequest& draw : draws)
+		{
+			// A material belongs to one pipeline, as a material's shader picks it //
+
+			draw.Material = next() % materials;
+			draw.Pipeline = draw.Material % pipelines;
+			draw.Mesh = next() % meshes;
+			draw.Layer = 0;
+			draw.Depth = static_cast<float>(next() % 100000) * 0.01f;
+			std::memset(&draw.Transform, 0, sizeof(draw.Transform));
+			draw.Transform.Rows[0][0] = draw.Transform.Rows[1][1] = draw.Transform.Rows[2][2] = 1.0f;
+		}
+
+		return draws;
+	}
+
+	BuildResult BuildFrame(DrawBatcher& batcher, const std::vector<DrawRequest>& draws, std::uint32_t repeat, bool sorting, bool instancing, ThreadPool* pool)
+	{
+		batcher.SetSortingEnabled(sorting);
+		batcher.SetInstancingEnabled(instancing);
+
+		BuildResult result;
+		for (std::uint32_t run = 0; run < repeat; ++run)
+		{
+			batcher.Reset();
+			for (const DrawRequest& draw : draws)
+			{
+				batcher.Submit(0, draw);
+			}
+
+			const auto start = std::chrono::steady_clock::now();
+			batcher.Build(pool);
+			const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+			result.BuildMilliseconds = run == 0 ? milliseconds : std::min(result.BuildMilliseconds, milliseconds);
+			result.SortMilliseconds = run == 0 ? batcher.Stats().SortMilliseconds : std::min(result.SortMilliseconds, batcher.Stats().SortMilliseconds);
+			result.Stats = batcher.Stats();
+		}
+
+		return result;
+	}
+
+	void PrintBinds(const char* name, const StateChangeCounts& counts, std::uint32_t draws)
+	{
+		std::printf("%-20s %8u draws: %8u pipelines, %8u materials, %8u meshes, %8u binds\n", name, draws,
+			counts.Pipelines, counts.Materials, counts.Meshes, counts.Total());
+	}
+
+	// RadixSort must order like std::stable_sort on the same keys //
+
+	bool RadixSortMatches(const std::vector<DrawRequest>& draws, ThreadPool* pool)
+	{
+		std::vector<std::uint64_t> keys(draws.size());
+		for (std::size_t i = 0; i < draws.size(); ++i)
+		{
+			keys[i] = EncodeSortKey(SortKeyLayout(), { 0, draws[i].Layer, draws[i].Pipeline, draws[i].Material, draws[i].Depth });
+		}
+
+		std::vector<std::uint32_t> expected(draws.size());
+		std::iota(expected.begin(), expected.end(), 0u);
+		std::stable_sort(expected.begin(), expected.end(), [&keys](std::uint32_t a, std::uint32_t b) { return keys[a] < keys[b]; });
+
+		std::vector<std::uint32_t> values(draws.size());
+		std::iota(values.begin(), values.end(), 0u);
+		RadixSort(keys, values, pool);
+
+		return values == expected && std::is_sorted(keys.begin(), keys.end());
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::uint32_t drawCount = 500000;
+	std::uint32_t pipelines = 32;
+	std::uint32_t materials = 512;
+	std::uint32_t meshes = 128;
+	std::uint32_t repeat = 5;
+	std::uint32_t threads = 0;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--draws") == 0 && i + 1 < argc)
+		{
+			drawCount = static_cast<std::uint32_t>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--pipelines") == 0 && i + 1 < argc)
+		{
+			pipelines = static_cast<std::uint32_t>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--materials") == 0 && i + 1 < argc)
+		{
+			materials = static_cast<std::uint32_t>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--meshes") == 0 && i + 1 < argc)
+		{
+			meshes = static_cast<std::uint32_t>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+		{
+			repeat = static_cast<std::uint32_t>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+		{
+			threads = static_cast<std::uint32_t>(std::max(0l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else
+		{
+			std::fprintf(stderr, "DrawSortBench [--draws <count>] [--pipelines <count>] [--materials <count>] [--meshes <count>] "
+				"[--repeat <count>] [--threads <count>]\n");
+			return 2;
+		}
+	}
+
+	ThreadPool pool(threads);
+	const std::vector<DrawRequest> draws = SceneDraws(drawCount, pipelines, materials, meshes);
+
+	DrawBatcher batcher;
+	const BuildResult unsorted = BuildFrame(batcher, draws, repeat, false, false, &pool);
+	const BuildResult serial = BuildFrame(batcher, draws, repeat, true, false, nullptr);
+	const BuildResult parallel = BuildFrame(batcher, draws, repeat, true, false, &pool);
+	const BuildResult instanced = BuildFrame(batcher, draws, repeat, true, true, &pool);
+
+	std::printf("%u draws, %u pipelines, %u materials, %u meshes, %u workers\n", drawCount, pipelines, materials, meshes, pool.ThreadCount());
+	std::printf("Sort: %.2f ms on one thread, %.2f ms on the pool; build %.2f ms unsorted, %.2f ms sorted, %.2f ms sorted and instanced\n",
+		serial.SortMilliseconds, parallel.SortMilliseconds, unsorted.BuildMilliseconds, parallel.BuildMilliseconds, instanced.BuildMilliseconds);
+
+	PrintBinds("Submitted", unsorted.Stats.StateChangesSubmitted, unsorted.Stats.SubmittedDraws);
+	PrintBinds("Sorted", parallel.Stats.StateChangesEmitted, parallel.Stats.EmittedDraws);
+	PrintBinds("Sorted, instanced", instanced.Stats.StateChangesEmitted, instanced.Stats.EmittedDraws);
+
+	if (!RadixSortMatches(draws, nullptr) || !RadixSortMatches(draws, &pool))
+	{
+		std::printf("RadixSort differs from std::stable_sort\n");
+		return 1;
+	}
+
+	if (parallel.Stats.StateChangesEmitted.Total() >= unsorted.Stats.StateChangesSubmitted.Total())
+	{
+		std::printf("Sorting didn't reduce the binds\n");
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,263 @@
+// Times streaming frames' footprint lookups through FootprintCache against computing them //
+/*
+   FootprintCacheBench [--frames <count>] [--uploads <count>] [--textures <count>] [--capacity <entries>]
+
+   Replays --frames streaming frames (1000 by default), each requesting --uploads
+   single mip footprints (2048 by default) of textures drawn from --textures
+   distinct descriptions (256 by default, sizes from 64 to 8192 in BC1, BC7, RGBA8
+   and RGBA16F, full mip chains), the lookups a streaming heavy frame makes through
+   TextureStreamingBackendD3D12 and CopyQueue. Runs the frames once calling the
+   footprint function every time and once through a FootprintCache of --capacity
+   entries (1024 by default). Prints the time per frame and per lookup of both and
+   the cache's hit rate; fails when a cached layout differs from a computed one or a
+   subresource range past the end of a texture comes back or gets cached.
+
+   On Windows the function is the engine's ComputeCopyableFootprints, build with
+   FootprintCache.cpp and FootprintCacheD3D12.cpp. Elsewhere it is a stand-in with
+   D3D12's pitch and placement rules for the four formats used here, cheaper than
+   D3DX12GetCopyableFootprints, so the times there only show the cache's own cost.
+   Build with FootprintCache.cpp.
+*/
+
+#if defined(_WIN32)
+#include "../FootprintCacheD3D12.h"
+#else
+#include "../FootprintCache.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace PowerEngine::Core;
+
+namespace
+{
+	struct Lookup
+	{
+		std::uint32_t Texture;
+		std::uint32_t Mip;
+	};
+
+	// DXGI_FORMAT and D3D12_RESOURCE_DIMENSION values //
+
+	constexpr std::uint32_t g_FormatBC1 = 71;
+	constexpr std::uint32_t g_FormatBC7 = 98;
+	constexpr std::uint32_t g_FormatRGBA8 = 28;
+	constexpr std::uint32_t g_FormatRGBA16F = 10;
+	constexpr std::uint32_t g_DimensionTexture2D = 3;
+
+#if defined(_WIN32)
+	const FootprintFunction g_ComputeFootprints = ComputeCopyableFootprints;
+#else
+	std::uint64_t Align(std::uint64_t value, std::uint64_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	// D3DX12GetCopyableFootprints for single plane 2D textures of the formats above //
+	/*
+	   Rows of blocks pitched to 256 bytes, each subresource placed on 512 bytes, the
+	   total ending at the last row's data as D3D12 has it.
+	*/
+
+	bool ComputeFootprints(const FootprintDesc& desc, std::uint32_t firstSubresource, std::uint32_t numSubresources, SubresourceFootprints& footprints)
+	{
+		const bool compressed = desc.Format == g_FormatBC1 || desc.Format == g_FormatBC7;
+		const std::uint32_t blockSize = compressed ? 4 : 1;
+		const std::uint32_t blockBytes = desc.Format == g_FormatRGBA8 ? 4 : desc.Format == g_FormatBC7 ? 16 : 8;
+
+		const std::uint32_t subresourceCount = std::uint32_t(desc.MipLevels) * desc.DepthOrArraySize;
+		if (desc.Dimension != g_DimensionTexture2D || firstSubresource > subresourceCount || numSubresources > subresourceCount - firstSubresource)
+		{
+			return false;
+		}
+
+		footprints.Layouts.resize(numSubresources);
+		footprints.NumRows.resize(numSubresources);
+		footprints.RowSizes.resize(numSubresources);
+		footprints.TotalBytes = 0;
+
+		std::uint64_t offset = 0;
+		for (std::uint32_t i = 0; i < numSubresources; ++i)
+		{
+			const std::uint32_t mip = (firstSubresource + i) % desc.MipLevels;
+			const std::uint32_t width = static_cast<std::uint32_t>(std::max<std::uint64_t>(1, desc.Width >> mip));
+			const std::uint32_t height = std::max(1u, desc.Height >> mip);
+			const std::uint32_t blocksWide = (width + blockSize - 1) / blockSize;
+			const std::uint32_t blocksHigh = (height + blockSize - 1) / blockSize;
+
+			const std::uint64_t rowSize = std::uint64_t(blocksWide) * blockBytes;
+			const std::uint32_t rowPitch = static_cast<std::uint32_t>(Align(rowSize, 256));
+			offset = Align(offset, 512);
+
+			footprints.Layouts[i] = { offset, desc.Format, blocksWide * blockSize, blocksHigh * blockSize, 1, rowPitch };
+			footprints.NumRows[i] = blocksHigh;
+			footprints.RowSizes[i] = rowSize;
+			footprints.TotalBytes = offset + std::uint64_t(rowPitch) * (blocksHigh - 1) + rowSize;
+			offset += std::uint64_t(rowPitch) * blocksHigh;
+		}
+
+		return true;
+	}
+
+	const FootprintFunction g_ComputeFootprints = ComputeFootprints;
+#endif
+
+	std::vector<FootprintDesc> TextureDescs(std::uint32_t count)
+	{
+		const std::uint32_t formats[] = { g_FormatBC1, g_FormatBC7, g_FormatRGBA8, g_FormatRGBA16F };
+
+		std::vector<FootprintDesc> descs;
+		descs.reserve(count);
+
+		for (std::uint32_t i = 0; i < count; ++i)
+		{
+			const std::uint64_t width = 64ull << (i % 8);
+			const std::uint32_t height = 64u << ((i / 8) % 8);
+
+			std::uint16_t mipLevels = 1;
+			while ((std::max<std::uint64_t>(width, height) >> mipLevels) > 0)
+			{
+				mipLevels++;
+			}
+
+			descs.push_back({ g_DimensionTexture2D, width, height, 1, mipLevels, formats[(i / 64) % 4] });
+		}
+
+		return descs;
+	}
+
+	// Streaming requests favour a working set, a few textures take most of each frame //
+
+	std::vector<Lookup> FrameLookups(const std::vector<FootprintDesc>& descs, std::uint32_t frames, std::uint32_t uploads)
+	{
+		std::vector<Lookup> lookups;
+		lookups.reserve(std::size_t(frames) * uploads);
+
+		std::uint32_t state = 12345;
+		for (std::size_t i = 0; i < std::size_t(frames) * uploads; ++i)
+		{
+			state = state * 1664525u + 1013904223u;
+			const std::uint32_t pick = state >> 8;
+			const std::uint32_t texture = (pick & 3) != 0 ? pick % std::min<std::uint32_t>(32, static_cast<std::uint32_t>(descs.size())) : pick % static_cast<std::uint32_t>(descs.size());
+			lookups.push_back({ texture, (state >> 4) % descs[texture].MipLevels });
+		}
+
+		return lookups;
+	}
+
+	// Field by field, the padding after RowPitch is never written //
+
+	bool SameLayout(const PlacedFootprint& a, const PlacedFootprint& b)
+	{
+		return a.Offset == b.Offset && a.Format == b.Format && a.Width == b.Width && a.Height == b.Height && a.Depth == b.Depth &&
+			a.RowPitch == b.RowPitch;
+	}
+
+	double Seconds(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::uint32_t frames = 1000;
+	std::uint32_t uploads = 2048;
+	std::uint32_t textures = 256;
+	std::uint32_t capacity = 1024;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+		{
+			frames = static_cast<std::uint32_t>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--uploads") == 0 && i + 1 < argc)
+		{
+			uploads = static_cast<std::uint32_t>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--textures") == 0 && i + 1 < argc)
+		{
+			textures = static_cast<std::uint32_t>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--capacity") == 0 && i + 1 < argc)
+		{
+			capacity = static_cast<std::uint32_t>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else
+		{
+			std::fprintf(stderr, "FootprintCacheBench [--frames <count>] [--uploads <count>] [--textures <count>] [--capacity <entries>]\n");
+			return 2;
+		}
+	}
+
+	const std::vector<FootprintDesc> descs = TextureDescs(textures);
+	const std::vector<Lookup> lookups = FrameLookups(descs, frames, uploads);
+
+	// Both loops sum the sizes so neither can be optimized away //
+
+	std::uint64_t computedBytes = 0;
+	SubresourceFootprints computed;
+	auto start = std::chrono::steady_clock::now();
+	for (const Lookup& lookup : lookups)
+	{
+		g_ComputeFootprints(descs[lookup.Texture], lookup.Mip, 1, computed);
+		computedBytes += computed.TotalBytes;
+	}
+	const double computedSeconds = Seconds(start);
+
+	FootprintCache cache(g_ComputeFootprints, capacity);
+	std::uint64_t cachedBytes = 0;
+	start = std::chrono::steady_clock::now();
+	for (const Lookup& lookup : lookups)
+	{
+		cachedBytes += cache.Get(descs[lookup.Texture], lookup.Mip, 1)->TotalBytes;
+	}
+	const double cachedSeconds = Seconds(start);
+	const FootprintCacheStats stats = cache.Stats();
+
+	bool matched = computedBytes == cachedBytes;
+	for (std::uint32_t texture = 0; texture < descs.size() && matched; ++texture)
+	{
+		for (std::uint32_t mip = 0; mip < descs[texture].MipLevels && matched; ++mip)
+		{
+			g_ComputeFootprints(descs[texture], mip, 1, computed);
+
+			const std::shared_ptr<const SubresourceFootprints> cached = cache.Get(descs[texture], mip, 1);
+			matched = SameLayout(cached->Layouts[0], computed.Layouts[0]) && cached->NumRows[0] == computed.NumRows[0] &&
+				cached->RowSizes[0] == computed.RowSizes[0] && cached->TotalBytes == computed.TotalBytes;
+		}
+	}
+
+	// One past the last mip must fail every time, never from the cache //
+
+	const std::uint32_t entries = cache.Stats().Entries;
+	const bool failedPastEnd = !cache.Get(descs[0], descs[0].MipLevels, 1) && !cache.Get(descs[0], descs[0].MipLevels, 1) && cache.Stats().Entries == entries;
+
+	const double lookupCount = static_cast<double>(lookups.size());
+	std::printf("%u frames of %u lookups over %zu textures\n", frames, uploads, descs.size());
+	std::printf("Computed:                    %8.1f us/frame, %6.1f ns/lookup\n", computedSeconds * 1e6 / frames, computedSeconds * 1e9 / lookupCount);
+	std::printf("FootprintCache:              %8.1f us/frame, %6.1f ns/lookup, %.2fx\n", cachedSeconds * 1e6 / frames, cachedSeconds * 1e9 / lookupCount,
+		computedSeconds / cachedSeconds);
+	std::printf("Hits %llu, misses %llu, evictions %llu, %u entries\n", static_cast<unsigned long long>(stats.Hits),
+		static_cast<unsigned long long>(stats.Misses), static_cast<unsigned long long>(stats.Evictions), stats.Entries);
+
+	if (!matched)
+	{
+		std::printf("A cached footprint differs from a computed one\n");
+		return 1;
+	}
+
+	if (!failedPastEnd)
+	{
+		std::printf("A subresource past the last mip was returned or cached\n");
+		return 1;
+	}
+
+	return 0;
+}
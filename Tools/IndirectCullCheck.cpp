@@ -0,0 +1,330 @@
+// Checks GenerateIndirectArguments against a plain scalar cull and times both //
+/*
+   IndirectCullCheck [--objects <count>] [--meshes <count>] [--views <count>] [--repeat <count>] [--threads <count>]
+
+   Scatters --objects scene objects (1000000 by default) with bounding spheres of
+   0.5 to 8 units in a 2000 unit cube around the camera, every 50th one hidden,
+   drawing --meshes meshes (64). For --views camera yaws (8) the frustum comes from
+   ExtractFrustum of a 90 degree perspective, then:
+
+   - a scalar cull written here from scratch, one object at a time in double
+     precision straight into the argument list, gives the expected draws;
+   - GenerateIndirectArguments runs on the calling thread and over a pool of
+     --threads workers (one per hardware thread by default).
+
+   Both GenerateIndirectArguments runs must be identical, in object order, and
+   agree with the scalar cull on every object except those whose sphere touches a
+   plane to within float rounding, which may go either way. Every draw must carry
+   its object's mesh range. Each run is repeated --repeat times (5) keeping the
+   fastest; prints the time per view of the three and the visible share, fails on
+   the first disagreement.
+
+   Build with IndirectDraws.cpp and ThreadPool.cpp, runs on any platform.
+*/
+
+#include "../IndirectDraws.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace PowerEngine::Core;
+
+namespace
+{
+	enum class Expected : std::uint8_t
+	{
+		Culled,
+		Visible,
+		Either
+	};
+
+	std::uint32_t NextRandom(std::uint32_t& state)
+	{
+		state = state * 1664525u + 1013904223u;
+		return state >> 8;
+	}
+
+	float RandomRange(std::uint32_t& state, float low, float high)
+	{
+		return low + (high - low) * static_cast<float>(NextRandom(state) & 0xFFFF) / 65535.0f;
+	}
+
+	std::vector<SceneObject> SceneObjects(std::uint32_t count, std::uint32_t meshCount)
+	{
+		std::vector<SceneObject> objects(count);
+		std::uint32_t state = 7;
+
+		for (std::uint32_t i = 0; i < count; ++i)
+		{
+			SceneObject& object = objects[i];
+			object = {};
+			object.BoundsCenter[0] = RandomRange(state, -1000.0f, 1000.0f);
+			object.BoundsCenter[1] = RandomRange(state, -1000.0f, 1000.0f);
+			object.BoundsCenter[2] = RandomRange(state, -1000.0f, 1000.0f);
+			object.BoundsRadius = RandomRange(state, 0.5f, 8.0f);
+			object.Mesh = NextRandom(state) % meshCount;
+			object.Material = NextRandom(state) % 16;
+			object.Flags = i % 50 == 49 ? g_SceneObjectHidden : 0;
+		}
+
+		return objects;
+	}
+
+	std::vector<IndirectMesh> Meshes(std::uint32_t count)
+	{
+		std::vector<IndirectMesh> meshes(count);
+		std::uint32_t startIndex = 0;
+		std::int32_t baseVertex = 0;
+
+		for (IndirectMesh& mesh : meshes)
+		{
+			mesh.IndexCount = 3 * (1 + static_cast<std::uint32_t>(&mesh - meshes.data()) * 37 % 2000);
+			mesh.StartIndex = startIndex;
+			mesh.BaseVertex = baseVertex;
+			startIndex += mesh.IndexCount;
+			baseVertex += static_cast<std::int32_t>(mesh.IndexCount / 2);
+		}
+
+		return meshes;
+	}
+
+	// Row-major yaw * perspective for row vectors, DirectXMath's XMMatrixRotationY * XMMatrixPerspectiveFovLH //
+
+	CullFrustum ViewFrustum(float yaw)
+	{
+		const float nearZ = 0.1f;
+		const float farZ = 1500.0f;
+		const float scale = 1.0f / std::tan(0.25f * 3.14159265f);
+		const float range = farZ / (farZ - nearZ);
+		const float c = std::cos(yaw);
+		const float s = std::sin(yaw);
+
+		// Camera at the origin, the view is the inverse (transpose) of the camera's yaw //
+
+		const float view[4][4] = { { c, 0.0f, s, 0.0f }, { 0.0f, 1.0f, 0.0f, 0.0f }, { -s, 0.0f, c, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f } };
+		const float projection[4][4] = { { scale, 0.0f, 0.0f, 0.0f }, { 0.0f, scale, 0.0f, 0.0f }, { 0.0f, 0.0f, range, 1.0f }, { 0.0f, 0.0f, -range * nearZ, 0.0f } };
+
+		float viewProjection[4][4] = {};
+		for (int r = 0; r < 4; ++r)
+		{
+			for (int col = 0; col < 4; ++col)
+			{
+				for (int k = 0; k < 4; ++k)
+				{
+					viewProjection[r][col] += view[r][k] * projection[k][col];
+				}
+			}
+		}
+
+		return ExtractFrustum(viewProjection);
+	}
+
+	// The reference: per object, every plane in double, no groups, scans or pools //
+
+	std::uint32_t ScalarCull(const CullFrustum& frustum, const std::vector<SceneObject>& objects, const std::vector<IndirectMesh>& meshes,
+		std::vector<IndirectDrawArguments>& arguments, std::vector<Expected>* expected)
+	{
+		arguments.clear();
+
+		for (std::uint32_t i = 0; i < objects.size(); ++i)
+		{
+			const SceneObject& object = objects[i];
+
+			Expected result = Expected::Visible;
+			if (object.Flags & g_SceneObjectHidden)
+			{
+				result = Expected::Culled;
+			}
+			else
+			{
+				for (const float* plane : frustum.Planes)
+				{
+					const double margin = double(plane[0]) * object.BoundsCenter[0] + double(plane[1]) * object.BoundsCenter[1] +
+						double(plane[2]) * object.BoundsCenter[2] + double(plane[3]) + object.BoundsRadius;
+
+					// Float sums of terms up to ~1000 are off by a few 1e-4 at most //
+
+					const double tolerance = 1e-3;
+					if (margin < -tolerance)
+					{
+						result = Expected::Culled;
+						break;
+					}
+					if (margin < tolerance)
+					{
+						result = Expected::Either;
+					}
+				}
+			}
+
+			if (expected)
+			{
+				(*expected)[i] = result;
+			}
+
+			if (result != Expected::Culled)
+			{
+				const IndirectMesh& mesh = meshes[object.Mesh];
+				arguments.push_back({ i, mesh.IndexCount, 1, mesh.StartIndex, mesh.BaseVertex, 0 });
+			}
+		}
+
+		return static_cast<std::uint32_t>(arguments.size());
+	}
+
+	// Walks the objects once, the GPU draws must be the certain ones plus some of the borderline ones //
+
+	bool MatchesReference(const std::vector<IndirectDrawArguments>& arguments, const std::vector<Expected>& expected,
+		const std::vector<SceneObject>& objects, const std::vector<IndirectMesh>& meshes, std::uint32_t& borderline)
+	{
+		std::size_t next = 0;
+		for (std::uint32_t i = 0; i < expected.size(); ++i)
+		{
+			const bool drawn = next < arguments.size() && arguments[next].DrawId == i;
+
+			if (expected[i] == Expected::Either)
+			{
+				borderline++;
+			}
+			else if (drawn != (expected[i] == Expected::Visible))
+			{
+				std::printf("Object %u %s by GenerateIndirectArguments, the scalar cull %s it\n", i, drawn ? "drawn" : "culled",
+					drawn ? "culls" : "draws");
+				return false;
+			}
+
+			if (drawn)
+			{
+				const IndirectMesh& mesh = meshes[objects[i].Mesh];
+				const IndirectDrawArguments reference = { i, mesh.IndexCount, 1, mesh.StartIndex, mesh.BaseVertex, 0 };
+				if (!(arguments[next] == reference))
+				{
+					std::printf("Draw %zu of object %u does not carry its mesh range\n", next, i);
+					return false;
+				}
+				next++;
+			}
+		}
+
+		if (next != arguments.size())
+		{
+			std::printf("Draw %zu is out of object order or past the last object\n", next);
+			return false;
+		}
+
+		return true;
+	}
+
+	template<typename Function>
+	double FastestMilliseconds(std::uint32_t repeat, Function&& function)
+	{
+		double best = 1e30;
+		for (std::uint32_t i = 0; i < repeat; ++i)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			function();
+			best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		}
+		return best;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::uint32_t objectCount = 1000000;
+	std::uint32_t meshCount = 64;
+	std::uint32_t views = 8;
+	std::uint32_t repeat = 5;
+	std::uint32_t threads = 0;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--objects") == 0 && i + 1 < argc)
+		{
+			objectCount = static_cast<std::uint32_t>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--meshes") == 0 && i + 1 < argc)
+		{
+			meshCount = static_cast<std::uint32_t>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--views") == 0 && i + 1 < argc)
+		{
+			views = static_cast<std::uint32_t>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+		{
+			repeat = static_cast<std::uint32_t>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+		{
+			threads = static_cast<std::uint32_t>(std::max(0l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else
+		{
+			std::fprintf(stderr, "IndirectCullCheck [--objects <count>] [--meshes <count>] [--views <count>] [--repeat <count>] [--threads <count>]\n");
+			return 2;
+		}
+	}
+
+	const std::vector<SceneObject> objects = SceneObjects(objectCount, meshCount);
+	const std::vector<IndirectMesh> meshes = Meshes(meshCount);
+	ThreadPool pool(threads);
+
+	std::vector<IndirectDrawArguments> reference;
+	std::vector<IndirectDrawArguments> serial;
+	std::vector<IndirectDrawArguments> pooled;
+	std::vector<Expected> expected(objectCount);
+
+	double scalarMilliseconds = 0.0;
+	double serialMilliseconds = 0.0;
+	double pooledMilliseconds = 0.0;
+	std::uint64_t visible = 0;
+	std::uint32_t borderline = 0;
+
+	for (std::uint32_t view = 0; view < views; ++view)
+	{
+		const CullFrustum frustum = ViewFrustum(6.2831853f * static_cast<float>(view) / static_cast<float>(views));
+
+		ScalarCull(frustum, objects, meshes, reference, &expected);
+		scalarMilliseconds += FastestMilliseconds(repeat, [&] { ScalarCull(frustum, objects, meshes, reference, nullptr); });
+
+		std::uint32_t serialCount = 0;
+		std::uint32_t pooledCount = 0;
+		serialMilliseconds += FastestMilliseconds(repeat, [&] { serialCount = GenerateIndirectArguments(frustum, objects, meshes, serial, nullptr); });
+		pooledMilliseconds += FastestMilliseconds(repeat, [&] { pooledCount = GenerateIndirectArguments(frustum, objects, meshes, pooled, &pool); });
+
+		if (serialCount != serial.size() || pooledCount != pooled.size())
+		{
+			std::printf("View %u: the returned draw count differs from the arguments written\n", view);
+			return 1;
+		}
+
+		if (serial.size() != pooled.size() || !std::equal(serial.begin(), serial.end(), pooled.begin()))
+		{
+			std::printf("View %u: the pooled arguments differ from the single threaded ones\n", view);
+			return 1;
+		}
+
+		if (!MatchesReference(pooled, expected, objects, meshes, borderline))
+		{
+			std::printf("View %u: GenerateIndirectArguments disagrees with the scalar cull\n", view);
+			return 1;
+		}
+
+		visible += pooled.size();
+	}
+
+	std::printf("%u objects, %u views, %.1f%% visible, %u borderline\n", objectCount, views,
+		100.0 * static_cast<double>(visible) / (double(objectCount) * views), borderline);
+	std::printf("Scalar cull:                           %8.3f ms/view\n", scalarMilliseconds / views);
+	std::printf("GenerateIndirectArguments, 1 thread:   %8.3f ms/view, %.2fx the scalar cull\n", serialMilliseconds / views,
+		scalarMilliseconds / serialMilliseconds);
+	std::printf("GenerateIndirectArguments, %2u threads: %8.3f ms/view, %.2fx the scalar cull\n", pool.ThreadCount() + 1,
+		pooledMilliseconds / views, scalarMilliseconds / pooledMilliseconds);
+	return 0;
+}
@@ -0,0 +1,247 @@
+// Measures cooked mesh loading against plain file reads of the same bytes //
+/*
+   MeshLoadBench <directory> [--size <MB>] [--meshes <count>] [--repeat <count>] [--no-cook] [--keep] [--min-ratio <ratio>]
+
+   Cooks --meshes synthetic meshes (16 by default) of --size MB in total (512 by
+   default) into the directory as mesh_<n>.pmesh, then loads them with MeshFile,
+   mapping each one and copying its streams into an upload sized buffer, and reads
+   them again with a plain ifstream read into a buffer, the I/O bound of the same
+   bytes. --repeat runs both that many times and keeps the fastest. Prints MB/s of
+   both and their ratio; with --min-ratio, fails when mesh loading runs at less than
+   that fraction of the plain reads. The files are removed afterwards unless --keep.
+
+   Freshly cooked files sit in the page cache. For cold numbers, cook with --keep,
+   drop the cache (echo 3 > /proc/sys/vm/drop_caches) and run again with --no-cook.
+
+   Build with MeshFormat.cpp and MappedFile.cpp, runs on any platform.
+*/
+
+#include "../MeshFormat.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace PowerEngine::Assets;
+
+namespace
+{
+	constexpr std::uint32_t g_VertexStride = 32;	// position, normal, uv
+
+	std::string MeshPath(const std::string& directory, std::uint32_t index)
+	{
+		char name[32];
+		std::snprintf(name, sizeof(name), "/mesh_%03u.pmesh", index);
+		return directory + name;
+	}
+
+	bool CookMeshes(const std::string& directory, std::uint32_t meshCount, std::uint64_t meshBytes)
+	{
+		// Three quarters vertices, the rest 32-bit indices //
+
+		const std::uint32_t vertexCount = static_cast<std::uint32_t>(meshBytes * 3 / 4 / g_VertexStride);
+		const std::uint32_t indexCount = static_cast<std::uint32_t>(meshBytes / 4 / sizeof(std::uint32_t));
+
+		std::vector<float> vertices(std::uint64_t(vertexCount) * g_VertexStride / sizeof(float));
+		for (std::size_t i = 0; i < vertices.size(); ++i)
+		{
+			vertices[i] = static_cast<float>(i % 1024) * 0.25f;
+		}
+
+		std::vector<std::uint32_t> indices(indexCount);
+		for (std::uint32_t i = 0; i < indexCount; ++i)
+		{
+			indices[i] = vertexCount ? i % vertexCount : 0;
+		}
+
+		const MeshStreamDesc streams[] =
+		{
+			{ MeshStreamType::Vertices, g_VertexStride, 0, vertices.data(), vertices.size() * sizeof(float) },
+			{ MeshStreamType::Indices32, sizeof(std::uint32_t), 0, indices.data(), indices.size() * sizeof(std::uint32_t) },
+		};
+
+		const float boundsMin[3] = { 0.0f, 0.0f, 0.0f };
+		const float boundsMax[3] = { 256.0f, 256.0f, 256.0f };
+
+		for (std::uint32_t i = 0; i < meshCount; ++i)
+		{
+			if (!WriteCookedMesh(MeshPath(directory, i).c_str(), streams, 2, vertexCount, indexCount, boundsMin, boundsMax))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	double Seconds(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// Maps every mesh and copies its streams into upload memory, returns the bytes copied or 0 on failure //
+
+	std::uint64_t LoadMeshes(const std::string& directory, std::uint32_t meshCount, std::vector<std::uint8_t>& upload)
+	{
+		std::uint64_t bytes = 0;
+
+		for (std::uint32_t i = 0; i < meshCount; ++i)
+		{
+			MeshFile mesh;
+			if (!mesh.Open(MeshPath(directory, i).c_str()))
+			{
+				return 0;
+			}
+
+			if (upload.size() < mesh.UploadSize())
+			{
+				upload.resize(static_cast<std::size_t>(mesh.UploadSize()));
+			}
+
+			mesh.CopyStreams(upload.data());
+			bytes += mesh.Header().FileSize;
+		}
+
+		return bytes;
+	}
+
+	std::uint64_t ReadMeshes(const std::string& directory, std::uint32_t meshCount, std::vector<std::uint8_t>& buffer)
+	{
+		std::uint64_t bytes = 0;
+
+		for (std::uint32_t i = 0; i < meshCount; ++i)
+		{
+			std::ifstream file(MeshPath(directory, i), std::ios::binary | std::ios::ate);
+			if (!file)
+			{
+				return 0;
+			}
+
+			const std::uint64_t size = static_cast<std::uint64_t>(file.tellg());
+			if (buffer.size() < size)
+			{
+				buffer.resize(static_cast<std::size_t>(size));
+			}
+
+			file.seekg(0);
+			if (!file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(size)))
+			{
+				return 0;
+			}
+
+			bytes += size;
+		}
+
+		return bytes;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const char* directory = nullptr;
+	std::uint64_t sizeMegabytes = 512;
+	std::uint32_t meshCount = 16;
+	std::uint32_t repeat = 1;
+	bool cook = true;
+	bool keep = false;
+	double minRatio = -1.0;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+		{
+			sizeMegabytes = std::max(1ull, std::strtoull(argv[++i], nullptr, 10));
+		}
+		else if (std::strcmp(argv[i], "--meshes") == 0 && i + 1 < argc)
+		{
+			meshCount = static_cast<std::uint32_t>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+		{
+			repeat = static_cast<std::uint32_t>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--no-cook") == 0)
+		{
+			cook = false;
+		}
+		else if (std::strcmp(argv[i], "--keep") == 0)
+		{
+			keep = true;
+		}
+		else if (std::strcmp(argv[i], "--min-ratio") == 0 && i + 1 < argc)
+		{
+			minRatio = std::strtod(argv[++i], nullptr);
+		}
+		else
+		{
+			directory = argv[i];
+		}
+	}
+
+	if (!directory)
+	{
+		std::fprintf(stderr, "MeshLoadBench <directory> [--size <MB>] [--meshes <count>] [--repeat <count>] [--no-cook] [--keep] [--min-ratio <ratio>]\n");
+		return 2;
+	}
+
+	if (cook && !CookMeshes(directory, meshCount, (sizeMegabytes << 20) / meshCount))
+	{
+		std::fprintf(stderr, "Can't write meshes to %s.\n", directory);
+		return 2;
+	}
+
+	std::vector<std::uint8_t> upload;
+	std::vector<std::uint8_t> buffer;
+	double loadSeconds = 0.0;
+	double readSeconds = 0.0;
+	std::uint64_t bytes = 0;
+
+	for (std::uint32_t run = 0; run < repeat; ++run)
+	{
+		auto start = std::chrono::steady_clock::now();
+		bytes = LoadMeshes(directory, meshCount, upload);
+		const double load = Seconds(start);
+
+		start = std::chrono::steady_clock::now();
+		const std::uint64_t readBytes = ReadMeshes(directory, meshCount, buffer);
+		const double read = Seconds(start);
+
+		if (bytes == 0 || readBytes != bytes)
+		{
+			std::fprintf(stderr, "Can't load the meshes in %s.\n", directory);
+			return 1;
+		}
+
+		loadSeconds = run == 0 ? load : std::min(loadSeconds, load);
+		readSeconds = run == 0 ? read : std::min(readSeconds, read);
+	}
+
+	if (!keep)
+	{
+		for (std::uint32_t i = 0; i < meshCount; ++i)
+		{
+			std::remove(MeshPath(directory, i).c_str());
+		}
+	}
+
+	const double megabytes = static_cast<double>(bytes) / (1024.0 * 1024.0);
+	const double loadRate = megabytes / std::max(loadSeconds, 1e-9);
+	const double readRate = megabytes / std::max(readSeconds, 1e-9);
+	const double ratio = loadRate / readRate;
+
+	std::printf("%u meshes, %.0f MB: mesh load %.0f MB/s (%.3f s), plain read %.0f MB/s (%.3f s), ratio %.2f\n",
+		meshCount, megabytes, loadRate, loadSeconds, readRate, readSeconds, ratio);
+
+	if (minRatio >= 0.0 && ratio < minRatio)
+	{
+		std::printf("Mesh loading at %.2f of plain reads, under %.2f\n", ratio, minRatio);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,217 @@
+// Runs the frame pacer against a simulated CPU and GPU timeline //
+/*
+   PacingReplay <timings> [--refresh <hz>] [--latency <frames>] [--margin <ms>] [--no-pacing] [--max-p99 <ms>] [--quiet]
+
+   Each line of the timings file is one frame: "<cpu ms> <gpu ms>", the time from
+   input sampling to submission and the GPU time. Lines starting with # are skipped.
+   The simulated GPU runs frames in submission order, a frame is displayed at the
+   first vblank after its GPU work ends (--refresh, 60 by default, 0 displays it
+   right away) and the CPU starts a frame once fewer than --latency presents (1 by
+   default, the swap chain's maximum frame latency) wait for the display, as the
+   frame latency waitable object lets it. GPU times reach the pacer once the
+   simulated GPU has finished the frame. Prints the timeline of every frame unless
+   --quiet, then FPS, input to display latency percentiles and the refreshes that
+   showed no new frame; with --max-p99, fails when the 99th percentile is over it.
+
+   Build with FramePacing.cpp, runs on any platform.
+*/
+
+#include "../FramePacing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace PowerEngine::Core;
+
+namespace
+{
+	struct FrameCost
+	{
+		double Cpu = 0.0;
+		double Gpu = 0.0;
+	};
+
+	struct GpuFrame
+	{
+		double End;
+		double Milliseconds;
+	};
+
+	bool ReadTimings(const char* path, std::vector<FrameCost>& frames)
+	{
+		std::ifstream file(path);
+		if (!file)
+		{
+			return false;
+		}
+
+		std::string line;
+		while (std::getline(file, line))
+		{
+			if (line.empty() || line[0] == '#')
+			{
+				continue;
+			}
+
+			FrameCost cost;
+			std::istringstream fields(line);
+			if (!(fields >> cost.Cpu >> cost.Gpu))
+			{
+				return false;
+			}
+
+			frames.push_back(cost);
+		}
+
+		return !frames.empty();
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const char* timingsPath = nullptr;
+	FramePacingSettings settings;
+	double refreshRate = 60.0;
+	std::uint32_t maxLatency = 1;
+	bool pacing = true;
+	double maxP99 = -1.0;
+	bool quiet = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--refresh") == 0 && i + 1 < argc)
+		{
+			refreshRate = std::max(std::strtod(argv[++i], nullptr), 0.0);
+		}
+		else if (std::strcmp(argv[i], "--latency") == 0 && i + 1 < argc)
+		{
+			maxLatency = static_cast<std::uint32_t>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--margin") == 0 && i + 1 < argc)
+		{
+			settings.MarginMilliseconds = std::strtod(argv[++i], nullptr);
+		}
+		else if (std::strcmp(argv[i], "--no-pacing") == 0)
+		{
+			pacing = false;
+		}
+		else if (std::strcmp(argv[i], "--max-p99") == 0 && i + 1 < argc)
+		{
+			maxP99 = std::strtod(argv[++i], nullptr);
+		}
+		else if (std::strcmp(argv[i], "--quiet") == 0)
+		{
+			quiet = true;
+		}
+		else
+		{
+			timingsPath = argv[i];
+		}
+	}
+
+	if (!timingsPath)
+	{
+		std::fprintf(stderr, "PacingReplay <timings> [--refresh <hz>] [--latency <frames>] [--margin <ms>] [--no-pacing] [--max-p99 <ms>] [--quiet]\n");
+		return 2;
+	}
+
+	std::vector<FrameCost> frames;
+	if (!ReadTimings(timingsPath, frames))
+	{
+		std::fprintf(stderr, "Can't read %s as a timing trace.\n", timingsPath);
+		return 2;
+	}
+
+	const double period = refreshRate > 0.0 ? 1000.0 / refreshRate : 0.0;
+
+	FramePacer pacer(settings);
+	pacer.SetDisplayTiming(0.0, period);
+
+	FrameLatencyTracker latency(static_cast<std::uint32_t>(frames.size()));
+	std::deque<GpuFrame> gpuInFlight;
+	std::vector<double> displays;
+
+	double now = 0.0;
+	double gpuFree = 0.0;
+	double lastDisplay = -period;
+	std::uint64_t emptyRefreshes = 0;
+
+	for (std::size_t i = 0; i < frames.size(); ++i)
+	{
+		// The waitable object releases the CPU once fewer than maxLatency presents wait for the display //
+
+		if (i >= maxLatency)
+		{
+			now = std::max(now, displays[i - maxLatency]);
+		}
+
+		// Timestamps of the frames the GPU has finished are read back //
+
+		while (!gpuInFlight.empty() && gpuInFlight.front().End <= now)
+		{
+			pacer.RecordGpu(gpuInFlight.front().Milliseconds);
+			gpuInFlight.pop_front();
+		}
+
+		const double sleep = pacing ? pacer.SleepMilliseconds(now) : 0.0;
+		now += sleep;
+
+		FrameStamps stamps;
+		stamps.Input = now;
+		stamps.Simulate = now;
+
+		now += frames[i].Cpu;
+		stamps.Submit = now;
+		stamps.Present = now;
+
+		pacer.RecordCpu(frames[i].Cpu);
+		pacer.Submitted(now);
+
+		const double gpuEnd = std::max(now, gpuFree) + frames[i].Gpu;
+		gpuFree = gpuEnd;
+		gpuInFlight.push_back({ gpuEnd, frames[i].Gpu });
+
+		// Flip model with vsync: one new frame per vblank at most, the first after the GPU is done //
+
+		double display = gpuEnd;
+		if (period > 0.0)
+		{
+			display = std::ceil(std::max(gpuEnd, lastDisplay + period * 0.5) / period) * period;
+			emptyRefreshes += i == 0 ? 0 : static_cast<std::uint64_t>(std::llround((display - lastDisplay) / period)) - 1;
+		}
+		lastDisplay = display;
+		displays.push_back(display);
+
+		latency.Presented(i, stamps);
+		latency.Displayed(i, display);
+
+		if (!quiet)
+		{
+			std::printf("%6zu  sleep %6.2f  input %9.2f  submit %9.2f  gpu end %9.2f  display %9.2f  latency %6.2f ms\n",
+				i, sleep, stamps.Input, stamps.Submit, gpuEnd, display, display - stamps.Input);
+		}
+	}
+
+	const FrameLatencyReport report = latency.Report();
+	const double seconds = (displays.back() - displays.front()) / 1000.0;
+	const double fps = seconds > 0.0 ? static_cast<double>(frames.size() - 1) / seconds : 0.0;
+
+	std::printf("%zu frames, FPS %.1f, latency %s, %llu refreshes without a new frame\n", frames.size(), fps,
+		FrameLatencyTracker::Format(report).c_str(), static_cast<unsigned long long>(emptyRefreshes));
+
+	if (maxP99 >= 0.0 && report.InputToDisplay.P99 > maxP99)
+	{
+		std::printf("99th percentile latency %.2f ms over %.2f ms\n", report.InputToDisplay.P99, maxP99);
+		return 1;
+	}
+
+	return 0;
+}
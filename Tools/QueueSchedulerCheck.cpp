@@ -0,0 +1,198 @@
+// Checks the queue scheduler's batches on simulated queues //
+/*
+   QueueSchedulerCheck [--graphs <count>] [--passes <count>] [--seed <n>]
+
+   First compiles the engine's frame (Scene, IndirectCull on the compute queue,
+   Composite waiting on both) and a longer frame with compute passes feeding direct
+   passes and the other way around, with and without async compute. Each one runs on
+   SimulateQueues, must pass ValidateTimings and, with async compute, overlap the
+   queues and end no later than the serial frame. Then does the same for --graphs
+   random pass graphs (1000) of up to --passes passes (32). Finally checks that
+   ValidateTimings rejects a timeline where a pass starts before its dependency ends.
+   Prints the frame time and overlap of the fixed frames, fails on the first check
+   that does not hold.
+
+   Build with QueueScheduler.cpp, runs on any platform.
+*/
+
+#include "../QueueScheduler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace PowerEngine::Core;
+
+namespace
+{
+	struct FrameResult
+	{
+		bool Valid;
+		double FrameTime;
+		double Overlap;
+	};
+
+	FrameResult RunFrame(QueueScheduler& scheduler, const std::vector<double>& durations, bool asyncCompute)
+	{
+		scheduler.Compile(asyncCompute);
+		std::vector<PassTiming> timings = SimulateQueues(scheduler, durations);
+
+		FrameResult result = { ValidateTimings(scheduler, timings), 0.0, MeasureOverlap(timings) };
+		for (const PassTiming& timing : timings)
+		{
+			result.FrameTime = std::max(result.FrameTime, timing.End);
+		}
+		return result;
+	}
+
+	// Serial and async compiles of the same graph, the async one may only be faster //
+
+	bool CheckGraph(const char* name, QueueScheduler& scheduler, const std::vector<double>& durations, bool print)
+	{
+		const FrameResult serial = RunFrame(scheduler, durations, false);
+		const FrameResult async = RunFrame(scheduler, durations, true);
+
+		if (print)
+		{
+			std::printf("%-10s serial %6.2f ms, async %6.2f ms, %5.2f ms overlapped, %zu batches\n", name, serial.FrameTime,
+				async.FrameTime, async.Overlap, scheduler.Batches().size());
+		}
+
+		if (!serial.Valid || !async.Valid)
+		{
+			std::printf("%s: a pass starts before one of its dependencies ends\n", name);
+			return false;
+		}
+		if (serial.Overlap != 0.0)
+		{
+			std::printf("%s: the queues overlap without async compute\n", name);
+			return false;
+		}
+		if (async.FrameTime > serial.FrameTime + 1e-9)
+		{
+			std::printf("%s: async compute made the frame longer, %.3f ms against %.3f ms\n", name, async.FrameTime, serial.FrameTime);
+			return false;
+		}
+
+		return true;
+	}
+
+	std::uint32_t NextRandom(std::uint32_t& state)
+	{
+		state = state * 1664525u + 1013904223u;
+		return state >> 8;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::uint32_t graphCount = 1000;
+	std::uint32_t maxPasses = 32;
+	std::uint32_t random = 1;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--graphs") == 0 && i + 1 < argc)
+		{
+			graphCount = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (std::strcmp(argv[i], "--passes") == 0 && i + 1 < argc)
+		{
+			maxPasses = static_cast<std::uint32_t>(std::max(1ul, std::strtoul(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+		{
+			random = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else
+		{
+			std::fprintf(stderr, "QueueSchedulerCheck [--graphs <count>] [--passes <count>] [--seed <n>]\n");
+			return 2;
+		}
+	}
+
+	// EngineCore's frame: the scene draws while the cull runs, the composite needs both //
+
+	QueueScheduler engine;
+	PassId scene = engine.AddPass("Scene", false);
+	PassId cull = engine.AddPass("IndirectCull", true);
+	engine.AddPass("Composite", false, { scene, cull });
+
+	if (!CheckGraph("engine", engine, { 4.0, 1.5, 2.0 }, true))
+	{
+		return 1;
+	}
+
+	if (engine.Batches().size() != 3 || engine.PassQueue(cull) != QueueType::Compute)
+	{
+		std::printf("engine: expected the cull alone on the compute queue between two direct batches\n");
+		return 1;
+	}
+
+	// Dependencies both ways across the queues //
+
+	QueueScheduler crossed;
+	PassId depth = crossed.AddPass("Depth", false);
+	PassId lightCull = crossed.AddPass("LightCull", true, { depth });
+	PassId shadows = crossed.AddPass("Shadows", false);
+	PassId particles = crossed.AddPass("Particles", true);
+	PassId lighting = crossed.AddPass("Lighting", false, { lightCull, shadows });
+	PassId bloom = crossed.AddPass("Bloom", true, { lighting });
+	crossed.AddPass("Tonemap", false, { bloom, particles });
+
+	if (!CheckGraph("crossed", crossed, { 1.0, 0.8, 2.5, 1.2, 3.0, 0.6, 0.4 }, true))
+	{
+		return 1;
+	}
+
+	// Random graphs, dependencies only on earlier passes as AddPass() requires //
+
+	for (std::uint32_t graph = 0; graph < graphCount; ++graph)
+	{
+		QueueScheduler scheduler;
+		std::vector<double> durations;
+
+		const std::uint32_t passCount = 1 + NextRandom(random) % maxPasses;
+		for (PassId pass = 0; pass < passCount; ++pass)
+		{
+			scheduler.AddPass("Pass", NextRandom(random) % 2 == 0);
+			durations.push_back(0.1 * static_cast<double>(1 + NextRandom(random) % 30));
+
+			const std::uint32_t dependencyCount = pass > 0 ? NextRandom(random) % std::min(pass + 1, 4u) : 0;
+			for (std::uint32_t i = 0; i < dependencyCount; ++i)
+			{
+				scheduler.AddDependency(pass, NextRandom(random) % pass);
+			}
+		}
+
+		char name[32];
+		std::snprintf(name, sizeof(name), "graph %u", graph);
+		if (!CheckGraph(name, scheduler, durations, false))
+		{
+			return 1;
+		}
+	}
+
+	// A timeline that breaks a dependency must be rejected //
+
+	engine.Compile(true);
+	std::vector<PassTiming> broken = SimulateQueues(engine, { 4.0, 1.5, 2.0 });
+	for (PassTiming& timing : broken)
+	{
+		if (timing.Pass == cull)
+		{
+			timing.End = 100.0;
+		}
+	}
+
+	if (ValidateTimings(engine, broken))
+	{
+		std::printf("ValidateTimings accepted a pass starting before its dependency ended\n");
+		return 1;
+	}
+
+	std::printf("%u random graphs scheduled without breaking a dependency\n", graphCount);
+	return 0;
+}
@@ -0,0 +1,410 @@
+// Drives the residency manager through a shrinking and growing budget and checks its evictions //
+/*
+   ResidencyCheck [--objects <count>] [--frames <count>] [--latency <frames>] [--seed <n>] [--quiet]
+
+   First a fixed case: five 10 byte objects used in the order B, D, A, E, C must be
+   evicted B and D when the budget drops to 30 bytes, then A at 20 bytes, nothing
+   when it grows back, only B handed back by TakeMakeResident once B is used again,
+   and nothing while every object is still in flight, which must count as a stalled
+   update.
+
+   Then --objects objects (2000, 64 KB to 4 MB, a quarter of them non local) are
+   used by --frames frames (2400): a window sliding over the objects plus a few
+   random ones, each frame signaling the next fence value and the GPU completing
+   them --latency frames (2) later. A SimulatedVideoMemory budget starts above
+   everything tracked, shrinks to 30% of it over the second quarter, stays there
+   and grows back over the last quarter. Every Update() must:
+
+   - only evict objects whose last use has completed;
+   - evict least recently used first, no object left resident in a segment was
+     used before one evicted from it;
+   - stop once the projected usage fits, the last eviction was needed;
+   - leave the usage under the target, unless the next candidate is in flight.
+
+   TakeMakeResident must hand back exactly the evicted objects used since and the
+   manager's resident bytes must match a mirror kept here. Prints the evictions,
+   make residents and stalls per phase unless --quiet, fails on the first check
+   that does not hold.
+
+   Build with ResidencyManager.cpp, runs on any platform.
+*/
+
+#include "../ResidencyManager.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace PowerEngine::Core;
+
+namespace
+{
+	// The check's own view of every object //
+
+	struct Mirror
+	{
+		std::uint64_t Size = 0;
+		std::uint64_t LastUsed = 0;
+		MemorySegment Segment = MemorySegment::Local;
+		bool Resident = true;
+		bool UsedWhileEvicted = false;
+	};
+
+	struct PhaseStats
+	{
+		std::uint64_t Evictions = 0;
+		std::uint64_t EvictedBytes = 0;
+		std::uint64_t MakeResidents = 0;
+		std::uint64_t StalledUpdates = 0;
+	};
+
+	std::uint32_t NextRandom(std::uint32_t& state)
+	{
+		state = state * 1664525u + 1013904223u;
+		return state >> 8;
+	}
+
+	std::uint32_t Index(MemorySegment segment)
+	{
+		return static_cast<std::uint32_t>(segment);
+	}
+
+	int Fail(const char* message, std::uint32_t frame)
+	{
+		std::printf("Frame %u: %s\n", frame, message);
+		return 1;
+	}
+
+	// The fixed case, budgetFraction 1 so the target is the budget //
+
+	bool CheckFixedOrder()
+	{
+		ResidencyManager manager(1.0);
+		SimulatedVideoMemory memory;
+		memory.Budget[Index(MemorySegment::Local)] = 50;
+
+		const ResidencyHandle a = manager.Track(10, MemorySegment::Local);
+		const ResidencyHandle b = manager.Track(10, MemorySegment::Local);
+		const ResidencyHandle c = manager.Track(10, MemorySegment::Local);
+		const ResidencyHandle d = manager.Track(10, MemorySegment::Local);
+		const ResidencyHandle e = manager.Track(10, MemorySegment::Local);
+
+		manager.MarkUsed(b, 1);
+		manager.MarkUsed(d, 2);
+		manager.MarkUsed(a, 3);
+		manager.MarkUsed(e, 4);
+		manager.MarkUsed(c, 5);
+
+		MemoryBudget budgets[g_MemorySegmentCount];
+		std::vector<ResidencyHandle> evict;
+
+		memory.Budget[Index(MemorySegment::Local)] = 30;
+		memory.Query(manager, budgets);
+		manager.Update(budgets, 5, evict);
+		if (evict != std::vector<ResidencyHandle>{ b, d })
+		{
+			std::printf("Fixed case: a 30 byte budget should evict B then D\n");
+			return false;
+		}
+
+		evict.clear();
+		memory.Budget[Index(MemorySegment::Local)] = 20;
+		memory.Query(manager, budgets);
+		manager.Update(budgets, 5, evict);
+		if (evict != std::vector<ResidencyHandle>{ a })
+		{
+			std::printf("Fixed case: a 20 byte budget should evict A next\n");
+			return false;
+		}
+
+		evict.clear();
+		memory.Budget[Index(MemorySegment::Local)] = 50;
+		memory.Query(manager, budgets);
+		manager.Update(budgets, 5, evict);
+		if (!evict.empty())
+		{
+			std::printf("Fixed case: a grown budget should evict nothing\n");
+			return false;
+		}
+
+		std::vector<ResidencyHandle> makeResident;
+		manager.MarkUsed(b, 6);
+		manager.MarkUsed(e, 6);
+		manager.TakeMakeResident(makeResident);
+		if (makeResident != std::vector<ResidencyHandle>{ b } || !manager.IsResident(b) || manager.IsResident(d) ||
+			manager.ResidentBytes(MemorySegment::Local) != 30)
+		{
+			std::printf("Fixed case: only B should come back when B and E are used\n");
+			return false;
+		}
+
+		// B, C and E in flight: nothing may go, the update stalls //
+
+		manager.MarkUsed(c, 7);
+		evict.clear();
+		memory.Budget[Index(MemorySegment::Local)] = 10;
+		memory.Query(manager, budgets);
+		manager.Update(budgets, 5, evict);
+		if (!evict.empty() || manager.Stats().StalledUpdates != 1)
+		{
+			std::printf("Fixed case: objects in flight were evicted or the update did not stall\n");
+			return false;
+		}
+
+		return true;
+	}
+
+	// Budget of a frame as a share of the tracked bytes: full, shrinking, low, growing //
+
+	double BudgetShare(std::uint32_t frame, std::uint32_t frames, std::uint32_t& phase)
+	{
+		const double quarter = frames / 4.0;
+		const double t = frame / quarter;
+		phase = std::min(3u, static_cast<std::uint32_t>(t));
+
+		switch (phase)
+		{
+		case 0:
+			return 1.1;
+		case 1:
+			return 1.1 - 0.8 * (t - 1.0);
+		case 2:
+			return 0.3;
+		default:
+			return 0.3 + 0.8 * std::min(1.0, t - 3.0);
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::uint32_t objectCount = 2000;
+	std::uint32_t frames = 2400;
+	std::uint32_t latency = 2;
+	std::uint32_t random = 1;
+	bool quiet = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--objects") == 0 && i + 1 < argc)
+		{
+			objectCount = static_cast<std::uint32_t>(std::max(8l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+		{
+			frames = static_cast<std::uint32_t>(std::max(4l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--latency") == 0 && i + 1 < argc)
+		{
+			latency = static_cast<std::uint32_t>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+		{
+			random = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (std::strcmp(argv[i], "--quiet") == 0)
+		{
+			quiet = true;
+		}
+		else
+		{
+			std::fprintf(stderr, "ResidencyCheck [--objects <count>] [--frames <count>] [--latency <frames>] [--seed <n>] [--quiet]\n");
+			return 2;
+		}
+	}
+
+	if (!CheckFixedOrder())
+	{
+		return 1;
+	}
+
+	const double budgetFraction = 0.95;
+	ResidencyManager manager(budgetFraction);
+	SimulatedVideoMemory memory;
+
+	std::vector<Mirror> mirrors;
+	std::uint64_t trackedBytes[g_MemorySegmentCount] = {};
+	for (std::uint32_t i = 0; i < objectCount; ++i)
+	{
+		Mirror mirror;
+		mirror.Size = (64ull * 1024) << (NextRandom(random) % 7);
+		mirror.Segment = i % 4 == 3 ? MemorySegment::NonLocal : MemorySegment::Local;
+
+		const ResidencyHandle handle = manager.Track(mirror.Size, mirror.Segment);
+		if (handle != mirrors.size())
+		{
+			std::printf("Track handed out handle %u for the object %zu\n", handle, mirrors.size());
+			return 1;
+		}
+
+		trackedBytes[Index(mirror.Segment)] += mirror.Size;
+		mirrors.push_back(mirror);
+	}
+
+	for (std::uint32_t segment = 0; segment < g_MemorySegmentCount; ++segment)
+	{
+		memory.ExternalUsage[segment] = trackedBytes[segment] / 20;
+	}
+
+	const char* phaseNames[] = { "full", "shrinking", "low", "growing" };
+	PhaseStats phases[4];
+	const std::uint32_t window = std::max(1u, objectCount / 8);
+
+	std::vector<ResidencyHandle> evict;
+	std::vector<ResidencyHandle> makeResident;
+	MemoryBudget budgets[g_MemorySegmentCount];
+
+	for (std::uint32_t frame = 0; frame < frames; ++frame)
+	{
+		std::uint32_t phase;
+		const double share = BudgetShare(frame, frames, phase);
+		for (std::uint32_t segment = 0; segment < g_MemorySegmentCount; ++segment)
+		{
+			memory.Budget[segment] = static_cast<std::uint64_t>(share * (trackedBytes[segment] + memory.ExternalUsage[segment]));
+		}
+
+		// Frame f signals fence f + 1, the GPU is --latency frames behind //
+
+		const std::uint64_t frameFence = frame + 1;
+		const std::uint64_t completed = frame >= latency ? frame + 1 - latency : 0;
+
+		evict.clear();
+		memory.Query(manager, budgets);
+		const std::uint64_t stalledBefore = manager.Stats().StalledUpdates;
+		manager.Update(budgets, completed, evict);
+		const bool stalled = manager.Stats().StalledUpdates != stalledBefore;
+		phases[phase].StalledUpdates += stalled ? 1 : 0;
+
+		std::uint64_t newestEvicted[g_MemorySegmentCount] = {};
+		bool evicted[g_MemorySegmentCount] = {};
+		std::uint64_t lastEvictedSize[g_MemorySegmentCount] = {};
+
+		for (ResidencyHandle handle : evict)
+		{
+			Mirror& mirror = mirrors[handle];
+			const std::uint32_t segment = Index(mirror.Segment);
+
+			if (!mirror.Resident)
+			{
+				return Fail("evicted an object that was not resident", frame);
+			}
+			if (mirror.LastUsed > completed)
+			{
+				return Fail("evicted an object still in flight", frame);
+			}
+			if (evicted[segment] && mirror.LastUsed < newestEvicted[segment])
+			{
+				return Fail("evicted out of last use order", frame);
+			}
+
+			mirror.Resident = false;
+			evicted[segment] = true;
+			newestEvicted[segment] = mirror.LastUsed;
+			lastEvictedSize[segment] = mirror.Size;
+			phases[phase].Evictions++;
+			phases[phase].EvictedBytes += mirror.Size;
+		}
+
+		// LRU: nothing still resident in a segment was used before its newest eviction //
+
+		std::uint64_t residentBytes[g_MemorySegmentCount] = {};
+		std::uint64_t oldestCandidate[g_MemorySegmentCount];
+		std::fill(std::begin(oldestCandidate), std::end(oldestCandidate), ~0ull);
+
+		for (const Mirror& mirror : mirrors)
+		{
+			const std::uint32_t segment = Index(mirror.Segment);
+			if (!mirror.Resident)
+			{
+				continue;
+			}
+
+			residentBytes[segment] += mirror.Size;
+			oldestCandidate[segment] = std::min(oldestCandidate[segment], mirror.LastUsed);
+			if (evicted[segment] && mirror.LastUsed < newestEvicted[segment])
+			{
+				return Fail("kept an object used before one it evicted", frame);
+			}
+		}
+
+		for (std::uint32_t segment = 0; segment < g_MemorySegmentCount; ++segment)
+		{
+			if (residentBytes[segment] != manager.ResidentBytes(static_cast<MemorySegment>(segment)))
+			{
+				return Fail("the manager's resident bytes differ from the mirror", frame);
+			}
+
+			const std::uint64_t target = static_cast<std::uint64_t>(budgets[segment].Budget * budgetFraction);
+			const std::uint64_t usage = memory.ExternalUsage[segment] + residentBytes[segment];
+
+			if (evicted[segment] && usage + lastEvictedSize[segment] <= target)
+			{
+				return Fail("evicted more than the budget needed", frame);
+			}
+			if (usage > target && oldestCandidate[segment] <= completed && oldestCandidate[segment] != ~0ull)
+			{
+				return Fail("stayed over the target with a completed object left to evict", frame);
+			}
+		}
+
+		// The frame's working set: a sliding window and a few random objects //
+
+		const std::uint32_t windowStart = static_cast<std::uint32_t>((std::uint64_t(frame) * 3) % objectCount);
+		for (std::uint32_t i = 0; i < window + 16; ++i)
+		{
+			const ResidencyHandle handle = i < window ? (windowStart + i) % objectCount : NextRandom(random) % objectCount;
+			Mirror& mirror = mirrors[handle];
+
+			manager.MarkUsed(handle, frameFence);
+			mirror.LastUsed = frameFence;
+			mirror.UsedWhileEvicted |= !mirror.Resident;
+		}
+
+		makeResident.clear();
+		manager.TakeMakeResident(makeResident);
+		std::sort(makeResident.begin(), makeResident.end());
+		if (std::adjacent_find(makeResident.begin(), makeResident.end()) != makeResident.end())
+		{
+			return Fail("TakeMakeResident handed an object back twice", frame);
+		}
+
+		for (ResidencyHandle handle = 0; handle < mirrors.size(); ++handle)
+		{
+			Mirror& mirror = mirrors[handle];
+			const bool returned = std::binary_search(makeResident.begin(), makeResident.end(), handle);
+			if (returned != mirror.UsedWhileEvicted)
+			{
+				return Fail(returned ? "TakeMakeResident handed back an object that was not used" :
+					"TakeMakeResident missed an evicted object the frame used", frame);
+			}
+
+			if (returned)
+			{
+				mirror.Resident = true;
+				mirror.UsedWhileEvicted = false;
+				phases[phase].MakeResidents++;
+			}
+		}
+
+		if (!quiet && frame % 300 == 0)
+		{
+			std::printf("frame %4u %-9s budget %5.1f%%, local %6.1f MB resident, non local %6.1f MB resident\n", frame, phaseNames[phase],
+				share * 100.0, manager.ResidentBytes(MemorySegment::Local) / 1048576.0, manager.ResidentBytes(MemorySegment::NonLocal) / 1048576.0);
+		}
+	}
+
+	if (!quiet)
+	{
+		for (std::uint32_t phase = 0; phase < 4; ++phase)
+		{
+			std::printf("%-9s %6llu evictions (%8.1f MB), %6llu made resident, %4llu stalled updates\n", phaseNames[phase],
+				static_cast<unsigned long long>(phases[phase].Evictions), phases[phase].EvictedBytes / 1048576.0,
+				static_cast<unsigned long long>(phases[phase].MakeResidents), static_cast<unsigned long long>(phases[phase].StalledUpdates));
+		}
+	}
+
+	std::printf("%u objects over %u frames evicted in LRU order\n", objectCount, frames);
+	return 0;
+}
@@ -0,0 +1,171 @@
+// Runs the dynamic resolution controller against a synthetic GPU timing trace //
+/*
+   ResolutionReplay <timings> [--latency <frames>] [--target <ms>] [--min-scale <scale>] [--max-scale <scale>] [--max-over <percent>] [--quiet]
+
+   Each line of the timings file is one frame: "<pixel ms> [<fixed ms>]", the GPU
+   time of the frame at scale 1 split into the part that grows with the pixel count
+   and the part that does not. Lines starting with # are skipped. The frame at scale s
+   costs fixed + pixel * s * s, and its time sets the scale of the frame --latency
+   frames later (3 by default, the engine's frames in flight, at least 1), as
+   timestamps read back when a frame slot comes around again do. Prints the
+   scale and GPU time of every frame unless --quiet, then how many frames went over
+   the target; with --max-over, fails when more than that percentage of frames did.
+
+   Build with DynamicResolution.cpp, runs on any platform.
+*/
+
+#include "../DynamicResolution.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace PowerEngine::Core;
+
+namespace
+{
+	struct FrameCost
+	{
+		double Pixel = 0.0;
+		double Fixed = 0.0;
+	};
+
+	struct Sample
+	{
+		double GpuMilliseconds;
+		float Scale;
+	};
+
+	bool ReadTimings(const char* path, std::vector<FrameCost>& frames)
+	{
+		std::ifstream file(path);
+		if (!file)
+		{
+			return false;
+		}
+
+		std::string line;
+		while (std::getline(file, line))
+		{
+			if (line.empty() || line[0] == '#')
+			{
+				continue;
+			}
+
+			FrameCost cost;
+			std::istringstream fields(line);
+			if (!(fields >> cost.Pixel))
+			{
+				return false;
+			}
+			fields >> cost.Fixed;
+
+			frames.push_back(cost);
+		}
+
+		return !frames.empty();
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const char* timingsPath = nullptr;
+	DynamicResolutionSettings settings;
+	std::uint32_t latency = 3;
+	double maxOver = -1.0;
+	bool quiet = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--latency") == 0 && i + 1 < argc)
+		{
+			latency = static_cast<std::uint32_t>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--target") == 0 && i + 1 < argc)
+		{
+			settings.TargetMilliseconds = std::strtod(argv[++i], nullptr);
+		}
+		else if (std::strcmp(argv[i], "--min-scale") == 0 && i + 1 < argc)
+		{
+			settings.MinScale = std::strtof(argv[++i], nullptr);
+		}
+		else if (std::strcmp(argv[i], "--max-scale") == 0 && i + 1 < argc)
+		{
+			settings.MaxScale = std::strtof(argv[++i], nullptr);
+		}
+		else if (std::strcmp(argv[i], "--max-over") == 0 && i + 1 < argc)
+		{
+			maxOver = std::strtod(argv[++i], nullptr);
+		}
+		else if (std::strcmp(argv[i], "--quiet") == 0)
+		{
+			quiet = true;
+		}
+		else
+		{
+			timingsPath = argv[i];
+		}
+	}
+
+	if (!timingsPath)
+	{
+		std::fprintf(stderr, "ResolutionReplay <timings> [--latency <frames>] [--target <ms>] [--min-scale <scale>] [--max-scale <scale>] [--max-over <percent>] [--quiet]\n");
+		return 2;
+	}
+
+	std::vector<FrameCost> frames;
+	if (!ReadTimings(timingsPath, frames))
+	{
+		std::fprintf(stderr, "Can't read %s as a timing trace.\n", timingsPath);
+		return 2;
+	}
+
+	DynamicResolutionController controller(settings);
+	const double target = controller.Settings().TargetMilliseconds;
+
+	std::deque<Sample> inFlight;
+	std::uint64_t over = 0;
+	double worst = 0.0;
+	double scaleSum = 0.0;
+
+	for (std::size_t i = 0; i < frames.size(); ++i)
+	{
+		if (inFlight.size() == latency)
+		{
+			controller.Update(inFlight.front().GpuMilliseconds, inFlight.front().Scale);
+			inFlight.pop_front();
+		}
+
+		const float scale = controller.Scale();
+		const double gpu = frames[i].Fixed + frames[i].Pixel * scale * scale;
+
+		over += gpu > target ? 1 : 0;
+		worst = std::max(worst, gpu);
+		scaleSum += scale;
+
+		if (!quiet)
+		{
+			std::printf("%6zu  scale %.3f  gpu %7.2f ms%s\n", i, scale, gpu, gpu > target ? "  OVER" : "");
+		}
+
+		inFlight.push_back({ gpu, scale });
+	}
+
+	const double overPercent = 100.0 * static_cast<double>(over) / static_cast<double>(frames.size());
+	std::printf("%zu frames, %llu over %.2f ms (%.1f%%), worst %.2f ms, mean scale %.3f\n", frames.size(),
+		static_cast<unsigned long long>(over), target, overPercent, worst, scaleSum / static_cast<double>(frames.size()));
+
+	if (maxOver >= 0.0 && overPercent > maxOver)
+	{
+		std::printf("More than %.1f%% of the frames went over the target\n", maxOver);
+		return 1;
+	}
+
+	return 0;
+}
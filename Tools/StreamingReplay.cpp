@@ -0,0 +1,349 @@
+// Runs the texture streamer against a CPU stand-in backend through a budget change //
+/*
+   StreamingReplay [--textures <count>] [--frames <count>] [--budget <MB>] [--low-budget <MB>] [--bandwidth <MB/s>] [--quiet]
+
+   Registers --textures 2048x2048 block compressed textures (256 by default, one
+   byte per texel, the 4 smallest mips pinned) spread along a line the camera flies
+   over, one 60 Hz frame at a time. The budget starts at --budget (256 MB), drops
+   to --low-budget (96 MB) for the middle third of the --frames (1800) and comes
+   back for the last third. The backend copies one upload at a time at
+   --bandwidth (500 MB/s) and cancels the uploads it has not started when the
+   budget drops, as a backend dropping queued work does.
+   The backend keeps its own view of every texture's mips and checks each request,
+   eviction and completion against it. Prints residency every 60 frames unless
+   --quiet, then per phase the uploads, evictions, cancellations, upload latency
+   and how many mips the textures were short of the desired ones on average. Fails
+   when the backend and the streamer disagree or the resident bytes stay over the
+   budget after an Update().
+
+   Build with TextureStreamer.cpp and MemoryTracker.cpp, runs on any platform.
+*/
+
+#include "../TextureStreamer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+using namespace PowerEngine::Assets;
+
+namespace
+{
+	constexpr std::uint32_t g_TextureSize = 2048;
+	constexpr std::uint32_t g_MipCount = 12;
+	constexpr std::uint32_t g_PinnedMips = 4;
+	constexpr double g_FrameSeconds = 1.0 / 60.0;
+	constexpr std::uint64_t g_MegaByte = 1024 * 1024;
+
+	// Stand-in for the GPU side: a serial copy queue with a fixed bandwidth //
+
+	class ReplayBackend : public ITextureStreamingBackend
+	{
+	public:
+
+		ReplayBackend(std::uint32_t textureCount, const std::uint64_t* mipSizes, double bytesPerSecond)
+			: m_ResidentMips(textureCount, g_MipCount - g_PinnedMips)
+			, m_MipSizes(mipSizes)
+			, m_BytesPerSecond(bytesPerSecond)
+		{
+		}
+
+		void BeginUpload(TextureId texture, std::uint32_t mip) override
+		{
+			Check(mip + 1 == m_ResidentMips[texture], "upload of a mip that is not the next finer one");
+			m_Queue.push_back({ texture, mip, 0.0 });
+		}
+
+		void Evict(TextureId texture, std::uint32_t mip) override
+		{
+			Check(mip == m_ResidentMips[texture], "eviction of a mip that is not the finest resident one");
+			Check(mip < g_MipCount - g_PinnedMips, "eviction of a pinned mip");
+			m_ResidentMips[texture]++;
+		}
+
+		// Copies for the length of a frame, completions report back at the time they land //
+
+		void Advance(TextureStreamer& streamer, double beginSeconds, double endSeconds)
+		{
+			double time = std::max(beginSeconds, m_BusyUntil);
+
+			while (!m_Queue.empty())
+			{
+				Upload& upload = m_Queue.front();
+				const double remaining = static_cast<double>(m_MipSizes[upload.Mip]) / m_BytesPerSecond - upload.Progress;
+
+				if (time + remaining > endSeconds)
+				{
+					upload.Progress += std::max(endSeconds - time, 0.0);
+					break;
+				}
+
+				time += remaining;
+				m_ResidentMips[upload.Texture] = upload.Mip;
+				streamer.OnMipResident(upload.Texture, upload.Mip, time);
+				m_Queue.pop_front();
+			}
+
+			m_BusyUntil = m_Queue.empty() ? time : endSeconds;
+		}
+
+		// Drops every upload that has not started copying yet //
+
+		std::uint64_t CancelQueued(TextureStreamer& streamer)
+		{
+			std::uint64_t cancelled = 0;
+			while (m_Queue.size() > 1 || (!m_Queue.empty() && m_Queue.front().Progress == 0.0))
+			{
+				const Upload upload = m_Queue.back();
+				m_Queue.pop_back();
+				streamer.OnUploadCancelled(upload.Texture, upload.Mip);
+				cancelled++;
+			}
+			return cancelled;
+		}
+
+		std::uint64_t ResidentBytes() const
+		{
+			std::uint64_t bytes = 0;
+			for (std::uint32_t first : m_ResidentMips)
+			{
+				for (std::uint32_t mip = first; mip < g_MipCount; ++mip)
+				{
+					bytes += m_MipSizes[mip];
+				}
+			}
+			return bytes;
+		}
+
+		std::uint32_t ResidentMip(TextureId texture) const { return m_ResidentMips[texture]; }
+		bool Failed() const { return m_Failed; }
+
+	private:
+
+		struct Upload
+		{
+			TextureId Texture;
+			std::uint32_t Mip;
+			double Progress;		// seconds of copy already done
+		};
+
+		void Check(bool condition, const char* message)
+		{
+			if (!condition && !m_Failed)
+			{
+				std::printf("Backend: %s\n", message);
+				m_Failed = true;
+			}
+		}
+
+	private:
+
+		std::vector<std::uint32_t> m_ResidentMips;
+		const std::uint64_t* m_MipSizes;
+		double m_BytesPerSecond;
+		std::deque<Upload> m_Queue;
+		double m_BusyUntil = 0.0;
+		bool m_Failed = false;
+	};
+
+	struct PhaseReport
+	{
+		const char* Name;
+		std::uint64_t Budget = 0;
+		std::uint64_t Frames = 0;
+		std::uint64_t Uploads = 0;
+		std::uint64_t Evictions = 0;
+		std::uint64_t Cancelled = 0;
+		std::uint64_t PeakResident = 0;
+		double MissingMips = 0.0;
+		double AverageLatencyMs = 0.0;
+		double MaxLatencyMs = 0.0;
+	};
+
+	// Deterministic positions, the replay must give the same numbers every run //
+
+	std::uint32_t NextRandom(std::uint32_t& state)
+	{
+		state = state * 1664525u + 1013904223u;
+		return state >> 8;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::uint32_t textureCount = 256;
+	std::uint64_t frameCount = 1800;
+	std::uint64_t budget = 256 * g_MegaByte;
+	std::uint64_t lowBudget = 96 * g_MegaByte;
+	double bandwidth = 500.0 * static_cast<double>(g_MegaByte);
+	bool quiet = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--textures") == 0 && i + 1 < argc)
+		{
+			textureCount = static_cast<std::uint32_t>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+		{
+			frameCount = std::max(3ull, std::strtoull(argv[++i], nullptr, 10));
+		}
+		else if (std::strcmp(argv[i], "--budget") == 0 && i + 1 < argc)
+		{
+			budget = std::strtoull(argv[++i], nullptr, 10) * g_MegaByte;
+		}
+		else if (std::strcmp(argv[i], "--low-budget") == 0 && i + 1 < argc)
+		{
+			lowBudget = std::strtoull(argv[++i], nullptr, 10) * g_MegaByte;
+		}
+		else if (std::strcmp(argv[i], "--bandwidth") == 0 && i + 1 < argc)
+		{
+			bandwidth = std::max(1.0, std::strtod(argv[++i], nullptr)) * static_cast<double>(g_MegaByte);
+		}
+		else if (std::strcmp(argv[i], "--quiet") == 0)
+		{
+			quiet = true;
+		}
+		else
+		{
+			std::fprintf(stderr, "StreamingReplay [--textures <count>] [--frames <count>] [--budget <MB>] [--low-budget <MB>] [--bandwidth <MB/s>] [--quiet]\n");
+			return 2;
+		}
+	}
+
+	// Block compressed, a 4x4 block is the smallest a mip gets //
+
+	std::uint64_t mipSizes[g_MipCount];
+	std::uint64_t pinnedBytes = 0;
+	for (std::uint32_t mip = 0; mip < g_MipCount; ++mip)
+	{
+		const std::uint64_t size = std::max(g_TextureSize >> mip, 4u);
+		mipSizes[mip] = size * size;
+		pinnedBytes += mip >= g_MipCount - g_PinnedMips ? mipSizes[mip] : 0;
+	}
+
+	if (pinnedBytes * textureCount > std::min(budget, lowBudget))
+	{
+		std::fprintf(stderr, "The pinned mips alone take %.1f MB, more than the budget.\n",
+			static_cast<double>(pinnedBytes * textureCount) / static_cast<double>(g_MegaByte));
+		return 2;
+	}
+
+	ReplayBackend backend(textureCount, mipSizes, bandwidth);
+	TextureStreamer streamer(backend, budget);
+
+	std::vector<TextureId> textures(textureCount);
+	std::vector<float> positions(textureCount);
+	std::uint32_t random = 1;
+
+	for (std::uint32_t i = 0; i < textureCount; ++i)
+	{
+		StreamingTextureDesc desc = { g_TextureSize, g_TextureSize, g_MipCount, g_PinnedMips, mipSizes };
+		textures[i] = streamer.RegisterTexture(desc);
+		positions[i] = static_cast<float>(NextRandom(random) % 10000) * 0.01f;
+	}
+
+	PhaseReport phases[3] = { { "full" }, { "low" }, { "restored" } };
+	const std::uint64_t budgets[3] = { budget, lowBudget, budget };
+
+	bool failed = false;
+	std::uint64_t lastUploads = 0;
+	std::uint64_t lastEvictions = 0;
+
+	for (std::uint64_t frame = 0; frame < frameCount; ++frame)
+	{
+		const std::size_t phase = static_cast<std::size_t>(std::min<std::uint64_t>(frame * 3 / frameCount, 2));
+		PhaseReport& report = phases[phase];
+		const double time = static_cast<double>(frame) * g_FrameSeconds;
+
+		if (report.Frames == 0)
+		{
+			if (phase > 0 && budgets[phase] < budgets[phase - 1])
+			{
+				report.Cancelled += backend.CancelQueued(streamer);
+			}
+			streamer.SetBudget(budgets[phase]);
+			streamer.ResetLatencyStats();
+			report.Budget = budgets[phase];
+		}
+
+		// The camera flies along the line and back, the objects near it cover most of the screen //
+
+		const float camera = 50.0f + 45.0f * std::sin(static_cast<float>(time));
+		for (std::uint32_t i = 0; i < textureCount; ++i)
+		{
+			const float distance = std::fabs(positions[i] - camera) + 1.0f;
+			streamer.ReportUsage(textures[i], 4.0e6f / (distance * distance));
+		}
+
+		streamer.Update(time);
+
+		// Uploads landing during the frame may go over a lowered budget, the next Update() evicts //
+
+		const TextureStreamingStats& stats = streamer.Stats();
+
+		if (stats.ResidentBytes > stats.BudgetBytes)
+		{
+			std::printf("Frame %llu: %llu resident bytes over the %llu byte budget\n", static_cast<unsigned long long>(frame),
+				static_cast<unsigned long long>(stats.ResidentBytes), static_cast<unsigned long long>(stats.BudgetBytes));
+			failed = true;
+		}
+
+		backend.Advance(streamer, time, time + g_FrameSeconds);
+
+		if (backend.ResidentBytes() != stats.ResidentBytes)
+		{
+			std::printf("Frame %llu: the backend holds %llu bytes, the streamer counts %llu\n", static_cast<unsigned long long>(frame),
+				static_cast<unsigned long long>(backend.ResidentBytes()), static_cast<unsigned long long>(stats.ResidentBytes));
+			failed = true;
+		}
+
+		std::uint32_t missing = 0;
+		for (std::uint32_t i = 0; i < textureCount; ++i)
+		{
+			if (streamer.ResidentMip(textures[i]) != backend.ResidentMip(textures[i]))
+			{
+				failed = true;
+			}
+			missing += streamer.ResidentMip(textures[i]) - std::min(streamer.DesiredMip(textures[i]), streamer.ResidentMip(textures[i]));
+		}
+
+		report.Frames++;
+		report.Uploads += stats.Uploads - lastUploads;
+		report.Evictions += stats.Evictions - lastEvictions;
+		report.PeakResident = std::max(report.PeakResident, stats.ResidentBytes);
+		report.MissingMips += static_cast<double>(missing) / static_cast<double>(textureCount);
+		report.AverageLatencyMs = stats.AverageLatencyMs;
+		report.MaxLatencyMs = stats.MaxLatencyMs;
+		lastUploads = stats.Uploads;
+		lastEvictions = stats.Evictions;
+
+		if (!quiet && frame % 60 == 0)
+		{
+			std::printf("%6llu  %-8s resident %7.1f / %5.1f MB  pending %3u  missing mips %.2f\n", static_cast<unsigned long long>(frame), report.Name,
+				static_cast<double>(stats.ResidentBytes) / static_cast<double>(g_MegaByte), static_cast<double>(stats.BudgetBytes) / static_cast<double>(g_MegaByte),
+				stats.PendingRequests, static_cast<double>(missing) / static_cast<double>(textureCount));
+		}
+	}
+
+	for (const PhaseReport& report : phases)
+	{
+		std::printf("%-8s budget %5.1f MB, peak %5.1f MB, %llu uploads, %llu evictions, %llu cancelled, latency avg %.1f ms max %.1f ms, missing mips %.2f\n",
+			report.Name, static_cast<double>(report.Budget) / static_cast<double>(g_MegaByte),
+			static_cast<double>(report.PeakResident) / static_cast<double>(g_MegaByte), static_cast<unsigned long long>(report.Uploads),
+			static_cast<unsigned long long>(report.Evictions), static_cast<unsigned long long>(report.Cancelled), report.AverageLatencyMs,
+			report.MaxLatencyMs, report.Frames ? report.MissingMips / static_cast<double>(report.Frames) : 0.0);
+	}
+
+	if (failed || backend.Failed())
+	{
+		std::printf("The streamer and the backend disagree or the budget was exceeded\n");
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,277 @@
+// Replays a command trace captured by the engine (F12 or --capture <frames>) //
+/*
+   TraceReplay <trace> [--d3d12] [--repeat <count>] [--baseline <trace>] [--tolerance <percent>]
+
+   By default the trace runs on the CPU stand-in device, which needs neither D3D12
+   nor a GPU, so it runs in CI on any platform. It prints the work of every frame,
+   fails on a malformed stream and, with --baseline, fails when the per frame work of
+   the trace grew past the tolerance over the baseline's. --d3d12 replays on the
+   default adapter instead, Windows only. --repeat replays that many times and
+   reports the fastest, the first replay warms caches.
+
+   Build with the engine's portable sources: CommandTrace.cpp, MappedFile.cpp and
+   RenderStats.cpp, plus CommandTraceD3D12.cpp on Windows.
+*/
+
+#include "../CommandTrace.h"
+#if defined(_WIN32)
+#include "../CommandTraceD3D12.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace PowerEngine::Core;
+
+namespace
+{
+	// Per frame average of the counters CI compares //
+
+	struct TraceSummary
+	{
+		std::uint64_t Frames = 0;
+		double Render[g_RenderCounterCount] = {};
+		double CommandLists = 0.0;
+		double Submissions = 0.0;
+		double Signals = 0.0;
+		double Waits = 0.0;
+		double Copies = 0.0;
+	};
+
+	bool Simulate(CommandTraceReader& reader, SimulatedTraceDevice& device)
+	{
+		std::string error;
+		const bool replayed = ReplayCommandTrace(reader, device, &error);
+		device.Finish();
+
+		if (!replayed)
+		{
+			std::fprintf(stderr, "%s\n", error.c_str());
+		}
+		for (const std::string& message : device.Errors())
+		{
+			std::fprintf(stderr, "%s\n", message.c_str());
+		}
+
+		return replayed && device.Errors().empty();
+	}
+
+	void PrintFrames(const SimulatedTraceDevice& device)
+	{
+		for (const TraceFrameStats& frame : device.Frames())
+		{
+			std::printf("%s | Lists %llu Submits %llu Signals %llu Waits %llu Copies %llu\n",
+				RenderStats::Format(frame.Render).c_str(),
+				static_cast<unsigned long long>(frame.CommandLists), static_cast<unsigned long long>(frame.Submissions),
+				static_cast<unsigned long long>(frame.Signals), static_cast<unsigned long long>(frame.Waits),
+				static_cast<unsigned long long>(frame.Copies));
+		}
+	}
+
+	TraceSummary Summarize(const std::vector<TraceFrameStats>& frames)
+	{
+		TraceSummary summary;
+		summary.Frames = frames.size();
+
+		for (const TraceFrameStats& frame : frames)
+		{
+			for (std::uint32_t i = 0; i < g_RenderCounterCount; ++i)
+			{
+				summary.Render[i] += static_cast<double>(frame.Render.Counters[i]);
+			}
+			summary.CommandLists += static_cast<double>(frame.CommandLists);
+			summary.Submissions += static_cast<double>(frame.Submissions);
+			summary.Signals += static_cast<double>(frame.Signals);
+			summary.Waits += static_cast<double>(frame.Waits);
+			summary.Copies += static_cast<double>(frame.Copies);
+		}
+
+		const double scale = frames.empty() ? 0.0 : 1.0 / static_cast<double>(frames.size());
+		for (double& counter : summary.Render)
+		{
+			counter *= scale;
+		}
+		summary.CommandLists *= scale;
+		summary.Submissions *= scale;
+		summary.Signals *= scale;
+		summary.Waits *= scale;
+		summary.Copies *= scale;
+
+		return summary;
+	}
+
+	// Returns the number of counters that regressed //
+
+	int Compare(const char* name, double value, double baseline, double tolerance)
+	{
+		const bool regressed = value > baseline * (1.0 + tolerance / 100.0);
+		std::printf("%-22s %12.1f %12.1f%s\n", name, baseline, value, regressed ? "  REGRESSED" : "");
+		return regressed ? 1 : 0;
+	}
+
+	int CompareSummaries(const TraceSummary& summary, const TraceSummary& baseline, double tolerance)
+	{
+		std::printf("%-22s %12s %12s   (per frame)\n", "", "baseline", "trace");
+
+		int regressions = 0;
+		for (std::uint32_t i = 0; i < g_RenderCounterCount; ++i)
+		{
+			const RenderCounter counter = static_cast<RenderCounter>(i);
+			const double scale = counter == RenderCounter::UploadBytes ? 1.0 / 1024.0 : 1.0;	// named in KB
+			regressions += Compare(RenderCounterName(counter), summary.Render[i] * scale, baseline.Render[i] * scale, tolerance);
+		}
+		regressions += Compare("CommandLists", summary.CommandLists, baseline.CommandLists, tolerance);
+		regressions += Compare("Submissions", summary.Submissions, baseline.Submissions, tolerance);
+		regressions += Compare("Signals", summary.Signals, baseline.Signals, tolerance);
+		regressions += Compare("Waits", summary.Waits, baseline.Waits, tolerance);
+		regressions += Compare("Copies", summary.Copies, baseline.Copies, tolerance);
+
+		return regressions;
+	}
+
+#if defined(_WIN32)
+	bool ReplayD3D12(CommandTraceReader& reader, std::uint32_t repeat)
+	{
+		ComPtr<ID3D12Device2> device;
+		if (FAILED(D3D12CreateDevice(nullptr, D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&device))))
+		{
+			std::fprintf(stderr, "No D3D12 device.\n");
+			return false;
+		}
+
+		double fastest = 0.0;
+		for (std::uint32_t i = 0; i < repeat; ++i)
+		{
+			reader.Rewind();
+			TraceDeviceD3D12 replay(device);
+
+			const auto start = std::chrono::steady_clock::now();
+			std::string error;
+			const bool replayed = ReplayCommandTrace(reader, replay, &error);
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			replay.Finish();
+
+			if (!replayed)
+			{
+				std::fprintf(stderr, "%s\n", error.c_str());
+				return false;
+			}
+
+			fastest = i == 0 ? seconds : std::min(fastest, seconds);
+			if (i + 1 == repeat)
+			{
+				std::printf("D3D12: %llu frames, %llu draws and dispatches skipped\n",
+					static_cast<unsigned long long>(replay.Frames()), static_cast<unsigned long long>(replay.SkippedCommands()));
+			}
+		}
+
+		std::printf("Submission time %.3f ms\n", fastest * 1000.0);
+		return true;
+	}
+#endif
+}
+
+int main(int argc, char** argv)
+{
+	const char* tracePath = nullptr;
+	const char* baselinePath = nullptr;
+	double tolerance = 0.0;
+	std::uint32_t repeat = 1;
+	bool d3d12 = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--d3d12") == 0)
+		{
+			d3d12 = true;
+		}
+		else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+		{
+			repeat = static_cast<std::uint32_t>(std::max(1l, std::strtol(argv[++i], nullptr, 10)));
+		}
+		else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+		{
+			baselinePath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc)
+		{
+			tolerance = std::strtod(argv[++i], nullptr);
+		}
+		else
+		{
+			tracePath = argv[i];
+		}
+	}
+
+	if (!tracePath)
+	{
+		std::fprintf(stderr, "TraceReplay <trace> [--d3d12] [--repeat <count>] [--baseline <trace>] [--tolerance <percent>]\n");
+		return 2;
+	}
+
+	CommandTraceReader reader;
+	if (!reader.Open(tracePath))
+	{
+		std::fprintf(stderr, "Can't open %s as a command trace.\n", tracePath);
+		return 2;
+	}
+
+	if (d3d12)
+	{
+#if defined(_WIN32)
+		return ReplayD3D12(reader, repeat) ? 0 : 1;
+#else
+		std::fprintf(stderr, "D3D12 replay needs Windows.\n");
+		return 2;
+#endif
+	}
+
+	// The stand-in replays are timed as a whole, they check and count every record //
+
+	SimulatedTraceDevice device;
+	double fastest = 0.0;
+
+	for (std::uint32_t i = 0; i < repeat; ++i)
+	{
+		reader.Rewind();
+		device = SimulatedTraceDevice();
+
+		const auto start = std::chrono::steady_clock::now();
+		const bool valid = Simulate(reader, device);
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		fastest = i == 0 ? seconds : std::min(fastest, seconds);
+
+		if (!valid)
+		{
+			return 1;
+		}
+	}
+
+	PrintFrames(device);
+	std::printf("%zu frames, replayed in %.3f ms\n", device.Frames().size(), fastest * 1000.0);
+
+	if (baselinePath)
+	{
+		CommandTraceReader baselineReader;
+		SimulatedTraceDevice baselineDevice;
+		if (!baselineReader.Open(baselinePath) || !Simulate(baselineReader, baselineDevice))
+		{
+			std::fprintf(stderr, "Can't replay the baseline %s.\n", baselinePath);
+			return 2;
+		}
+
+		const int regressions = CompareSummaries(Summarize(device.Frames()), Summarize(baselineDevice.Frames()), tolerance);
+		if (regressions != 0)
+		{
+			std::printf("%d counters regressed past %.1f%%\n", regressions, tolerance);
+			return 1;
+		}
+	}
+
+	return 0;
+}